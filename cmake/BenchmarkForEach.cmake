@@ -0,0 +1,17 @@
+function(benchmark_foreach)
+    # Create a benchmark for each module.
+    foreach(BENCHMARK IN LISTS ARGV)
+        # Benchmark name is file name without .cpp extension.
+        get_filename_component(BENCHMARK_NAME ${BENCHMARK} NAME_WLE)
+        # Create the benchmark executable.
+        add_executable(${BENCHMARK_NAME})
+        # Add source files to the executable.
+        target_sources(${BENCHMARK_NAME} PRIVATE ${BENCHMARK})
+        # Get include directories of the Network Testing Suite.
+        get_target_property(NTS_INCLUDE_DIRS nts INCLUDE_DIRECTORIES)
+        # Add include directories.
+        target_include_directories(${BENCHMARK_NAME} PUBLIC ${NTS_INCLUDE_DIRS})
+        # Link to the required libraries.
+        target_link_libraries(${BENCHMARK_NAME} benchmark::benchmark_main nts)
+    endforeach()
+endfunction(benchmark_foreach)
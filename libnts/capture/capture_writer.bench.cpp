@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+
+#include <libnts/capture/capture_writer.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+/// Cost of capture() on the receive path, for 128 byte frames. Arguments select direct
+/// I/O and io_uring.
+void BM_CaptureWriter(benchmark::State& state)
+{
+    const std::string filename = "/tmp/nts_capture.bench.pcapng";
+    cap::CaptureWriterOptions options;
+    options.directIo = state.range(0) != 0;
+    options.useIoUring = state.range(1) != 0;
+    cap::CaptureWriter writer(filename, options);
+    const std::vector<uint8_t> frame(128, 0xab);
+    int64_t timestamp = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(writer.capture(frame.data(), frame.size(), timestamp++));
+    }
+    writer.close();
+
+    const cap::CaptureStatistics statistics = writer.getStatistics();
+    state.SetItemsProcessed(statistics.frames);
+    state.SetBytesProcessed(statistics.bytes);
+    state.counters["drops"] = statistics.drops;
+    state.counters["backpressure"] = statistics.backpressure;
+    std::remove(filename.c_str());
+}
+
+BENCHMARK(BM_CaptureWriter)->Args({ 0, 0 })->Args({ 1, 0 })->Args({ 1, 1 });
+
+} // namespace benchmarks
+} // namespace nts
@@ -0,0 +1,606 @@
+#include <libnts/capture/capture_writer.hpp>
+
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <libnts/config/configuration.hpp>
+#include <libnts/core/io_uring.hpp>
+
+namespace nts {
+namespace cap {
+
+namespace {
+
+/// Alignment of the offsets, lengths and buffers of O_DIRECT writes.
+constexpr std::size_t directAlignment{ 4096 };
+
+/// Type of the pcapng Section Header Block.
+constexpr uint32_t sectionHeaderBlock{ 0x0a0d0d0a };
+
+/// Type of the pcapng Interface Description Block.
+constexpr uint32_t interfaceBlock{ 1 };
+
+/// Type of the pcapng Enhanced Packet Block.
+constexpr uint32_t enhancedPacketBlock{ 6 };
+
+/// Type of the pcapng Custom Block that readers may skip and must not copy. Used as padding.
+constexpr uint32_t paddingBlock{ 0x40000BAD };
+
+/// Private Enterprise Number of the padding block (the IANA example enterprise).
+constexpr uint32_t paddingEnterprise{ 32473 };
+
+/// Smallest padding block: type, length, enterprise number and trailing length.
+constexpr std::size_t minimumPadding{ 16 };
+
+/// Size of the section header and interface description that start the file.
+constexpr std::size_t fileHeaderSize{ 28 + 32 };
+
+/// Enhanced Packet Block without the frame.
+constexpr std::size_t enhancedPacketOverhead{ 32 };
+
+constexpr int64_t nanosecondsPerSecond{ 1000000000 };
+
+/// Current time in nanoseconds since the epoch.
+int64_t wallClock()
+{
+    timespec time;
+    clock_gettime(CLOCK_REALTIME, &time);
+    return int64_t(time.tv_sec) * nanosecondsPerSecond + time.tv_nsec;
+}
+
+/// Adds to a counter that only the calling thread writes, without a locked instruction.
+inline void add(std::atomic<uint64_t>& counter, const uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/// Writes a native 32-bit integer and returns the position after it.
+inline uint8_t* put32(uint8_t* position, const uint32_t value)
+{
+    memcpy(position, &value, sizeof(value));
+    return position + sizeof(value);
+}
+
+/// Writes a native 16-bit integer and returns the position after it.
+inline uint8_t* put16(uint8_t* position, const uint16_t value)
+{
+    memcpy(position, &value, sizeof(value));
+    return position + sizeof(value);
+}
+
+/// Writes a padding block that fills the given number of bytes.
+void putPadding(uint8_t* position, const std::size_t length)
+{
+    memset(position, 0, length);
+    put32(position, paddingBlock);
+    put32(position + 4, static_cast<uint32_t>(length));
+    put32(position + 8, paddingEnterprise);
+    put32(position + length - 4, static_cast<uint32_t>(length));
+}
+
+/// Writes the section header and the description of the Ethernet interface, with
+/// nanosecond timestamps.
+void putFileHeader(uint8_t* position, const uint32_t snapLength)
+{
+    position = put32(position, sectionHeaderBlock);
+    position = put32(position, 28);
+    position = put32(position, 0x1a2b3c4d);
+    position = put16(position, 1);
+    position = put16(position, 0);
+    // Unknown section length.
+    position = put32(position, 0xFFFFFFFF);
+    position = put32(position, 0xFFFFFFFF);
+    position = put32(position, 28);
+
+    position = put32(position, interfaceBlock);
+    position = put32(position, 32);
+    position = put16(position, static_cast<uint16_t>(linkTypeEthernet));
+    position = put16(position, 0);
+    position = put32(position, snapLength);
+    // if_tsresol: 10^-9 seconds.
+    position = put16(position, 9);
+    position = put16(position, 1);
+    position = put32(position, 9);
+    // opt_endofopt.
+    position = put32(position, 0);
+    put32(position, 32);
+}
+
+} // namespace
+
+CaptureWriterOptions& CaptureWriterOptions::configure(std::shared_ptr<Configuration> config, const std::string& key)
+{
+    if (auto size = config->getInt(key + ".BlockSize"))
+    {
+        blockSize = size.value();
+    }
+    if (auto count = config->getInt(key + ".BlockCount"))
+    {
+        blockCount = count.value();
+    }
+    if (auto length = config->getInt(key + ".SnapLength"))
+    {
+        snapLength = length.value();
+    }
+    if (auto direct = config->getBool(key + ".DirectIo"))
+    {
+        directIo = direct.value();
+    }
+    if (auto uring = config->getBool(key + ".IoUring"))
+    {
+        useIoUring = uring.value();
+    }
+    return *this;
+}
+
+CaptureWriter::CaptureWriter(const std::string& filename, const CaptureWriterOptions& options)
+    : options(options)
+    , blockLengths(options.blockCount, 0)
+    , freeBlocks(options.blockCount)
+    , fullBlocks(options.blockCount)
+{
+    if (options.blockSize == 0 || options.blockSize % directAlignment != 0)
+    {
+        throw std::invalid_argument("Capture block size must be a multiple of 4096");
+    }
+    if (options.blockCount < 2)
+    {
+        throw std::invalid_argument("Capture writer needs at least two blocks");
+    }
+    // The largest frame must fit in a block after the file header, with room for padding.
+    if (fileHeaderSize + enhancedPacketOverhead + ((std::size_t(options.snapLength) + 3) & ~std::size_t(3)) + minimumPadding > options.blockSize)
+    {
+        throw std::invalid_argument("Capture snap length doesn't fit in a block");
+    }
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (options.directIo)
+    {
+        fd = open(filename.c_str(), flags | O_DIRECT, 0644);
+        direct = fd >= 0;
+    }
+    if (fd < 0)
+    {
+        fd = open(filename.c_str(), flags, 0644);
+    }
+    if (fd < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "open");
+    }
+
+    // Populated up front, so the receive path never takes a page fault on a fresh block.
+    const std::size_t arenaSize = options.blockSize * options.blockCount;
+    void* mapping = mmap(nullptr, arenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        const int error = errno;
+        ::close(fd);
+        throw boost::system::system_error(error, boost::system::system_category(), "mmap");
+    }
+    blocks = static_cast<uint8_t*>(mapping);
+
+    eventFd = eventfd(0, EFD_CLOEXEC);
+    if (eventFd < 0)
+    {
+        const int error = errno;
+        munmap(blocks, arenaSize);
+        ::close(fd);
+        throw boost::system::system_error(error, boost::system::system_category(), "eventfd");
+    }
+
+    if (options.useIoUring)
+    {
+        try
+        {
+            ring.reset(new ss::IoUring(static_cast<uint32_t>(options.blockCount)));
+            pendingBlocks.reserve(options.blockCount);
+        }
+        catch (const boost::system::system_error&)
+        {
+            // Not supported, or not allowed. The blocks are written directly instead.
+        }
+    }
+    if (ring)
+    {
+        try
+        {
+            // Fixed buffers save pinning the pages of each block on every write.
+            ring->registerBuffers({ iovec{ blocks, arenaSize } });
+            fixedBuffers = true;
+        }
+        catch (const boost::system::system_error&)
+        {
+            // Over the locked memory limit. Plain writes still work.
+        }
+    }
+
+    for (uint32_t block = 1; block < options.blockCount; block++)
+    {
+        freeBlocks.tryPush(block);
+    }
+    currentBlock = 0;
+    hasBlock = true;
+    putFileHeader(blocks, options.snapLength);
+    blockLengths[0] = fileHeaderSize;
+
+    ioThread = std::thread(&CaptureWriter::writeBlocks, this);
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const boost::system::system_error&)
+    {
+        // Nothing can be done about it in a destructor.
+    }
+}
+
+bool CaptureWriter::capture(const uint8_t* data, const std::size_t length, const int64_t timestamp)
+{
+    if (!hasBlock && !acquireBlock())
+    {
+        add(drops, 1);
+        return false;
+    }
+
+    const uint32_t captured = static_cast<uint32_t>(std::min<std::size_t>(length, options.snapLength));
+    const std::size_t padded = (std::size_t(captured) + 3) & ~std::size_t(3);
+    const std::size_t needed = enhancedPacketOverhead + padded;
+
+    // Frames either fill the block exactly, or leave room for a padding block.
+    std::size_t remaining = options.blockSize - blockLengths[currentBlock];
+    if (needed != remaining && needed + minimumPadding > remaining)
+    {
+        releaseBlock();
+        if (!acquireBlock())
+        {
+            add(drops, 1);
+            return false;
+        }
+    }
+
+    uint8_t* position = getBlock(currentBlock) + blockLengths[currentBlock];
+    const uint64_t time = static_cast<uint64_t>(std::max<int64_t>(timestamp, 0));
+    position = put32(position, enhancedPacketBlock);
+    position = put32(position, static_cast<uint32_t>(needed));
+    position = put32(position, 0);
+    position = put32(position, static_cast<uint32_t>(time >> 32));
+    position = put32(position, static_cast<uint32_t>(time));
+    position = put32(position, captured);
+    position = put32(position, static_cast<uint32_t>(length));
+    memcpy(position, data, captured);
+    memset(position + captured, 0, padded - captured);
+    put32(position + padded, static_cast<uint32_t>(needed));
+
+    blockLengths[currentBlock] += needed;
+    add(frames, 1);
+    add(bytes, captured);
+    if (blockLengths[currentBlock] == options.blockSize)
+    {
+        releaseBlock();
+    }
+    return true;
+}
+
+bool CaptureWriter::capture(const uint8_t* data, const std::size_t length)
+{
+    return capture(data, length, wallClock());
+}
+
+void CaptureWriter::flush()
+{
+    if (hasBlock && blockLengths[currentBlock] > 0)
+    {
+        releaseBlock();
+    }
+}
+
+void CaptureWriter::close()
+{
+    if (closed)
+    {
+        return;
+    }
+    flush();
+    closed = true;
+    stopping.store(true, std::memory_order_release);
+    notify();
+    ioThread.join();
+
+    ring.reset();
+    munmap(blocks, options.blockSize * options.blockCount);
+    ::close(eventFd);
+    ::close(fd);
+
+    const int error = firstError.load();
+    if (error != 0)
+    {
+        throw boost::system::system_error(error, boost::system::system_category(), "write");
+    }
+}
+
+CaptureStatistics CaptureWriter::getStatistics() const
+{
+    CaptureStatistics statistics;
+    statistics.frames = frames.load(std::memory_order_relaxed);
+    statistics.bytes = bytes.load(std::memory_order_relaxed);
+    statistics.drops = drops.load(std::memory_order_relaxed);
+    statistics.backpressure = backpressure.load(std::memory_order_relaxed);
+    statistics.blocksWritten = blocksWritten.load(std::memory_order_relaxed);
+    statistics.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+    statistics.writeErrors = writeErrors.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+bool CaptureWriter::isDirect() const
+{
+    return direct;
+}
+
+bool CaptureWriter::isUsingIoUring() const
+{
+    return ring != nullptr;
+}
+
+bool CaptureWriter::acquireBlock()
+{
+    if (closed)
+    {
+        return false;
+    }
+    if (!freeBlocks.tryPop(currentBlock))
+    {
+        if (!starved)
+        {
+            starved = true;
+            add(backpressure, 1);
+        }
+        return false;
+    }
+    blockLengths[currentBlock] = 0;
+    hasBlock = true;
+    starved = false;
+    return true;
+}
+
+void CaptureWriter::releaseBlock()
+{
+    std::size_t& length = blockLengths[currentBlock];
+    if (direct && length % directAlignment != 0)
+    {
+        // Frames keep the gap to the end of the block at zero or at least a padding block,
+        // so a gap that is too small never occurs at the end of the block.
+        std::size_t aligned = (length + directAlignment - 1) / directAlignment * directAlignment;
+        if (aligned - length < minimumPadding)
+        {
+            aligned += directAlignment;
+        }
+        putPadding(getBlock(currentBlock) + length, aligned - length);
+        length = aligned;
+    }
+    fullBlocks.tryPush(currentBlock);
+    hasBlock = false;
+    notify();
+}
+
+void CaptureWriter::writeBlocks()
+{
+    if (ring)
+    {
+        try
+        {
+            writeBlocksWithIoUring();
+            return;
+        }
+        catch (const boost::system::system_error& error)
+        {
+            // The ring stopped accepting writes. The blocks of the failed submission and the
+            // remaining ones are written directly, after the ones submitted to the ring. The
+            // writes still in flight are collected first, so their blocks are reused.
+            recordError(error.code().value());
+            try
+            {
+                ss::IoCompletion completion;
+                while (writesInFlight > 0)
+                {
+                    ring->waitCompletion(completion);
+                    completeWrite(completion);
+                    writesInFlight--;
+                }
+            }
+            catch (const boost::system::system_error& drainError)
+            {
+                recordError(drainError.code().value());
+            }
+            lseek(fd, static_cast<off_t>(fileOffset), SEEK_SET);
+            for (const uint32_t block : pendingBlocks)
+            {
+                writeBlock(block);
+            }
+        }
+    }
+    writeBlocksSynchronously();
+}
+
+void CaptureWriter::writeBlocksSynchronously()
+{
+    for (;;)
+    {
+        uint32_t block;
+        if (!fullBlocks.tryPop(block))
+        {
+            // Blocks handed over before the writer stopped are visible after the flag.
+            if (stopping.load(std::memory_order_acquire) && fullBlocks.empty())
+            {
+                return;
+            }
+            waitForBlocks();
+            continue;
+        }
+        writeBlock(block);
+    }
+}
+
+void CaptureWriter::writeBlock(const uint32_t block)
+{
+    const uint8_t* data = getBlock(block);
+    const std::size_t length = blockLengths[block];
+    std::size_t written = 0;
+    while (written < length)
+    {
+        // Blocks are written in order, so the file position is the block offset. Unlike
+        // pwrite, this also works on pipes.
+        const ssize_t result = ::write(fd, data + written, length - written);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            recordError(errno);
+            break;
+        }
+        written += result;
+    }
+    fileOffset += written;
+    completeBlock(block, written);
+}
+
+void CaptureWriter::writeBlocksWithIoUring()
+{
+    for (;;)
+    {
+        // Every block handed over is submitted at once, with a single system call.
+        uint32_t block;
+        const std::size_t submissionOffset = fileOffset;
+        while (fullBlocks.tryPop(block))
+        {
+            io_uring_sqe* entry = ring->getSubmission();
+            entry->opcode = fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            entry->fd = fd;
+            entry->addr = reinterpret_cast<uint64_t>(getBlock(block));
+            entry->len = static_cast<uint32_t>(blockLengths[block]);
+            entry->off = fileOffset;
+            entry->buf_index = 0;
+            entry->user_data = block;
+            fileOffset += blockLengths[block];
+            pendingBlocks.push_back(block);
+        }
+        const bool submitted = !pendingBlocks.empty();
+        if (submitted)
+        {
+            try
+            {
+                ring->submit();
+            }
+            catch (const boost::system::system_error&)
+            {
+                // The kernel took none of the entries. The caller writes the blocks from
+                // their own offset.
+                fileOffset = submissionOffset;
+                throw;
+            }
+            writesInFlight += pendingBlocks.size();
+            pendingBlocks.clear();
+        }
+
+        ss::IoCompletion completion;
+        bool completed = false;
+        while (ring->peekCompletion(completion))
+        {
+            completeWrite(completion);
+            writesInFlight--;
+            completed = true;
+        }
+        if (submitted || completed)
+        {
+            continue;
+        }
+
+        if (writesInFlight > 0)
+        {
+            ring->waitCompletion(completion);
+            completeWrite(completion);
+            writesInFlight--;
+        }
+        else if (stopping.load(std::memory_order_acquire) && fullBlocks.empty())
+        {
+            return;
+        }
+        else
+        {
+            waitForBlocks();
+        }
+    }
+}
+
+void CaptureWriter::completeWrite(const ss::IoCompletion& completion)
+{
+    const uint32_t block = static_cast<uint32_t>(completion.userData);
+    if (completion.result < 0)
+    {
+        recordError(-completion.result);
+        completeBlock(block, 0);
+        return;
+    }
+    if (std::size_t(completion.result) < blockLengths[block])
+    {
+        // Regular files only write part of a block when the disk is full.
+        recordError(ENOSPC);
+    }
+    completeBlock(block, completion.result);
+}
+
+void CaptureWriter::completeBlock(const uint32_t block, const std::size_t written)
+{
+    if (written > 0)
+    {
+        add(blocksWritten, 1);
+        add(bytesWritten, written);
+    }
+    freeBlocks.tryPush(block);
+}
+
+void CaptureWriter::recordError(const int error)
+{
+    add(writeErrors, 1);
+    int expected = 0;
+    firstError.compare_exchange_strong(expected, error);
+}
+
+void CaptureWriter::waitForBlocks()
+{
+    uint64_t value;
+    while (read(eventFd, &value, sizeof(value)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+void CaptureWriter::notify()
+{
+    const uint64_t value = 1;
+    while (::write(eventFd, &value, sizeof(value)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+uint8_t* CaptureWriter::getBlock(const uint32_t block) const
+{
+    return blocks + std::size_t(block) * options.blockSize;
+}
+
+} // namespace cap
+} // namespace nts
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libnts/capture/pcap_file.hpp>
+#include <libnts/core/ring_buffer.hpp>
+
+namespace nts {
+
+// Forward declarations.
+class Configuration;
+namespace ss {
+class IoUring;
+struct IoCompletion;
+}
+
+namespace cap {
+
+/// Settings of a CaptureWriter.
+struct CaptureWriterOptions
+{
+    /// Size of each block in bytes. Must be a multiple of 4096.
+    std::size_t blockSize{ 1 << 20 };
+
+    /// Number of blocks. Frames are dropped when every block is waiting to be written.
+    std::size_t blockCount{ 16 };
+
+    /// Largest number of bytes stored for a frame.
+    uint32_t snapLength{ defaultSnapLength };
+
+    /// Bypass the page cache (O_DIRECT). Falls back to buffered writes when the file system
+    /// doesn't support it.
+    bool directIo{ false };
+
+    /// Write blocks through io_uring, with several writes in flight. Falls back to write
+    /// calls when io_uring is not available.
+    bool useIoUring{ false };
+
+    /// Configure the options with the parameters under the given key.
+    /// @example
+    /// options.configure(config, "Session.Capture"); // Reads "Session.Capture.BlockSize", etc.
+    CaptureWriterOptions& configure(std::shared_ptr<Configuration> config, const std::string& key);
+};
+
+/// Counters of a CaptureWriter.
+struct CaptureStatistics
+{
+    /// Frames stored in a block.
+    uint64_t frames{ 0 };
+
+    /// Bytes of the stored frames.
+    uint64_t bytes{ 0 };
+
+    /// Frames that were not stored because no block was free.
+    uint64_t drops{ 0 };
+
+    /// Times the receive path ran out of free blocks.
+    uint64_t backpressure{ 0 };
+
+    /// Blocks written to the file.
+    uint64_t blocksWritten{ 0 };
+
+    /// Bytes written to the file, including headers and padding.
+    uint64_t bytesWritten{ 0 };
+
+    /// Writes that failed.
+    uint64_t writeErrors{ 0 };
+};
+
+/// Records frames to a pcapng file from a dedicated I/O thread.
+///
+/// @details Frames are appended as Enhanced Packet Blocks into large, page aligned blocks
+/// of memory. Full blocks are handed to the I/O thread through a lock-free queue and
+/// returned once they are written, so capture() never waits for the disk: when every block
+/// is in flight, the frame is dropped and counted instead. capture() must be called from a
+/// single thread.
+///
+/// With direct I/O, blocks are padded to the 4096 byte alignment required by O_DIRECT with
+/// a custom block, which readers skip.
+///
+/// @example
+/// auto capture = std::make_shared<CaptureWriter>("run.pcapng");
+/// session.setCaptureWriter(capture);
+/// ...
+/// capture->close();
+/// std::cout << capture->getStatistics().drops;
+class CaptureWriter
+{
+public:
+    /// Constructor. Creates or truncates the file and starts the I/O thread.
+    /// @throws boost::system::system_error If the file can't be created.
+    /// @throws std::invalid_argument If the options are invalid.
+    explicit CaptureWriter(const std::string& filename, const CaptureWriterOptions& options = CaptureWriterOptions());
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /// Destructor. Closes the writer, ignoring write errors.
+    ~CaptureWriter();
+
+    /// Store a frame. Frames longer than the snap length are truncated.
+    /// @param timestamp Time of the frame in nanoseconds since the epoch.
+    /// @returns Whether the frame was stored, rather than dropped.
+    bool capture(const uint8_t* data, const std::size_t length, const int64_t timestamp);
+
+    /// Store a frame with the current time.
+    bool capture(const uint8_t* data, const std::size_t length);
+
+    /// Hand the current block to the I/O thread, even if it is not full.
+    /// @details Called from the capturing thread.
+    void flush();
+
+    /// Write every stored frame and stop the I/O thread.
+    /// @details Frames captured afterwards are dropped.
+    /// @throws boost::system::system_error If a block could not be written.
+    void close();
+
+    /// Snapshot of the counters.
+    CaptureStatistics getStatistics() const;
+
+    /// Whether the file bypasses the page cache.
+    bool isDirect() const;
+
+    /// Whether the blocks are written through io_uring.
+    bool isUsingIoUring() const;
+
+private:
+    /// Takes a free block for the capturing thread.
+    bool acquireBlock();
+
+    /// Pads the current block and hands it to the I/O thread.
+    void releaseBlock();
+
+    /// Body of the I/O thread.
+    void writeBlocks();
+
+    /// Writes blocks with write calls.
+    void writeBlocksSynchronously();
+
+    /// Writes a block at the file position with write calls, and returns it to the free blocks.
+    void writeBlock(const uint32_t block);
+
+    /// Writes blocks through io_uring.
+    void writeBlocksWithIoUring();
+
+    /// Accounts for a write submitted through io_uring.
+    void completeWrite(const ss::IoCompletion& completion);
+
+    /// Counts a written block and returns it to the capturing thread.
+    void completeBlock(const uint32_t block, const std::size_t written);
+
+    /// Counts a failed write, and keeps the first error for close().
+    void recordError(const int error);
+
+    /// Waits until a block is handed over or the writer is closed.
+    void waitForBlocks();
+
+    /// Wakes up the I/O thread.
+    void notify();
+
+    /// Start of a block.
+    uint8_t* getBlock(const uint32_t block) const;
+
+    /// Settings of the writer.
+    CaptureWriterOptions options;
+
+    /// Descriptor of the file.
+    int fd{ -1 };
+
+    /// Descriptor that wakes up the I/O thread (eventfd).
+    int eventFd{ -1 };
+
+    /// Memory of all the blocks.
+    uint8_t* blocks{ nullptr };
+
+    /// Submits the writes when io_uring is used.
+    std::unique_ptr<ss::IoUring> ring;
+
+    /// Whether the blocks are registered with the ring.
+    bool fixedBuffers{ false };
+
+    /// Bytes used in each block.
+    std::vector<std::size_t> blockLengths;
+
+    /// Blocks ready to be filled, returned by the I/O thread. Sized for every block, so
+    /// pushes never fail.
+    SpscRingBuffer<uint32_t> freeBlocks;
+
+    /// Blocks ready to be written, handed over by the capturing thread.
+    SpscRingBuffer<uint32_t> fullBlocks;
+
+    /// Block being filled, owned by the capturing thread.
+    uint32_t currentBlock{ 0 };
+
+    /// Whether the capturing thread holds a block.
+    bool hasBlock{ false };
+
+    /// Whether the capturing thread ran out of blocks, so consecutive drops count as a single
+    /// backpressure event.
+    bool starved{ false };
+
+    /// Whether the file was opened with O_DIRECT.
+    bool direct{ false };
+
+    /// Whether the writer was closed.
+    bool closed{ false };
+
+    /// Offset of the next block in the file, used by the I/O thread.
+    std::size_t fileOffset{ 0 };
+
+    /// Blocks prepared for a submission to the ring that hasn't gone through yet, in file
+    /// order, used by the I/O thread. They are written directly if the submission fails.
+    std::vector<uint32_t> pendingBlocks;
+
+    /// Writes submitted to the ring whose completion wasn't read yet, used by the I/O thread.
+    std::size_t writesInFlight{ 0 };
+
+    /// Set when the I/O thread should exit once every handed over block is written.
+    std::atomic<bool> stopping{ false };
+
+    /// Counters written by the capturing thread.
+    std::atomic<uint64_t> frames{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<uint64_t> drops{ 0 };
+    std::atomic<uint64_t> backpressure{ 0 };
+
+    /// Counters written by the I/O thread.
+    std::atomic<uint64_t> blocksWritten{ 0 };
+    std::atomic<uint64_t> bytesWritten{ 0 };
+    std::atomic<uint64_t> writeErrors{ 0 };
+
+    /// First write error.
+    std::atomic<int> firstError{ 0 };
+
+    /// Writes the blocks.
+    std::thread ioThread;
+};
+
+} // namespace cap
+} // namespace nts
@@ -0,0 +1,190 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include <libnts/capture/capture_writer.hpp>
+#include <libnts/config/configuration.test.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Path of a scratch file for the test.
+/// @details Named after the test and the process, since ctest runs each test in its own
+/// process and several of them at once.
+std::string tempFile(const std::string& name)
+{
+    const std::string test = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    return ::testing::TempDir() + "nts_" + test + "_" + std::to_string(getpid()) + "_" + name;
+}
+
+/// Frame whose bytes and length depend on its index.
+std::vector<uint8_t> makeFrame(const std::size_t index)
+{
+    std::vector<uint8_t> frame(60 + index % 1400);
+    for (std::size_t i = 0; i < frame.size(); i++)
+    {
+        frame[i] = static_cast<uint8_t>(index + i);
+    }
+    return frame;
+}
+
+/// Captures frames with the options and checks that they read back unchanged.
+void checkRoundTrip(const cap::CaptureWriterOptions& options)
+{
+    const std::string filename = tempFile("capture_writer.pcapng");
+    constexpr std::size_t frameCount{ 500 };
+    {
+        cap::CaptureWriter writer(filename, options);
+        for (std::size_t i = 0; i < frameCount; i++)
+        {
+            const std::vector<uint8_t> frame = makeFrame(i);
+            ASSERT_TRUE(writer.capture(frame.data(), frame.size(), 1000000000 + int64_t(i)));
+            if (i == frameCount / 2)
+            {
+                writer.flush();
+            }
+        }
+        writer.close();
+
+        const cap::CaptureStatistics statistics = writer.getStatistics();
+        EXPECT_EQ(statistics.frames, frameCount);
+        EXPECT_EQ(statistics.drops, 0u);
+        EXPECT_EQ(statistics.writeErrors, 0u);
+        EXPECT_GT(statistics.blocksWritten, 1u);
+
+        struct stat status;
+        ASSERT_EQ(stat(filename.c_str(), &status), 0);
+        EXPECT_EQ(uint64_t(status.st_size), statistics.bytesWritten);
+        if (writer.isDirect())
+        {
+            EXPECT_EQ(status.st_size % 4096, 0);
+        }
+    }
+
+    cap::PcapReader reader(filename);
+    EXPECT_EQ(reader.getFormat(), cap::CaptureFormat::PcapNg);
+    cap::CapturedFrame frame;
+    for (std::size_t i = 0; i < frameCount; i++)
+    {
+        ASSERT_TRUE(reader.next(frame));
+        const std::vector<uint8_t> expected = makeFrame(i);
+        ASSERT_EQ(std::vector<uint8_t>(frame.data, frame.data + frame.length), expected);
+        EXPECT_EQ(frame.timestamp, 1000000000 + int64_t(i));
+    }
+    EXPECT_FALSE(reader.next(frame));
+    std::remove(filename.c_str());
+}
+
+} // namespace
+
+TEST(CaptureWriterUnitTests, RoundTrip)
+{
+    cap::CaptureWriterOptions options;
+    options.blockSize = 16384;
+    // Enough blocks for the whole capture, so no frame is dropped however slow the disk is.
+    options.blockCount = 64;
+    options.snapLength = 4096;
+    checkRoundTrip(options);
+}
+
+TEST(CaptureWriterUnitTests, DirectIoRoundTrip)
+{
+    cap::CaptureWriterOptions options;
+    options.blockSize = 16384;
+    options.blockCount = 64;
+    options.snapLength = 4096;
+    options.directIo = true;
+    checkRoundTrip(options);
+
+    options.useIoUring = true;
+    checkRoundTrip(options);
+}
+
+TEST(CaptureWriterUnitTests, Backpressure)
+{
+    // Nothing reads the pipe until the capture is over, so the I/O thread stalls once the
+    // pipe is full and the blocks run out.
+    const std::string filename = tempFile("capture_writer.fifo");
+    std::remove(filename.c_str());
+    ASSERT_EQ(mkfifo(filename.c_str(), 0600), 0);
+    const int reader = open(filename.c_str(), O_RDONLY | O_NONBLOCK);
+    ASSERT_GE(reader, 0);
+
+    cap::CaptureWriterOptions options;
+    options.blockSize = 8192;
+    options.blockCount = 2;
+    options.snapLength = 2048;
+    cap::CaptureWriter writer(filename, options);
+
+    constexpr std::size_t frameCount{ 2000 };
+    const std::vector<uint8_t> frame(1000, 0x5a);
+    std::size_t captured = 0;
+    for (std::size_t i = 0; i < frameCount; i++)
+    {
+        captured += writer.capture(frame.data(), frame.size()) ? 1 : 0;
+    }
+    cap::CaptureStatistics statistics = writer.getStatistics();
+    EXPECT_EQ(statistics.frames, captured);
+    EXPECT_EQ(statistics.frames + statistics.drops, frameCount);
+    EXPECT_GT(statistics.drops, 0u);
+    EXPECT_GE(statistics.backpressure, 1u);
+
+    // Drain the pipe, so the writer can finish.
+    fcntl(reader, F_SETFL, 0);
+    uint64_t drained = 0;
+    std::thread drain([reader, &drained]() {
+        std::vector<uint8_t> buffer(65536);
+        ssize_t result;
+        while ((result = read(reader, buffer.data(), buffer.size())) > 0)
+        {
+            drained += result;
+        }
+    });
+    writer.close();
+    drain.join();
+    close(reader);
+
+    statistics = writer.getStatistics();
+    EXPECT_EQ(statistics.writeErrors, 0u);
+    EXPECT_EQ(drained, statistics.bytesWritten);
+
+    // Frames are dropped once the writer is closed.
+    EXPECT_FALSE(writer.capture(frame.data(), frame.size()));
+    std::remove(filename.c_str());
+}
+
+TEST(CaptureWriterUnitTests, Options)
+{
+    const std::string filename = tempFile("capture_writer_options.pcapng");
+    cap::CaptureWriterOptions options;
+    options.blockSize = 5000;
+    EXPECT_THROW(cap::CaptureWriter(filename, options), std::invalid_argument);
+    options.blockSize = 4096;
+    options.snapLength = 4096;
+    EXPECT_THROW(cap::CaptureWriter(filename, options), std::invalid_argument);
+    options.blockCount = 1;
+    options.snapLength = 1024;
+    EXPECT_THROW(cap::CaptureWriter(filename, options), std::invalid_argument);
+
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->intParams["Capture.BlockSize"] = 65536;
+    config->intParams["Capture.BlockCount"] = 8;
+    config->intParams["Capture.SnapLength"] = 1518;
+    config->boolParams["Capture.DirectIo"] = true;
+    config->boolParams["Capture.IoUring"] = true;
+    options.configure(config, "Capture");
+    EXPECT_EQ(options.blockSize, 65536u);
+    EXPECT_EQ(options.blockCount, 8u);
+    EXPECT_EQ(options.snapLength, 1518u);
+    EXPECT_TRUE(options.directIo);
+    EXPECT_TRUE(options.useIoUring);
+    std::remove(filename.c_str());
+}
+
+} // namespace tests
+} // namespace nts
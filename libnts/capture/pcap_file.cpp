@@ -0,0 +1,437 @@
+#include <libnts/capture/pcap_file.hpp>
+
+#include <algorithm>
+#include <boost/endian/conversion.hpp>
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nts {
+namespace cap {
+
+namespace {
+
+/// Magic number of pcap files with microsecond timestamps.
+constexpr uint32_t pcapMagic{ 0xa1b2c3d4 };
+
+/// Magic number of pcap files with nanosecond timestamps.
+constexpr uint32_t pcapNanosecondMagic{ 0xa1b23c4d };
+
+/// Size of the pcap file header.
+constexpr std::size_t pcapHeaderSize{ 24 };
+
+/// Size of the header of a pcap record.
+constexpr std::size_t pcapRecordHeaderSize{ 16 };
+
+/// Type of the pcapng Section Header Block. Reads the same in both byte orders.
+constexpr uint32_t sectionHeaderBlock{ 0x0a0d0d0a };
+
+/// Type of the pcapng Interface Description Block.
+constexpr uint32_t interfaceBlock{ 1 };
+
+/// Type of the pcapng Simple Packet Block.
+constexpr uint32_t simplePacketBlock{ 3 };
+
+/// Type of the pcapng Enhanced Packet Block.
+constexpr uint32_t enhancedPacketBlock{ 6 };
+
+/// Byte order magic of pcapng sections.
+constexpr uint32_t byteOrderMagic{ 0x1a2b3c4d };
+
+/// Type, length and trailing length of a pcapng block.
+constexpr std::size_t blockOverhead{ 12 };
+
+/// Fixed fields of an Enhanced Packet Block.
+constexpr std::size_t enhancedPacketHeaderSize{ 20 };
+
+/// Option of an Interface Description Block that sets the timestamp resolution.
+constexpr uint16_t timestampResolutionOption{ 9 };
+
+/// Records are written once this many bytes are buffered.
+constexpr std::size_t writeBufferSize{ 1 << 20 };
+
+constexpr int64_t nanosecondsPerSecond{ 1000000000 };
+
+/// Native 32-bit integer.
+uint32_t load32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/// Converts a timestamp in the given units to nanoseconds.
+int64_t toNanoseconds(const uint64_t timestamp, const uint64_t unitsPerSecond)
+{
+    if (unitsPerSecond == uint64_t(nanosecondsPerSecond))
+    {
+        return static_cast<int64_t>(timestamp);
+    }
+    const uint64_t seconds = timestamp / unitsPerSecond;
+    const uint64_t remainder = timestamp % unitsPerSecond;
+    return static_cast<int64_t>(seconds * nanosecondsPerSecond + static_cast<uint64_t>(static_cast<long double>(remainder) * nanosecondsPerSecond / unitsPerSecond));
+}
+
+/// Appends a native 32-bit integer to the buffer.
+void append32(std::vector<uint8_t>& buffer, const uint32_t value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+}
+
+} // namespace
+
+PcapReader::PcapReader(const std::string& filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "open");
+    }
+    struct stat status;
+    if (fstat(fd, &status) < 0)
+    {
+        const int error = errno;
+        close(fd);
+        throw boost::system::system_error(error, boost::system::system_category(), "fstat");
+    }
+    size = status.st_size;
+    if (size < blockOverhead)
+    {
+        close(fd);
+        throw std::runtime_error("Not a pcap or pcapng file: " + filename);
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw boost::system::system_error(error, boost::system::system_category(), "mmap");
+    }
+    begin = static_cast<const uint8_t*>(mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    const uint32_t magic = load32(begin);
+    if (magic == sectionHeaderBlock)
+    {
+        format = CaptureFormat::PcapNg;
+        if (!readSectionHeader())
+        {
+            munmap(mapping, size);
+            throw std::runtime_error("Invalid pcapng section header: " + filename);
+        }
+        firstPosition = 0;
+
+        // The link type comes from the first interface, which precedes the frames.
+        while (position + blockOverhead <= size)
+        {
+            const uint32_t type = read32(begin + position);
+            const uint32_t length = read32(begin + position + 4);
+            if (length < blockOverhead || position + length > size)
+            {
+                break;
+            }
+            if (type == interfaceBlock && length >= blockOverhead + 2)
+            {
+                linkType = read16(begin + position + 8);
+                break;
+            }
+            position += length;
+        }
+        rewind();
+        return;
+    }
+
+    format = CaptureFormat::Pcap;
+    if (magic == pcapMagic || magic == pcapNanosecondMagic)
+    {
+        swapped = false;
+    }
+    else if (magic == boost::endian::endian_reverse(pcapMagic) || magic == boost::endian::endian_reverse(pcapNanosecondMagic))
+    {
+        swapped = true;
+    }
+    else
+    {
+        munmap(mapping, size);
+        throw std::runtime_error("Not a pcap or pcapng file: " + filename);
+    }
+    if (size < pcapHeaderSize)
+    {
+        munmap(mapping, size);
+        throw std::runtime_error("Truncated pcap header: " + filename);
+    }
+    nanosecond = read32(begin) == pcapNanosecondMagic;
+    linkType = read32(begin + 20) & 0x0FFFFFFF;
+    firstPosition = pcapHeaderSize;
+    rewind();
+}
+
+PcapReader::~PcapReader()
+{
+    munmap(const_cast<uint8_t*>(begin), size);
+}
+
+bool PcapReader::next(CapturedFrame& outFrame)
+{
+    return format == CaptureFormat::Pcap ? nextPcap(outFrame) : nextPcapNg(outFrame);
+}
+
+void PcapReader::rewind()
+{
+    position = firstPosition;
+    interfaces.clear();
+}
+
+CaptureFormat PcapReader::getFormat() const
+{
+    return format;
+}
+
+uint32_t PcapReader::getLinkType() const
+{
+    return linkType;
+}
+
+std::size_t PcapReader::getFileSize() const
+{
+    return size;
+}
+
+bool PcapReader::nextPcap(CapturedFrame& outFrame)
+{
+    if (position + pcapRecordHeaderSize > size)
+    {
+        return false;
+    }
+    const uint8_t* record = begin + position;
+    const uint32_t length = read32(record + 8);
+    if (length > size - position - pcapRecordHeaderSize)
+    {
+        return false;
+    }
+    const int64_t fraction = read32(record + 4);
+    outFrame.data = record + pcapRecordHeaderSize;
+    outFrame.length = length;
+    outFrame.originalLength = read32(record + 12);
+    outFrame.timestamp = int64_t(read32(record)) * nanosecondsPerSecond + (nanosecond ? fraction : fraction * 1000);
+    outFrame.interface = 0;
+    position += pcapRecordHeaderSize + length;
+    return true;
+}
+
+bool PcapReader::nextPcapNg(CapturedFrame& outFrame)
+{
+    while (position + blockOverhead <= size)
+    {
+        if (load32(begin + position) == sectionHeaderBlock)
+        {
+            if (!readSectionHeader())
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const uint32_t type = read32(begin + position);
+        const uint32_t length = read32(begin + position + 4);
+        if (length < blockOverhead || length % 4 != 0 || length > size - position)
+        {
+            return false;
+        }
+        const uint8_t* body = begin + position + 8;
+        const std::size_t bodyLength = length - blockOverhead;
+        position += length;
+
+        if (type == interfaceBlock)
+        {
+            readInterface(body, bodyLength);
+        }
+        else if (type == enhancedPacketBlock && bodyLength >= enhancedPacketHeaderSize)
+        {
+            const uint32_t interface = read32(body);
+            const uint64_t timestamp = (uint64_t(read32(body + 4)) << 32) | read32(body + 8);
+            const uint64_t unitsPerSecond = interface < interfaces.size() ? interfaces[interface].unitsPerSecond : 1000000;
+            outFrame.data = body + enhancedPacketHeaderSize;
+            outFrame.length = std::min<std::size_t>(read32(body + 12), bodyLength - enhancedPacketHeaderSize);
+            outFrame.originalLength = read32(body + 16);
+            outFrame.timestamp = toNanoseconds(timestamp, unitsPerSecond);
+            outFrame.interface = interface;
+            return true;
+        }
+        else if (type == simplePacketBlock && bodyLength >= 4)
+        {
+            // Simple blocks have no timestamp, and their captured length is implied by the
+            // length of the block.
+            outFrame.data = body + 4;
+            outFrame.originalLength = read32(body);
+            outFrame.length = std::min<std::size_t>(outFrame.originalLength, bodyLength - 4);
+            outFrame.timestamp = 0;
+            outFrame.interface = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PcapReader::readSectionHeader()
+{
+    if (position + blockOverhead + 4 > size)
+    {
+        return false;
+    }
+    const uint32_t magic = load32(begin + position + 8);
+    if (magic == byteOrderMagic)
+    {
+        swapped = false;
+    }
+    else if (magic == boost::endian::endian_reverse(byteOrderMagic))
+    {
+        swapped = true;
+    }
+    else
+    {
+        return false;
+    }
+    const uint32_t length = read32(begin + position + 4);
+    if (length < blockOverhead + 4 || length > size - position)
+    {
+        return false;
+    }
+    // Interface numbers start over in each section.
+    interfaces.clear();
+    position += length;
+    return true;
+}
+
+void PcapReader::readInterface(const uint8_t* body, const std::size_t length)
+{
+    Interface interface{ linkTypeEthernet, 1000000 };
+    if (length >= 8)
+    {
+        interface.linkType = read16(body);
+    }
+
+    // Options follow the fixed fields, each padded to 32 bits.
+    std::size_t offset = 8;
+    while (offset + 4 <= length)
+    {
+        const uint16_t code = read16(body + offset);
+        const uint16_t optionLength = read16(body + offset + 2);
+        if (code == 0 || offset + 4 + optionLength > length)
+        {
+            break;
+        }
+        if (code == timestampResolutionOption && optionLength >= 1)
+        {
+            const uint8_t resolution = body[offset + 4];
+            const uint8_t exponent = resolution & 0x7F;
+            if (resolution & 0x80)
+            {
+                interface.unitsPerSecond = uint64_t(1) << std::min<uint8_t>(exponent, 63);
+            }
+            else
+            {
+                interface.unitsPerSecond = 1;
+                for (uint8_t i = 0; i < std::min<uint8_t>(exponent, 19); i++)
+                {
+                    interface.unitsPerSecond *= 10;
+                }
+            }
+        }
+        offset += 4 + ((optionLength + 3) & ~3);
+    }
+    interfaces.push_back(interface);
+}
+
+uint16_t PcapReader::read16(const uint8_t* data) const
+{
+    uint16_t value;
+    memcpy(&value, data, sizeof(value));
+    return swapped ? boost::endian::endian_reverse(value) : value;
+}
+
+uint32_t PcapReader::read32(const uint8_t* data) const
+{
+    const uint32_t value = load32(data);
+    return swapped ? boost::endian::endian_reverse(value) : value;
+}
+
+PcapWriter::PcapWriter(const std::string& filename, const uint32_t linkType, const uint32_t snapLength)
+    : snapLength(snapLength)
+{
+    fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "open");
+    }
+    buffer.reserve(writeBufferSize + pcapRecordHeaderSize + snapLength);
+
+    // File header, in native byte order.
+    append32(buffer, pcapNanosecondMagic);
+    const uint16_t version[2] = { 2, 4 };
+    const uint8_t* versionBytes = reinterpret_cast<const uint8_t*>(version);
+    buffer.insert(buffer.end(), versionBytes, versionBytes + sizeof(version));
+    append32(buffer, 0);
+    append32(buffer, 0);
+    append32(buffer, snapLength);
+    append32(buffer, linkType);
+}
+
+PcapWriter::~PcapWriter()
+{
+    try
+    {
+        flush();
+    }
+    catch (const boost::system::system_error&)
+    {
+        // Nothing can be done about it in a destructor.
+    }
+    close(fd);
+}
+
+void PcapWriter::write(const uint8_t* data, const std::size_t length, const int64_t timestamp)
+{
+    const uint32_t captured = static_cast<uint32_t>(std::min<std::size_t>(length, snapLength));
+    const int64_t time = std::max<int64_t>(timestamp, 0);
+    append32(buffer, static_cast<uint32_t>(time / nanosecondsPerSecond));
+    append32(buffer, static_cast<uint32_t>(time % nanosecondsPerSecond));
+    append32(buffer, captured);
+    append32(buffer, static_cast<uint32_t>(length));
+    buffer.insert(buffer.end(), data, data + captured);
+    if (buffer.size() >= writeBufferSize)
+    {
+        flush();
+    }
+}
+
+void PcapWriter::flush()
+{
+    std::size_t written = 0;
+    while (written < buffer.size())
+    {
+        const ssize_t result = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (result < 0)
+        {
+            const int error = errno;
+            if (error == EINTR)
+            {
+                continue;
+            }
+            // Keep what is left, so a later flush can try again.
+            buffer.erase(buffer.begin(), buffer.begin() + written);
+            throw boost::system::system_error(error, boost::system::system_category(), "write");
+        }
+        written += result;
+    }
+    buffer.clear();
+}
+
+} // namespace cap
+} // namespace nts
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nts {
+namespace cap {
+
+/// Link type of Ethernet frames (LINKTYPE_ETHERNET).
+constexpr uint32_t linkTypeEthernet{ 1 };
+
+/// Largest frame that capture files are expected to hold.
+constexpr uint32_t defaultSnapLength{ 262144 };
+
+/// Layouts of capture files.
+enum class CaptureFormat
+{
+    /// Classic libpcap format, with microsecond or nanosecond timestamps.
+    Pcap,
+    /// Block based pcapng format.
+    PcapNg,
+};
+
+/// Frame of a capture file.
+struct CapturedFrame
+{
+    /// Start of the captured bytes. Points into the mapped file.
+    const uint8_t* data{ nullptr };
+
+    /// Number of captured bytes.
+    std::size_t length{ 0 };
+
+    /// Length of the frame on the wire, which is larger than the captured length when the
+    /// frame was truncated.
+    std::size_t originalLength{ 0 };
+
+    /// Time of capture in nanoseconds since the epoch.
+    int64_t timestamp{ 0 };
+
+    /// Interface of the frame. Always 0 for pcap files.
+    uint32_t interface{ 0 };
+};
+
+/// Reads the frames of a pcap or pcapng file.
+///
+/// @details The file is memory mapped instead of read through a stream, so frames are
+/// handed out in place, without copying, and the kernel reads ahead of the sequential
+/// access. Both byte orders are supported, as well as nanosecond pcap files and the
+/// timestamp resolution option of pcapng interfaces. A truncated last record ends the
+/// capture.
+///
+/// @example
+/// PcapReader reader("regression.pcapng");
+/// CapturedFrame frame;
+/// while (reader.next(frame))
+/// {
+///     message.deserialize(frame.data, frame.length);
+/// }
+class PcapReader
+{
+public:
+    /// Constructor. Maps the file.
+    /// @throws boost::system::system_error If the file can't be opened or mapped.
+    /// @throws std::runtime_error If the file is neither a pcap nor a pcapng file.
+    explicit PcapReader(const std::string& filename);
+
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+    /// Destructor. Unmaps the file.
+    ~PcapReader();
+
+    /// Reads the next frame.
+    /// @details The frame stays valid for the lifetime of the reader.
+    /// @returns Whether there was a frame left.
+    bool next(CapturedFrame& outFrame);
+
+    /// Goes back to the first frame.
+    void rewind();
+
+    /// Layout of the file.
+    CaptureFormat getFormat() const;
+
+    /// Link type of the first interface.
+    uint32_t getLinkType() const;
+
+    /// Size of the file in bytes.
+    std::size_t getFileSize() const;
+
+private:
+    /// Interface described by a pcapng Interface Description Block.
+    struct Interface
+    {
+        /// Link type of the frames.
+        uint32_t linkType;
+
+        /// Timestamp units per second.
+        uint64_t unitsPerSecond;
+    };
+
+    /// Reads the next record of a pcap file.
+    bool nextPcap(CapturedFrame& outFrame);
+
+    /// Reads blocks of a pcapng file until the next frame.
+    bool nextPcapNg(CapturedFrame& outFrame);
+
+    /// Reads a Section Header Block at the current position.
+    /// @returns Whether the block is valid.
+    bool readSectionHeader();
+
+    /// Reads an Interface Description Block.
+    void readInterface(const uint8_t* body, const std::size_t length);
+
+    /// 16-bit integer in the byte order of the file.
+    uint16_t read16(const uint8_t* data) const;
+
+    /// 32-bit integer in the byte order of the file.
+    uint32_t read32(const uint8_t* data) const;
+
+    /// Start of the mapped file.
+    const uint8_t* begin{ nullptr };
+
+    /// Size of the mapped file.
+    std::size_t size{ 0 };
+
+    /// Offset of the next record or block.
+    std::size_t position{ 0 };
+
+    /// Offset of the first record or block.
+    std::size_t firstPosition{ 0 };
+
+    /// Layout of the file.
+    CaptureFormat format{ CaptureFormat::Pcap };
+
+    /// Whether the byte order of the file differs from the native one.
+    bool swapped{ false };
+
+    /// Link type of the pcap file, or of the first pcapng interface.
+    uint32_t linkType{ linkTypeEthernet };
+
+    /// Whether pcap timestamps are in nanoseconds instead of microseconds.
+    bool nanosecond{ false };
+
+    /// Interfaces of the current pcapng section.
+    std::vector<Interface> interfaces;
+};
+
+/// Writes frames to a pcap file with nanosecond timestamps.
+///
+/// @details Records are gathered in a buffer and written in large chunks.
+class PcapWriter
+{
+public:
+    /// Constructor. Creates or truncates the file and writes the file header.
+    /// @throws boost::system::system_error If the file can't be created.
+    PcapWriter(const std::string& filename, const uint32_t linkType = linkTypeEthernet, const uint32_t snapLength = defaultSnapLength);
+
+    PcapWriter(const PcapWriter&) = delete;
+    PcapWriter& operator=(const PcapWriter&) = delete;
+
+    /// Destructor. Writes the buffered records and closes the file.
+    ~PcapWriter();
+
+    /// Appends a frame to the file.
+    /// @details Frames longer than the snap length are truncated.
+    /// @param timestamp Time of the frame in nanoseconds since the epoch.
+    /// @throws boost::system::system_error If the file can't be written.
+    void write(const uint8_t* data, const std::size_t length, const int64_t timestamp);
+
+    /// Writes the buffered records to the file.
+    /// @throws boost::system::system_error If the file can't be written.
+    void flush();
+
+private:
+    /// Descriptor of the file.
+    int fd{ -1 };
+
+    /// Largest number of bytes stored for a frame.
+    uint32_t snapLength;
+
+    /// Records that are not written yet.
+    std::vector<uint8_t> buffer;
+};
+
+} // namespace cap
+} // namespace nts
@@ -0,0 +1,180 @@
+#include <boost/endian/conversion.hpp>
+#include <boost/system/system_error.hpp>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include <libnts/capture/pcap_file.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Path of a scratch file for the test.
+std::string tempFile(const std::string& name)
+{
+    return ::testing::TempDir() + "nts_" + name;
+}
+
+/// Writes the bytes to a file.
+void writeFile(const std::string& filename, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+/// Builds capture files in either byte order.
+class CaptureBuilder
+{
+public:
+    explicit CaptureBuilder(const bool swapped)
+        : swapped(swapped)
+    {
+    }
+
+    CaptureBuilder& u16(const uint16_t value)
+    {
+        const uint16_t ordered = swapped ? boost::endian::endian_reverse(value) : value;
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&ordered);
+        bytes.insert(bytes.end(), data, data + sizeof(ordered));
+        return *this;
+    }
+
+    CaptureBuilder& u32(const uint32_t value)
+    {
+        const uint32_t ordered = swapped ? boost::endian::endian_reverse(value) : value;
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&ordered);
+        bytes.insert(bytes.end(), data, data + sizeof(ordered));
+        return *this;
+    }
+
+    CaptureBuilder& raw(const std::vector<uint8_t>& data)
+    {
+        bytes.insert(bytes.end(), data.begin(), data.end());
+        return *this;
+    }
+
+    const bool swapped;
+    std::vector<uint8_t> bytes;
+};
+
+/// Section header, interface with microsecond resolution, interface with nanosecond
+/// resolution, enhanced packet on the second interface and simple packet.
+std::vector<uint8_t> makePcapNg(const bool swapped)
+{
+    CaptureBuilder file(swapped);
+    // Section Header Block.
+    file.u32(0x0a0d0d0a).u32(28).u32(0x1a2b3c4d).u16(1).u16(0).u32(0xFFFFFFFF).u32(0xFFFFFFFF).u32(28);
+    // Interface Description Block without options.
+    file.u32(1).u32(20).u16(1).u16(0).u32(65535).u32(20);
+    // Interface Description Block with if_tsresol = 9 and the end of options.
+    file.u32(1).u32(32).u16(1).u16(0).u32(65535).u16(9).u16(1).raw({ 9, 0, 0, 0 }).u16(0).u16(0).u32(32);
+    // Enhanced Packet Block with 5 bytes padded to 8.
+    file.u32(6).u32(40).u32(1).u32(0).u32(1500000123).u32(5).u32(60).raw({ 1, 2, 3, 4, 5, 0, 0, 0 }).u32(40);
+    // Simple Packet Block with 4 bytes.
+    file.u32(3).u32(20).u32(4).raw({ 6, 7, 8, 9 }).u32(20);
+    return file.bytes;
+}
+
+} // namespace
+
+TEST(PcapFileUnitTests, RoundTrip)
+{
+    const std::string filename = tempFile("round_trip.pcap");
+    {
+        cap::PcapWriter writer(filename, cap::linkTypeEthernet, 4);
+        writer.write(std::vector<uint8_t>{ 1, 2, 3 }.data(), 3, 1000000000123);
+        writer.write(std::vector<uint8_t>{ 4, 5, 6, 7, 8, 9 }.data(), 6, 1000000001000);
+    }
+
+    cap::PcapReader reader(filename);
+    EXPECT_EQ(reader.getFormat(), cap::CaptureFormat::Pcap);
+    EXPECT_EQ(reader.getLinkType(), cap::linkTypeEthernet);
+    EXPECT_EQ(reader.getFileSize(), 24u + 16u + 3u + 16u + 4u);
+
+    cap::CapturedFrame frame;
+    ASSERT_TRUE(reader.next(frame));
+    EXPECT_EQ(std::vector<uint8_t>(frame.data, frame.data + frame.length), std::vector<uint8_t>({ 1, 2, 3 }));
+    EXPECT_EQ(frame.originalLength, 3u);
+    EXPECT_EQ(frame.timestamp, 1000000000123);
+
+    // Frames longer than the snap length are truncated.
+    ASSERT_TRUE(reader.next(frame));
+    EXPECT_EQ(std::vector<uint8_t>(frame.data, frame.data + frame.length), std::vector<uint8_t>({ 4, 5, 6, 7 }));
+    EXPECT_EQ(frame.originalLength, 6u);
+    EXPECT_EQ(frame.timestamp, 1000000001000);
+    EXPECT_FALSE(reader.next(frame));
+
+    reader.rewind();
+    ASSERT_TRUE(reader.next(frame));
+    EXPECT_EQ(frame.length, 3u);
+    std::remove(filename.c_str());
+}
+
+TEST(PcapFileUnitTests, SwappedMicrosecondPcap)
+{
+    CaptureBuilder file(true);
+    file.u32(0xa1b2c3d4).u16(2).u16(4).u32(0).u32(0).u32(65535).u32(1);
+    file.u32(10).u32(250).u32(2).u32(2).raw({ 0xAB, 0xCD });
+    // The last record is truncated.
+    file.u32(11).u32(0).u32(8).u32(8).raw({ 1, 2 });
+
+    const std::string filename = tempFile("swapped.pcap");
+    writeFile(filename, file.bytes);
+
+    cap::PcapReader reader(filename);
+    EXPECT_EQ(reader.getLinkType(), 1u);
+    cap::CapturedFrame frame;
+    ASSERT_TRUE(reader.next(frame));
+    EXPECT_EQ(frame.length, 2u);
+    EXPECT_EQ(frame.data[0], 0xAB);
+    EXPECT_EQ(frame.timestamp, 10000250000);
+    EXPECT_FALSE(reader.next(frame));
+    std::remove(filename.c_str());
+}
+
+TEST(PcapFileUnitTests, PcapNg)
+{
+    for (const bool swapped : { false, true })
+    {
+        const std::string filename = tempFile("capture.pcapng");
+        writeFile(filename, makePcapNg(swapped));
+
+        cap::PcapReader reader(filename);
+        EXPECT_EQ(reader.getFormat(), cap::CaptureFormat::PcapNg);
+        EXPECT_EQ(reader.getLinkType(), 1u);
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            cap::CapturedFrame frame;
+            ASSERT_TRUE(reader.next(frame));
+            EXPECT_EQ(std::vector<uint8_t>(frame.data, frame.data + frame.length), std::vector<uint8_t>({ 1, 2, 3, 4, 5 }));
+            EXPECT_EQ(frame.originalLength, 60u);
+            EXPECT_EQ(frame.interface, 1u);
+            // The second interface counts in nanoseconds.
+            EXPECT_EQ(frame.timestamp, 1500000123);
+
+            ASSERT_TRUE(reader.next(frame));
+            EXPECT_EQ(std::vector<uint8_t>(frame.data, frame.data + frame.length), std::vector<uint8_t>({ 6, 7, 8, 9 }));
+            EXPECT_FALSE(reader.next(frame));
+            reader.rewind();
+        }
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(PcapFileUnitTests, Errors)
+{
+    EXPECT_THROW(cap::PcapReader{ tempFile("missing.pcap") }, boost::system::system_error);
+
+    const std::string filename = tempFile("garbage.pcap");
+    writeFile(filename, std::vector<uint8_t>(64, 0x55));
+    EXPECT_THROW(cap::PcapReader{ filename }, std::runtime_error);
+    std::remove(filename.c_str());
+
+    EXPECT_THROW(cap::PcapWriter{ ::testing::TempDir() + "missing/directory.pcap" }, boost::system::system_error);
+}
+
+} // namespace tests
+} // namespace nts
@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+
+#include <libnts/capture/pcap_session.hpp>
+#include <libnts/messaging/message.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// Number of frames of the replayed capture.
+constexpr std::size_t frameCount{ 100000 };
+
+/// Writes a capture of 128 byte frames.
+std::string makeCapture()
+{
+    const std::string filename = "/tmp/nts_replay.bench.pcap";
+    cap::PcapWriter writer(filename);
+    std::vector<uint8_t> frame(128, 0xab);
+    for (std::size_t i = 0; i < frameCount; i++)
+    {
+        writer.write(frame.data(), frame.size(), int64_t(i) * 1000);
+    }
+    return filename;
+}
+
+} // namespace
+
+/// Copy each frame of the capture into a buffer.
+void BM_PcapReceiveVector(benchmark::State& state)
+{
+    const std::string filename = makeCapture();
+    ss::PcapSession session(filename);
+    std::vector<uint8_t> frame(1514);
+    for (auto _ : state)
+    {
+        if (session.receive(frame) == 0)
+        {
+            session.rewind();
+        }
+        benchmark::DoNotOptimize(frame.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    std::remove(filename.c_str());
+}
+
+/// Hand out each frame of the capture in place.
+void BM_PcapReceiveFrame(benchmark::State& state)
+{
+    const std::string filename = makeCapture();
+    ss::PcapSession session(filename);
+    cap::CapturedFrame frame;
+    for (auto _ : state)
+    {
+        if (!session.receiveFrame(frame))
+        {
+            session.rewind();
+        }
+        benchmark::DoNotOptimize(frame.data);
+    }
+    state.SetItemsProcessed(state.iterations());
+    std::remove(filename.c_str());
+}
+
+/// Batches of frames, as read by a receive loop.
+void BM_PcapReceiveBatch(benchmark::State& state)
+{
+    const std::string filename = makeCapture();
+    ss::PcapSession session(filename);
+    std::vector<std::vector<uint8_t>> frames(state.range(0));
+    std::size_t received = 0;
+    for (auto _ : state)
+    {
+        for (auto& frame : frames)
+        {
+            frame.resize(1514);
+        }
+        std::size_t count = session.receiveBatch(frames, frames.size());
+        if (count == 0)
+        {
+            session.rewind();
+        }
+        received += count;
+        benchmark::DoNotOptimize(frames.data());
+    }
+    state.SetItemsProcessed(received);
+    std::remove(filename.c_str());
+}
+
+BENCHMARK(BM_PcapReceiveVector);
+BENCHMARK(BM_PcapReceiveFrame);
+BENCHMARK(BM_PcapReceiveBatch)->Arg(64);
+
+} // namespace benchmarks
+} // namespace nts
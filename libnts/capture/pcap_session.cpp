@@ -0,0 +1,180 @@
+#include <libnts/capture/pcap_session.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Current time in nanoseconds since the epoch, used for the timestamps of sent frames.
+int64_t wallClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+PcapSession::PcapSession(const std::string& inputFile, const std::string& outputFile)
+    : sendBuffer(cap::defaultSnapLength)
+{
+    if (!inputFile.empty())
+    {
+        reader.reset(new cap::PcapReader(inputFile));
+    }
+    if (!outputFile.empty())
+    {
+        writer.reset(new cap::PcapWriter(outputFile));
+    }
+    atEnd = !reader;
+}
+
+std::size_t PcapSession::send(std::vector<uint8_t>& inData)
+{
+    getWriter().write(inData.data(), inData.size(), wallClock());
+    return inData.size();
+}
+
+std::size_t PcapSession::send(Serializable& inData)
+{
+    cap::PcapWriter& output = getWriter();
+    const std::size_t size = inData.serialize(sendBuffer.data(), sendBuffer.size());
+    if (size == 0)
+    {
+        return 0;
+    }
+    output.write(sendBuffer.data(), size, wallClock());
+    return size;
+}
+
+std::size_t PcapSession::receive(std::vector<uint8_t>& outData)
+{
+    cap::CapturedFrame frame;
+    if (!receiveFrame(frame))
+    {
+        return 0;
+    }
+    const std::size_t length = std::min(frame.length, outData.size());
+    memcpy(outData.data(), frame.data, length);
+    return length;
+}
+
+std::size_t PcapSession::receive(Serializable& outData)
+{
+    cap::CapturedFrame frame;
+    if (!receiveFrame(frame))
+    {
+        return 0;
+    }
+    outData.deserialize(frame.data, frame.length);
+    return frame.length;
+}
+
+std::size_t PcapSession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    cap::PcapWriter& output = getWriter();
+    const int64_t timestamp = wallClock();
+    for (const auto& frame : inFrames)
+    {
+        output.write(frame.data(), frame.size(), timestamp);
+    }
+    return inFrames.size();
+}
+
+std::size_t PcapSession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    const std::size_t frameCount = std::min(maxFrames, outFrames.size());
+    std::size_t received = 0;
+    cap::CapturedFrame frame;
+    while (received < frameCount && receiveFrame(frame))
+    {
+        std::vector<uint8_t>& outData = outFrames[received++];
+        const std::size_t length = std::min(frame.length, outData.size());
+        memcpy(outData.data(), frame.data, length);
+        outData.resize(length);
+    }
+    return received;
+}
+
+bool PcapSession::receiveFrame(cap::CapturedFrame& outFrame)
+{
+    cap::PcapReader& input = getReader();
+    if (atEnd || !input.next(outFrame))
+    {
+        atEnd = true;
+        return false;
+    }
+    if (replayMode == ReplayMode::OriginalTiming)
+    {
+        pace(outFrame);
+    }
+    return true;
+}
+
+ReplayMode PcapSession::getReplayMode() const
+{
+    return replayMode;
+}
+
+PcapSession& PcapSession::setReplayMode(const ReplayMode mode)
+{
+    replayMode = mode;
+    started = false;
+    return *this;
+}
+
+bool PcapSession::isAtEnd() const
+{
+    return atEnd;
+}
+
+void PcapSession::rewind()
+{
+    getReader().rewind();
+    atEnd = false;
+    started = false;
+}
+
+void PcapSession::flush()
+{
+    getWriter().flush();
+}
+
+cap::PcapReader& PcapSession::getReader()
+{
+    if (!reader)
+    {
+        throw std::logic_error("PcapSession has no input capture");
+    }
+    return *reader;
+}
+
+cap::PcapWriter& PcapSession::getWriter()
+{
+    if (!writer)
+    {
+        throw std::logic_error("PcapSession has no output capture");
+    }
+    return *writer;
+}
+
+void PcapSession::pace(const cap::CapturedFrame& frame)
+{
+    // The first frame sets the origin of both clocks.
+    if (!started)
+    {
+        started = true;
+        firstTimestamp = frame.timestamp;
+        startTime = std::chrono::steady_clock::now();
+        return;
+    }
+    // Frames that were captured out of order are received right away.
+    const int64_t offset = std::max<int64_t>(frame.timestamp - firstTimestamp, 0);
+    std::this_thread::sleep_until(startTime + std::chrono::nanoseconds(offset));
+}
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libnts/capture/pcap_file.hpp>
+#include <libnts/core/session.hpp>
+
+namespace nts {
+namespace ss {
+
+/// How a PcapSession paces the frames it receives from its capture.
+enum class ReplayMode
+{
+    /// Frames are received as fast as they are asked for.
+    Fast,
+    /// Frames are received with the spacing they were captured with.
+    OriginalTiming,
+};
+
+/// Session that receives frames from a capture file and sends frames to another one.
+///
+/// @details Replaying captures exercises the parsing pipeline without a network interface
+/// or raw socket privileges. The input capture is memory mapped by a PcapReader, so
+/// receiving an object deserializes it straight from the file. Sent frames are appended to
+/// a pcap file with the current time.
+///
+/// Receive operations return 0 once the whole capture was received. Batch receives return
+/// what is left, which may be fewer frames than requested, without blocking.
+///
+/// @example
+/// PcapSession session("regression.pcapng");
+/// Message message;
+/// while (session.receive(message.clear()) > 0)
+/// {
+///     ...
+/// }
+class PcapSession : public Session
+{
+public:
+    /// Constructor.
+    /// @param inputFile Capture that frames are received from. Empty for none.
+    /// @param outputFile Capture that frames are sent to. Empty for none.
+    /// @throws boost::system::system_error If a file can't be opened.
+    /// @throws std::runtime_error If the input file is not a capture.
+    explicit PcapSession(const std::string& inputFile, const std::string& outputFile = "");
+
+    /// Deconstructor.
+    ~PcapSession() = default;
+
+    /// Append the frame to the output capture.
+    /// @throws std::logic_error If the session has no output capture.
+    virtual std::size_t send(std::vector<uint8_t>& inData);
+
+    /// Append the object to the output capture.
+    /// @throws std::logic_error If the session has no output capture.
+    virtual std::size_t send(Serializable& inData);
+
+    /// Receive the next frame of the input capture.
+    /// @param outData Must be non-empty (size > 0). Longer frames are truncated.
+    /// @returns The number of bytes received, or 0 at the end of the capture.
+    /// @throws std::logic_error If the session has no input capture.
+    virtual std::size_t receive(std::vector<uint8_t>& outData);
+
+    /// Receive the next frame of the input capture as an object.
+    /// @returns The size of the frame, or 0 at the end of the capture.
+    /// @throws std::logic_error If the session has no input capture.
+    virtual std::size_t receive(Serializable& outData);
+
+    /// Append the frames to the output capture.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive the next frames of the input capture.
+    /// @returns The number of frames received, which is 0 at the end of the capture.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Receive the next frame of the input capture without copying it.
+    /// @param outFrame Points into the mapped capture, and stays valid for the lifetime of
+    /// the session.
+    /// @returns Whether there was a frame left.
+    virtual bool receiveFrame(cap::CapturedFrame& outFrame);
+
+    /// How received frames are paced.
+    virtual ReplayMode getReplayMode() const;
+
+    /// How received frames are paced.
+    virtual PcapSession& setReplayMode(const ReplayMode mode);
+
+    /// Whether every frame of the input capture was received.
+    virtual bool isAtEnd() const;
+
+    /// Start receiving from the first frame of the input capture again.
+    virtual void rewind();
+
+    /// Write the frames sent so far to the output capture.
+    virtual void flush();
+
+private:
+    /// Throws if there is no input capture.
+    cap::PcapReader& getReader();
+
+    /// Throws if there is no output capture.
+    cap::PcapWriter& getWriter();
+
+    /// Waits until the frame is due in original timing mode.
+    void pace(const cap::CapturedFrame& frame);
+
+    /// Input capture.
+    std::unique_ptr<cap::PcapReader> reader;
+
+    /// Output capture.
+    std::unique_ptr<cap::PcapWriter> writer;
+
+    /// How received frames are paced.
+    ReplayMode replayMode{ ReplayMode::Fast };
+
+    /// Whether the input capture has no frames left.
+    bool atEnd{ false };
+
+    /// Whether the first frame of the replay was received.
+    bool started{ false };
+
+    /// Timestamp of the first frame of the replay, in nanoseconds.
+    int64_t firstTimestamp{ 0 };
+
+    /// Time when the first frame of the replay was received.
+    std::chrono::steady_clock::time_point startTime;
+
+    /// Reusable buffer for serializing objects.
+    std::vector<uint8_t> sendBuffer;
+};
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+
+#include <libnts/capture/pcap_session.hpp>
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/ipv4/ipv4.hpp>
+#include <libnts/messaging/message.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Path of a scratch file for the test.
+std::string tempFile(const std::string& name)
+{
+    return ::testing::TempDir() + "nts_" + name;
+}
+
+} // namespace
+
+TEST(PcapSessionUnitTests, SendAndReceive)
+{
+    const std::string filename = tempFile("session.pcap");
+    Message request = Message()
+                          .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+                          .addDataUnit(std::make_shared<ip::Ipv4DataUnit>(ip::Ipv4DataUnit().setTTL(9)));
+    {
+        ss::PcapSession session("", filename);
+        EXPECT_EQ(session.send(request), 34u);
+
+        // Objects that don't fit in a frame aren't recorded.
+        Message oversized = Message().addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData(std::vector<uint8_t>(cap::defaultSnapLength + 1, 0))));
+        EXPECT_EQ(session.send(oversized), 0u);
+
+        std::vector<uint8_t> frame{ 1, 2, 3 };
+        EXPECT_EQ(session.send(frame), 3u);
+        std::vector<std::vector<uint8_t>> frames(2, std::vector<uint8_t>(5, 7));
+        EXPECT_EQ(session.sendBatch(frames), 2u);
+
+        // Only the output capture is open.
+        EXPECT_TRUE(session.isAtEnd());
+        EXPECT_THROW(session.receive(frame), std::logic_error);
+    }
+
+    ss::PcapSession session(filename);
+    Message reply;
+    EXPECT_EQ(session.receive(reply), 34u);
+    EXPECT_EQ(reply.getSize(), 34u);
+
+    std::vector<uint8_t> frame(2);
+    EXPECT_EQ(session.receive(frame), 2u);
+    EXPECT_EQ(frame, std::vector<uint8_t>({ 1, 2 }));
+
+    // Batches return what is left.
+    std::vector<std::vector<uint8_t>> frames(4, std::vector<uint8_t>(64));
+    EXPECT_EQ(session.receiveBatch(frames, 4), 2u);
+    EXPECT_EQ(frames[0], std::vector<uint8_t>(5, 7));
+    EXPECT_TRUE(session.isAtEnd());
+    EXPECT_EQ(session.receive(frame), 0u);
+    EXPECT_EQ(session.receiveBatch(frames, 4), 0u);
+
+    session.rewind();
+    EXPECT_FALSE(session.isAtEnd());
+    cap::CapturedFrame captured;
+    ASSERT_TRUE(session.receiveFrame(captured));
+    EXPECT_EQ(captured.length, 34u);
+
+    std::vector<uint8_t> data(3);
+    EXPECT_THROW(session.send(data), std::logic_error);
+    std::remove(filename.c_str());
+}
+
+TEST(PcapSessionUnitTests, OriginalTiming)
+{
+    const std::string filename = tempFile("timing.pcap");
+    {
+        cap::PcapWriter writer(filename);
+        const std::vector<uint8_t> frame(60, 0);
+        for (int64_t i = 0; i < 5; i++)
+        {
+            writer.write(frame.data(), frame.size(), 1000000000 + i * 10000000);
+        }
+    }
+
+    ss::PcapSession session(filename);
+    std::vector<uint8_t> frame(60);
+    auto start = std::chrono::steady_clock::now();
+    while (session.receive(frame) > 0)
+    {
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    // The frames are 10 ms apart, so the replay takes at least 40 ms.
+    session.setReplayMode(ss::ReplayMode::OriginalTiming).rewind();
+    EXPECT_EQ(session.getReplayMode(), ss::ReplayMode::OriginalTiming);
+    start = std::chrono::steady_clock::now();
+    while (session.receive(frame) > 0)
+    {
+    }
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(40));
+    std::remove(filename.c_str());
+}
+
+TEST(PcapSessionUnitTests, Configuration)
+{
+    const std::string filename = tempFile("configured.pcap");
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Session.Type"] = "pcap";
+    config->stringParams["Session.OutputFile"] = filename;
+    config->stringParams["Session.Replay"] = "original";
+
+    auto session = std::dynamic_pointer_cast<ss::PcapSession>(ss::Session::create(config));
+    ASSERT_TRUE(session);
+    EXPECT_EQ(session->getReplayMode(), ss::ReplayMode::OriginalTiming);
+
+    config->stringParams["Session.Replay"] = "slow";
+    EXPECT_THROW(ss::Session::create(config), std::invalid_argument);
+
+    // Unknown types don't fall back to a raw session.
+    config->stringParams["Session.Type"] = "pcapng";
+    EXPECT_THROW(ss::Session::create(config), std::invalid_argument);
+    std::remove(filename.c_str());
+}
+
+} // namespace tests
+} // namespace nts
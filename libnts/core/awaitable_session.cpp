@@ -0,0 +1,125 @@
+#include <libnts/core/awaitable_session.hpp>
+
+#include <atomic>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Await an operation that reports its result to a Session::CompletionHandler.
+template <typename Operation>
+boost::asio::awaitable<std::size_t> awaitOperation(Operation operation)
+{
+    return boost::asio::async_initiate<decltype(boost::asio::use_awaitable), void(boost::system::error_code, std::size_t)>(
+        [operation](auto handler) mutable {
+            // Coroutine handlers are move-only, while session handlers must be copyable.
+            auto shared = std::make_shared<decltype(handler)>(std::move(handler));
+            auto executor = boost::asio::get_associated_executor(*shared);
+            operation([shared, executor](const boost::system::error_code& error, std::size_t bytes) {
+                // Sessions may complete before returning, so the coroutine is resumed from its executor.
+                boost::asio::post(executor, [shared, error, bytes]() { (*shared)(error, bytes); });
+            });
+        },
+        boost::asio::use_awaitable);
+}
+
+/// Await an operation, cancelling it if it does not complete in time.
+template <typename Operation>
+boost::asio::awaitable<std::size_t> awaitOperation(Operation operation, const std::chrono::milliseconds timeout)
+{
+    auto slot = std::make_shared<CancellationSlot>();
+    auto timedOut = std::make_shared<std::atomic<bool>>(false);
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, timeout);
+    timer.async_wait([slot, timedOut](const boost::system::error_code& error) {
+        if (!error)
+        {
+            *timedOut = true;
+            slot->emit();
+        }
+    });
+
+    try
+    {
+        const std::size_t bytes = co_await awaitOperation([operation, slot](Session::CompletionHandler handler) mutable {
+            operation(handler, slot);
+        });
+        timer.cancel();
+        co_return bytes;
+    }
+    catch (const boost::system::system_error& error)
+    {
+        if (*timedOut)
+        {
+            throw boost::system::system_error(boost::asio::error::timed_out);
+        }
+        throw;
+    }
+}
+
+} // namespace
+
+AwaitableSession::AwaitableSession(std::shared_ptr<Session> session)
+    : session(session)
+{
+}
+
+boost::asio::awaitable<std::size_t> AwaitableSession::send(std::vector<uint8_t>& inData)
+{
+    return awaitOperation([session = session, &inData](Session::CompletionHandler handler) {
+        session->asyncSend(inData, handler);
+    });
+}
+
+boost::asio::awaitable<std::size_t> AwaitableSession::send(Serializable& inData)
+{
+    return awaitOperation([session = session, &inData](Session::CompletionHandler handler) {
+        session->asyncSend(inData, handler);
+    });
+}
+
+boost::asio::awaitable<std::size_t> AwaitableSession::receive(std::vector<uint8_t>& outData)
+{
+    return awaitOperation([session = session, &outData](Session::CompletionHandler handler) {
+        session->asyncReceive(outData, handler);
+    });
+}
+
+boost::asio::awaitable<std::size_t> AwaitableSession::receive(std::vector<uint8_t>& outData, const std::chrono::milliseconds timeout)
+{
+    return awaitOperation(
+        [session = session, &outData](Session::CompletionHandler handler, std::shared_ptr<CancellationSlot> slot) {
+            session->asyncReceive(outData, handler, slot);
+        },
+        timeout);
+}
+
+boost::asio::awaitable<std::size_t> AwaitableSession::receive(Serializable& outData)
+{
+    return awaitOperation([session = session, &outData](Session::CompletionHandler handler) {
+        session->asyncReceive(outData, handler);
+    });
+}
+
+boost::asio::awaitable<std::size_t> AwaitableSession::receive(Serializable& outData, const std::chrono::milliseconds timeout)
+{
+    return awaitOperation(
+        [session = session, &outData](Session::CompletionHandler handler, std::shared_ptr<CancellationSlot> slot) {
+            session->asyncReceive(outData, handler, slot);
+        },
+        timeout);
+}
+
+std::shared_ptr<Session> AwaitableSession::getSession() const
+{
+    return session;
+}
+
+} // namespace ss
+} // namespace nts
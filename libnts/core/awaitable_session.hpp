@@ -0,0 +1,77 @@
+#pragma once
+
+#include <boost/asio/awaitable.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <libnts/core/session.hpp>
+
+namespace nts {
+namespace ss {
+
+/// Lets C++20 coroutines await the operations of a session.
+///
+/// @details Each operation starts the matching asynchronous operation of the wrapped session
+/// and suspends the coroutine until it completes, so test scripts can be written as linear
+/// sequences of sends and receives. Many such scripts can be multiplexed on the few threads
+/// that run the io_context they were spawned on. Errors are thrown as
+/// boost::system::system_error, and receive timeouts as boost::asio::error::timed_out.
+///
+/// @note Only available when the library is built with NTS_ENABLE_COROUTINES.
+///
+/// @example
+/// boost::asio::awaitable<void> ping(AwaitableSession session)
+/// {
+///     co_await session.send(request);
+///     co_await session.receive(reply, std::chrono::seconds(1));
+/// }
+/// boost::asio::co_spawn(*rawSession->getContext(), ping(AwaitableSession(rawSession)), boost::asio::detached);
+/// rawSession->run(4);
+class AwaitableSession
+{
+public:
+    /// Constructor.
+    /// @param session Session whose asynchronous operations are awaited.
+    explicit AwaitableSession(std::shared_ptr<Session> session);
+
+    /// Destructor.
+    ~AwaitableSession() = default;
+
+    /// Send data to the network.
+    /// @param inData Must remain valid until the operation completes.
+    /// @returns The number of bytes sent.
+    boost::asio::awaitable<std::size_t> send(std::vector<uint8_t>& inData);
+
+    /// Send object to the network.
+    /// @returns The number of bytes sent.
+    boost::asio::awaitable<std::size_t> send(Serializable& inData);
+
+    /// Receive data from the network.
+    /// @param outData Must be non-empty (size > 0), and remain valid until the operation completes.
+    /// @returns The number of bytes received.
+    boost::asio::awaitable<std::size_t> receive(std::vector<uint8_t>& outData);
+
+    /// Receive data from the network, giving up after the timeout.
+    /// @details The timeout cancels only this receive, through a CancellationSlot.
+    boost::asio::awaitable<std::size_t> receive(std::vector<uint8_t>& outData, const std::chrono::milliseconds timeout);
+
+    /// Receive object from the network.
+    /// @param outData Must remain valid until the operation completes.
+    /// @returns The number of bytes received.
+    boost::asio::awaitable<std::size_t> receive(Serializable& outData);
+
+    /// Receive object from the network, giving up after the timeout.
+    /// @details The timeout cancels only this receive, through a CancellationSlot.
+    boost::asio::awaitable<std::size_t> receive(Serializable& outData, const std::chrono::milliseconds timeout);
+
+    /// Session whose asynchronous operations are awaited.
+    std::shared_ptr<Session> getSession() const;
+
+private:
+    /// Session whose asynchronous operations are awaited.
+    std::shared_ptr<Session> session;
+};
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <deque>
+#include <gtest/gtest.h>
+
+#include <libnts/core/awaitable_session.hpp>
+#include <libnts/core/data_unit.hpp>
+
+namespace nts {
+namespace tests {
+
+/// Session that plays back sent frames to pending receive operations, from an io_context.
+class LoopSession : public ss::Session
+{
+public:
+    explicit LoopSession(boost::asio::io_context& context)
+        : context(context)
+    {
+    }
+
+    virtual std::size_t send(std::vector<uint8_t>& inData)
+    {
+        frames.push_back(inData);
+        deliver();
+        return inData.size();
+    }
+
+    virtual std::size_t send(Serializable& inData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t receive(std::vector<uint8_t>& outData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t receive(Serializable& outData)
+    {
+        return 0;
+    }
+
+    virtual void asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler)
+    {
+        const std::size_t bytes = send(inData);
+        boost::asio::post(context, [handler, bytes]() { handler(boost::system::error_code(), bytes); });
+    }
+
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler)
+    {
+        pending.push_back({ &outData, handler });
+        deliver();
+    }
+
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<ss::CancellationSlot> slot)
+    {
+        asyncReceive(outData, handler);
+        slot->assign([this, buffer = &outData]() {
+            // Only the operation of the slot is aborted.
+            auto operation = std::find_if(pending.begin(), pending.end(), [buffer](const auto& entry) { return entry.first == buffer; });
+            if (operation != pending.end())
+            {
+                boost::asio::post(context, [handler = operation->second]() { handler(boost::asio::error::operation_aborted, 0); });
+                pending.erase(operation);
+            }
+        });
+    }
+
+    virtual void cancel()
+    {
+        for (auto& operation : pending)
+        {
+            boost::asio::post(context, [handler = operation.second]() { handler(boost::asio::error::operation_aborted, 0); });
+        }
+        pending.clear();
+    }
+
+private:
+    /// Complete the pending receive operations with the sent frames.
+    void deliver()
+    {
+        while (!frames.empty() && !pending.empty())
+        {
+            auto operation = pending.front();
+            pending.pop_front();
+            std::vector<uint8_t> frame = frames.front();
+            frames.pop_front();
+            std::copy(frame.begin(), frame.end(), operation.first->begin());
+            boost::asio::post(context, [handler = operation.second, bytes = frame.size()]() { handler(boost::system::error_code(), bytes); });
+        }
+    }
+
+    boost::asio::io_context& context;
+    std::deque<std::vector<uint8_t>> frames;
+    std::deque<std::pair<std::vector<uint8_t>*, CompletionHandler>> pending;
+};
+
+TEST(AwaitableSessionUnitTests, SendReceive)
+{
+    boost::asio::io_context context;
+    ss::AwaitableSession session(std::make_shared<LoopSession>(context));
+
+    std::size_t bytesReceived = 0;
+    boost::asio::co_spawn(
+        context, [&]() -> boost::asio::awaitable<void> {
+            std::vector<uint8_t> request{ 1, 2, 3, 4 };
+            co_await session.send(request);
+
+            std::vector<uint8_t> reply(ss::MTU_SIZE, 0);
+            bytesReceived = co_await session.receive(reply, std::chrono::seconds(1));
+        },
+        boost::asio::detached);
+    context.run();
+
+    EXPECT_EQ(bytesReceived, 4);
+}
+
+TEST(AwaitableSessionUnitTests, Timeout)
+{
+    boost::asio::io_context context;
+    ss::AwaitableSession session(std::make_shared<LoopSession>(context));
+
+    bool timedOut = false;
+    boost::asio::co_spawn(
+        context, [&]() -> boost::asio::awaitable<void> {
+            std::vector<uint8_t> reply(ss::MTU_SIZE, 0);
+            try
+            {
+                co_await session.receive(reply, std::chrono::milliseconds(10));
+            }
+            catch (const boost::system::system_error& error)
+            {
+                timedOut = error.code() == boost::asio::error::timed_out;
+            }
+        },
+        boost::asio::detached);
+    context.run();
+
+    EXPECT_TRUE(timedOut);
+}
+
+TEST(AwaitableSessionUnitTests, TimeoutCancelsOnlyItsReceive)
+{
+    boost::asio::io_context context;
+    ss::AwaitableSession session(std::make_shared<LoopSession>(context));
+
+    // The first script waits without a timeout.
+    std::size_t bytesReceived = 0;
+    boost::asio::co_spawn(
+        context, [&]() -> boost::asio::awaitable<void> {
+            std::vector<uint8_t> reply(ss::MTU_SIZE, 0);
+            bytesReceived = co_await session.receive(reply);
+        },
+        boost::asio::detached);
+
+    // The second script times out, and then sends the frame the first one waits for.
+    bool timedOut = false;
+    boost::asio::co_spawn(
+        context, [&]() -> boost::asio::awaitable<void> {
+            std::vector<uint8_t> reply(ss::MTU_SIZE, 0);
+            try
+            {
+                co_await session.receive(reply, std::chrono::milliseconds(10));
+            }
+            catch (const boost::system::system_error& error)
+            {
+                timedOut = error.code() == boost::asio::error::timed_out;
+            }
+            std::vector<uint8_t> request{ 1, 2, 3 };
+            co_await session.send(request);
+        },
+        boost::asio::detached);
+    context.run();
+
+    EXPECT_TRUE(timedOut);
+    EXPECT_EQ(bytesReceived, 3);
+}
+
+TEST(AwaitableSessionUnitTests, ConcurrentScripts)
+{
+    boost::asio::io_context context;
+    ss::AwaitableSession session(std::make_shared<LoopSession>(context));
+
+    // Every script waits for a reply before the next request is sent by another script.
+    const int scriptCount = 100;
+    int repliesReceived = 0;
+    for (int i = 0; i < scriptCount; i++)
+    {
+        boost::asio::co_spawn(
+            context, [&]() -> boost::asio::awaitable<void> {
+                std::vector<uint8_t> reply(ss::MTU_SIZE, 0);
+                co_await session.receive(reply);
+                repliesReceived++;
+
+                std::vector<uint8_t> request{ 1 };
+                co_await session.send(request);
+            },
+            boost::asio::detached);
+    }
+
+    // Start the chain of requests.
+    boost::asio::co_spawn(
+        context, [&]() -> boost::asio::awaitable<void> {
+            std::vector<uint8_t> request{ 1 };
+            co_await session.send(request);
+        },
+        boost::asio::detached);
+    context.run();
+
+    EXPECT_EQ(repliesReceived, scriptCount);
+}
+
+} // namespace tests
+} // namespace nts
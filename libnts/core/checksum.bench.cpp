@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include <libnts/core/checksum.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// Adds one big-endian word at a time, the way the IPv4 header sum used to. Serves as a baseline.
+uint16_t sumPerWord(const uint8_t* data, const std::size_t length)
+{
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i + 1 < length; i += 2)
+    {
+        sum += (uint32_t(data[i]) << 8) | data[i + 1];
+    }
+    if (length % 2)
+    {
+        sum += uint32_t(data[length - 1]) << 8;
+    }
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(sum);
+}
+
+/// Data of the given size.
+std::vector<uint8_t> makeData(const std::size_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    return data;
+}
+
+} // namespace
+
+void BM_ChecksumPerWord(benchmark::State& state)
+{
+    const std::vector<uint8_t> data = makeData(state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sumPerWord(data.data(), data.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_Checksum(benchmark::State& state, const ChecksumKernel kernel)
+{
+    if (!isChecksumKernelSupported(kernel))
+    {
+        state.SkipWithError("Kernel not supported by the CPU");
+        return;
+    }
+    const std::vector<uint8_t> data = makeData(state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(onesComplementSum(data.data(), data.size(), 0, kernel));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// From the minimum frame to a jumbo frame.
+BENCHMARK(BM_ChecksumPerWord)->RangeMultiplier(4)->Range(64, 9216);
+BENCHMARK_CAPTURE(BM_Checksum, Scalar, ChecksumKernel::Scalar)->RangeMultiplier(4)->Range(64, 9216);
+BENCHMARK_CAPTURE(BM_Checksum, Sse2, ChecksumKernel::Sse2)->RangeMultiplier(4)->Range(64, 9216);
+BENCHMARK_CAPTURE(BM_Checksum, Avx2, ChecksumKernel::Avx2)->RangeMultiplier(4)->Range(64, 9216);
+
+} // namespace benchmarks
+} // namespace nts
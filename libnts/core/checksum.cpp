@@ -0,0 +1,225 @@
+#include <libnts/core/checksum.hpp>
+
+#include <algorithm>
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NTS_CHECKSUM_X86 1
+#include <immintrin.h>
+#else
+#define NTS_CHECKSUM_X86 0
+#endif
+
+namespace nts {
+
+namespace {
+
+/// Sums the data in native byte order, without folding.
+typedef uint64_t (*SumFunction)(const uint8_t* data, std::size_t length);
+
+/// Steps of the vector kernels between two flushes of their 32-bit lanes. Each lane receives
+/// one 16-bit word per step, so it can't overflow before the flush.
+constexpr std::size_t stepsPerFlush{ 16384 };
+
+/// Native byte order sum of the data, added to the given sum.
+/// @details The one's complement sum doesn't depend on byte order (RFC 1071), so words are
+/// added as they are loaded and the folded result is swapped once at the end.
+uint64_t sumScalar(const uint8_t* data, std::size_t length, uint64_t sum)
+{
+    while (length >= 16)
+    {
+        uint32_t words[4];
+        memcpy(words, data, sizeof(words));
+        sum += uint64_t(words[0]) + words[1] + words[2] + words[3];
+        data += 16;
+        length -= 16;
+    }
+    while (length >= 4)
+    {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        sum += word;
+        data += 4;
+        length -= 4;
+    }
+    if (length >= 2)
+    {
+        uint16_t word;
+        memcpy(&word, data, sizeof(word));
+        sum += word;
+        data += 2;
+        length -= 2;
+    }
+    if (length == 1)
+    {
+        // The trailing byte is the first byte of a zero padded word.
+        const uint8_t padded[2] = { data[0], 0 };
+        uint16_t word;
+        memcpy(&word, padded, sizeof(word));
+        sum += word;
+    }
+    return sum;
+}
+
+uint64_t sumScalar(const uint8_t* data, std::size_t length)
+{
+    return sumScalar(data, length, 0);
+}
+
+#if NTS_CHECKSUM_X86
+
+__attribute__((target("sse2"))) uint64_t sumSse2(const uint8_t* data, std::size_t length)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t sum = 0;
+    while (length >= 32)
+    {
+        // Widen the 16-bit words to 32-bit lanes, with two vectors in flight per step.
+        __m128i accumulators[4] = { zero, zero, zero, zero };
+        const std::size_t steps = std::min(length / 32, stepsPerFlush);
+        for (std::size_t i = 0; i < steps; i++)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+            accumulators[0] = _mm_add_epi32(accumulators[0], _mm_unpacklo_epi16(a, zero));
+            accumulators[1] = _mm_add_epi32(accumulators[1], _mm_unpackhi_epi16(a, zero));
+            accumulators[2] = _mm_add_epi32(accumulators[2], _mm_unpacklo_epi16(b, zero));
+            accumulators[3] = _mm_add_epi32(accumulators[3], _mm_unpackhi_epi16(b, zero));
+            data += 32;
+        }
+        length -= steps * 32;
+
+        uint32_t lanes[16];
+        memcpy(lanes, accumulators, sizeof(lanes));
+        for (const uint32_t lane : lanes)
+        {
+            sum += lane;
+        }
+    }
+    return sumScalar(data, length, sum);
+}
+
+__attribute__((target("avx2"))) uint64_t sumAvx2(const uint8_t* data, std::size_t length)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uint64_t sum = 0;
+    while (length >= 64)
+    {
+        // Widen the 16-bit words to 32-bit lanes, with two vectors in flight per step.
+        __m256i accumulators[4] = { zero, zero, zero, zero };
+        const std::size_t steps = std::min(length / 64, stepsPerFlush);
+        for (std::size_t i = 0; i < steps; i++)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+            accumulators[0] = _mm256_add_epi32(accumulators[0], _mm256_unpacklo_epi16(a, zero));
+            accumulators[1] = _mm256_add_epi32(accumulators[1], _mm256_unpackhi_epi16(a, zero));
+            accumulators[2] = _mm256_add_epi32(accumulators[2], _mm256_unpacklo_epi16(b, zero));
+            accumulators[3] = _mm256_add_epi32(accumulators[3], _mm256_unpackhi_epi16(b, zero));
+            data += 64;
+        }
+        length -= steps * 64;
+
+        uint32_t lanes[32];
+        memcpy(lanes, accumulators, sizeof(lanes));
+        for (const uint32_t lane : lanes)
+        {
+            sum += lane;
+        }
+    }
+    return sumScalar(data, length, sum);
+}
+
+#endif
+
+/// Implementation of the kernel.
+SumFunction getSumFunction(const ChecksumKernel kernel)
+{
+    switch (kernel)
+    {
+#if NTS_CHECKSUM_X86
+    case ChecksumKernel::Sse2:
+        return sumSse2;
+    case ChecksumKernel::Avx2:
+        return sumAvx2;
+#endif
+    default:
+        return sumScalar;
+    }
+}
+
+/// Fastest kernel supported by the CPU.
+ChecksumKernel selectKernel()
+{
+    if (isChecksumKernelSupported(ChecksumKernel::Avx2))
+    {
+        return ChecksumKernel::Avx2;
+    }
+    if (isChecksumKernelSupported(ChecksumKernel::Sse2))
+    {
+        return ChecksumKernel::Sse2;
+    }
+    return ChecksumKernel::Scalar;
+}
+
+/// Fold the native byte order sum to 16 bits, convert it to network byte order and add the
+/// initial sum.
+uint16_t finish(uint64_t sum, const uint32_t initial)
+{
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    sum = uint64_t(boost::endian::native_to_big(static_cast<uint16_t>(sum))) + initial;
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(sum);
+}
+
+} // namespace
+
+uint16_t onesComplementSum(const uint8_t* data, const std::size_t length, const uint32_t initial)
+{
+    static const SumFunction sum = getSumFunction(getChecksumKernel());
+    return finish(sum(data, length), initial);
+}
+
+uint16_t onesComplementSum(const uint8_t* data, const std::size_t length, const uint32_t initial, const ChecksumKernel kernel)
+{
+    return finish(getSumFunction(kernel)(data, length), initial);
+}
+
+uint16_t internetChecksum(const uint8_t* data, const std::size_t length, const uint32_t initial)
+{
+    return static_cast<uint16_t>(~onesComplementSum(data, length, initial));
+}
+
+bool isChecksumKernelSupported(const ChecksumKernel kernel)
+{
+    switch (kernel)
+    {
+    case ChecksumKernel::Scalar:
+        return true;
+#if NTS_CHECKSUM_X86
+    case ChecksumKernel::Sse2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case ChecksumKernel::Avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+ChecksumKernel getChecksumKernel()
+{
+    static const ChecksumKernel kernel = selectKernel();
+    return kernel;
+}
+
+} // namespace nts
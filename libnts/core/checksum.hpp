@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nts {
+
+/// Implementations of the one's complement sum.
+enum class ChecksumKernel
+{
+    /// Portable implementation that adds 32-bit words into a 64-bit accumulator.
+    Scalar,
+    /// Adds 16 bytes per step with SSE2 instructions.
+    Sse2,
+    /// Adds 32 bytes per step with AVX2 instructions.
+    Avx2,
+};
+
+/// One's complement sum of the data, as used by the Internet checksum (RFC 1071).
+///
+/// @details The data is read as a sequence of 16-bit big-endian words. An odd trailing byte is
+/// padded with zero. The fastest kernel supported by the CPU is selected the first time the
+/// function is called.
+///
+/// @param data Start of the data. Doesn't need to be aligned.
+/// @param length Number of bytes.
+/// @param initial Sum of data that precedes this range, such as a pseudo-header. The range is
+/// assumed to start at an even offset.
+/// @returns The sum, folded to 16 bits.
+uint16_t onesComplementSum(const uint8_t* data, const std::size_t length, const uint32_t initial = 0);
+
+/// One's complement sum of the data, computed with the given kernel.
+/// @note The kernel must be supported by the CPU.
+uint16_t onesComplementSum(const uint8_t* data, const std::size_t length, const uint32_t initial, const ChecksumKernel kernel);
+
+/// Internet checksum of the data: the complement of its one's complement sum.
+/// @details A range that includes a valid checksum has a checksum of zero.
+uint16_t internetChecksum(const uint8_t* data, const std::size_t length, const uint32_t initial = 0);
+
+/// Internet checksum of data in which a 16-bit word changed, without summing the data again.
+/// @details Implements equation 3 of RFC 1624, which doesn't produce a -0 checksum.
+/// @param checksum Checksum of the data before the change.
+/// @param oldWord Previous value of the word, in host byte order.
+/// @param newWord New value of the word, in host byte order.
+inline uint16_t updateChecksum(const uint16_t checksum, const uint16_t oldWord, const uint16_t newWord)
+{
+    uint32_t sum = uint32_t(uint16_t(~checksum)) + uint16_t(~oldWord) + newWord;
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+/// Internet checksum of data in which a 32-bit word changed, such as an IPv4 address.
+/// @details The word must start at an even offset.
+inline uint16_t updateChecksum32(const uint16_t checksum, const uint32_t oldWord, const uint32_t newWord)
+{
+    uint32_t sum = uint32_t(uint16_t(~checksum))
+        + uint16_t(~(oldWord >> 16)) + uint16_t(~oldWord)
+        + (newWord >> 16) + (newWord & 0xFFFF);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+/// Whether the CPU supports the kernel.
+bool isChecksumKernelSupported(const ChecksumKernel kernel);
+
+/// Kernel used by onesComplementSum when none is given.
+ChecksumKernel getChecksumKernel();
+
+} // namespace nts
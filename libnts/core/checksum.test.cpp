@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <libnts/core/checksum.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Straightforward RFC 1071 sum, one big-endian word at a time.
+uint16_t referenceSum(const uint8_t* data, const std::size_t length)
+{
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i < length; i += 2)
+    {
+        sum += uint32_t(data[i]) << 8;
+        if (i + 1 < length)
+        {
+            sum += data[i + 1];
+        }
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(sum);
+}
+
+/// Data that exercises the carries.
+std::vector<uint8_t> makeData(const std::size_t size)
+{
+    std::vector<uint8_t> data(size);
+    uint32_t state = 12345;
+    for (auto& byte : data)
+    {
+        state = state * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(state >> 16) | 0x80;
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(ChecksumUnitTests, KnownValues)
+{
+    // Example from RFC 1071, section 3.
+    const uint8_t data[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+    EXPECT_EQ(onesComplementSum(data, sizeof(data)), 0xddf2);
+    EXPECT_EQ(internetChecksum(data, sizeof(data)), 0x220d);
+
+    // Odd lengths are padded with zero.
+    EXPECT_EQ(onesComplementSum(data, 3), 0xf201);
+
+    // The initial sum is added in network byte order.
+    EXPECT_EQ(onesComplementSum(data, 2, 0x1234), 0x1235);
+    EXPECT_EQ(onesComplementSum(nullptr, 0, 0x2ffff), 0x0002);
+
+    // A range that includes its checksum sums to 0xFFFF.
+    std::vector<uint8_t> message(data, data + sizeof(data));
+    const uint16_t checksum = internetChecksum(message.data(), message.size());
+    message.push_back(checksum >> 8);
+    message.push_back(checksum & 0xFF);
+    EXPECT_EQ(onesComplementSum(message.data(), message.size()), 0xFFFF);
+    EXPECT_EQ(internetChecksum(message.data(), message.size()), 0);
+}
+
+TEST(ChecksumUnitTests, Kernels)
+{
+    EXPECT_TRUE(isChecksumKernelSupported(ChecksumKernel::Scalar));
+    EXPECT_TRUE(isChecksumKernelSupported(getChecksumKernel()));
+
+    // Every length and alignment around the vector sizes, and sizes beyond a lane flush.
+    const std::vector<uint8_t> data = makeData(1200000);
+    std::vector<std::size_t> lengths;
+    for (std::size_t length = 0; length <= 300; length++)
+    {
+        lengths.push_back(length);
+    }
+    lengths.insert(lengths.end(), { 1500, 9000, 9001, 600000, 1199990 });
+
+    for (const ChecksumKernel kernel : { ChecksumKernel::Scalar, ChecksumKernel::Sse2, ChecksumKernel::Avx2 })
+    {
+        if (!isChecksumKernelSupported(kernel))
+        {
+            continue;
+        }
+        for (std::size_t offset = 0; offset < 4; offset++)
+        {
+            for (const std::size_t length : lengths)
+            {
+                const uint8_t* start = data.data() + offset;
+                ASSERT_EQ(onesComplementSum(start, length, 0, kernel), referenceSum(start, length))
+                    << "Kernel " << static_cast<int>(kernel) << ", offset " << offset << ", length " << length;
+            }
+        }
+    }
+}
+
+TEST(ChecksumUnitTests, Update)
+{
+    std::vector<uint8_t> data = makeData(64);
+    uint16_t checksum = internetChecksum(data.data(), data.size());
+
+    // Each change gives the same checksum as summing the data again.
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        const std::size_t offset = (i * 7 % 32) * 2;
+        const uint16_t oldWord = uint16_t((data[offset] << 8) | data[offset + 1]);
+        const uint16_t newWord = uint16_t(i * 40503);
+        data[offset] = newWord >> 8;
+        data[offset + 1] = newWord & 0xFF;
+        checksum = updateChecksum(checksum, oldWord, newWord);
+        ASSERT_EQ(checksum, internetChecksum(data.data(), data.size()));
+    }
+
+    // Same for 32-bit words.
+    const uint32_t oldWord = uint32_t((data[8] << 24) | (data[9] << 16) | (data[10] << 8) | data[11]);
+    const uint32_t newWord = 0xc0a80001;
+    data[8] = 0xc0;
+    data[9] = 0xa8;
+    data[10] = 0x00;
+    data[11] = 0x01;
+    EXPECT_EQ(updateChecksum32(checksum, oldWord, newWord), internetChecksum(data.data(), data.size()));
+}
+
+} // namespace tests
+} // namespace nts
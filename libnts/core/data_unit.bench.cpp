@@ -0,0 +1,138 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+#include <libnts/core/data_unit.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// Writes the data one byte per call, the way GenericDataUnit used to. Serves as a baseline.
+void writePerByte(std::ostream& outStream, const std::vector<uint8_t>& inData)
+{
+    for (const uint8_t& byte : inData)
+    {
+        outStream.write(reinterpret_cast<const char*>(&byte), 1);
+    }
+}
+
+/// Reads the data one byte per call, the way GenericDataUnit used to. Serves as a baseline.
+void readPerByte(std::istream& inStream, std::vector<uint8_t>& outData)
+{
+    outData.clear();
+    char byte;
+    while (true)
+    {
+        inStream.read(&byte, 1);
+        if (inStream.fail())
+        {
+            break;
+        }
+        outData.push_back(byte);
+    }
+}
+
+/// Payload of the given size.
+std::vector<uint8_t> makePayload(const std::size_t size)
+{
+    std::vector<uint8_t> payload(size);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+    return payload;
+}
+
+} // namespace
+
+void BM_GenericToStreamPerByte(benchmark::State& state)
+{
+    const std::vector<uint8_t> payload = makePayload(state.range(0));
+    std::stringstream stream;
+    for (auto _ : state)
+    {
+        stream.seekp(0);
+        writePerByte(stream, payload);
+        benchmark::DoNotOptimize(stream);
+    }
+    state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+void BM_GenericToStream(benchmark::State& state)
+{
+    GenericDataUnit unit;
+    unit.setData(makePayload(state.range(0)));
+    std::stringstream stream;
+    for (auto _ : state)
+    {
+        stream.seekp(0);
+        unit.toStream(stream);
+        benchmark::DoNotOptimize(stream);
+    }
+    state.SetBytesProcessed(state.iterations() * unit.getUnitSize());
+}
+
+void BM_GenericFromStreamPerByte(benchmark::State& state)
+{
+    const std::vector<uint8_t> payload = makePayload(state.range(0));
+    std::istringstream stream(std::string(payload.begin(), payload.end()));
+    std::vector<uint8_t> data;
+    for (auto _ : state)
+    {
+        stream.clear();
+        stream.seekg(0);
+        readPerByte(stream, data);
+        benchmark::DoNotOptimize(data.data());
+    }
+    state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+void BM_GenericFromStream(benchmark::State& state)
+{
+    const std::vector<uint8_t> payload = makePayload(state.range(0));
+    std::istringstream stream(std::string(payload.begin(), payload.end()));
+    GenericDataUnit unit;
+    for (auto _ : state)
+    {
+        stream.clear();
+        stream.seekg(0);
+        unit.fromStream(stream);
+        benchmark::DoNotOptimize(unit.getData().data());
+    }
+    state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+void BM_GenericSerialize(benchmark::State& state)
+{
+    GenericDataUnit unit;
+    unit.setData(makePayload(state.range(0)));
+    std::vector<uint8_t> buffer(unit.getUnitSize());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(unit.serialize(buffer.data(), buffer.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * unit.getUnitSize());
+}
+
+void BM_GenericDeserialize(benchmark::State& state)
+{
+    const std::vector<uint8_t> payload = makePayload(state.range(0));
+    GenericDataUnit unit;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(unit.deserialize(payload.data(), payload.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+// Minimum frame payload, full MTU and jumbo frame.
+BENCHMARK(BM_GenericToStreamPerByte)->Arg(46)->Arg(1500)->Arg(9000);
+BENCHMARK(BM_GenericToStream)->Arg(46)->Arg(1500)->Arg(9000);
+BENCHMARK(BM_GenericFromStreamPerByte)->Arg(46)->Arg(1500)->Arg(9000);
+BENCHMARK(BM_GenericFromStream)->Arg(46)->Arg(1500)->Arg(9000);
+BENCHMARK(BM_GenericSerialize)->Arg(46)->Arg(1500)->Arg(9000);
+BENCHMARK(BM_GenericDeserialize)->Arg(46)->Arg(1500)->Arg(9000);
+
+} // namespace benchmarks
+} // namespace nts
@@ -1,31 +1,80 @@
 #include <libnts/core/data_unit.hpp>
 
+#include <algorithm>
 #include <boost/asio.hpp>
+#include <cstring>
 #include <sstream>
 
 namespace nts {
 
+namespace {
+
+/// Smallest number of bytes requested from the stream at once.
+constexpr std::streamsize minimumChunkSize{ 4096 };
+
+} // namespace
+
 void GenericDataUnit::toStream(std::ostream& outStream) const
 {
-    for (const uint8_t& byte : data)
-    {
-        outStream.write(reinterpret_cast<const char*>(&byte), 1);
-    }
+    outStream.write(reinterpret_cast<const char*>(data.data()), data.size());
 }
 
 void GenericDataUnit::fromStream(std::istream& inStream)
 {
     data.clear();
-    char byte;
-    for (int i = 0; i < 1500; i++)
+    std::istream::sentry sentry(inStream, true);
+    if (!sentry)
     {
-        inStream.read(&byte, 1);
-        if (inStream.fail())
+        return;
+    }
+
+    // Everything that is left in the stream belongs to the unit. Most streams hold it all in
+    // their buffer already, in which case it is moved with a single transfer.
+    std::streambuf* buffer = inStream.rdbuf();
+    std::streamsize chunkSize = buffer->in_avail();
+    data.reserve(std::max<std::streamsize>(chunkSize, 0));
+    while (true)
+    {
+        if (chunkSize <= 0)
+        {
+            // The amount left is unknown, so read it in chunks until the stream runs out.
+            if (std::istream::traits_type::eq_int_type(buffer->sgetc(), std::istream::traits_type::eof()))
+            {
+                break;
+            }
+            chunkSize = minimumChunkSize;
+        }
+
+        const std::size_t offset = data.size();
+        data.resize(offset + chunkSize);
+        const std::streamsize bytes = buffer->sgetn(reinterpret_cast<char*>(data.data() + offset), chunkSize);
+        data.resize(offset + bytes);
+        if (bytes < chunkSize)
         {
             break;
         }
-        data.push_back(byte);
+        chunkSize = buffer->in_avail();
     }
+    inStream.setstate(std::ios::eofbit);
+}
+
+std::size_t GenericDataUnit::serialize(uint8_t* outBuffer, const std::size_t capacity) const
+{
+    if (capacity < data.size())
+    {
+        return 0;
+    }
+    if (!data.empty())
+    {
+        memcpy(outBuffer, data.data(), data.size());
+    }
+    return data.size();
+}
+
+std::size_t GenericDataUnit::deserialize(const uint8_t* inBuffer, const std::size_t length)
+{
+    data.assign(inBuffer, inBuffer + length);
+    return length;
 }
 
 std::string GenericDataUnit::toString() const
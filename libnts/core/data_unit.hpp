@@ -14,7 +14,7 @@ public:
     ProtocolDataUnit() = default;
 
     /// Deconstructor.
-    ~ProtocolDataUnit() = default;
+    virtual ~ProtocolDataUnit() = default;
 
     /// Writes the object to the stream.
     virtual void toStream(std::ostream& outStream) const = 0;
@@ -46,8 +46,17 @@ public:
     virtual void toStream(std::ostream& outStream) const;
 
     /// Reads the object from the stream.
+    /// @details Consumes everything that is left in the stream, regardless of its size.
     virtual void fromStream(std::istream& inStream);
 
+    /// Writes the object to the buffer.
+    /// @returns The number of bytes written, or 0 if the data does not fit.
+    virtual std::size_t serialize(uint8_t* outBuffer, const std::size_t capacity) const;
+
+    /// Reads the object from the buffer. The whole buffer becomes the data of the unit.
+    /// @returns The number of bytes read.
+    virtual std::size_t deserialize(const uint8_t* inBuffer, const std::size_t length);
+
     /// Representation of the object in a console friendly format.
     virtual std::string toString() const;
 
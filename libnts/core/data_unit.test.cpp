@@ -1,5 +1,6 @@
 #include <boost/asio.hpp>
 #include <gtest/gtest.h>
+#include <sstream>
 
 #include <libnts/core/data_unit.hpp>
 
@@ -36,5 +37,45 @@ TEST(DataUnitUnitTests, Serialization)
     EXPECT_EQ(unitA.getData(), unitB.getData());
 }
 
+TEST(DataUnitUnitTests, JumboPayload)
+{
+    // Larger than both the MTU and the chunks the unit reads at once.
+    std::vector<uint8_t> payload(9000);
+    for (std::size_t i = 0; i < payload.size(); i++)
+    {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+    GenericDataUnit unitA;
+    unitA.setData(payload);
+
+    std::stringstream stream;
+    stream << unitA;
+
+    // Bytes that were already consumed don't belong to the unit.
+    stream.ignore(10);
+    GenericDataUnit unitB;
+    stream >> unitB;
+    EXPECT_EQ(unitB.getData(), std::vector<uint8_t>(payload.begin() + 10, payload.end()));
+    EXPECT_TRUE(stream.eof());
+}
+
+TEST(DataUnitUnitTests, BufferSerialization)
+{
+    GenericDataUnit unitA;
+    unitA.setData(data);
+
+    // Doesn't fit.
+    std::vector<uint8_t> buffer(data.size() - 1, 0);
+    EXPECT_EQ(unitA.serialize(buffer.data(), buffer.size()), 0);
+
+    buffer.resize(data.size());
+    EXPECT_EQ(unitA.serialize(buffer.data(), buffer.size()), data.size());
+    EXPECT_EQ(buffer, data);
+
+    GenericDataUnit unitB;
+    EXPECT_EQ(unitB.deserialize(buffer.data(), buffer.size()), data.size());
+    EXPECT_EQ(unitB.getData(), data);
+}
+
 } // namespace tests
 } // namespace nts
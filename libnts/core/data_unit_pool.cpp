@@ -0,0 +1,110 @@
+#include <libnts/core/data_unit_pool.hpp>
+
+#include <atomic>
+#include <new>
+
+namespace nts {
+
+std::shared_ptr<DataUnitPool> DataUnitPool::create()
+{
+    // The constructor is protected, so make_shared can't be used.
+    return std::shared_ptr<DataUnitPool>(new DataUnitPool());
+}
+
+DataUnitPool::~DataUnitPool()
+{
+    for (auto& entry : freeObjects)
+    {
+        for (void* object : entry.objects)
+        {
+            entry.destroy(object);
+        }
+    }
+    for (auto& blocks : freeBlocks)
+    {
+        for (void* block : blocks)
+        {
+            ::operator delete(block);
+        }
+    }
+}
+
+std::size_t DataUnitPool::getFreeObjectCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t count = 0;
+    for (const auto& entry : freeObjects)
+    {
+        count += entry.objects.size();
+    }
+    return count;
+}
+
+void* DataUnitPool::allocateBlock(const std::size_t size)
+{
+    const std::size_t sizeClass = (size + blockAlignment - 1) / blockAlignment;
+    if (sizeClass >= blockClassCount)
+    {
+        return ::operator new(size);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<void*>& blocks = freeBlocks[sizeClass];
+        if (!blocks.empty())
+        {
+            void* block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+    }
+
+    // Blocks of the same class are interchangeable, so they are allocated at the class size.
+    return ::operator new(sizeClass * blockAlignment);
+}
+
+void DataUnitPool::deallocateBlock(void* block, const std::size_t size)
+{
+    const std::size_t sizeClass = (size + blockAlignment - 1) / blockAlignment;
+    if (sizeClass >= blockClassCount)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBlocks[sizeClass].push_back(block);
+}
+
+void* DataUnitPool::takeObject(const std::size_t typeSlot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (typeSlot >= freeObjects.size() || freeObjects[typeSlot].objects.empty())
+    {
+        return nullptr;
+    }
+    std::vector<void*>& objects = freeObjects[typeSlot].objects;
+    void* object = objects.back();
+    objects.pop_back();
+    return object;
+}
+
+void DataUnitPool::giveObject(const std::size_t typeSlot, void* object, void (*destroy)(void*))
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (typeSlot >= freeObjects.size())
+    {
+        freeObjects.resize(typeSlot + 1);
+    }
+    FreeObjects& entry = freeObjects[typeSlot];
+    entry.destroy = destroy;
+    entry.objects.push_back(object);
+}
+
+std::size_t DataUnitPool::makeTypeSlot()
+{
+    static std::atomic<std::size_t> nextTypeSlot{ 0 };
+    return nextTypeSlot++;
+}
+
+} // namespace nts
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nts {
+
+/// Recycles data units and the control blocks of the shared pointers that own them.
+///
+/// @details Objects made by the pool are not destroyed when their last owner lets go of them.
+/// They go back to the pool instead, keeping the storage of their members, and are handed out
+/// again by the next call to make(). The control blocks of the shared pointers are also taken
+/// from free lists, so once the pool is warmed up, making and releasing objects doesn't touch
+/// the heap. The pool lives for as long as any of the objects it made.
+///
+/// @note The free lists are guarded by a mutex, so objects can be released on any thread, for
+/// instance by the consumer of a message that was parsed on a receiving thread. The lock is
+/// uncontended when each thread or session has its own pool.
+///
+/// @example
+/// auto pool = DataUnitPool::create();
+/// std::shared_ptr<EthernetDataUnit> frame = pool->make<EthernetDataUnit>();
+class DataUnitPool : public std::enable_shared_from_this<DataUnitPool>
+{
+public:
+    /// Create a pool. Pools are always owned by shared pointers.
+    static std::shared_ptr<DataUnitPool> create();
+
+    /// Destructor. Destroys the pooled objects and frees the pooled memory.
+    ~DataUnitPool();
+
+    /// Object of the given type, in its default state.
+    /// @details Recycled objects are reset by copying a default constructed object over them.
+    template <typename T>
+    std::shared_ptr<T> make();
+
+    /// Number of objects waiting to be handed out again.
+    std::size_t getFreeObjectCount() const;
+
+    /// Memory for a control block. Sizes beyond the largest class come from the heap.
+    void* allocateBlock(const std::size_t size);
+
+    /// Give back the memory of a control block.
+    void deallocateBlock(void* block, const std::size_t size);
+
+protected:
+    /// Constructor.
+    DataUnitPool() = default;
+
+    /// Object that was given back to the free list of a type, or nullptr.
+    void* takeObject(const std::size_t typeSlot);
+
+    /// Give an object back to the free list of its type.
+    void giveObject(const std::size_t typeSlot, void* object, void (*destroy)(void*));
+
+    /// Index of the free list of the given type.
+    /// @details Slots are handed out on first use, so lookups don't hash type names.
+    template <typename T>
+    static std::size_t getTypeSlot();
+
+    /// Slot for a type that was not seen before.
+    static std::size_t makeTypeSlot();
+
+private:
+    /// Allocator for the control blocks of the shared pointers made by the pool.
+    template <typename T>
+    class BlockAllocator;
+
+    /// Objects of the same type that were given back to the pool.
+    struct FreeObjects
+    {
+        /// Objects waiting to be handed out again.
+        std::vector<void*> objects;
+
+        /// Destroys an object of the type.
+        void (*destroy)(void*){ nullptr };
+    };
+
+    /// Granularity of the block size classes.
+    static constexpr std::size_t blockAlignment{ 16 };
+
+    /// Number of block size classes.
+    static constexpr std::size_t blockClassCount{ 16 };
+
+    /// Protects the free lists.
+    mutable std::mutex mutex;
+
+    /// Free objects by type slot.
+    std::vector<FreeObjects> freeObjects;
+
+    /// Free blocks by size class.
+    std::array<std::vector<void*>, blockClassCount> freeBlocks;
+};
+
+template <typename T>
+class DataUnitPool::BlockAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit BlockAllocator(std::shared_ptr<DataUnitPool> pool)
+        : pool(pool)
+    {
+    }
+
+    template <typename U>
+    BlockAllocator(const BlockAllocator<U>& other)
+        : pool(other.pool)
+    {
+    }
+
+    T* allocate(const std::size_t count)
+    {
+        return static_cast<T*>(pool->allocateBlock(count * sizeof(T)));
+    }
+
+    void deallocate(T* block, const std::size_t count)
+    {
+        pool->deallocateBlock(block, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const BlockAllocator<U>& other) const
+    {
+        return pool == other.pool;
+    }
+
+    template <typename U>
+    bool operator!=(const BlockAllocator<U>& other) const
+    {
+        return pool != other.pool;
+    }
+
+private:
+    template <typename U>
+    friend class BlockAllocator;
+
+    /// Keeps the pool alive until the block is given back.
+    std::shared_ptr<DataUnitPool> pool;
+};
+
+template <typename T>
+std::shared_ptr<T> DataUnitPool::make()
+{
+    const std::size_t typeSlot = getTypeSlot<T>();
+    T* object = static_cast<T*>(takeObject(typeSlot));
+    if (object)
+    {
+        static const T prototype;
+        *object = prototype;
+    }
+    else
+    {
+        object = new T();
+    }
+
+    // The control block owns a reference to the pool, so the recycler can use a plain pointer.
+    DataUnitPool* self = this;
+    auto recycle = [self, typeSlot](T* object) {
+        self->giveObject(typeSlot, object, [](void* object) { delete static_cast<T*>(object); });
+    };
+    return std::shared_ptr<T>(object, recycle, BlockAllocator<T>(shared_from_this()));
+}
+
+template <typename T>
+std::size_t DataUnitPool::getTypeSlot()
+{
+    static const std::size_t typeSlot = makeTypeSlot();
+    return typeSlot;
+}
+
+/// Object of the given type from the pool, or from the heap when there is no pool.
+template <typename T>
+std::shared_ptr<T> makeDataUnit(DataUnitPool* pool)
+{
+    if (pool)
+    {
+        return pool->make<T>();
+    }
+    return std::make_shared<T>();
+}
+
+} // namespace nts
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <libnts/core/data_unit.hpp>
+#include <libnts/core/data_unit_pool.hpp>
+
+namespace nts {
+namespace tests {
+
+TEST(DataUnitPoolUnitTests, Recycling)
+{
+    auto pool = DataUnitPool::create();
+
+    std::shared_ptr<GenericDataUnit> unitA = pool->make<GenericDataUnit>();
+    unitA->setData({ 1, 2, 3 });
+    const GenericDataUnit* address = unitA.get();
+    EXPECT_EQ(pool->getFreeObjectCount(), 0);
+
+    // Releasing the unit gives it back to the pool.
+    unitA.reset();
+    EXPECT_EQ(pool->getFreeObjectCount(), 1);
+
+    // The same object is handed out again, in its default state.
+    std::shared_ptr<GenericDataUnit> unitB = pool->make<GenericDataUnit>();
+    EXPECT_EQ(unitB.get(), address);
+    EXPECT_TRUE(unitB->getData().empty());
+    EXPECT_EQ(pool->getFreeObjectCount(), 0);
+
+    // Objects of other types are not mixed up.
+    unitB.reset();
+    std::shared_ptr<ProtocolDataUnit> unitC = makeDataUnit<GenericDataUnit>(pool.get());
+    EXPECT_EQ(unitC.get(), address);
+}
+
+TEST(DataUnitPoolUnitTests, Lifetime)
+{
+    std::shared_ptr<GenericDataUnit> unit;
+    std::weak_ptr<DataUnitPool> weakPool;
+    {
+        auto pool = DataUnitPool::create();
+        weakPool = pool;
+        unit = pool->make<GenericDataUnit>();
+    }
+
+    // The pool is kept alive by the objects it made.
+    EXPECT_FALSE(weakPool.expired());
+    unit->setData({ 1, 2, 3 });
+    unit.reset();
+    EXPECT_TRUE(weakPool.expired());
+}
+
+TEST(DataUnitPoolUnitTests, ReleaseOnOtherThreads)
+{
+    auto pool = DataUnitPool::create();
+    constexpr std::size_t threadCount{ 4 };
+    constexpr std::size_t unitCount{ 1000 };
+    std::set<const GenericDataUnit*> addresses;
+
+    // Units are made on this thread while other threads release theirs.
+    std::vector<std::vector<std::shared_ptr<GenericDataUnit>>> batches(threadCount);
+    for (auto& batch : batches)
+    {
+        for (std::size_t i = 0; i < unitCount; i++)
+        {
+            batch.push_back(pool->make<GenericDataUnit>());
+            addresses.insert(batch.back().get());
+        }
+    }
+    std::vector<std::thread> threads;
+    for (auto& batch : batches)
+    {
+        threads.emplace_back([&batch]() { batch.clear(); });
+    }
+    std::vector<std::shared_ptr<GenericDataUnit>> units;
+    for (std::size_t i = 0; i < unitCount; i++)
+    {
+        units.push_back(pool->make<GenericDataUnit>());
+        addresses.insert(units.back().get());
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Every unit made so far is back in the pool, once.
+    units.clear();
+    EXPECT_EQ(pool->getFreeObjectCount(), addresses.size());
+}
+
+TEST(DataUnitPoolUnitTests, WithoutPool)
+{
+    std::shared_ptr<GenericDataUnit> unit = makeDataUnit<GenericDataUnit>(nullptr);
+    ASSERT_TRUE(unit);
+    EXPECT_TRUE(unit->getData().empty());
+}
+
+} // namespace tests
+} // namespace nts
@@ -0,0 +1,222 @@
+#include <libnts/core/io_uring.hpp>
+
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Creates a ring (io_uring_setup), which glibc has no wrapper for.
+int setup(const uint32_t entries, io_uring_params& params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+}
+
+/// Submits entries and waits for completions (io_uring_enter).
+int enter(const int fd, const uint32_t toSubmit, const uint32_t minComplete, const uint32_t flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+/// Registers resources with a ring (io_uring_register).
+int registerRing(const int fd, const uint32_t opcode, const void* arguments, const uint32_t count)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arguments, count));
+}
+
+/// Field of a mapped ring at the given offset.
+uint32_t* ringField(void* mapping, const uint32_t offset)
+{
+    return reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(mapping) + offset);
+}
+
+} // namespace
+
+IoUring::IoUring(const uint32_t entryCount, const uint32_t flags, const uint32_t completionCount)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = flags;
+    if (completionCount > 0)
+    {
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = completionCount;
+    }
+    fd = setup(entryCount, params);
+    if (fd < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "io_uring_setup");
+    }
+
+    submissionMappingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    completionMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMapping)
+    {
+        submissionMappingSize = std::max(submissionMappingSize, completionMappingSize);
+        completionMappingSize = submissionMappingSize;
+    }
+    entriesMappingSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    submissionMapping = mmap(nullptr, submissionMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    completionMapping = submissionMapping;
+    if (submissionMapping != MAP_FAILED && !singleMapping)
+    {
+        completionMapping = mmap(nullptr, completionMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    void* entriesMapping = MAP_FAILED;
+    if (submissionMapping != MAP_FAILED && completionMapping != MAP_FAILED)
+    {
+        entriesMapping = mmap(nullptr, entriesMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    }
+    if (entriesMapping == MAP_FAILED)
+    {
+        const int error = errno;
+        if (completionMapping != MAP_FAILED && completionMapping != submissionMapping)
+        {
+            munmap(completionMapping, completionMappingSize);
+        }
+        if (submissionMapping != MAP_FAILED)
+        {
+            munmap(submissionMapping, submissionMappingSize);
+        }
+        close(fd);
+        throw boost::system::system_error(error, boost::system::system_category(), "mmap");
+    }
+    entries = static_cast<io_uring_sqe*>(entriesMapping);
+
+    submissionHead = ringField(submissionMapping, params.sq_off.head);
+    submissionTail = ringField(submissionMapping, params.sq_off.tail);
+    submissionArray = ringField(submissionMapping, params.sq_off.array);
+    submissionMask = *ringField(submissionMapping, params.sq_off.ring_mask);
+    submissionEntries = *ringField(submissionMapping, params.sq_off.ring_entries);
+    localTail = *submissionTail;
+
+    completionHead = ringField(completionMapping, params.cq_off.head);
+    completionTail = ringField(completionMapping, params.cq_off.tail);
+    completionMask = *ringField(completionMapping, params.cq_off.ring_mask);
+    completions = static_cast<uint8_t*>(completionMapping) + params.cq_off.cqes;
+}
+
+IoUring::~IoUring()
+{
+    munmap(entries, entriesMappingSize);
+    if (completionMapping != submissionMapping)
+    {
+        munmap(completionMapping, completionMappingSize);
+    }
+    munmap(submissionMapping, submissionMappingSize);
+    close(fd);
+}
+
+bool IoUring::isSupported()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    const int probe = setup(1, params);
+    if (probe < 0)
+    {
+        return false;
+    }
+    close(probe);
+    return true;
+}
+
+io_uring_sqe* IoUring::getSubmission()
+{
+    const uint32_t head = __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE);
+    if (localTail - head >= submissionEntries)
+    {
+        return nullptr;
+    }
+    const uint32_t index = localTail & submissionMask;
+    submissionArray[index] = index;
+    localTail++;
+    io_uring_sqe* entry = &entries[index];
+    memset(entry, 0, sizeof(io_uring_sqe));
+    return entry;
+}
+
+uint32_t IoUring::submit(const uint32_t waitCount)
+{
+    // Publish the entries before the kernel reads the tail. The kernel moves the head past
+    // the entries it consumes, so entries that a short submission left behind are counted
+    // again here.
+    __atomic_store_n(submissionTail, localTail, __ATOMIC_RELEASE);
+    const uint32_t toSubmit = localTail - __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE);
+    if (toSubmit == 0 && waitCount == 0)
+    {
+        return 0;
+    }
+    int result;
+    do
+    {
+        result = enter(fd, toSubmit, waitCount, waitCount > 0 ? IORING_ENTER_GETEVENTS : 0);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "io_uring_enter");
+    }
+    return static_cast<uint32_t>(result);
+}
+
+bool IoUring::peekCompletion(IoCompletion& outCompletion)
+{
+    const uint32_t head = *completionHead;
+    if (head == __atomic_load_n(completionTail, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+    const io_uring_cqe& entry = static_cast<const io_uring_cqe*>(completions)[head & completionMask];
+    outCompletion.userData = entry.user_data;
+    outCompletion.result = entry.res;
+    outCompletion.flags = entry.flags;
+    __atomic_store_n(completionHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void IoUring::waitCompletion(IoCompletion& outCompletion)
+{
+    while (!peekCompletion(outCompletion))
+    {
+        submit(1);
+    }
+}
+
+void IoUring::registerBuffers(const std::vector<iovec>& buffers)
+{
+    if (registerRing(fd, IORING_REGISTER_BUFFERS, buffers.data(), static_cast<uint32_t>(buffers.size())) < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "IORING_REGISTER_BUFFERS");
+    }
+}
+
+void IoUring::registerBufferRing(void* bufferRing, const uint32_t entryCount, const uint16_t groupId)
+{
+    io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+    registration.ring_entries = entryCount;
+    registration.bgid = groupId;
+    if (registerRing(fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "IORING_REGISTER_PBUF_RING");
+    }
+}
+
+int IoUring::getDescriptor() const
+{
+    return fd;
+}
+
+} // namespace ss
+} // namespace nts
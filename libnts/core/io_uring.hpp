@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Forward declarations.
+struct io_uring_sqe;
+struct iovec;
+
+namespace nts {
+namespace ss {
+
+/// Result of an operation submitted to an IoUring.
+struct IoCompletion
+{
+    /// Value given to the submission.
+    uint64_t userData{ 0 };
+
+    /// Return value of the operation, or a negated errno value.
+    int32_t result{ 0 };
+
+    /// IORING_CQE_F_* flags of the completion.
+    uint32_t flags{ 0 };
+};
+
+/// Submission and completion queues shared with the kernel (io_uring).
+///
+/// @details Operations are described in submission entries, which are handed to the kernel
+/// in bulk by submit(), so a single system call can start many operations. Results are read
+/// from the completion queue without entering the kernel. The queues are not thread safe,
+/// and are meant to be driven by a single thread.
+///
+/// @example
+/// IoUring ring(64);
+/// io_uring_sqe* entry = ring.getSubmission();
+/// entry->opcode = IORING_OP_WRITE;
+/// ...
+/// ring.submit(1);
+/// IoCompletion completion;
+/// ring.peekCompletion(completion);
+class IoUring
+{
+public:
+    /// Constructor. Creates the queues and maps them into the process.
+    /// @param entryCount Size of the submission queue. Rounded up to a power of two.
+    /// @param flags IORING_SETUP_* flags.
+    /// @param completionCount Size of the completion queue, which is twice the size of the
+    /// submission queue when 0. Rounded up to a power of two.
+    /// @throws boost::system::system_error If the queues cannot be created.
+    explicit IoUring(const uint32_t entryCount, const uint32_t flags = 0, const uint32_t completionCount = 0);
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /// Destructor. Unmaps the queues and closes the ring.
+    ~IoUring();
+
+    /// Whether the kernel supports io_uring and the process is allowed to use it.
+    static bool isSupported();
+
+    /// Next free submission entry, cleared.
+    /// @returns nullptr if every entry is waiting to be submitted.
+    io_uring_sqe* getSubmission();
+
+    /// Hand the prepared submission entries to the kernel, along with the entries that a
+    /// previous call couldn't submit.
+    /// @param waitCount Number of completions to wait for before returning.
+    /// @returns The number of entries submitted.
+    /// @throws boost::system::system_error If the entries cannot be submitted.
+    uint32_t submit(const uint32_t waitCount = 0);
+
+    /// Take the next completion, if there is one.
+    /// @returns Whether a completion was taken.
+    bool peekCompletion(IoCompletion& outCompletion);
+
+    /// Take the next completion, waiting for one if necessary.
+    /// @throws boost::system::system_error If the wait fails.
+    void waitCompletion(IoCompletion& outCompletion);
+
+    /// Register buffers with the kernel, so fixed operations skip mapping them each time.
+    /// @throws boost::system::system_error If the buffers cannot be registered.
+    void registerBuffers(const std::vector<iovec>& buffers);
+
+    /// Register a ring of buffers that receive operations select from (IORING_REGISTER_PBUF_RING).
+    /// @param bufferRing Page aligned memory for entryCount io_uring_buf entries.
+    /// @param entryCount Number of entries. Must be a power of two.
+    /// @param groupId Group that submissions select buffers from (io_uring_sqe::buf_group).
+    /// @throws boost::system::system_error If the ring cannot be registered.
+    void registerBufferRing(void* bufferRing, const uint32_t entryCount, const uint16_t groupId);
+
+    /// Descriptor of the ring.
+    int getDescriptor() const;
+
+private:
+    /// Descriptor of the ring.
+    int fd{ -1 };
+
+    /// Mapping of the submission ring.
+    void* submissionMapping{ nullptr };
+    std::size_t submissionMappingSize{ 0 };
+
+    /// Mapping of the completion ring. Same as the submission ring with IORING_FEAT_SINGLE_MMAP.
+    void* completionMapping{ nullptr };
+    std::size_t completionMappingSize{ 0 };
+
+    /// Mapping of the submission entries.
+    io_uring_sqe* entries{ nullptr };
+    std::size_t entriesMappingSize{ 0 };
+
+    /// Fields of the submission ring.
+    uint32_t* submissionHead{ nullptr };
+    uint32_t* submissionTail{ nullptr };
+    uint32_t* submissionArray{ nullptr };
+    uint32_t submissionMask{ 0 };
+    uint32_t submissionEntries{ 0 };
+
+    /// Tail of the entries prepared but not yet submitted.
+    uint32_t localTail{ 0 };
+
+    /// Fields of the completion ring.
+    uint32_t* completionHead{ nullptr };
+    uint32_t* completionTail{ nullptr };
+    uint32_t completionMask{ 0 };
+    void* completions{ nullptr };
+};
+
+} // namespace ss
+} // namespace nts
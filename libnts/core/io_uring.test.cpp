@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <libnts/core/io_uring.hpp>
+
+namespace nts {
+namespace tests {
+
+TEST(IoUringUnitTests, Nop)
+{
+    if (!ss::IoUring::isSupported())
+    {
+        GTEST_SKIP() << "io_uring is not available";
+    }
+    ss::IoUring ring(4);
+
+    // Every entry can be prepared before the queue is full.
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        io_uring_sqe* entry = ring.getSubmission();
+        ASSERT_NE(entry, nullptr);
+        entry->opcode = IORING_OP_NOP;
+        entry->user_data = i;
+    }
+    EXPECT_EQ(ring.getSubmission(), nullptr);
+    EXPECT_EQ(ring.submit(4), 4u);
+
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        ss::IoCompletion completion;
+        ring.waitCompletion(completion);
+        EXPECT_EQ(completion.userData, i);
+        EXPECT_EQ(completion.result, 0);
+    }
+    ss::IoCompletion completion;
+    EXPECT_FALSE(ring.peekCompletion(completion));
+}
+
+TEST(IoUringUnitTests, FixedWrite)
+{
+    if (!ss::IoUring::isSupported())
+    {
+        GTEST_SKIP() << "io_uring is not available";
+    }
+    const std::string filename = ::testing::TempDir() + "nts_io_uring.bin";
+    const int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+
+    std::vector<uint8_t> buffer{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    ss::IoUring ring(8);
+    ring.registerBuffers({ iovec{ buffer.data(), buffer.size() } });
+
+    io_uring_sqe* entry = ring.getSubmission();
+    ASSERT_NE(entry, nullptr);
+    entry->opcode = IORING_OP_WRITE_FIXED;
+    entry->fd = fd;
+    entry->addr = reinterpret_cast<uint64_t>(buffer.data() + 2);
+    entry->len = 4;
+    entry->off = 0;
+    entry->buf_index = 0;
+    ring.submit();
+
+    ss::IoCompletion completion;
+    ring.waitCompletion(completion);
+    EXPECT_EQ(completion.result, 4);
+
+    std::vector<uint8_t> contents(8, 0);
+    EXPECT_EQ(pread(fd, contents.data(), contents.size(), 0), 4);
+    EXPECT_EQ(std::vector<uint8_t>(contents.begin(), contents.begin() + 4), std::vector<uint8_t>({ 3, 4, 5, 6 }));
+    close(fd);
+    std::remove(filename.c_str());
+}
+
+} // namespace tests
+} // namespace nts
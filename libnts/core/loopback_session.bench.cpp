@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+#include <thread>
+
+#include <libnts/core/loopback_session.hpp>
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/icmp/icmp.hpp>
+#include <libnts/ipv4/ipv4.hpp>
+#include <libnts/messaging/message.hpp>
+#include <libnts/messaging/parser.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// ICMP echo request with a payload.
+Message makeRequest()
+{
+    std::shared_ptr<MessageParser> parser = MessageParser::getInstance();
+    parser->addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet");
+    parser->addProtocol(std::make_shared<ip::Ipv4Parser>(), "ipv4");
+    parser->addProtocol(std::make_shared<icmp::IcmpParser>(), "icmp");
+
+    return Message()
+        .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+        .addDataUnit(std::make_shared<ip::Ipv4DataUnit>(ip::Ipv4DataUnit().setProtocol((uint8_t)ip::IpPayloadProtocols::ICMP)))
+        .addDataUnit(std::make_shared<icmp::IcmpDataUnit>())
+        .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData(std::vector<uint8_t>(56, 0xab))));
+}
+
+} // namespace
+
+/// Frames of the given size sent and received one at a time by the same thread.
+void BM_LoopbackRoundTrip(benchmark::State& state)
+{
+    auto session = ss::LoopbackSession::createEcho(1024);
+    std::vector<uint8_t> frame(state.range(0), 0xab);
+    std::vector<uint8_t> buffer(frame.size());
+    for (auto _ : state)
+    {
+        session->send(frame);
+        benchmark::DoNotOptimize(session->receive(buffer));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+
+BENCHMARK(BM_LoopbackRoundTrip)->Arg(64)->Arg(1500);
+
+/// Batches of 64 byte frames sent and received by the same thread.
+void BM_LoopbackBatch(benchmark::State& state)
+{
+    auto session = ss::LoopbackSession::createEcho(1024);
+    std::vector<std::vector<uint8_t>> frames(state.range(0), std::vector<uint8_t>(64, 0xab));
+    std::vector<std::vector<uint8_t>> buffers(frames.size(), std::vector<uint8_t>(64));
+    for (auto _ : state)
+    {
+        session->sendBatch(frames);
+        benchmark::DoNotOptimize(session->receiveBatch(buffers, buffers.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * frames.size());
+}
+
+BENCHMARK(BM_LoopbackBatch)->Arg(1)->Arg(64);
+
+/// 64 byte frames streamed from a sender thread to the benchmark thread.
+void BM_LoopbackStream(benchmark::State& state)
+{
+    auto sessions = ss::LoopbackSession::createPair(1024);
+    std::thread sender([&sessions]() {
+        std::vector<uint8_t> frame(64, 0xab);
+        while (sessions.first->send(frame) > 0)
+        {
+        }
+    });
+    std::vector<uint8_t> buffer(64);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sessions.second->receive(buffer));
+    }
+    sessions.second->close();
+    sender.join();
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_LoopbackStream)->UseRealTime();
+
+/// Messages serialized into the ring and parsed back, with no network in between.
+void BM_LoopbackMessage(benchmark::State& state)
+{
+    auto session = ss::LoopbackSession::createEcho(1024);
+    Message request = makeRequest();
+    Message reply = Message().setLazy(state.range(0) != 0);
+    for (auto _ : state)
+    {
+        session->send(request);
+        session->receive(reply.clear());
+        benchmark::DoNotOptimize(reply.getDataUnit("icmp"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_LoopbackMessage)->Arg(0)->Arg(1);
+
+} // namespace benchmarks
+} // namespace nts
@@ -0,0 +1,364 @@
+#include <libnts/core/loopback_session.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include <libnts/core/ring_buffer.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Largest frame an object is serialized into, like the buffers of raw sessions.
+constexpr std::size_t maxFrameSize{ 65536 };
+
+/// Size of the buffer of each slot before it has to grow. Fits an Ethernet frame.
+constexpr std::size_t initialFrameSize{ 2048 };
+
+/// Number of times a waiting thread spins before yielding the processor.
+constexpr unsigned spinLimit{ 256 };
+
+/// Number of times a waiting thread yields the processor before it starts sleeping.
+constexpr unsigned yieldLimit{ 64 };
+
+/// Longest sleep between two attempts of a waiting thread.
+constexpr std::chrono::microseconds maxSleep{ 1000 };
+
+/// Slot of a loopback ring.
+struct LoopbackFrame
+{
+    LoopbackFrame()
+        : data(initialFrameSize)
+    {
+    }
+
+    /// Buffer of the frame. Its size is the capacity of the slot.
+    std::vector<uint8_t> data;
+
+    /// Number of bytes of the frame.
+    std::size_t length{ 0 };
+};
+
+/// Hint to the CPU that this is a spin loop.
+inline void relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+/// Waits between attempts, spinning at first, then yielding the processor, and then sleeping
+/// for twice as long each time, up to maxSleep. A thread that waits for long doesn't keep a
+/// core busy, at the cost of noticing the next frame up to maxSleep late.
+class Backoff
+{
+public:
+    void pause()
+    {
+        if (spins < spinLimit)
+        {
+            spins++;
+            relax();
+        }
+        else if (yields < yieldLimit)
+        {
+            yields++;
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(sleep);
+            sleep = std::min(sleep * 2, maxSleep);
+        }
+    }
+
+private:
+    unsigned spins{ 0 };
+    unsigned yields{ 0 };
+    std::chrono::microseconds sleep{ 1 };
+};
+
+/// Serializes an object into a slot, growing its buffer up to maxFrameSize until it fits.
+/// @returns The number of bytes written, or 0 if the object doesn't fit in maxFrameSize.
+inline std::size_t serializeInto(LoopbackFrame& slot, const Serializable& inData)
+{
+    // Slots grow until the object fits, so later laps serialize without allocating.
+    std::size_t bytes = inData.serialize(slot.data.data(), slot.data.size());
+    while (bytes == 0 && slot.data.size() < maxFrameSize)
+    {
+        slot.data.resize(std::min(slot.data.size() * 2, maxFrameSize));
+        bytes = inData.serialize(slot.data.data(), slot.data.size());
+    }
+    slot.length = bytes;
+    return bytes;
+}
+
+/// Copies a frame into a slot, growing its buffer if needed.
+inline void store(LoopbackFrame& slot, const uint8_t* data, const std::size_t length)
+{
+    if (slot.data.size() < length)
+    {
+        slot.data.resize(length);
+    }
+    memcpy(slot.data.data(), data, length);
+    slot.length = length;
+}
+
+/// Copies a frame out of a slot.
+/// @returns The number of bytes copied.
+inline std::size_t load(const LoopbackFrame& slot, std::vector<uint8_t>& outData)
+{
+    const std::size_t length = std::min(slot.length, outData.size());
+    memcpy(outData.data(), slot.data.data(), length);
+    return length;
+}
+
+} // namespace
+
+class LoopbackSession::Channel
+{
+public:
+    Channel(const std::size_t capacity, const LoopbackMode mode)
+    {
+        if (mode == LoopbackMode::SingleProducer)
+        {
+            singleProducer.reset(new SpscRingBuffer<LoopbackFrame>(capacity));
+        }
+        else
+        {
+            multiProducer.reset(new MpmcRingBuffer<LoopbackFrame>(capacity));
+        }
+    }
+
+    template <typename Writer>
+    bool tryPush(Writer&& writer)
+    {
+        return singleProducer ? singleProducer->tryPushInPlace(writer) : multiProducer->tryPushInPlace(writer);
+    }
+
+    /// Only for single producer channels. A slot claimed from an MPMC ring is always published.
+    template <typename Writer>
+    bool tryPushIf(Writer&& writer)
+    {
+        return singleProducer->tryPushInPlaceIf(writer);
+    }
+
+    bool isSingleProducer() const
+    {
+        return singleProducer != nullptr;
+    }
+
+    template <typename Reader>
+    bool tryPop(Reader&& reader)
+    {
+        return singleProducer ? singleProducer->tryPopInPlace(reader) : multiProducer->tryPopInPlace(reader);
+    }
+
+    template <typename Writer>
+    std::size_t pushBatch(Writer&& writer, const std::size_t count)
+    {
+        return singleProducer ? singleProducer->pushBatch(writer, count) : multiProducer->pushBatch(writer, count);
+    }
+
+    template <typename Reader>
+    std::size_t popBatch(Reader&& reader, const std::size_t count)
+    {
+        return singleProducer ? singleProducer->popBatch(reader, count) : multiProducer->popBatch(reader, count);
+    }
+
+    std::size_t size() const
+    {
+        return singleProducer ? singleProducer->size() : multiProducer->size();
+    }
+
+    /// Set when either session of the connection is closed.
+    std::atomic<bool> closed{ false };
+
+private:
+    std::unique_ptr<SpscRingBuffer<LoopbackFrame>> singleProducer;
+    std::unique_ptr<MpmcRingBuffer<LoopbackFrame>> multiProducer;
+};
+
+namespace {
+
+/// Calls attempt() until it succeeds or the channel is closed.
+/// @returns Whether an attempt succeeded.
+template <typename Channel, typename Attempt>
+bool retry(Channel& channel, Attempt&& attempt)
+{
+    Backoff backoff;
+    while (!channel.closed.load(std::memory_order_acquire))
+    {
+        if (attempt())
+        {
+            return true;
+        }
+        backoff.pause();
+    }
+    return false;
+}
+
+/// Calls attempt() until it succeeds, or the channel is closed and drained.
+/// @returns Whether an attempt succeeded.
+template <typename Channel, typename Attempt>
+bool retryUntilDrained(Channel& channel, Attempt&& attempt)
+{
+    // Frames sent before the channel was closed are still received.
+    return retry(channel, attempt) || attempt();
+}
+
+} // namespace
+
+std::pair<std::shared_ptr<LoopbackSession>, std::shared_ptr<LoopbackSession>> LoopbackSession::createPair(const std::size_t capacity, const LoopbackMode mode)
+{
+    auto forward = std::make_shared<Channel>(capacity, mode);
+    auto backward = std::make_shared<Channel>(capacity, mode);
+    return std::make_pair(std::shared_ptr<LoopbackSession>(new LoopbackSession(backward, forward)),
+                          std::shared_ptr<LoopbackSession>(new LoopbackSession(forward, backward)));
+}
+
+std::shared_ptr<LoopbackSession> LoopbackSession::createEcho(const std::size_t capacity, const LoopbackMode mode)
+{
+    auto channel = std::make_shared<Channel>(capacity, mode);
+    return std::shared_ptr<LoopbackSession>(new LoopbackSession(channel, channel));
+}
+
+LoopbackSession::LoopbackSession(std::shared_ptr<Channel> incoming, std::shared_ptr<Channel> outgoing)
+    : incoming(incoming)
+    , outgoing(outgoing)
+{
+}
+
+LoopbackSession::~LoopbackSession()
+{
+    close();
+}
+
+std::size_t LoopbackSession::send(std::vector<uint8_t>& inData)
+{
+    const bool sent = retry(*outgoing, [&]() {
+        return outgoing->tryPush([&inData](LoopbackFrame& slot) { store(slot, inData.data(), inData.size()); });
+    });
+    return sent ? inData.size() : 0;
+}
+
+std::size_t LoopbackSession::send(Serializable& inData)
+{
+    std::size_t bytes = 0;
+    if (outgoing->isSingleProducer())
+    {
+        // Objects that don't fit leave the slot unpublished.
+        bool serialized = true;
+        const bool sent = retry(*outgoing, [&]() {
+            return outgoing->tryPushIf([&inData, &bytes, &serialized](LoopbackFrame& slot) {
+                bytes = serializeInto(slot, inData);
+                serialized = bytes > 0;
+                return serialized;
+            }) || !serialized;
+        });
+        return sent ? bytes : 0;
+    }
+
+    // Other producers may wait for the slot once it is claimed, so the object is serialized
+    // beforehand.
+    static thread_local LoopbackFrame staging;
+    bytes = serializeInto(staging, inData);
+    if (bytes == 0)
+    {
+        return 0;
+    }
+    const bool sent = retry(*outgoing, [&]() {
+        return outgoing->tryPush([bytes](LoopbackFrame& slot) { store(slot, staging.data.data(), bytes); });
+    });
+    return sent ? bytes : 0;
+}
+
+std::size_t LoopbackSession::receive(std::vector<uint8_t>& outData)
+{
+    std::size_t bytes = 0;
+    retryUntilDrained(*incoming, [&]() {
+        return incoming->tryPop([&outData, &bytes](LoopbackFrame& slot) { bytes = load(slot, outData); });
+    });
+    return bytes;
+}
+
+std::size_t LoopbackSession::receive(Serializable& outData)
+{
+    std::size_t bytes = 0;
+    retryUntilDrained(*incoming, [&]() {
+        return incoming->tryPop([&outData, &bytes](LoopbackFrame& slot) {
+            outData.deserialize(slot.data.data(), slot.length);
+            bytes = slot.length;
+        });
+    });
+    return bytes;
+}
+
+std::size_t LoopbackSession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    std::size_t framesSent = 0;
+    retry(*outgoing, [&]() {
+        framesSent += outgoing->pushBatch([&inFrames, framesSent](LoopbackFrame& slot, const std::size_t index) {
+            const std::vector<uint8_t>& frame = inFrames[framesSent + index];
+            store(slot, frame.data(), frame.size());
+        },
+                                          inFrames.size() - framesSent);
+        return framesSent == inFrames.size();
+    });
+    return framesSent;
+}
+
+std::size_t LoopbackSession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    const std::size_t frameCount = std::min(maxFrames, outFrames.size());
+    std::size_t received = 0;
+    retryUntilDrained(*incoming, [&]() {
+        received = incoming->popBatch([&outFrames](LoopbackFrame& slot, const std::size_t index) {
+            outFrames[index].resize(load(slot, outFrames[index]));
+        },
+                                      frameCount);
+        return received > 0;
+    });
+    return received;
+}
+
+bool LoopbackSession::waitForFrames(const std::chrono::milliseconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    Backoff backoff;
+    while (incoming->size() == 0)
+    {
+        if (incoming->closed.load(std::memory_order_acquire) || std::chrono::steady_clock::now() >= deadline)
+        {
+            return incoming->size() > 0;
+        }
+        backoff.pause();
+    }
+    return true;
+}
+
+void LoopbackSession::close()
+{
+    incoming->closed.store(true, std::memory_order_release);
+    outgoing->closed.store(true, std::memory_order_release);
+}
+
+bool LoopbackSession::isClosed() const
+{
+    return incoming->closed.load(std::memory_order_acquire) || outgoing->closed.load(std::memory_order_acquire);
+}
+
+std::size_t LoopbackSession::getPendingFrames() const
+{
+    return incoming->size();
+}
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <libnts/core/session.hpp>
+
+namespace nts {
+namespace ss {
+
+/// Threads that may use each side of a loopback connection.
+enum class LoopbackMode
+{
+    /// One thread sends and one thread receives in each direction (SPSC rings).
+    SingleProducer,
+    /// Any number of threads send and receive in each direction (MPMC rings).
+    MultiProducer,
+};
+
+/// Session that exchanges frames with another session of the same process through memory.
+///
+/// @details Each direction of a connection is a lock-free ring of frame slots. Sending
+/// copies the frame into the next slot of the peer's ring, and receiving copies it out, or
+/// deserializes objects straight from the slot. Slots keep their buffers from one lap of
+/// the ring to the next, so the steady state doesn't allocate. Without a network interface
+/// or privileges, loopback sessions let benchmarks measure serializers and parsers in
+/// isolation, and let protocol tests run deterministically.
+///
+/// Sends wait while the peer's ring is full, and receives wait until a frame arrives. Waiting
+/// threads spin briefly, then yield and then sleep, for up to a millisecond at a time. Once
+/// either side is closed, sends return 0 and receives return 0 after the frames that were
+/// already sent.
+///
+/// @example
+/// auto sessions = LoopbackSession::createPair();
+/// sessions.first->send(request);
+/// sessions.second->receive(message);
+class LoopbackSession : public Session
+{
+public:
+    /// Create two connected sessions. Frames sent by one are received by the other.
+    /// @param capacity Number of frames each direction holds. Rounded up to a power of two.
+    /// @param mode Threads that may use the sessions.
+    static std::pair<std::shared_ptr<LoopbackSession>, std::shared_ptr<LoopbackSession>> createPair(const std::size_t capacity = 1024, const LoopbackMode mode = LoopbackMode::SingleProducer);
+
+    /// Create a session that receives the frames it sends.
+    /// @param capacity Number of frames the session holds. Rounded up to a power of two.
+    /// @param mode Threads that may use the session.
+    static std::shared_ptr<LoopbackSession> createEcho(const std::size_t capacity = 1024, const LoopbackMode mode = LoopbackMode::SingleProducer);
+
+    /// Deconstructor. Closes the session.
+    ~LoopbackSession();
+
+    /// Send data to the peer.
+    /// @returns The number of bytes sent, or 0 if the connection is closed.
+    virtual std::size_t send(std::vector<uint8_t>& inData);
+
+    /// Send object to the peer. In single producer mode, the object is serialized straight
+    /// into the peer's ring.
+    /// @returns The number of bytes sent, or 0 if the connection is closed or the object is
+    /// larger than 64 KiB, in which case nothing is sent.
+    virtual std::size_t send(Serializable& inData);
+
+    /// Receive data from the peer.
+    /// @param outData Must be non-empty (size > 0). Longer frames are truncated.
+    /// @returns The number of bytes received, or 0 if the connection is closed.
+    virtual std::size_t receive(std::vector<uint8_t>& outData);
+
+    /// Receive object from the peer. The object is deserialized straight from the ring.
+    /// @returns The size of the frame, or 0 if the connection is closed.
+    virtual std::size_t receive(Serializable& outData);
+
+    /// Send several frames to the peer, publishing as many as fit at once.
+    /// @returns The number of frames sent, which is only short if the connection is closed.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive the available frames from the peer.
+    /// @details Blocks until at least one frame is received.
+    /// @returns The number of frames received, or 0 if the connection is closed.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Wait until a frame can be received without blocking.
+    /// @returns Whether a frame is available before the timeout expires.
+    virtual bool waitForFrames(const std::chrono::milliseconds timeout);
+
+    /// Close both directions of the connection.
+    virtual void close();
+
+    /// Whether the connection was closed by either side.
+    virtual bool isClosed() const;
+
+    /// Number of frames waiting to be received by this session.
+    virtual std::size_t getPendingFrames() const;
+
+private:
+    /// One direction of a connection.
+    class Channel;
+
+    /// Constructor.
+    LoopbackSession(std::shared_ptr<Channel> incoming, std::shared_ptr<Channel> outgoing);
+
+    /// Frames received by this session.
+    std::shared_ptr<Channel> incoming;
+
+    /// Frames sent by this session.
+    std::shared_ptr<Channel> outgoing;
+};
+
+} // namespace ss
+} // namespace nts
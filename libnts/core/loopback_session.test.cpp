@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <thread>
+
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/core/data_unit.hpp>
+#include <libnts/core/loopback_session.hpp>
+
+namespace nts {
+namespace tests {
+
+TEST(LoopbackSessionUnitTests, SendReceive)
+{
+    auto sessions = ss::LoopbackSession::createPair(4);
+    std::vector<uint8_t> request = { 1, 2, 3, 4, 5 };
+    std::vector<uint8_t> reply = { 9, 8, 7 };
+    ASSERT_EQ(sessions.first->send(request), 5u);
+    ASSERT_EQ(sessions.second->send(reply), 3u);
+    EXPECT_EQ(sessions.first->getPendingFrames(), 1u);
+    EXPECT_EQ(sessions.second->getPendingFrames(), 1u);
+
+    std::vector<uint8_t> buffer(16, 0);
+    ASSERT_EQ(sessions.second->receive(buffer), 5u);
+    EXPECT_EQ(std::vector<uint8_t>(buffer.begin(), buffer.begin() + 5), request);
+    ASSERT_EQ(sessions.first->receive(buffer), 3u);
+    EXPECT_EQ(std::vector<uint8_t>(buffer.begin(), buffer.begin() + 3), reply);
+
+    // Frames larger than a slot make it grow.
+    std::vector<uint8_t> jumbo(9000, 0x5a);
+    ASSERT_EQ(sessions.first->send(jumbo), jumbo.size());
+    std::vector<uint8_t> jumboBuffer(9000, 0);
+    ASSERT_EQ(sessions.second->receive(jumboBuffer), jumbo.size());
+    EXPECT_EQ(jumboBuffer, jumbo);
+}
+
+TEST(LoopbackSessionUnitTests, SendReceiveObject)
+{
+    auto sessions = ss::LoopbackSession::createPair();
+    GenericDataUnit request = GenericDataUnit().setData(std::vector<uint8_t>(4000, 0x33));
+    ASSERT_EQ(sessions.first->send(request), 4000u);
+
+    GenericDataUnit reply;
+    ASSERT_EQ(sessions.second->receive(reply), 4000u);
+    EXPECT_EQ(reply.getData(), request.getData());
+
+    // Objects larger than the largest frame aren't sent, in either mode.
+    GenericDataUnit oversized = GenericDataUnit().setData(std::vector<uint8_t>(70000, 0x44));
+    EXPECT_EQ(sessions.first->send(oversized), 0u);
+    EXPECT_EQ(sessions.second->getPendingFrames(), 0u);
+    ASSERT_EQ(sessions.first->send(request), 4000u);
+    ASSERT_EQ(sessions.second->receive(reply), 4000u);
+
+    auto shared = ss::LoopbackSession::createEcho(4, ss::LoopbackMode::MultiProducer);
+    EXPECT_EQ(shared->send(oversized), 0u);
+    EXPECT_EQ(shared->getPendingFrames(), 0u);
+    ASSERT_EQ(shared->send(request), 4000u);
+    ASSERT_EQ(shared->receive(reply), 4000u);
+    EXPECT_EQ(reply.getData(), request.getData());
+}
+
+TEST(LoopbackSessionUnitTests, Batch)
+{
+    auto sessions = ss::LoopbackSession::createPair(8);
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint8_t i = 0; i < 20; i++)
+    {
+        frames.push_back(std::vector<uint8_t>(60 + i, i));
+    }
+
+    // More frames than the ring holds, so the sender waits for the receiver.
+    std::thread sender([&sessions, &frames]() { EXPECT_EQ(sessions.first->sendBatch(frames), frames.size()); });
+    std::vector<std::vector<uint8_t>> received;
+    std::vector<std::vector<uint8_t>> buffers(6, std::vector<uint8_t>(128));
+    while (received.size() < frames.size())
+    {
+        const std::size_t count = sessions.second->receiveBatch(buffers, buffers.size());
+        ASSERT_GT(count, 0u);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            received.push_back(buffers[i]);
+            buffers[i].resize(128);
+        }
+    }
+    sender.join();
+    EXPECT_EQ(received, frames);
+}
+
+TEST(LoopbackSessionUnitTests, Close)
+{
+    auto sessions = ss::LoopbackSession::createPair(4);
+    std::vector<uint8_t> frame = { 1, 2, 3 };
+    ASSERT_EQ(sessions.first->send(frame), 3u);
+    EXPECT_TRUE(sessions.second->waitForFrames(std::chrono::milliseconds(0)));
+    sessions.first->close();
+    EXPECT_TRUE(sessions.second->isClosed());
+
+    // Frames sent before the close are still received.
+    std::vector<uint8_t> buffer(16, 0);
+    EXPECT_EQ(sessions.second->receive(buffer), 3u);
+    EXPECT_EQ(sessions.second->receive(buffer), 0u);
+    EXPECT_EQ(sessions.second->send(frame), 0u);
+    EXPECT_FALSE(sessions.second->waitForFrames(std::chrono::milliseconds(10)));
+
+    // Closing wakes up a blocked receiver.
+    auto pair = ss::LoopbackSession::createPair(4);
+    std::thread receiver([&pair]() {
+        std::vector<uint8_t> buffer(16, 0);
+        EXPECT_EQ(pair.second->receive(buffer), 0u);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pair.first.reset();
+    receiver.join();
+}
+
+TEST(LoopbackSessionUnitTests, MultiProducer)
+{
+    auto sessions = ss::LoopbackSession::createPair(16, ss::LoopbackMode::MultiProducer);
+    constexpr int threadCount{ 4 };
+    constexpr int frameCount{ 2000 };
+    std::vector<std::thread> senders;
+    for (int t = 0; t < threadCount; t++)
+    {
+        senders.emplace_back([&sessions, t]() {
+            std::vector<uint8_t> frame(64, uint8_t(t));
+            for (int i = 0; i < frameCount; i++)
+            {
+                sessions.first->send(frame);
+            }
+        });
+    }
+
+    std::vector<int> counts(threadCount, 0);
+    std::vector<uint8_t> buffer(64, 0);
+    for (int i = 0; i < threadCount * frameCount; i++)
+    {
+        ASSERT_EQ(sessions.second->receive(buffer), 64u);
+        counts[buffer[0]]++;
+    }
+    for (auto& sender : senders)
+    {
+        sender.join();
+    }
+    EXPECT_EQ(counts, std::vector<int>(threadCount, frameCount));
+}
+
+TEST(LoopbackSessionUnitTests, Create)
+{
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Session.Type"] = "loopback";
+    config->intParams["Session.Loopback.Capacity"] = 8;
+    config->boolParams["Session.Loopback.MultiProducer"] = true;
+    std::shared_ptr<ss::Session> session = ss::Session::create(config);
+    ASSERT_TRUE(std::dynamic_pointer_cast<ss::LoopbackSession>(session));
+
+    // The session receives the frames it sends.
+    std::vector<uint8_t> frame = { 4, 5, 6 };
+    ASSERT_EQ(session->send(frame), 3u);
+    std::vector<uint8_t> buffer(3, 0);
+    ASSERT_EQ(session->receive(buffer), 3u);
+    EXPECT_EQ(buffer, frame);
+}
+
+} // namespace tests
+} // namespace nts
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nts {
+
+namespace detail {
+
+/// Size of a cache line. Indices written by different threads are kept this far apart, so
+/// the threads don't invalidate each other's caches (false sharing).
+constexpr std::size_t cacheLineSize{ 64 };
+
+/// Smallest power of two that is not smaller than the value.
+inline std::size_t roundUpToPowerOfTwo(const std::size_t value)
+{
+    std::size_t power = 1;
+    while (power < value)
+    {
+        power <<= 1;
+    }
+    return power;
+}
+
+} // namespace detail
+
+/// Bounded lock-free queue with a single producer thread and a single consumer thread.
+///
+/// @details Elements live in preallocated slots and are filled and read in place by the
+/// functions passed to the push and pop operations, so elements that own buffers keep them
+/// from one lap of the ring to the next. Each side keeps a cached copy of the other side's
+/// index, and only reads the shared one when the cached copy says the ring is full or
+/// empty. Batch operations publish any number of elements with a single index update.
+///
+/// @example
+/// SpscRingBuffer<Frame> ring(1024);
+/// ring.tryPushInPlace([&](Frame& slot) { slot.assign(data, length); });   // Producer thread.
+/// ring.tryPopInPlace([&](Frame& slot) { process(slot); });                // Consumer thread.
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    /// Constructor.
+    /// @param capacity Number of elements. Rounded up to a power of two.
+    explicit SpscRingBuffer(const std::size_t capacity)
+        : slots(detail::roundUpToPowerOfTwo(capacity))
+        , mask(slots.size() - 1)
+    {
+    }
+
+    /// Number of elements the ring holds.
+    std::size_t capacity() const
+    {
+        return slots.size();
+    }
+
+    /// Number of elements in the ring. Only exact when neither side is active.
+    std::size_t size() const
+    {
+        // The head is read first, so it can't be past the tail.
+        const std::size_t popped = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - popped;
+    }
+
+    /// Whether the ring holds no element. Only exact when neither side is active.
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// Add an element, filled in place by writer(T&).
+    /// @returns Whether there was room for it.
+    template <typename Writer>
+    bool tryPushInPlace(Writer&& writer)
+    {
+        const std::size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == slots.size())
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead == slots.size())
+            {
+                return false;
+            }
+        }
+        writer(slots[position & mask]);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Add an element, filled in place by writer(T&), unless the writer returns false.
+    /// @details The slot is only published when the writer accepts it, so a writer that
+    /// finds out late that it has nothing to add leaves the ring unchanged.
+    /// @returns Whether the element was added. The writer isn't called if the ring is full.
+    template <typename Writer>
+    bool tryPushInPlaceIf(Writer&& writer)
+    {
+        const std::size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == slots.size())
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead == slots.size())
+            {
+                return false;
+            }
+        }
+        if (!writer(slots[position & mask]))
+        {
+            return false;
+        }
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Add a copy of the element.
+    /// @returns Whether there was room for it.
+    bool tryPush(const T& value)
+    {
+        return tryPushInPlace([&value](T& slot) { slot = value; });
+    }
+
+    /// Add up to count elements, filled in place by writer(T&, index).
+    /// @returns The number of elements added.
+    template <typename Writer>
+    std::size_t pushBatch(Writer&& writer, const std::size_t count)
+    {
+        const std::size_t position = tail.load(std::memory_order_relaxed);
+        std::size_t room = slots.size() - (position - cachedHead);
+        if (room < count)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            room = slots.size() - (position - cachedHead);
+        }
+        const std::size_t pushed = room < count ? room : count;
+        for (std::size_t i = 0; i < pushed; i++)
+        {
+            writer(slots[(position + i) & mask], i);
+        }
+        tail.store(position + pushed, std::memory_order_release);
+        return pushed;
+    }
+
+    /// Take the oldest element, which is handed to reader(T&) before its slot is reused.
+    /// @returns Whether there was an element.
+    template <typename Reader>
+    bool tryPopInPlace(Reader&& reader)
+    {
+        const std::size_t position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail)
+            {
+                return false;
+            }
+        }
+        reader(slots[position & mask]);
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Take the oldest element.
+    /// @returns Whether there was an element.
+    bool tryPop(T& outValue)
+    {
+        return tryPopInPlace([&outValue](T& slot) { outValue = slot; });
+    }
+
+    /// Take up to count elements, which are handed to reader(T&, index) in order.
+    /// @returns The number of elements taken.
+    template <typename Reader>
+    std::size_t popBatch(Reader&& reader, const std::size_t count)
+    {
+        const std::size_t position = head.load(std::memory_order_relaxed);
+        std::size_t available = cachedTail - position;
+        if (available < count)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            available = cachedTail - position;
+        }
+        const std::size_t popped = available < count ? available : count;
+        for (std::size_t i = 0; i < popped; i++)
+        {
+            reader(slots[(position + i) & mask], i);
+        }
+        head.store(position + popped, std::memory_order_release);
+        return popped;
+    }
+
+private:
+    /// Slots of the elements.
+    std::vector<T> slots;
+
+    /// Maps positions to slots.
+    const std::size_t mask;
+
+    /// Next position to pop, written by the consumer.
+    std::atomic<std::size_t> head{ 0 };
+
+    /// Consumer's copy of the tail.
+    std::size_t cachedTail{ 0 };
+
+    char headPadding[detail::cacheLineSize - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+
+    /// Next position to push, written by the producer.
+    std::atomic<std::size_t> tail{ 0 };
+
+    /// Producer's copy of the head.
+    std::size_t cachedHead{ 0 };
+
+    char tailPadding[detail::cacheLineSize - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+};
+
+/// Bounded lock-free queue for any number of producer and consumer threads.
+///
+/// @details Each slot carries a sequence number that tells whether it is ready to be
+/// written or read in the current lap of the ring (D. Vyukov's bounded MPMC queue). Threads
+/// claim a position with a compare-and-swap and then fill or read the slot in place, so
+/// contention is limited to the two indices.
+///
+/// @example
+/// MpmcRingBuffer<Frame> ring(1024);
+/// ring.tryPushInPlace([&](Frame& slot) { slot.assign(data, length); });   // Any thread.
+/// ring.tryPopInPlace([&](Frame& slot) { process(slot); });                // Any thread.
+template <typename T>
+class MpmcRingBuffer
+{
+public:
+    /// Constructor.
+    /// @param capacity Number of elements. Rounded up to a power of two, and at least 2.
+    explicit MpmcRingBuffer(const std::size_t capacity)
+        : cells(detail::roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity))
+        , mask(cells.size() - 1)
+    {
+        for (std::size_t i = 0; i < cells.size(); i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Number of elements the ring holds.
+    std::size_t capacity() const
+    {
+        return cells.size();
+    }
+
+    /// Number of elements in the ring. Only exact when no thread is active.
+    std::size_t size() const
+    {
+        const std::size_t pushed = tail.load(std::memory_order_acquire);
+        const std::size_t popped = head.load(std::memory_order_acquire);
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+    /// Whether the ring holds no element. Only exact when no thread is active.
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// Add an element, filled in place by writer(T&).
+    /// @returns Whether there was room for it.
+    template <typename Writer>
+    bool tryPushInPlace(Writer&& writer)
+    {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = cells[position & mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = std::ptrdiff_t(sequence) - std::ptrdiff_t(position);
+            if (difference == 0)
+            {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    writer(cell.value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The slot still holds the element of the previous lap.
+                return false;
+            }
+            else
+            {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Add a copy of the element.
+    /// @returns Whether there was room for it.
+    bool tryPush(const T& value)
+    {
+        return tryPushInPlace([&value](T& slot) { slot = value; });
+    }
+
+    /// Add up to count elements, filled in place by writer(T&, index).
+    /// @returns The number of elements added.
+    template <typename Writer>
+    std::size_t pushBatch(Writer&& writer, const std::size_t count)
+    {
+        std::size_t pushed = 0;
+        while (pushed < count && tryPushInPlace([&writer, pushed](T& slot) { writer(slot, pushed); }))
+        {
+            pushed++;
+        }
+        return pushed;
+    }
+
+    /// Take the oldest element, which is handed to reader(T&) before its slot is reused.
+    /// @returns Whether there was an element.
+    template <typename Reader>
+    bool tryPopInPlace(Reader&& reader)
+    {
+        std::size_t position = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = cells[position & mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = std::ptrdiff_t(sequence) - std::ptrdiff_t(position + 1);
+            if (difference == 0)
+            {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    reader(cell.value);
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The slot is not written yet.
+                return false;
+            }
+            else
+            {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Take the oldest element.
+    /// @returns Whether there was an element.
+    bool tryPop(T& outValue)
+    {
+        return tryPopInPlace([&outValue](T& slot) { outValue = slot; });
+    }
+
+    /// Take up to count elements, which are handed to reader(T&, index) in order.
+    /// @returns The number of elements taken.
+    template <typename Reader>
+    std::size_t popBatch(Reader&& reader, const std::size_t count)
+    {
+        std::size_t popped = 0;
+        while (popped < count && tryPopInPlace([&reader, popped](T& slot) { reader(slot, popped); }))
+        {
+            popped++;
+        }
+        return popped;
+    }
+
+private:
+    /// Slot and the lap it is ready for.
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence{ 0 };
+        T value;
+    };
+
+    /// Slots of the elements.
+    std::vector<Cell> cells;
+
+    /// Maps positions to slots.
+    const std::size_t mask;
+
+    char padding[detail::cacheLineSize];
+
+    /// Next position to pop.
+    std::atomic<std::size_t> head{ 0 };
+
+    char headPadding[detail::cacheLineSize - sizeof(std::atomic<std::size_t>)];
+
+    /// Next position to push.
+    std::atomic<std::size_t> tail{ 0 };
+
+    char tailPadding[detail::cacheLineSize - sizeof(std::atomic<std::size_t>)];
+};
+
+} // namespace nts
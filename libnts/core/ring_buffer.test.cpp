@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <thread>
+
+#include <libnts/core/ring_buffer.hpp>
+
+namespace nts {
+namespace tests {
+
+TEST(RingBufferUnitTests, SpscWrapAround)
+{
+    SpscRingBuffer<uint32_t> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+    EXPECT_TRUE(ring.empty());
+
+    // Several laps, so positions wrap around the slots.
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(ring.tryPush(i));
+        ASSERT_TRUE(ring.tryPush(i + 100));
+        EXPECT_EQ(ring.size(), 2u);
+        ASSERT_TRUE(ring.tryPop(value));
+        EXPECT_EQ(value, i);
+        ASSERT_TRUE(ring.tryPop(value));
+        EXPECT_EQ(value, i + 100);
+    }
+    EXPECT_FALSE(ring.tryPop(value));
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(ring.tryPush(i));
+    }
+    EXPECT_FALSE(ring.tryPush(4));
+    EXPECT_EQ(ring.size(), 4u);
+}
+
+TEST(RingBufferUnitTests, SpscDeclinedPush)
+{
+    SpscRingBuffer<uint32_t> ring(2);
+    EXPECT_FALSE(ring.tryPushInPlaceIf([](uint32_t& slot) {
+        slot = 1;
+        return false;
+    }));
+    EXPECT_TRUE(ring.empty());
+
+    EXPECT_TRUE(ring.tryPushInPlaceIf([](uint32_t& slot) {
+        slot = 2;
+        return true;
+    }));
+    uint32_t value = 0;
+    ASSERT_TRUE(ring.tryPop(value));
+    EXPECT_EQ(value, 2u);
+}
+
+TEST(RingBufferUnitTests, SpscBatch)
+{
+    SpscRingBuffer<uint32_t> ring(8);
+    EXPECT_EQ(ring.pushBatch([](uint32_t& slot, const std::size_t index) { slot = uint32_t(index); }, 6), 6u);
+
+    // Only the free slots are filled.
+    EXPECT_EQ(ring.pushBatch([](uint32_t& slot, const std::size_t index) { slot = uint32_t(index + 6); }, 6), 2u);
+
+    std::vector<uint32_t> values;
+    EXPECT_EQ(ring.popBatch([&values](uint32_t& slot, const std::size_t index) { values.push_back(slot); }, 16), 8u);
+    EXPECT_EQ(values, std::vector<uint32_t>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+    EXPECT_EQ(ring.popBatch([](uint32_t& slot, const std::size_t index) {}, 16), 0u);
+}
+
+TEST(RingBufferUnitTests, SpscThreads)
+{
+    SpscRingBuffer<uint64_t> ring(64);
+    constexpr uint64_t count{ 100000 };
+    std::thread producer([&ring]() {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            while (!ring.tryPush(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // Elements arrive in order.
+    uint64_t expected = 0;
+    uint64_t value;
+    while (expected < count)
+    {
+        if (!ring.tryPop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(value, expected);
+        expected++;
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(RingBufferUnitTests, MpmcThreads)
+{
+    MpmcRingBuffer<uint64_t> ring(16);
+    EXPECT_EQ(ring.capacity(), 16u);
+    constexpr uint64_t count{ 20000 };
+    constexpr int threadCount{ 4 };
+
+    std::atomic<uint64_t> sum{ 0 };
+    std::atomic<uint64_t> popped{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&ring, t]() {
+            for (uint64_t i = 1; i <= count; i++)
+            {
+                while (!ring.tryPush(i + t * count))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&ring, &sum, &popped]() {
+            uint64_t value;
+            while (popped.load() < threadCount * count)
+            {
+                if (!ring.tryPop(value))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                sum += value;
+                popped++;
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Every element is taken exactly once.
+    const uint64_t total = threadCount * count;
+    EXPECT_EQ(popped.load(), total);
+    EXPECT_EQ(sum.load(), total * (total + 1) / 2);
+    EXPECT_TRUE(ring.empty());
+}
+
+} // namespace tests
+} // namespace nts
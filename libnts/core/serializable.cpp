@@ -1,7 +1,32 @@
 #include <libnts/core/serializable.hpp>
 
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
 namespace nts {
 
+std::size_t Serializable::serialize(uint8_t* outBuffer, const std::size_t capacity) const
+{
+    boost::iostreams::stream<boost::iostreams::array_sink> os(reinterpret_cast<char*>(outBuffer), capacity);
+    toStream(os);
+    if (!os)
+    {
+        return 0;
+    }
+    return static_cast<std::size_t>(os.tellp());
+}
+
+std::size_t Serializable::deserialize(const uint8_t* inBuffer, const std::size_t length)
+{
+    boost::iostreams::stream<boost::iostreams::array_source> is(reinterpret_cast<const char*>(inBuffer), length);
+    fromStream(is);
+
+    // Reading past the end leaves the stream without a position.
+    is.clear();
+    const std::streampos position = is.tellg();
+    return position < 0 ? length : static_cast<std::size_t>(position);
+}
+
 std::ostream& operator<<(std::ostream& outStream, const Serializable& other)
 {
     other.toStream(outStream);
@@ -1,7 +1,9 @@
 #pragma once
 
-#include <ostream>
+#include <cstddef>
+#include <cstdint>
 #include <istream>
+#include <ostream>
 
 namespace nts {
 
@@ -13,7 +15,7 @@ public:
     Serializable() = default;
 
     /// Deconstructor.
-    ~Serializable() = default;
+    virtual ~Serializable() = default;
 
     /// Writes the object to the stream.
     virtual void toStream(std::ostream& outStream) const = 0;
@@ -21,6 +23,23 @@ public:
     /// Reads the object from the stream.
     virtual void fromStream(std::istream& inStream) = 0;
 
+    /// Writes the object to the buffer.
+    /// @details The default implementation is an adapter over toStream(). Objects on the hot
+    /// path should override it to write their fields directly.
+    /// @param outBuffer Buffer with room for at least capacity bytes.
+    /// @param capacity Size of the buffer in bytes.
+    /// @returns The number of bytes written, or 0 if the object does not fit.
+    virtual std::size_t serialize(uint8_t* outBuffer, const std::size_t capacity) const;
+
+    /// Reads the object from the buffer.
+    /// @details The default implementation is an adapter over fromStream(). Objects that read
+    /// until the end of the stream can't be told apart from ones that run out of data, so it
+    /// reports the whole buffer as read whenever fromStream() reaches the end.
+    /// @param inBuffer Buffer with at least length bytes.
+    /// @param length Size of the buffer in bytes.
+    /// @returns The number of bytes read. Overrides return 0 if the buffer is too short.
+    virtual std::size_t deserialize(const uint8_t* inBuffer, const std::size_t length);
+
     /// Representation of the object in a console friendly format.
     virtual std::string toString() const = 0;
 
@@ -1,11 +1,39 @@
+#include <algorithm>
+#include <atomic>
+#include <boost/system/system_error.hpp>
 #include <iostream>
+#include <stdexcept>
 
 #include <libnts/core/session.hpp>
+#include <libnts/capture/capture_writer.hpp>
+#include <libnts/capture/pcap_session.hpp>
+#include <libnts/config/configuration.hpp>
+#include <libnts/core/loopback_session.hpp>
+#include <libnts/core/shared_memory_session.hpp>
+#include <libnts/ethernet/io_uring_session.hpp>
 #include <libnts/ethernet/raw_session.hpp>
+#include <libnts/ethernet/ring_session.hpp>
+#include <libnts/ethernet/tap_session.hpp>
+#include <libnts/ethernet/xdp_session.hpp>
 
 namespace nts {
 namespace ss {
 
+namespace {
+
+/// Attaches the capture writer configured under "Session.Capture", if there is one.
+void configureCapture(RawSession& session, std::shared_ptr<Configuration> config)
+{
+    if (auto file = config->getString("Session.Capture.File"))
+    {
+        cap::CaptureWriterOptions options;
+        options.configure(config, "Session.Capture");
+        session.setCaptureWriter(std::make_shared<cap::CaptureWriter>(file.value(), options));
+    }
+}
+
+} // namespace
+
 std::shared_ptr<Session> Session::create()
 {
     std::shared_ptr<RawSession> rawSession = std::make_shared<RawSession>();
@@ -13,5 +41,250 @@ std::shared_ptr<Session> Session::create()
     return session;
 }
 
+std::shared_ptr<Session> Session::create(std::shared_ptr<Configuration> config)
+{
+    const std::string type = config->getString("Session.Type").value_or("raw");
+    const std::string interface = config->getString("Session.Interface").value_or("eth0");
+
+    if (type == "ring")
+    {
+        RingGeometry rxGeometry;
+        rxGeometry.configure(config, "Session.RxRing");
+
+        // The transmit ring is only created when it is configured.
+        RingGeometry txGeometry;
+        txGeometry.blockCount = 0;
+        txGeometry.configure(config, "Session.TxRing");
+
+        auto session = std::make_shared<RingSession>(interface, rxGeometry, txGeometry);
+        if (auto threshold = config->getInt("Session.TxRing.FlushThreshold"))
+        {
+            session->setFlushThreshold(threshold.value());
+        }
+        configureCapture(*session, config);
+        return session;
+    }
+    if (type == "pcap")
+    {
+        auto session = std::make_shared<PcapSession>(config->getString("Session.InputFile").value_or(""),
+                                                     config->getString("Session.OutputFile").value_or(""));
+        const std::string replay = config->getString("Session.Replay").value_or("fast");
+        if (replay == "original")
+        {
+            session->setReplayMode(ReplayMode::OriginalTiming);
+        }
+        else if (replay != "fast")
+        {
+            throw std::invalid_argument("Unknown replay mode: " + replay);
+        }
+        return session;
+    }
+    if (type == "loopback")
+    {
+        const int capacity = config->getInt("Session.Loopback.Capacity").value_or(1024);
+        if (capacity <= 0)
+        {
+            throw std::invalid_argument("Loopback capacity must be positive");
+        }
+        const bool multiProducer = config->getBool("Session.Loopback.MultiProducer").value_or(false);
+        return LoopbackSession::createEcho(capacity, multiProducer ? LoopbackMode::MultiProducer : LoopbackMode::SingleProducer);
+    }
+    if (type == "uring")
+    {
+        IoUringOptions options;
+        options.configure(config, "Session.IoUring");
+        auto session = std::make_shared<IoUringSession>(interface, options);
+        configureCapture(*session, config);
+        return session;
+    }
+    if (type == "xdp")
+    {
+        XdpOptions options;
+        options.configure(config, "Session.Xdp");
+        return std::make_shared<XdpSession>(interface, options);
+    }
+    if (type == "tap")
+    {
+        // The kernel names the device when no interface is configured.
+        return std::make_shared<TapSession>(config->getString("Session.Interface").value_or(""));
+    }
+    if (type == "shm")
+    {
+        const auto name = config->getString("Session.SharedMemory.Name");
+        if (!name)
+        {
+            throw std::invalid_argument("Shared memory sessions need a segment name");
+        }
+        if (config->getBool("Session.SharedMemory.Create").value_or(false))
+        {
+            SharedMemoryOptions options;
+            options.configure(config, "Session.SharedMemory");
+            return SharedMemorySession::create(name.value(), options);
+        }
+        return SharedMemorySession::open(name.value());
+    }
+    if (type == "raw")
+    {
+        auto session = std::make_shared<RawSession>(interface);
+        configureCapture(*session, config);
+        return session;
+    }
+    throw std::invalid_argument("Unknown session type: " + type);
+}
+
+std::size_t Session::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    std::size_t frameCount = 0;
+    for (auto& frame : inFrames)
+    {
+        try
+        {
+            if (send(frame) < frame.size())
+            {
+                break;
+            }
+        }
+        catch (const boost::system::system_error& error)
+        {
+            // Frames that were already sent are reported rather than lost.
+            if (frameCount == 0)
+            {
+                throw;
+            }
+            break;
+        }
+        frameCount++;
+    }
+    return frameCount;
+}
+
+std::size_t Session::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    const std::size_t frameCount = std::min(maxFrames, outFrames.size());
+    for (std::size_t i = 0; i < frameCount; i++)
+    {
+        outFrames[i].resize(receive(outFrames[i]));
+    }
+    return frameCount;
+}
+
+void Session::asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler)
+{
+    try
+    {
+        const std::size_t bytes = send(inData);
+        handler(boost::system::error_code(), bytes);
+    }
+    catch (const boost::system::system_error& error)
+    {
+        handler(error.code(), 0);
+    }
+}
+
+void Session::asyncSend(Serializable& inData, CompletionHandler handler)
+{
+    try
+    {
+        const std::size_t bytes = send(inData);
+        handler(boost::system::error_code(), bytes);
+    }
+    catch (const boost::system::system_error& error)
+    {
+        handler(error.code(), 0);
+    }
+}
+
+void Session::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler)
+{
+    try
+    {
+        const std::size_t bytes = receive(outData);
+        handler(boost::system::error_code(), bytes);
+    }
+    catch (const boost::system::system_error& error)
+    {
+        handler(error.code(), 0);
+    }
+}
+
+void Session::asyncReceive(Serializable& outData, CompletionHandler handler)
+{
+    try
+    {
+        const std::size_t bytes = receive(outData);
+        handler(boost::system::error_code(), bytes);
+    }
+    catch (const boost::system::system_error& error)
+    {
+        handler(error.code(), 0);
+    }
+}
+
+void Session::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    // Operations that already completed must not cancel the others.
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    asyncReceive(outData, [done, handler](const boost::system::error_code& error, std::size_t bytes) {
+        *done = true;
+        handler(error, bytes);
+    });
+    slot->assign([this, done]() {
+        if (!*done)
+        {
+            cancel();
+        }
+    });
+}
+
+void Session::asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    // Operations that already completed must not cancel the others.
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    asyncReceive(outData, [done, handler](const boost::system::error_code& error, std::size_t bytes) {
+        *done = true;
+        handler(error, bytes);
+    });
+    slot->assign([this, done]() {
+        if (!*done)
+        {
+            cancel();
+        }
+    });
+}
+
+void Session::cancel()
+{
+}
+
+void CancellationSlot::assign(std::function<void()> canceller)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (emitted)
+    {
+        lock.unlock();
+        canceller();
+        return;
+    }
+    this->canceller = canceller;
+}
+
+void CancellationSlot::emit()
+{
+    std::function<void()> cancelOperation;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (emitted)
+        {
+            return;
+        }
+        emitted = true;
+        cancelOperation = std::move(canceller);
+    }
+    if (cancelOperation)
+    {
+        cancelOperation();
+    }
+}
+
 } // namespace ss
 } // namespace nts
@@ -1,29 +1,93 @@
 #pragma once
 
+#include <boost/system/error_code.hpp>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <libnts/core/serializable.hpp>
 
 namespace nts {
+
+// Forward declaration.
+class Configuration;
+
 namespace ss {
 
 /// Maximum transmission unit size.
 constexpr uint16_t MTU_SIZE{ 1500 };
 
+/// Cancels a single asynchronous operation, leaving the other operations of the session alone.
+///
+/// @details The session attaches a canceller to the slot when the operation starts. Emitting
+/// the slot calls it, and the handler of the operation is then called with
+/// boost::asio::error::operation_aborted unless the operation already completed. A slot that
+/// is emitted before the canceller is attached cancels the operation as soon as it starts.
+/// Thread-safe.
+///
+/// @example
+/// auto slot = std::make_shared<CancellationSlot>();
+/// session.asyncReceive(reply, handler, slot);
+/// slot->emit(); // Only this receive is aborted.
+class CancellationSlot
+{
+public:
+    /// Attach the function that cancels the operation.
+    void assign(std::function<void()> canceller);
+
+    /// Cancel the operation, if it is still outstanding.
+    void emit();
+
+private:
+    /// Protects the canceller.
+    std::mutex mutex;
+
+    /// Cancels the operation.
+    std::function<void()> canceller;
+
+    /// Whether the slot was emitted.
+    bool emitted{ false };
+};
+
 /// Send and receive data from the network.
 class Session
 {
 public:
+    /// Called with the result of an asynchronous operation.
+    typedef std::function<void(const boost::system::error_code& error, std::size_t bytes)> CompletionHandler;
+
     /// Constructor.
     Session() = default;
 
     /// Deconstructor.
-    ~Session() = default;
+    virtual ~Session() = default;
 
     /// Create a session object to communicate with the network.
     static std::shared_ptr<Session> create();
 
+    /// Create a session object with the type and settings from the Configuration object.
+    /// @details The "Session.Type" parameter selects the implementation ("raw", "ring",
+    /// "uring", "xdp", "tap", "pcap", "loopback" or "shm") and "Session.Interface" the network
+    /// interface to bind to, or the TAP device to create. Raw, ring and AF_XDP sessions also
+    /// bind to either end of a veth pair.
+    ///
+    /// Ring sessions read the layout of their rings from "Session.RxRing" and
+    /// "Session.TxRing", io_uring sessions their queues from "Session.IoUring", and AF_XDP
+    /// sessions their UMEM and rings from "Session.Xdp". Raw, ring and io_uring sessions record
+    /// the frames they receive when "Session.Capture.File" is set, with the writer options
+    /// under "Session.Capture".
+    ///
+    /// Pcap sessions replay "Session.InputFile", record to "Session.OutputFile", and pace
+    /// frames by "Session.Replay" ("fast" or "original"). Loopback sessions receive the frames
+    /// they send, through a ring of "Session.Loopback.Capacity" frames that
+    /// "Session.Loopback.MultiProducer" makes safe for several threads. Shared memory sessions
+    /// create the segment named by "Session.SharedMemory.Name" when
+    /// "Session.SharedMemory.Create" is set, with the layout under "Session.SharedMemory", and
+    /// open it otherwise.
+    /// @throws std::invalid_argument If the type or one of the settings is invalid.
+    static std::shared_ptr<Session> create(std::shared_ptr<Configuration> config);
+
     /// Send data to the network.
     virtual std::size_t send(std::vector<uint8_t>& inData) = 0;
 
@@ -36,6 +100,63 @@ public:
 
     /// Receive object from the network.
     virtual std::size_t receive(Serializable& outData) = 0;
+
+    /// Send several frames to the network.
+    /// @details The default implementation sends one frame at a time, and stops at the first
+    /// frame that is not sent whole. Sessions that can amortize system calls over several frames
+    /// should override it.
+    /// @returns The number of frames sent.
+    /// @throws boost::system::system_error If the first frame cannot be sent.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive several frames from the network.
+    /// @details Blocks until at least one frame is received. The default implementation
+    /// receives one frame at a time until maxFrames are received.
+    /// @param outFrames Every frame must be non-empty (size > 0). Received frames are resized
+    /// to their length.
+    /// @param maxFrames Maximum number of frames to receive, limited by the size of outFrames.
+    /// @returns The number of frames received.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Start sending data to the network.
+    /// @details The default implementation sends the data synchronously and calls the handler
+    /// before returning. Sessions with an event loop should override it.
+    /// @param inData Must remain valid until the handler is called.
+    /// @param handler Called once the operation completes.
+    virtual void asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler);
+
+    /// Start sending an object to the network.
+    /// @param inData Only used before the function returns.
+    /// @param handler Called once the operation completes.
+    virtual void asyncSend(Serializable& inData, CompletionHandler handler);
+
+    /// Start receiving data from the network.
+    /// @param outData Must be non-empty (size > 0), and remain valid until the handler is called.
+    /// @param handler Called once the operation completes.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler);
+
+    /// Start receiving an object from the network.
+    /// @param outData Must remain valid until the handler is called.
+    /// @param handler Called once the operation completes.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler);
+
+    /// Start receiving data from the network, with a slot that cancels only this operation.
+    /// @details The default implementation attaches cancel() to the slot, so it aborts every
+    /// outstanding operation of the session. Sessions with an event loop should override it.
+    /// @param outData Must be non-empty (size > 0), and remain valid until the handler is called.
+    /// @param handler Called once the operation completes.
+    /// @param slot Cancels the operation when it is emitted.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Start receiving an object from the network, with a slot that cancels only this operation.
+    /// @param outData Must remain valid until the handler is called.
+    /// @param handler Called once the operation completes.
+    /// @param slot Cancels the operation when it is emitted.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Cancel all outstanding asynchronous operations.
+    /// @details Their handlers are called with boost::asio::error::operation_aborted.
+    virtual void cancel();
 };
 
 } // namespace ss
@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <gtest/gtest.h>
 
 #include <libnts/core/data_unit.hpp>
@@ -6,6 +7,44 @@
 namespace nts {
 namespace tests {
 
+/// Session that keeps sent frames in memory and plays them back when receiving.
+class EchoSession : public ss::Session
+{
+public:
+    virtual std::size_t send(std::vector<uint8_t>& inData)
+    {
+        if (frames.size() >= capacity)
+        {
+            return 0;
+        }
+        frames.push_back(inData);
+        return inData.size();
+    }
+
+    virtual std::size_t send(Serializable& inData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t receive(std::vector<uint8_t>& outData)
+    {
+        const std::vector<uint8_t> frame = frames.front();
+        frames.erase(frames.begin());
+        std::copy(frame.begin(), frame.end(), outData.begin());
+        return frame.size();
+    }
+
+    virtual std::size_t receive(Serializable& outData)
+    {
+        return 0;
+    }
+
+    std::vector<std::vector<uint8_t>> frames;
+
+    /// Number of frames that can be kept before sends fail.
+    std::size_t capacity{ SIZE_MAX };
+};
+
 /// Ping Request to "www.google.com". Must be updated manually.
 /// @todo Dynamically create the ping request.
 std::vector<uint8_t> pingRequest = { { 0x00, 0x15, 0x5d, 0xf6, 0x7c, 0x15, 0x00, 0x15, 0x5d, 0x3a, 0xe2, 0x9b, 0x08, 0x00, 0x45, 0x00, 0x54, 0x55, 0xc3, 0x40, 0x00, 0x40, 0x01, 0x3a, 0xc4, 0xac, 0x1c, 0x4e, 0x46, 0xd8, 0x3a, 0xd7, 0x84, 0x08, 0x00, 0xa7, 0x07, 0x14, 0xdc, 0x00, 0x01, 0xf1, 0xcd, 0x41, 0x63, 0x00, 0x00, 0x00, 0x00, 0x3b, 0x17, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37 } };
@@ -65,6 +104,69 @@ TEST(DISABLED_SessionUnitTests, SendSerializable)
     ASSERT_EQ(sendSize, pingRequestUnit.getData().size());
 }
 
+TEST(SessionUnitTests, DefaultBatch)
+{
+    EchoSession session;
+
+    // Send a batch of frames of different sizes.
+    std::vector<std::vector<uint8_t>> batch{ { 1, 2, 3 }, { 4, 5 }, { 6 } };
+    ASSERT_EQ(session.sendBatch(batch), 3);
+    ASSERT_EQ(session.frames.size(), 3);
+
+    // Receive at most two of them.
+    std::vector<std::vector<uint8_t>> frames(4, std::vector<uint8_t>(ss::MTU_SIZE, 0));
+    ASSERT_EQ(session.receiveBatch(frames, 2), 2);
+    EXPECT_EQ(frames[0], batch[0]);
+    EXPECT_EQ(frames[1], batch[1]);
+    EXPECT_EQ(frames[2].size(), ss::MTU_SIZE);
+
+    // Stop at the first frame that is not sent.
+    session.capacity = 2;
+    ASSERT_EQ(session.sendBatch(batch), 1);
+    ASSERT_EQ(session.frames.size(), 2);
+}
+
+TEST(SessionUnitTests, DefaultAsync)
+{
+    EchoSession session;
+
+    // The default implementation completes before returning.
+    std::vector<uint8_t> request{ 1, 2, 3 };
+    std::size_t bytesSent = 0;
+    session.asyncSend(request, [&bytesSent](const boost::system::error_code& error, std::size_t bytes) {
+        ASSERT_FALSE(error);
+        bytesSent = bytes;
+    });
+    ASSERT_EQ(bytesSent, request.size());
+
+    std::vector<uint8_t> reply(ss::MTU_SIZE, 0);
+    std::size_t bytesReceived = 0;
+    session.asyncReceive(reply, [&bytesReceived](const boost::system::error_code& error, std::size_t bytes) {
+        ASSERT_FALSE(error);
+        bytesReceived = bytes;
+    });
+    ASSERT_EQ(bytesReceived, request.size());
+    EXPECT_EQ(reply[2], 3);
+}
+
+TEST(DISABLED_SessionUnitTests, SendBatch)
+{
+    // Create a session to send ping requests.
+    std::shared_ptr<ss::Session> session = ss::Session::create();
+    ASSERT_TRUE(session);
+
+    // Send several requests at once.
+    std::vector<std::vector<uint8_t>> requests(32, pingRequest);
+    const std::size_t framesSent = session->sendBatch(requests);
+    ASSERT_EQ(framesSent, requests.size());
+
+    // Receive the replies.
+    std::vector<std::vector<uint8_t>> replies(64, std::vector<uint8_t>(ss::MTU_SIZE, 0));
+    const std::size_t framesReceived = session->receiveBatch(replies, replies.size());
+    std::cout << "Frames received: " << framesReceived << std::endl;
+    ASSERT_GT(framesReceived, 0);
+}
+
 TEST(DISABLED_SessionUnitTests, ReceiveSerializable)
 {
     // Create a session to send ping request.
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include <libnts/core/shared_memory_session.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+/// 64 byte frames streamed from a sender thread to the benchmark thread. The argument is
+/// the number of frames per batch, or 0 to send and receive one frame at a time.
+void BM_SharedMemoryStream(benchmark::State& state)
+{
+    auto receiver = ss::SharedMemorySession::create("");
+    auto sender = ss::SharedMemorySession::attach(receiver->getDescriptor());
+    const std::size_t batchSize = state.range(0);
+    std::thread thread([&sender, batchSize]() {
+        std::vector<std::vector<uint8_t>> frames(batchSize == 0 ? 1 : batchSize, std::vector<uint8_t>(64, 0xab));
+        while ((batchSize == 0 ? sender->send(frames[0]) : sender->sendBatch(frames)) > 0)
+        {
+        }
+    });
+
+    std::vector<std::vector<uint8_t>> buffers(batchSize == 0 ? 1 : batchSize, std::vector<uint8_t>(64));
+    std::size_t frames = 0;
+    for (auto _ : state)
+    {
+        frames += batchSize == 0 ? (receiver->receive(buffers[0]) > 0 ? 1 : 0) : receiver->receiveBatch(buffers, buffers.size());
+        for (auto& buffer : buffers)
+        {
+            buffer.resize(64);
+        }
+    }
+    receiver->close();
+    thread.join();
+    state.SetItemsProcessed(frames);
+}
+
+BENCHMARK(BM_SharedMemoryStream)->Arg(0)->Arg(64)->UseRealTime();
+
+/// 64 byte frames streamed from a child process to the benchmark process.
+void BM_SharedMemoryProcesses(benchmark::State& state)
+{
+    auto receiver = ss::SharedMemorySession::create("");
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        {
+            auto sender = ss::SharedMemorySession::attach(receiver->getDescriptor());
+            std::vector<std::vector<uint8_t>> frames(64, std::vector<uint8_t>(64, 0xab));
+            while (sender->sendBatch(frames) > 0)
+            {
+            }
+        }
+        _exit(0);
+    }
+
+    std::vector<std::vector<uint8_t>> buffers(64, std::vector<uint8_t>(64));
+    std::size_t frames = 0;
+    for (auto _ : state)
+    {
+        frames += receiver->receiveBatch(buffers, buffers.size());
+        for (auto& buffer : buffers)
+        {
+            buffer.resize(64);
+        }
+    }
+    receiver->close();
+    waitpid(child, nullptr, 0);
+    state.SetItemsProcessed(frames);
+}
+
+BENCHMARK(BM_SharedMemoryProcesses)->UseRealTime();
+
+} // namespace benchmarks
+} // namespace nts
@@ -0,0 +1,536 @@
+#include <libnts/core/shared_memory_session.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <boost/system/system_error.hpp>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <libnts/config/configuration.hpp>
+#include <libnts/core/ring_buffer.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Identifies a segment created by this class ("NTSS").
+constexpr uint32_t segmentMagic{ 0x4e545353 };
+
+/// Version of the segment layout.
+constexpr uint32_t segmentVersion{ 1 };
+
+/// Offset of the first slot. The header and the ring indices fit before it.
+constexpr std::size_t slotsOffset{ 4096 };
+
+/// Bytes before the data of each slot, which hold the length of the frame.
+constexpr std::size_t slotHeaderSize{ 8 };
+
+/// Number of times a waiting side spins before it sleeps.
+constexpr unsigned spinLimit{ 2048 };
+
+/// Longest sleep before a waiting side checks on the connection again.
+constexpr std::chrono::milliseconds maxSleep{ 100 };
+
+/// Hint to the CPU that this is a spin loop.
+inline void relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+/// Sleep while the word holds the expected value, for at most the timeout.
+void futexWait(std::atomic<uint32_t>& word, const uint32_t expected, const std::chrono::nanoseconds timeout)
+{
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex words must be plain 32 bit integers");
+    const timespec time{ time_t(timeout.count() / 1000000000), long(timeout.count() % 1000000000) };
+    // The segment is shared between processes, so the futex can't be process private.
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &time, nullptr, 0);
+}
+
+/// Wake up the side sleeping on the word, if there is one.
+void wake(std::atomic<uint32_t>& sleeping)
+{
+    // Clearing the flag before waking makes a side that is about to sleep return at once.
+    if (sleeping.load(std::memory_order_relaxed) != 0 && sleeping.exchange(0) != 0)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sleeping), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+}
+
+/// Waits until ready() returns true, spinning at first and then sleeping on the futex.
+/// @returns Whether ready() returned true before the deadline, or before the connection
+/// was closed.
+template <typename Ready>
+bool waitUntil(Ready&& ready, std::atomic<uint32_t>& sleeping, const std::atomic<uint32_t>& closed, const std::chrono::steady_clock::time_point deadline)
+{
+    for (unsigned spins = 0; spins < spinLimit; spins++)
+    {
+        if (ready())
+        {
+            return true;
+        }
+        if (closed.load(std::memory_order_acquire))
+        {
+            return ready();
+        }
+        relax();
+    }
+    for (;;)
+    {
+        if (ready())
+        {
+            return true;
+        }
+        if (closed.load(std::memory_order_acquire))
+        {
+            return ready();
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+
+        // The other side checks the flag after publishing, so either it sees the flag or
+        // this side sees its update (the fences order both pairs of accesses).
+        sleeping.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready() && !closed.load(std::memory_order_acquire))
+        {
+            futexWait(sleeping, 1, std::min<std::chrono::nanoseconds>(deadline - now, maxSleep));
+        }
+        sleeping.store(0, std::memory_order_relaxed);
+    }
+}
+
+/// Size of the segment for the layout.
+std::size_t getSegmentSize(const std::size_t slotCount, const std::size_t slotStride)
+{
+    return slotsOffset + 2 * slotCount * slotStride;
+}
+
+/// Distance between slots of the given size, rounded up to whole cache lines.
+std::size_t getSlotStride(const std::size_t slotSize)
+{
+    return (slotHeaderSize + slotSize + detail::cacheLineSize - 1) / detail::cacheLineSize * detail::cacheLineSize;
+}
+
+/// Copies a frame into a slot.
+inline void storeFrame(uint8_t* slot, const uint8_t* data, const std::size_t length)
+{
+    const uint32_t frameLength = length;
+    memcpy(slot, &frameLength, sizeof(frameLength));
+    memcpy(slot + slotHeaderSize, data, length);
+}
+
+/// Length of the frame in a slot.
+/// @details The peer writes the length, so it is clamped to the size of the slot: a corrupt
+/// length can't make the reader leave the slot.
+inline std::size_t loadLength(const uint8_t* slot, const std::size_t slotSize)
+{
+    uint32_t frameLength;
+    memcpy(&frameLength, slot, sizeof(frameLength));
+    return std::min<std::size_t>(frameLength, slotSize);
+}
+
+} // namespace
+
+struct SharedMemorySession::SegmentHeader
+{
+    /// Written last by the creator, once the rest of the segment is ready.
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+
+    /// Set when either side closes the connection.
+    std::atomic<uint32_t> closed;
+
+    /// Set when the other side attaches.
+    std::atomic<uint32_t> attached;
+};
+
+struct SharedMemorySession::RingControl
+{
+    /// Next position to receive, written by the receiving side.
+    std::atomic<uint64_t> head;
+
+    /// Set while the sending side sleeps, waiting for room.
+    std::atomic<uint32_t> producerSleeping;
+
+    char headPadding[detail::cacheLineSize - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<uint32_t>)];
+
+    /// Next position to send, written by the sending side.
+    std::atomic<uint64_t> tail;
+
+    /// Set while the receiving side sleeps, waiting for frames.
+    std::atomic<uint32_t> consumerSleeping;
+
+    char tailPadding[detail::cacheLineSize - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<uint32_t>)];
+};
+
+SharedMemoryOptions& SharedMemoryOptions::configure(std::shared_ptr<Configuration> config, const std::string& key)
+{
+    if (auto count = config->getInt(key + ".SlotCount"))
+    {
+        slotCount = count.value();
+    }
+    if (auto size = config->getInt(key + ".SlotSize"))
+    {
+        slotSize = size.value();
+    }
+    return *this;
+}
+
+std::shared_ptr<SharedMemorySession> SharedMemorySession::create(const std::string& name, const SharedMemoryOptions& options)
+{
+    if (options.slotCount == 0 || options.slotCount > (1u << 30) || options.slotSize == 0 || options.slotSize > UINT32_MAX - slotHeaderSize)
+    {
+        throw std::invalid_argument("Invalid shared memory layout");
+    }
+
+    const int descriptor = name.empty() ? memfd_create("nts", MFD_CLOEXEC) : shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (descriptor < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), name.empty() ? "memfd_create" : "shm_open");
+    }
+    return std::shared_ptr<SharedMemorySession>(new SharedMemorySession(descriptor, name, true, options));
+}
+
+std::shared_ptr<SharedMemorySession> SharedMemorySession::open(const std::string& name)
+{
+    const int descriptor = shm_open(name.c_str(), O_RDWR, 0);
+    if (descriptor < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "shm_open");
+    }
+    return std::shared_ptr<SharedMemorySession>(new SharedMemorySession(descriptor, name, false, SharedMemoryOptions()));
+}
+
+std::shared_ptr<SharedMemorySession> SharedMemorySession::attach(const int descriptor)
+{
+    const int duplicate = fcntl(descriptor, F_DUPFD_CLOEXEC, 0);
+    if (duplicate < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "fcntl");
+    }
+    return std::shared_ptr<SharedMemorySession>(new SharedMemorySession(duplicate, "", false, SharedMemoryOptions()));
+}
+
+SharedMemorySession::SharedMemorySession(const int descriptor, const std::string& name, const bool creator, const SharedMemoryOptions& options)
+    : descriptor(descriptor)
+    , name(name)
+    , creator(creator)
+    , slotCount(detail::roundUpToPowerOfTwo(options.slotCount))
+    , slotSize(options.slotSize)
+    , slotStride(getSlotStride(options.slotSize))
+{
+    try
+    {
+        if (creator)
+        {
+            segmentSize = getSegmentSize(slotCount, slotStride);
+            if (ftruncate(descriptor, segmentSize) < 0)
+            {
+                throw boost::system::system_error(errno, boost::system::system_category(), "ftruncate");
+            }
+        }
+        else
+        {
+            struct stat status;
+            if (fstat(descriptor, &status) < 0)
+            {
+                throw boost::system::system_error(errno, boost::system::system_category(), "fstat");
+            }
+            segmentSize = status.st_size;
+            if (segmentSize < slotsOffset)
+            {
+                throw std::invalid_argument("Not a shared memory session segment");
+            }
+        }
+
+        void* mapping = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, 0);
+        if (mapping == MAP_FAILED)
+        {
+            throw boost::system::system_error(errno, boost::system::system_category(), "mmap");
+        }
+        segment = static_cast<uint8_t*>(mapping);
+        header = reinterpret_cast<SegmentHeader*>(segment);
+
+        if (creator)
+        {
+            // The file starts out zeroed, so the indices and flags are already cleared.
+            header->version = segmentVersion;
+            header->slotCount = slotCount;
+            header->slotSize = slotSize;
+            header->magic.store(segmentMagic, std::memory_order_release);
+        }
+        else
+        {
+            if (header->magic.load(std::memory_order_acquire) != segmentMagic || header->version != segmentVersion)
+            {
+                throw std::invalid_argument("Not a shared memory session segment");
+            }
+            slotCount = header->slotCount;
+            slotSize = header->slotSize;
+            slotStride = getSlotStride(slotSize);
+            if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || getSegmentSize(slotCount, slotStride) > segmentSize)
+            {
+                throw std::invalid_argument("Corrupted shared memory session segment");
+            }
+            if (header->attached.exchange(1) != 0)
+            {
+                throw std::logic_error("Shared memory segment already has a peer");
+            }
+        }
+    }
+    catch (...)
+    {
+        if (segment)
+        {
+            munmap(segment, segmentSize);
+        }
+        ::close(descriptor);
+        if (creator && !name.empty())
+        {
+            shm_unlink(name.c_str());
+        }
+        throw;
+    }
+
+    // The creator sends on the first ring and receives on the second.
+    static_assert(sizeof(SegmentHeader) <= detail::cacheLineSize, "The header must fit in a cache line");
+    static_assert(detail::cacheLineSize + 2 * sizeof(RingControl) <= slotsOffset, "The indices must fit before the slots");
+    RingControl* controls = reinterpret_cast<RingControl*>(segment + detail::cacheLineSize);
+    uint8_t* firstSlots = segment + slotsOffset;
+    uint8_t* secondSlots = firstSlots + slotCount * slotStride;
+    outgoing.control = creator ? &controls[0] : &controls[1];
+    outgoing.slots = creator ? firstSlots : secondSlots;
+    incoming.control = creator ? &controls[1] : &controls[0];
+    incoming.slots = creator ? secondSlots : firstSlots;
+    outgoing.cachedIndex = outgoing.control->head.load(std::memory_order_acquire);
+    incoming.cachedIndex = incoming.control->tail.load(std::memory_order_acquire);
+}
+
+SharedMemorySession::~SharedMemorySession()
+{
+    close();
+    munmap(segment, segmentSize);
+    ::close(descriptor);
+    if (creator && !name.empty())
+    {
+        shm_unlink(name.c_str());
+    }
+}
+
+std::size_t SharedMemorySession::send(std::vector<uint8_t>& inData)
+{
+    if (inData.size() > slotSize)
+    {
+        throw std::invalid_argument("Frame is larger than a shared memory slot");
+    }
+    const auto ready = [this]() { return getRoom() > 0; };
+    if (isClosed() || !waitUntil(ready, outgoing.control->producerSleeping, header->closed, std::chrono::steady_clock::time_point::max()))
+    {
+        return 0;
+    }
+    const uint64_t tail = outgoing.control->tail.load(std::memory_order_relaxed);
+    storeFrame(getSlot(outgoing, tail), inData.data(), inData.size());
+    publish(tail + 1);
+    return inData.size();
+}
+
+std::size_t SharedMemorySession::send(Serializable& inData)
+{
+    const auto ready = [this]() { return getRoom() > 0; };
+    if (isClosed() || !waitUntil(ready, outgoing.control->producerSleeping, header->closed, std::chrono::steady_clock::time_point::max()))
+    {
+        return 0;
+    }
+    const uint64_t tail = outgoing.control->tail.load(std::memory_order_relaxed);
+    uint8_t* slot = getSlot(outgoing, tail);
+    const std::size_t bytes = inData.serialize(slot + slotHeaderSize, slotSize);
+    if (bytes == 0)
+    {
+        return 0;
+    }
+    const uint32_t frameLength = bytes;
+    memcpy(slot, &frameLength, sizeof(frameLength));
+    publish(tail + 1);
+    return bytes;
+}
+
+std::size_t SharedMemorySession::receive(std::vector<uint8_t>& outData)
+{
+    const auto ready = [this]() { return getAvailable() > 0; };
+    if (!waitUntil(ready, incoming.control->consumerSleeping, header->closed, std::chrono::steady_clock::time_point::max()))
+    {
+        return 0;
+    }
+    const uint64_t head = incoming.control->head.load(std::memory_order_relaxed);
+    const uint8_t* slot = getSlot(incoming, head);
+    const std::size_t bytes = std::min(loadLength(slot, slotSize), outData.size());
+    memcpy(outData.data(), slot + slotHeaderSize, bytes);
+    release(head + 1);
+    return bytes;
+}
+
+std::size_t SharedMemorySession::receive(Serializable& outData)
+{
+    const auto ready = [this]() { return getAvailable() > 0; };
+    if (!waitUntil(ready, incoming.control->consumerSleeping, header->closed, std::chrono::steady_clock::time_point::max()))
+    {
+        return 0;
+    }
+    const uint64_t head = incoming.control->head.load(std::memory_order_relaxed);
+    const uint8_t* slot = getSlot(incoming, head);
+    const std::size_t length = loadLength(slot, slotSize);
+    outData.deserialize(slot + slotHeaderSize, length);
+    release(head + 1);
+    return length;
+}
+
+std::size_t SharedMemorySession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    for (const auto& frame : inFrames)
+    {
+        if (frame.size() > slotSize)
+        {
+            throw std::invalid_argument("Frame is larger than a shared memory slot");
+        }
+    }
+
+    const auto ready = [this]() { return getRoom() > 0; };
+    std::size_t framesSent = 0;
+    while (framesSent < inFrames.size())
+    {
+        if (isClosed() || !waitUntil(ready, outgoing.control->producerSleeping, header->closed, std::chrono::steady_clock::time_point::max()))
+        {
+            break;
+        }
+        const std::size_t count = std::min(getRoom(), inFrames.size() - framesSent);
+        const uint64_t tail = outgoing.control->tail.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const std::vector<uint8_t>& frame = inFrames[framesSent + i];
+            storeFrame(getSlot(outgoing, tail + i), frame.data(), frame.size());
+        }
+        publish(tail + count);
+        framesSent += count;
+    }
+    return framesSent;
+}
+
+std::size_t SharedMemorySession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    const auto ready = [this]() { return getAvailable() > 0; };
+    if (!waitUntil(ready, incoming.control->consumerSleeping, header->closed, std::chrono::steady_clock::time_point::max()))
+    {
+        return 0;
+    }
+    const std::size_t count = std::min(getAvailable(), std::min(maxFrames, outFrames.size()));
+    const uint64_t head = incoming.control->head.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const uint8_t* slot = getSlot(incoming, head + i);
+        std::vector<uint8_t>& frame = outFrames[i];
+        frame.resize(std::min(loadLength(slot, slotSize), frame.size()));
+        memcpy(frame.data(), slot + slotHeaderSize, frame.size());
+    }
+    release(head + count);
+    return count;
+}
+
+bool SharedMemorySession::waitForFrames(const std::chrono::milliseconds timeout)
+{
+    const auto ready = [this]() { return getAvailable() > 0; };
+    return waitUntil(ready, incoming.control->consumerSleeping, header->closed, std::chrono::steady_clock::now() + timeout);
+}
+
+void SharedMemorySession::close()
+{
+    header->closed.store(1, std::memory_order_seq_cst);
+    wake(incoming.control->producerSleeping);
+    wake(incoming.control->consumerSleeping);
+    wake(outgoing.control->producerSleeping);
+    wake(outgoing.control->consumerSleeping);
+}
+
+bool SharedMemorySession::isClosed() const
+{
+    return header->closed.load(std::memory_order_acquire) != 0;
+}
+
+std::size_t SharedMemorySession::getPendingFrames() const
+{
+    const uint64_t head = incoming.control->head.load(std::memory_order_acquire);
+    return incoming.control->tail.load(std::memory_order_acquire) - head;
+}
+
+SharedMemoryOptions SharedMemorySession::getOptions() const
+{
+    SharedMemoryOptions options;
+    options.slotCount = slotCount;
+    options.slotSize = slotSize;
+    return options;
+}
+
+int SharedMemorySession::getDescriptor() const
+{
+    return descriptor;
+}
+
+std::size_t SharedMemorySession::getRoom()
+{
+    const uint64_t tail = outgoing.control->tail.load(std::memory_order_relaxed);
+    if (tail - outgoing.cachedIndex == slotCount)
+    {
+        outgoing.cachedIndex = outgoing.control->head.load(std::memory_order_acquire);
+    }
+    return slotCount - (tail - outgoing.cachedIndex);
+}
+
+std::size_t SharedMemorySession::getAvailable()
+{
+    const uint64_t head = incoming.control->head.load(std::memory_order_relaxed);
+    if (incoming.cachedIndex == head)
+    {
+        incoming.cachedIndex = incoming.control->tail.load(std::memory_order_acquire);
+    }
+    return incoming.cachedIndex - head;
+}
+
+uint8_t* SharedMemorySession::getSlot(const Direction& direction, const uint64_t position) const
+{
+    return direction.slots + (position & (slotCount - 1)) * slotStride;
+}
+
+void SharedMemorySession::publish(const uint64_t tail)
+{
+    outgoing.control->tail.store(tail, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wake(outgoing.control->consumerSleeping);
+}
+
+void SharedMemorySession::release(const uint64_t head)
+{
+    incoming.control->head.store(head, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wake(incoming.control->producerSleeping);
+}
+
+} // namespace ss
+} // namespace nts
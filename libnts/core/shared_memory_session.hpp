@@ -0,0 +1,198 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libnts/core/session.hpp>
+
+namespace nts {
+
+// Forward declarations.
+class Configuration;
+
+namespace ss {
+
+/// Layout of a shared memory segment.
+struct SharedMemoryOptions
+{
+    /// Number of frames each direction holds. Rounded up to a power of two.
+    std::size_t slotCount{ 4096 };
+
+    /// Largest frame in bytes.
+    std::size_t slotSize{ 2048 };
+
+    /// Configure the options with the parameters under the given key.
+    /// @example
+    /// options.configure(config, "Session.SharedMemory"); // Reads "Session.SharedMemory.SlotCount", etc.
+    SharedMemoryOptions& configure(std::shared_ptr<Configuration> config, const std::string& key);
+};
+
+/// Session that exchanges frames with another process through shared memory.
+///
+/// @details The segment holds a ring of fixed size frame slots for each direction, with the
+/// indices of each ring on their own cache lines. Sending copies the frame, or serializes the
+/// object, into the next slot and publishes it with a single store, so a connection carries
+/// frames without system calls while both sides are busy. A side that has to wait spins for
+/// a while and then sleeps on a futex in the segment, which the other side only wakes when
+/// it sees the sleeper's flag.
+///
+/// One process creates the segment, either named (shm_open) or anonymous (memfd_create), and
+/// one other process opens it by name or attaches to an inherited descriptor. Each side must
+/// be used by a single thread at a time. Frames are the same bytes a network session carries.
+///
+/// Sends wait while the peer's ring is full, and receives wait until a frame arrives. Once
+/// either side is closed, sends return 0 and receives return 0 after the frames that were
+/// already sent.
+///
+/// @example
+/// auto generator = SharedMemorySession::create("/nts-test");    // Generator process.
+/// auto checker = SharedMemorySession::open("/nts-test");        // Checker process.
+class SharedMemorySession : public Session
+{
+public:
+    /// Create a segment and the session on its creating side.
+    /// @param name Name of the segment, like "/nts-test". Anonymous (memfd) if empty.
+    /// @param options Layout of the segment.
+    static std::shared_ptr<SharedMemorySession> create(const std::string& name, const SharedMemoryOptions& options = SharedMemoryOptions());
+
+    /// Open a named segment and create the session on its other side.
+    static std::shared_ptr<SharedMemorySession> open(const std::string& name);
+
+    /// Attach to the segment of the descriptor, as the other side. The descriptor is
+    /// duplicated, so it can be closed afterwards.
+    /// @example
+    /// auto parent = SharedMemorySession::create("");
+    /// if (fork() == 0)
+    /// {
+    ///     auto child = SharedMemorySession::attach(parent->getDescriptor());
+    ///     ...
+    /// }
+    static std::shared_ptr<SharedMemorySession> attach(const int descriptor);
+
+    /// Deconstructor. Closes the session, and removes the name of a segment it created.
+    ~SharedMemorySession();
+
+    /// Send data to the peer.
+    /// @throws std::invalid_argument If the frame is larger than a slot.
+    /// @returns The number of bytes sent, or 0 if the connection is closed.
+    virtual std::size_t send(std::vector<uint8_t>& inData);
+
+    /// Send object to the peer. The object is serialized straight into the peer's ring.
+    /// @returns The number of bytes sent, or 0 if the connection is closed or the object
+    /// does not fit in a slot.
+    virtual std::size_t send(Serializable& inData);
+
+    /// Receive data from the peer.
+    /// @param outData Must be non-empty (size > 0). Longer frames are truncated.
+    /// @returns The number of bytes received, or 0 if the connection is closed.
+    virtual std::size_t receive(std::vector<uint8_t>& outData);
+
+    /// Receive object from the peer. The object is deserialized straight from the ring.
+    /// @returns The size of the frame, or 0 if the connection is closed.
+    virtual std::size_t receive(Serializable& outData);
+
+    /// Send several frames to the peer, publishing as many as fit at once.
+    /// @throws std::invalid_argument If a frame is larger than a slot.
+    /// @returns The number of frames sent, which is only short if the connection is closed.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive the available frames from the peer.
+    /// @details Blocks until at least one frame is received.
+    /// @returns The number of frames received, or 0 if the connection is closed.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Wait until a frame can be received without blocking.
+    /// @returns Whether a frame is available before the timeout expires.
+    virtual bool waitForFrames(const std::chrono::milliseconds timeout);
+
+    /// Close both directions of the connection.
+    virtual void close();
+
+    /// Whether the connection was closed by either side.
+    virtual bool isClosed() const;
+
+    /// Number of frames waiting to be received by this session.
+    virtual std::size_t getPendingFrames() const;
+
+    /// Layout of the segment.
+    virtual SharedMemoryOptions getOptions() const;
+
+    /// Descriptor of the segment, which other processes can attach to.
+    virtual int getDescriptor() const;
+
+private:
+    /// Header at the start of the segment.
+    struct SegmentHeader;
+
+    /// Shared indices of one direction.
+    struct RingControl;
+
+    /// One direction, as seen by this side.
+    struct Direction
+    {
+        /// Indices in the segment.
+        RingControl* control{ nullptr };
+
+        /// First slot of the ring.
+        uint8_t* slots{ nullptr };
+
+        /// Copy of the index written by the other side.
+        uint64_t cachedIndex{ 0 };
+    };
+
+    /// Constructor. Maps the segment of the descriptor, which the session takes ownership of.
+    SharedMemorySession(const int descriptor, const std::string& name, const bool creator, const SharedMemoryOptions& options);
+
+    /// Number of slots the peer's ring has room for.
+    std::size_t getRoom();
+
+    /// Number of frames waiting to be received.
+    std::size_t getAvailable();
+
+    /// Slot at the position of the direction.
+    uint8_t* getSlot(const Direction& direction, const uint64_t position) const;
+
+    /// Make frames visible to the peer, waking it up if it sleeps.
+    void publish(const uint64_t tail);
+
+    /// Free received slots, waking the peer up if it waits for room.
+    void release(const uint64_t head);
+
+    /// Segment descriptor.
+    int descriptor;
+
+    /// Name of the segment, empty if anonymous.
+    std::string name;
+
+    /// Whether this side created the segment.
+    bool creator;
+
+    /// Mapping of the segment.
+    uint8_t* segment{ nullptr };
+
+    /// Size of the mapping in bytes.
+    std::size_t segmentSize{ 0 };
+
+    /// Header of the segment.
+    SegmentHeader* header{ nullptr };
+
+    /// Frames received by this side.
+    Direction incoming;
+
+    /// Frames sent by this side.
+    Direction outgoing;
+
+    /// Number of slots of each ring.
+    std::size_t slotCount;
+
+    /// Largest frame in bytes.
+    std::size_t slotSize;
+
+    /// Distance between slots in bytes.
+    std::size_t slotStride;
+};
+
+} // namespace ss
+} // namespace nts
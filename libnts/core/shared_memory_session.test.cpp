@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cstring>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/core/data_unit.hpp>
+#include <libnts/core/shared_memory_session.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Name of a segment that is unique to the test process.
+std::string segmentName(const std::string& name)
+{
+    return "/nts_test_" + name + "_" + std::to_string(getpid());
+}
+
+} // namespace
+
+TEST(SharedMemorySessionUnitTests, SendReceive)
+{
+    ss::SharedMemoryOptions options;
+    options.slotCount = 3;
+    options.slotSize = 100;
+    auto creator = ss::SharedMemorySession::create(segmentName("send_receive"), options);
+    auto peer = ss::SharedMemorySession::open(segmentName("send_receive"));
+    EXPECT_EQ(peer->getOptions().slotCount, 4u);
+    EXPECT_EQ(peer->getOptions().slotSize, 100u);
+
+    std::vector<uint8_t> request = { 1, 2, 3, 4, 5 };
+    std::vector<uint8_t> reply = { 9, 8, 7 };
+    ASSERT_EQ(creator->send(request), 5u);
+    ASSERT_EQ(peer->send(reply), 3u);
+    EXPECT_EQ(peer->getPendingFrames(), 1u);
+
+    std::vector<uint8_t> buffer(16, 0);
+    ASSERT_EQ(peer->receive(buffer), 5u);
+    EXPECT_EQ(std::vector<uint8_t>(buffer.begin(), buffer.begin() + 5), request);
+    ASSERT_EQ(creator->receive(buffer), 3u);
+    EXPECT_EQ(std::vector<uint8_t>(buffer.begin(), buffer.begin() + 3), reply);
+
+    GenericDataUnit object = GenericDataUnit().setData(std::vector<uint8_t>(100, 0x33));
+    ASSERT_EQ(creator->send(object), 100u);
+    GenericDataUnit received;
+    ASSERT_EQ(peer->receive(received), 100u);
+    EXPECT_EQ(received.getData(), object.getData());
+
+    // Frames must fit in a slot.
+    std::vector<uint8_t> jumbo(101, 0);
+    EXPECT_THROW(creator->send(jumbo), std::invalid_argument);
+    GenericDataUnit large = GenericDataUnit().setData(jumbo);
+    EXPECT_EQ(creator->send(large), 0u);
+
+    // A segment has a single peer.
+    EXPECT_THROW(ss::SharedMemorySession::open(segmentName("send_receive")), std::logic_error);
+}
+
+TEST(SharedMemorySessionUnitTests, CorruptLength)
+{
+    ss::SharedMemoryOptions options;
+    options.slotCount = 4;
+    options.slotSize = 100;
+    auto creator = ss::SharedMemorySession::create(segmentName("corrupt_length"), options);
+    auto peer = ss::SharedMemorySession::open(segmentName("corrupt_length"));
+
+    // Maps the segment like a hostile peer would.
+    const int descriptor = shm_open(segmentName("corrupt_length").c_str(), O_RDWR, 0);
+    ASSERT_GE(descriptor, 0);
+    struct stat status;
+    ASSERT_EQ(fstat(descriptor, &status), 0);
+    void* mapping = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    ASSERT_NE(mapping, MAP_FAILED);
+    uint8_t* segment = static_cast<uint8_t*>(mapping);
+
+    std::vector<uint8_t> frame(100);
+    for (std::size_t i = 0; i < frame.size(); i++)
+    {
+        frame[i] = uint8_t(i * 7 + 13);
+    }
+    const auto corruptLength = [&]() {
+        // The length of a frame sits in the slot header, right before the frame.
+        uint8_t* data = std::search(segment, segment + status.st_size, frame.begin(), frame.end());
+        ASSERT_NE(data, segment + status.st_size);
+        const uint32_t length = UINT32_MAX;
+        memcpy(data - 8, &length, sizeof(length));
+        std::fill(data, data + frame.size(), 0);
+    };
+
+    // Lengths past the slot are clamped to the slot.
+    ASSERT_EQ(creator->send(frame), 100u);
+    corruptLength();
+    std::vector<uint8_t> buffer(1000, 0);
+    EXPECT_EQ(peer->receive(buffer), 100u);
+
+    ASSERT_EQ(creator->send(frame), 100u);
+    corruptLength();
+    GenericDataUnit object;
+    EXPECT_EQ(peer->receive(object), 100u);
+    EXPECT_EQ(object.getData().size(), 100u);
+
+    ASSERT_EQ(creator->send(frame), 100u);
+    corruptLength();
+    std::vector<std::vector<uint8_t>> frames(1, std::vector<uint8_t>(1000));
+    EXPECT_EQ(peer->receiveBatch(frames, 1), 1u);
+    EXPECT_EQ(frames[0].size(), 100u);
+    munmap(mapping, status.st_size);
+}
+
+TEST(SharedMemorySessionUnitTests, Batch)
+{
+    ss::SharedMemoryOptions options;
+    options.slotCount = 8;
+    auto creator = ss::SharedMemorySession::create("", options);
+    auto peer = ss::SharedMemorySession::attach(creator->getDescriptor());
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint8_t i = 0; i < 50; i++)
+    {
+        frames.push_back(std::vector<uint8_t>(60 + i, i));
+    }
+
+    // More frames than the ring holds, so the sender waits for the receiver.
+    std::thread sender([&creator, &frames]() { EXPECT_EQ(creator->sendBatch(frames), frames.size()); });
+    std::vector<std::vector<uint8_t>> received;
+    std::vector<std::vector<uint8_t>> buffers(6, std::vector<uint8_t>(128));
+    while (received.size() < frames.size())
+    {
+        const std::size_t count = peer->receiveBatch(buffers, buffers.size());
+        ASSERT_GT(count, 0u);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            received.push_back(buffers[i]);
+            buffers[i].resize(128);
+        }
+    }
+    sender.join();
+    EXPECT_EQ(received, frames);
+}
+
+TEST(SharedMemorySessionUnitTests, Close)
+{
+    auto creator = ss::SharedMemorySession::create("");
+    auto peer = ss::SharedMemorySession::attach(creator->getDescriptor());
+    std::vector<uint8_t> frame = { 1, 2, 3 };
+    EXPECT_FALSE(peer->waitForFrames(std::chrono::milliseconds(10)));
+    ASSERT_EQ(creator->send(frame), 3u);
+    EXPECT_TRUE(peer->waitForFrames(std::chrono::milliseconds(0)));
+    creator->close();
+    EXPECT_TRUE(peer->isClosed());
+
+    // Frames sent before the close are still received.
+    std::vector<uint8_t> buffer(16, 0);
+    EXPECT_EQ(peer->receive(buffer), 3u);
+    EXPECT_EQ(peer->receive(buffer), 0u);
+    EXPECT_EQ(peer->send(frame), 0u);
+
+    // Closing wakes up a receiver that sleeps on the futex.
+    auto sleeper = ss::SharedMemorySession::create("");
+    auto waker = ss::SharedMemorySession::attach(sleeper->getDescriptor());
+    std::thread receiver([&sleeper]() {
+        std::vector<uint8_t> buffer(16, 0);
+        EXPECT_EQ(sleeper->receive(buffer), 0u);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    waker.reset();
+    receiver.join();
+
+    EXPECT_THROW(ss::SharedMemorySession::open(segmentName("missing")), boost::system::system_error);
+}
+
+TEST(SharedMemorySessionUnitTests, Processes)
+{
+    // The child sends numbered frames, which the parent receives in order.
+    const std::string name = segmentName("processes");
+    ss::SharedMemoryOptions options;
+    options.slotCount = 64;
+    auto creator = ss::SharedMemorySession::create(name, options);
+    constexpr uint32_t frameCount{ 100000 };
+    const pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        int status = 1;
+        {
+            auto peer = ss::SharedMemorySession::open(name);
+            std::vector<uint8_t> frame(64, 0);
+            for (uint32_t i = 0; i < frameCount; i++)
+            {
+                memcpy(frame.data(), &i, sizeof(i));
+                peer->send(frame);
+            }
+            // Wait for the parent to take the last frame before closing the connection.
+            std::vector<uint8_t> done(1, 0);
+            status = peer->receive(done) == 1 ? 0 : 1;
+        }
+        _exit(status);
+    }
+
+    std::vector<uint8_t> buffer(64, 0);
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        ASSERT_EQ(creator->receive(buffer), 64u);
+        uint32_t index;
+        memcpy(&index, buffer.data(), sizeof(index));
+        ASSERT_EQ(index, i);
+    }
+    std::vector<uint8_t> done(1, 1);
+    ASSERT_EQ(creator->send(done), 1u);
+
+    int status;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_TRUE(creator->isClosed());
+}
+
+TEST(SharedMemorySessionUnitTests, Create)
+{
+    const std::string name = segmentName("create");
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Session.Type"] = "shm";
+    config->stringParams["Session.SharedMemory.Name"] = name;
+    config->boolParams["Session.SharedMemory.Create"] = true;
+    config->intParams["Session.SharedMemory.SlotCount"] = 16;
+    config->intParams["Session.SharedMemory.SlotSize"] = 512;
+    std::shared_ptr<ss::Session> creator = ss::Session::create(config);
+    auto session = std::dynamic_pointer_cast<ss::SharedMemorySession>(creator);
+    ASSERT_TRUE(session);
+    EXPECT_EQ(session->getOptions().slotCount, 16u);
+    EXPECT_EQ(session->getOptions().slotSize, 512u);
+
+    config->boolParams["Session.SharedMemory.Create"] = false;
+    std::shared_ptr<ss::Session> peer = ss::Session::create(config);
+    std::vector<uint8_t> frame = { 4, 5, 6 };
+    ASSERT_EQ(peer->send(frame), 3u);
+    std::vector<uint8_t> buffer(3, 0);
+    ASSERT_EQ(creator->receive(buffer), 3u);
+    EXPECT_EQ(buffer, frame);
+
+    config->stringParams.erase("Session.SharedMemory.Name");
+    EXPECT_THROW(ss::Session::create(config), std::invalid_argument);
+}
+
+} // namespace tests
+} // namespace nts
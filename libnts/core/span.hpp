@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace nts {
+
+/// Non-owning view of a contiguous sequence of objects.
+///
+/// @details Stands in for std::span, which is not available before C++20. The view is only
+/// valid for as long as the sequence it refers to is not resized or destroyed.
+///
+/// @example
+/// for (const VlanTag& tag : frame.getVlanTags())
+/// {
+///     ...
+/// }
+template <typename T>
+class Span
+{
+public:
+    typedef T element_type;
+    typedef T* iterator;
+
+    /// Constructor. Creates an empty view.
+    constexpr Span() = default;
+
+    /// Constructor.
+    /// @param data First object of the sequence.
+    /// @param size Number of objects in the sequence.
+    constexpr Span(T* data, const std::size_t size)
+        : pointer(data)
+        , count(size)
+    {
+    }
+
+    /// Constructor. Views the whole array.
+    template <std::size_t N>
+    constexpr Span(std::array<T, N>& array)
+        : pointer(array.data())
+        , count(N)
+    {
+    }
+
+    /// Constructor. Views the whole array.
+    template <typename U, std::size_t N>
+    constexpr Span(const std::array<U, N>& array)
+        : pointer(array.data())
+        , count(N)
+    {
+    }
+
+    /// First object of the sequence.
+    constexpr T* data() const
+    {
+        return pointer;
+    }
+
+    /// Number of objects in the sequence.
+    constexpr std::size_t size() const
+    {
+        return count;
+    }
+
+    /// Whether the sequence has no objects.
+    constexpr bool empty() const
+    {
+        return count == 0;
+    }
+
+    /// Object at the given position. Not bounds checked.
+    constexpr T& operator[](const std::size_t index) const
+    {
+        return pointer[index];
+    }
+
+    constexpr iterator begin() const
+    {
+        return pointer;
+    }
+
+    constexpr iterator end() const
+    {
+        return pointer + count;
+    }
+
+private:
+    /// First object of the sequence.
+    T* pointer{ nullptr };
+
+    /// Number of objects in the sequence.
+    std::size_t count{ 0 };
+};
+
+} // namespace nts
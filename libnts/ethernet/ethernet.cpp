@@ -1,7 +1,7 @@
 #include <libnts/ethernet/ethernet.hpp>
 
 #include <algorithm>
-#include <netinet/ether.h>
+#include <cstring>
 #include <sstream>
 
 #include <libnts/config/configuration.hpp>
@@ -19,8 +19,9 @@ VlanTag& VlanTag::configure(std::shared_ptr<nts::Configuration> config)
 
 void VlanTag::toStream(std::ostream& outStream) const
 {
-    outStream.write(reinterpret_cast<const char*>(&protocolIdentifier), 2);
-    outStream.write(reinterpret_cast<const char*>(&controlInformation), 2);
+    uint8_t buffer[4];
+    serialize(buffer, sizeof(buffer));
+    outStream.write(reinterpret_cast<const char*>(buffer), sizeof(buffer));
 }
 
 void VlanTag::fromStream(std::istream& inStream)
@@ -28,6 +29,27 @@ void VlanTag::fromStream(std::istream& inStream)
     inStream.read(reinterpret_cast<char*>(&controlInformation), 2);
 }
 
+std::size_t VlanTag::serialize(uint8_t* outBuffer, const std::size_t capacity) const
+{
+    if (capacity < 4)
+    {
+        return 0;
+    }
+    memcpy(outBuffer + 0, &protocolIdentifier, 2);
+    memcpy(outBuffer + 2, &controlInformation, 2);
+    return 4;
+}
+
+std::size_t VlanTag::deserialize(const uint8_t* inBuffer, const std::size_t length)
+{
+    if (length < 2)
+    {
+        return 0;
+    }
+    memcpy(&controlInformation, inBuffer, 2);
+    return 2;
+}
+
 std::string VlanTag::toString() const
 {
     std::stringstream stream;
@@ -103,8 +125,7 @@ VlanTag& VlanTag::setVID(const uint16_t vid)
 
 EthernetDataUnit::EthernetDataUnit()
 {
-    setDestinationAddress("0:0:0:0:0:0");
-    setSourceAddress("0:0:0:0:0:0");
+    // The addresses are already zeroed by their initializers.
 }
 
 EthernetDataUnit& EthernetDataUnit::configure(std::shared_ptr<nts::Configuration> config)
@@ -122,20 +143,27 @@ EthernetDataUnit& EthernetDataUnit::configure(std::shared_ptr<nts::Configuration
 
 void EthernetDataUnit::toStream(std::ostream& outStream) const
 {
-    outStream.write(reinterpret_cast<const char*>(&destinationAddress[0]), 6);
-    outStream.write(reinterpret_cast<const char*>(&sourceAddress[0]), 6);
-    for (const VlanTag& tag : vlanTags)
+    // Frames rarely carry more than a few tags, so the header usually fits on the stack.
+    uint8_t stackBuffer[64];
+    std::vector<uint8_t> heapBuffer;
+    uint8_t* buffer = stackBuffer;
+
+    const std::size_t size = getUnitSize();
+    if (size > sizeof(stackBuffer))
     {
-        tag.toStream(outStream);
+        heapBuffer.resize(size);
+        buffer = heapBuffer.data();
     }
-    outStream.write(reinterpret_cast<const char*>(&etherTypeOrLength), 2);
+    serialize(buffer, size);
+    outStream.write(reinterpret_cast<const char*>(buffer), size);
 }
 
 void EthernetDataUnit::fromStream(std::istream& inStream)
 {
-    inStream.read(reinterpret_cast<char*>(&destinationAddress[0]), 6);
-    inStream.read(reinterpret_cast<char*>(&sourceAddress[0]), 6);
+    inStream.read(reinterpret_cast<char*>(destinationAddress.data()), 6);
+    inStream.read(reinterpret_cast<char*>(sourceAddress.data()), 6);
     inStream.read(reinterpret_cast<char*>(&etherTypeOrLength), 2);
+    vlanTags.clear();
     while (getEtherType() == (uint16_t)EtherType::VLAN)
     {
         VlanTag tag;
@@ -145,6 +173,59 @@ void EthernetDataUnit::fromStream(std::istream& inStream)
     }
 }
 
+std::size_t EthernetDataUnit::serialize(uint8_t* outBuffer, const std::size_t capacity) const
+{
+    const std::size_t size = getUnitSize();
+    if (capacity < size)
+    {
+        return 0;
+    }
+
+    std::size_t offset = 0;
+    memcpy(outBuffer + offset, destinationAddress.data(), 6);
+    offset += 6;
+    memcpy(outBuffer + offset, sourceAddress.data(), 6);
+    offset += 6;
+    for (const VlanTag& tag : vlanTags)
+    {
+        offset += tag.serialize(outBuffer + offset, capacity - offset);
+    }
+    memcpy(outBuffer + offset, &etherTypeOrLength, 2);
+    return size;
+}
+
+std::size_t EthernetDataUnit::deserialize(const uint8_t* inBuffer, const std::size_t length)
+{
+    if (length < 14)
+    {
+        return 0;
+    }
+
+    std::size_t offset = 0;
+    memcpy(destinationAddress.data(), inBuffer + offset, 6);
+    offset += 6;
+    memcpy(sourceAddress.data(), inBuffer + offset, 6);
+    offset += 6;
+    memcpy(&etherTypeOrLength, inBuffer + offset, 2);
+    offset += 2;
+
+    vlanTags.clear();
+    while (getEtherType() == (uint16_t)EtherType::VLAN)
+    {
+        // Each tag is followed by the next EtherType.
+        if (length - offset < 4)
+        {
+            return 0;
+        }
+        VlanTag tag;
+        offset += tag.deserialize(inBuffer + offset, length - offset);
+        addVlanTag(tag);
+        memcpy(&etherTypeOrLength, inBuffer + offset, 2);
+        offset += 2;
+    }
+    return offset;
+}
+
 std::string EthernetDataUnit::toString() const
 {
     std::stringstream stream;
@@ -153,9 +234,7 @@ std::string EthernetDataUnit::toString() const
            << "\n\tSource: " << getSourceAddress() << "\n\t"
            << (getLength() <= 1500 ? "Length: 0x" : "EtherType: 0x")
            << std::hex << getLength() << std::dec << "\n";
-    std::vector<VlanTag> tags;
-    getVlanTags(tags);
-    for (const auto& tag : tags)
+    for (const auto& tag : getVlanTags())
     {
         stream << tag.toString();
     }
@@ -172,28 +251,48 @@ std::size_t EthernetDataUnit::getUnitSize() const
     // Two 6-byte addresses plus a 2-byte EtherType/Length field.
     const std::size_t headerSize = 6 + 6 + 2;
 
-    // Include the VLAN tags in the total size.
-    std::size_t totalSize = headerSize;
-    for (const auto& tag : vlanTags)
-    {
-        totalSize += tag.getUnitSize();
-    }
-    return totalSize;
+    // Include the 4-byte VLAN tags in the total size.
+    return headerSize + 4 * vlanTags.size();
 }
 
 std::string EthernetDataUnit::getDestinationAddress() const
 {
-    return ether_ntoa(reinterpret_cast<const ether_addr*>(&destinationAddress[0]));
+    return getDestinationMac().toString();
 }
 
 std::string EthernetDataUnit::getSourceAddress() const
 {
-    return ether_ntoa(reinterpret_cast<const ether_addr*>(&sourceAddress[0]));
+    return getSourceMac().toString();
+}
+
+MacAddress EthernetDataUnit::getDestinationMac() const
+{
+    return MacAddress(destinationAddress);
+}
+
+MacAddress EthernetDataUnit::getSourceMac() const
+{
+    return MacAddress(sourceAddress);
+}
+
+nts::Span<const uint8_t> EthernetDataUnit::getDestinationAddressBytes() const
+{
+    return destinationAddress;
+}
+
+nts::Span<const uint8_t> EthernetDataUnit::getSourceAddressBytes() const
+{
+    return sourceAddress;
 }
 
 void EthernetDataUnit::getVlanTags(std::vector<VlanTag>& outTags) const
 {
-    outTags = vlanTags;
+    outTags.assign(vlanTags.begin(), vlanTags.end());
+}
+
+nts::Span<const VlanTag> EthernetDataUnit::getVlanTags() const
+{
+    return nts::Span<const VlanTag>(vlanTags.data(), vlanTags.size());
 }
 
 uint16_t EthernetDataUnit::getEtherType() const
@@ -208,21 +307,23 @@ uint16_t EthernetDataUnit::getLength() const
 
 EthernetDataUnit& EthernetDataUnit::setDestinationAddress(const std::string address)
 {
-    ether_addr addr = *ether_aton(address.c_str());
-    for (int i = 0; i < 6; i++)
-    {
-        destinationAddress[i] = addr.ether_addr_octet[i];
-    }
+    return setDestinationAddress(MacAddress::parse(address));
+}
+
+EthernetDataUnit& EthernetDataUnit::setDestinationAddress(const MacAddress& address)
+{
+    destinationAddress = address.getBytes();
     return *this;
 }
 
 EthernetDataUnit& EthernetDataUnit::setSourceAddress(const std::string address)
 {
-    ether_addr addr = *ether_aton(address.c_str());
-    for (int i = 0; i < 6; i++)
-    {
-        sourceAddress[i] = addr.ether_addr_octet[i];
-    }
+    return setSourceAddress(MacAddress::parse(address));
+}
+
+EthernetDataUnit& EthernetDataUnit::setSourceAddress(const MacAddress& address)
+{
+    sourceAddress = address.getBytes();
     return *this;
 }
 
@@ -277,7 +378,42 @@ std::shared_ptr<nts::ProtocolDataUnit> EthernetParser::parse(std::istream& inStr
     outContext["ethernet"] = 1;
     outContext["type"] = static_cast<int>(frame->getEtherType());
 
-    return std::move(frame);
+    return frame;
+}
+
+void EthernetParser::getDispatchKeys(std::vector<nts::ParserContext>& outKeys) const
+{
+    outKeys.assign({ nts::ParserContext{ nts::ProtocolId::None, 0 } });
+}
+
+std::shared_ptr<nts::ProtocolDataUnit> EthernetParser::parseLayer(std::istream& inStream, nts::ParserContext& context) const
+{
+    std::shared_ptr<EthernetDataUnit> frame = nts::makeDataUnit<EthernetDataUnit>(context.pool);
+    frame->fromStream(inStream);
+
+    context.protocol = nts::ProtocolId::Ethernet;
+    context.nextProtocol = frame->getEtherType();
+
+    return frame;
+}
+
+std::shared_ptr<nts::ProtocolDataUnit> EthernetParser::parseBuffer(const uint8_t* inBuffer, const std::size_t length, nts::ParserContext& context, std::size_t& outBytes) const
+{
+    std::shared_ptr<EthernetDataUnit> frame = nts::makeDataUnit<EthernetDataUnit>(context.pool);
+    outBytes = frame->deserialize(inBuffer, length);
+    if (outBytes == 0)
+    {
+        // Truncated, so the data can't be parsed any further.
+        outBytes = length;
+        context.protocol = nts::ProtocolId::Unknown;
+        context.nextProtocol = 0;
+        return frame;
+    }
+
+    context.protocol = nts::ProtocolId::Ethernet;
+    context.nextProtocol = frame->getEtherType();
+
+    return frame;
 }
 
 } // namespace eth
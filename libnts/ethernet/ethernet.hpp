@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
+#include <boost/container/small_vector.hpp>
 #include <boost/endian/arithmetic.hpp>
 
 #include <libnts/core/data_unit.hpp>
+#include <libnts/core/span.hpp>
+#include <libnts/ethernet/mac_address.hpp>
 #include <libnts/messaging/parser.hpp>
 
 namespace nts {
@@ -44,6 +48,15 @@ public:
     /// @note Assumes that the protocol identifier was already extracted from the stream.
     virtual void fromStream(std::istream& inStream);
 
+    /// Writes the VLAN tag to the buffer.
+    /// @returns The number of bytes written, or 0 if the tag does not fit.
+    virtual std::size_t serialize(uint8_t* outBuffer, const std::size_t capacity) const;
+
+    /// Reads the VLAN tag from the buffer.
+    /// @note Assumes that the buffer starts after the protocol identifier.
+    /// @returns The number of bytes read, or 0 if the buffer is too short.
+    virtual std::size_t deserialize(const uint8_t* inBuffer, const std::size_t length);
+
     /// Representation of the VLAN tag in a console friendly format.
     virtual std::string toString() const;
 
@@ -92,6 +105,9 @@ private:
 };
 
 /// Data Unit class for the Ethernet II protocol.
+///
+/// @details Addresses and up to two VLAN tags (QinQ) are stored inline, so constructing or
+/// parsing a frame doesn't allocate. Frames with more tags spill them to the heap.
 class EthernetDataUnit : public nts::ProtocolDataUnit
 {
 public:
@@ -110,6 +126,14 @@ public:
     /// Reads the ethernet frame from the stream.
     virtual void fromStream(std::istream& inStream);
 
+    /// Writes the ethernet frame to the buffer.
+    /// @returns The number of bytes written, or 0 if the frame does not fit.
+    virtual std::size_t serialize(uint8_t* outBuffer, const std::size_t capacity) const;
+
+    /// Reads the ethernet frame from the buffer.
+    /// @returns The number of bytes read, or 0 if the buffer is too short.
+    virtual std::size_t deserialize(const uint8_t* inBuffer, const std::size_t length);
+
     /// Unique tag that represents this protocol.
     virtual std::string getProtocolTag() const;
 
@@ -125,9 +149,25 @@ public:
     /// Source MAC address.
     std::string getSourceAddress() const;
 
+    /// Destination MAC address.
+    MacAddress getDestinationMac() const;
+
+    /// Source MAC address.
+    MacAddress getSourceMac() const;
+
+    /// Destination MAC address, in network byte order.
+    nts::Span<const uint8_t> getDestinationAddressBytes() const;
+
+    /// Source MAC address, in network byte order.
+    nts::Span<const uint8_t> getSourceAddressBytes() const;
+
     /// Virtual LAN tags.
     void getVlanTags(std::vector<VlanTag>& outTags) const;
 
+    /// Virtual LAN tags, outermost first.
+    /// @note The view is invalidated when tags are added or removed.
+    nts::Span<const VlanTag> getVlanTags() const;
+
     /// Protocol of the payload.
     uint16_t getEtherType() const;
 
@@ -135,11 +175,19 @@ public:
     uint16_t getLength() const;
 
     /// Destination MAC address.
+    /// @throws std::invalid_argument If the text is not a valid address.
     EthernetDataUnit& setDestinationAddress(const std::string address);
 
+    /// Destination MAC address.
+    EthernetDataUnit& setDestinationAddress(const MacAddress& address);
+
     /// Source MAC address.
+    /// @throws std::invalid_argument If the text is not a valid address.
     EthernetDataUnit& setSourceAddress(const std::string address);
 
+    /// Source MAC address.
+    EthernetDataUnit& setSourceAddress(const MacAddress& address);
+
     /// Virtual LAN tags.
     EthernetDataUnit& addVlanTag(const VlanTag& tag);
 
@@ -156,11 +204,14 @@ public:
     EthernetDataUnit& setLength(const uint16_t length);
 
 private:
-    std::vector<boost::endian::big_uint8_t> destinationAddress{ 0, 0, 0, 0, 0, 0 };
+    /// Number of VLAN tags stored without allocating.
+    static constexpr std::size_t inlineVlanTags{ 2 };
 
-    std::vector<boost::endian::big_uint8_t> sourceAddress{ 0, 0, 0, 0, 0, 0 };
+    std::array<uint8_t, 6> destinationAddress{};
 
-    std::vector<VlanTag> vlanTags;
+    std::array<uint8_t, 6> sourceAddress{};
+
+    boost::container::small_vector<VlanTag, inlineVlanTags> vlanTags;
 
     boost::endian::big_uint16_t etherTypeOrLength{ 0 };
 };
@@ -180,6 +231,15 @@ public:
 
     /// Parse an ethernet frame from the stream.
     virtual std::shared_ptr<nts::ProtocolDataUnit> parse(std::istream& inStream, std::map<std::string, int>& outContext) const;
+
+    /// At the start of a message.
+    virtual void getDispatchKeys(std::vector<nts::ParserContext>& outKeys) const;
+
+    /// Parse an ethernet frame from the stream.
+    virtual std::shared_ptr<nts::ProtocolDataUnit> parseLayer(std::istream& inStream, nts::ParserContext& context) const;
+
+    /// Parse an ethernet frame from the buffer.
+    virtual std::shared_ptr<nts::ProtocolDataUnit> parseBuffer(const uint8_t* inBuffer, const std::size_t length, nts::ParserContext& context, std::size_t& outBytes) const;
 };
 
 } // namespace eth
@@ -1,6 +1,7 @@
 #include <boost/asio.hpp>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <sstream>
 
 #include <libnts/ethernet/ethernet.hpp>
 #include <libnts/core/session.hpp>
@@ -31,6 +32,10 @@ TEST(EthernetUnitTests, Accessors)
 
     frame.setSourceAddress(sourceAddress);
     EXPECT_EQ(frame.getSourceAddress(), sourceAddress);
+    EXPECT_EQ(frame.getSourceMac(), MacAddress::parse(sourceAddress));
+
+    frame.setSourceAddress(MacAddress(0, 1, 2, 3, 4, 5));
+    EXPECT_EQ(frame.getSourceAddress(), "0:1:2:3:4:5");
 
     frame.setEtherType(etherType);
     EXPECT_EQ(frame.getEtherType(), etherType);
@@ -88,6 +93,68 @@ TEST(EthernetUnitTests, Serialization)
     EXPECT_EQ(tags[0].getVID(), 0xfff);
 }
 
+TEST(EthernetUnitTests, BufferSerialization)
+{
+    EthernetDataUnit frameA = EthernetDataUnit().setDestinationAddress(destinationAddress).setSourceAddress(sourceAddress).addVlanTag(VlanTag().setVID(0xfff)).setEtherType(etherType);
+
+    // Doesn't fit.
+    std::vector<uint8_t> buffer(frameA.getUnitSize() - 1, 0);
+    EXPECT_EQ(frameA.serialize(buffer.data(), buffer.size()), 0);
+
+    // Both APIs produce the same bytes.
+    buffer.resize(64);
+    ASSERT_EQ(frameA.serialize(buffer.data(), buffer.size()), 18);
+    std::stringstream stream;
+    frameA.toStream(stream);
+    EXPECT_EQ(stream.str(), std::string(buffer.begin(), buffer.begin() + 18));
+
+    EthernetDataUnit frameB;
+    EXPECT_EQ(frameB.deserialize(buffer.data(), 18), 18);
+    EXPECT_EQ(frameB.getDestinationAddress(), destinationAddress);
+    EXPECT_EQ(frameB.getSourceAddress(), sourceAddress);
+    EXPECT_EQ(frameB.getEtherType(), etherType);
+    std::vector<VlanTag> tags;
+    frameB.getVlanTags(tags);
+    ASSERT_EQ(tags.size(), 1);
+    EXPECT_EQ(tags[0].getVID(), 0xfff);
+
+    // Truncated inside the tag.
+    EXPECT_EQ(frameB.deserialize(buffer.data(), 16), 0);
+}
+
+TEST(EthernetUnitTests, InlineStorage)
+{
+    EthernetDataUnit frame = EthernetDataUnit().setDestinationAddress(destinationAddress).addVlanTag(VlanTag().setVID(0x123)).addVlanTag(VlanTag().setVID(0x456));
+
+    // Addresses are in network byte order.
+    nts::Span<const uint8_t> address = frame.getDestinationAddressBytes();
+    ASSERT_EQ(address.size(), 6);
+    EXPECT_EQ(address[1], 0x15);
+    EXPECT_EQ(address[5], 0x15);
+    EXPECT_EQ(frame.getSourceAddressBytes()[0], 0);
+
+    // QinQ tags are stored inside the frame itself.
+    nts::Span<const VlanTag> tags = frame.getVlanTags();
+    ASSERT_EQ(tags.size(), 2);
+    EXPECT_EQ(tags[0].getVID(), 0x123);
+    EXPECT_EQ(tags[1].getVID(), 0x456);
+    const auto* begin = reinterpret_cast<const uint8_t*>(&frame);
+    const auto* tag = reinterpret_cast<const uint8_t*>(tags.data());
+    EXPECT_TRUE(tag >= begin && tag < begin + sizeof(frame));
+
+    // Parsed tags too.
+    std::vector<uint8_t> buffer(frame.getUnitSize(), 0);
+    ASSERT_EQ(frame.serialize(buffer.data(), buffer.size()), 22);
+    EthernetDataUnit parsed;
+    ASSERT_EQ(parsed.deserialize(buffer.data(), buffer.size()), 22);
+    tags = parsed.getVlanTags();
+    ASSERT_EQ(tags.size(), 2);
+    EXPECT_EQ(tags[1].getVID(), 0x456);
+    begin = reinterpret_cast<const uint8_t*>(&parsed);
+    tag = reinterpret_cast<const uint8_t*>(tags.data());
+    EXPECT_TRUE(tag >= begin && tag < begin + sizeof(parsed));
+}
+
 TEST(VlanTagUnitTests, Accessors)
 {
     VlanTag tag;
@@ -0,0 +1,115 @@
+#include <libnts/ethernet/ethernet_view.hpp>
+
+#include <boost/endian/conversion.hpp>
+
+namespace eth {
+
+namespace {
+
+/// Two 6-byte addresses plus a 2-byte EtherType/Length field.
+constexpr std::size_t untaggedHeaderSize{ 14 };
+
+/// Size of a VLAN tag.
+constexpr std::size_t vlanTagSize{ 4 };
+
+/// Offset of the first EtherType/Length field.
+constexpr std::size_t etherTypeOffset{ 12 };
+
+} // namespace
+
+EthernetView::EthernetView(const uint8_t* data, const std::size_t length)
+    : data(data)
+    , length(length)
+{
+    if (length < untaggedHeaderSize)
+    {
+        return;
+    }
+
+    // Walk the tags once, so the getters don't have to.
+    std::size_t offset = etherTypeOffset;
+    while (boost::endian::load_big_u16(data + offset) == (uint16_t)EtherType::VLAN)
+    {
+        offset += vlanTagSize;
+        if (offset + 2 > length)
+        {
+            return;
+        }
+    }
+    headerSize = offset + 2;
+}
+
+bool EthernetView::isValid() const
+{
+    return headerSize != 0;
+}
+
+std::size_t EthernetView::getUnitSize() const
+{
+    return headerSize;
+}
+
+std::string EthernetView::getDestinationAddress() const
+{
+    return getDestinationMac().toString();
+}
+
+std::string EthernetView::getSourceAddress() const
+{
+    return getSourceMac().toString();
+}
+
+MacAddress EthernetView::getDestinationMac() const
+{
+    return MacAddress(data[0], data[1], data[2], data[3], data[4], data[5]);
+}
+
+MacAddress EthernetView::getSourceMac() const
+{
+    return MacAddress(data[6], data[7], data[8], data[9], data[10], data[11]);
+}
+
+std::size_t EthernetView::getVlanTagCount() const
+{
+    return (headerSize - untaggedHeaderSize) / vlanTagSize;
+}
+
+void EthernetView::getVlanTags(std::vector<VlanTag>& outTags) const
+{
+    outTags.clear();
+    for (std::size_t i = 0; i < getVlanTagCount(); i++)
+    {
+        // Each tag starts with the protocol identifier that precedes it.
+        const uint8_t* tag = data + etherTypeOffset + i * vlanTagSize;
+        outTags.push_back(VlanTag().setProtocolIdentifier(boost::endian::load_big_u16(tag)).setControlInformation(boost::endian::load_big_u16(tag + 2)));
+    }
+}
+
+uint16_t EthernetView::getEtherType() const
+{
+    return boost::endian::load_big_u16(data + headerSize - 2);
+}
+
+uint16_t EthernetView::getLength() const
+{
+    return getEtherType();
+}
+
+const uint8_t* EthernetView::getPayload() const
+{
+    return data + headerSize;
+}
+
+std::size_t EthernetView::getPayloadSize() const
+{
+    return length - headerSize;
+}
+
+EthernetDataUnit EthernetView::toDataUnit() const
+{
+    EthernetDataUnit frame;
+    frame.deserialize(data, headerSize);
+    return frame;
+}
+
+} // namespace eth
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <libnts/ethernet/ethernet.hpp>
+
+namespace eth {
+
+/// Read-only view of an Ethernet II header inside a received buffer.
+///
+/// @details Interprets the header fields in place instead of copying them, so a view costs two
+/// pointers and a size, is trivially copyable and never allocates. The getters mirror those of
+/// EthernetDataUnit. The buffer must outlive the view. When a test needs to modify the frame,
+/// toDataUnit() returns an owning copy.
+///
+/// @example
+/// EthernetView frame(buffer.data(), bytes);
+/// if (frame.isValid() && frame.getEtherType() == (uint16_t)EtherType::IPv4)
+/// {
+///     ip::Ipv4View packet(frame.getPayload(), frame.getPayloadSize());
+/// }
+class EthernetView
+{
+public:
+    /// Constructor. Creates an invalid view.
+    EthernetView() = default;
+
+    /// Constructor.
+    /// @param data Start of the frame.
+    /// @param length Number of bytes available from the start of the frame.
+    EthernetView(const uint8_t* data, const std::size_t length);
+
+    /// Whether the buffer holds the whole header, including the VLAN tags.
+    /// @note The other getters assume that the view is valid.
+    bool isValid() const;
+
+    /// Size of the header in bytes, including the VLAN tags.
+    std::size_t getUnitSize() const;
+
+    /// Destination MAC address.
+    std::string getDestinationAddress() const;
+
+    /// Source MAC address.
+    std::string getSourceAddress() const;
+
+    /// Destination MAC address.
+    MacAddress getDestinationMac() const;
+
+    /// Source MAC address.
+    MacAddress getSourceMac() const;
+
+    /// Number of VLAN tags in the header.
+    std::size_t getVlanTagCount() const;
+
+    /// Virtual LAN tags.
+    void getVlanTags(std::vector<VlanTag>& outTags) const;
+
+    /// Protocol of the payload.
+    uint16_t getEtherType() const;
+
+    /// Length of the payload.
+    uint16_t getLength() const;
+
+    /// Start of the payload, right after the header.
+    const uint8_t* getPayload() const;
+
+    /// Number of bytes available after the header.
+    std::size_t getPayloadSize() const;
+
+    /// Owning copy of the header.
+    EthernetDataUnit toDataUnit() const;
+
+private:
+    /// Start of the frame.
+    const uint8_t* data{ nullptr };
+
+    /// Number of bytes available from the start of the frame.
+    std::size_t length{ 0 };
+
+    /// Size of the header, or 0 if it doesn't fit in the buffer.
+    std::size_t headerSize{ 0 };
+};
+
+} // namespace eth
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <type_traits>
+
+#include <libnts/ethernet/ethernet_view.hpp>
+
+namespace eth {
+namespace tests {
+
+static_assert(std::is_trivially_copyable<EthernetView>::value, "Views must be trivially copyable");
+
+TEST(EthernetViewUnitTests, Accessors)
+{
+    EthernetDataUnit frame = EthernetDataUnit().setDestinationAddress("1:2:3:4:5:6").setSourceAddress("a:b:c:d:e:f").addVlanTag(VlanTag().setVID(0x123)).addVlanTag(VlanTag().setVID(0x456)).setEtherType((uint16_t)EtherType::IPv4);
+
+    // Header followed by a payload.
+    std::vector<uint8_t> buffer(64, 0xab);
+    ASSERT_EQ(frame.serialize(buffer.data(), buffer.size()), 22);
+
+    EthernetView view(buffer.data(), buffer.size());
+    ASSERT_TRUE(view.isValid());
+    EXPECT_EQ(view.getUnitSize(), 22);
+    EXPECT_EQ(view.getDestinationAddress(), "1:2:3:4:5:6");
+    EXPECT_EQ(view.getSourceAddress(), "a:b:c:d:e:f");
+    EXPECT_EQ(view.getEtherType(), (uint16_t)EtherType::IPv4);
+    EXPECT_EQ(view.getPayload(), buffer.data() + 22);
+    EXPECT_EQ(view.getPayloadSize(), 42);
+
+    std::vector<VlanTag> tags;
+    ASSERT_EQ(view.getVlanTagCount(), 2);
+    view.getVlanTags(tags);
+    ASSERT_EQ(tags.size(), 2);
+    EXPECT_EQ(tags[0].getVID(), 0x123);
+    EXPECT_EQ(tags[1].getVID(), 0x456);
+}
+
+TEST(EthernetViewUnitTests, Truncated)
+{
+    EthernetDataUnit frame = EthernetDataUnit().addVlanTag(VlanTag()).setEtherType((uint16_t)EtherType::IPv4);
+    std::vector<uint8_t> buffer(18, 0);
+    frame.serialize(buffer.data(), buffer.size());
+
+    EXPECT_FALSE(EthernetView().isValid());
+    EXPECT_FALSE(EthernetView(buffer.data(), 13).isValid());
+    EXPECT_FALSE(EthernetView(buffer.data(), 17).isValid());
+    EXPECT_TRUE(EthernetView(buffer.data(), 18).isValid());
+}
+
+TEST(EthernetViewUnitTests, ToDataUnit)
+{
+    EthernetDataUnit frameA = EthernetDataUnit().setDestinationAddress("1:2:3:4:5:6").addVlanTag(VlanTag().setVID(7)).setEtherType((uint16_t)EtherType::ARP);
+    std::vector<uint8_t> buffer(18, 0);
+    frameA.serialize(buffer.data(), buffer.size());
+
+    EthernetDataUnit frameB = EthernetView(buffer.data(), buffer.size()).toDataUnit();
+    EXPECT_EQ(frameB.getDestinationAddress(), "1:2:3:4:5:6");
+    EXPECT_EQ(frameB.getEtherType(), (uint16_t)EtherType::ARP);
+    EXPECT_EQ(frameB.getUnitSize(), 18);
+}
+
+} // namespace tests
+} // namespace eth
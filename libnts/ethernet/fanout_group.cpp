@@ -0,0 +1,147 @@
+#include <libnts/ethernet/fanout_group.hpp>
+
+#include <pthread.h>
+
+#include <libnts/logging/log.hpp>
+#include <libnts/messaging/message.hpp>
+#include <libnts/messaging/parser.hpp>
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Number of frames received by a worker with a single call.
+constexpr std::size_t workerBatchSize{ 64 };
+
+/// Size of the buffers the workers receive frames into. Fits a full MTU frame and its headers.
+constexpr std::size_t workerFrameSize{ 2048 };
+
+/// How often the workers check whether they should stop.
+constexpr std::chrono::milliseconds workerPollInterval{ 100 };
+
+} // namespace
+
+FanoutGroup::FanoutGroup(const std::string& interface, const std::size_t sessionCount, const FanoutMode mode, const uint16_t groupId)
+{
+    for (std::size_t i = 0; i < sessionCount; i++)
+    {
+        auto session = std::make_shared<RawSession>(interface);
+        session->joinFanout(groupId, mode);
+        sessions.push_back(session);
+    }
+}
+
+FanoutGroup::FanoutGroup(const std::string& interface, const std::size_t sessionCount, const FanoutMode mode, const uint16_t groupId, const RingGeometry& rxGeometry)
+{
+    for (std::size_t i = 0; i < sessionCount; i++)
+    {
+        auto session = std::make_shared<RingSession>(interface, rxGeometry);
+        session->joinFanout(groupId, mode);
+        sessions.push_back(session);
+    }
+}
+
+FanoutGroup::~FanoutGroup()
+{
+    stop();
+}
+
+std::size_t FanoutGroup::getSessionCount() const
+{
+    return sessions.size();
+}
+
+std::shared_ptr<RawSession> FanoutGroup::getSession(const std::size_t index) const
+{
+    if (index < sessions.size())
+    {
+        return sessions[index];
+    }
+    return nullptr;
+}
+
+void FanoutGroup::start(MessageHandler handler, const std::size_t firstCpu)
+{
+    if (running.exchange(true))
+    {
+        return;
+    }
+
+    const std::size_t cpuCount = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < sessions.size(); i++)
+    {
+        workers.emplace_back(&FanoutGroup::work, this, i, handler);
+
+        // Pin the worker to its own CPU.
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET((firstCpu + i) % cpuCount, &cpus);
+        pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpus), &cpus);
+    }
+}
+
+void FanoutGroup::stop()
+{
+    running = false;
+    for (auto& worker : workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+bool FanoutGroup::isRunning() const
+{
+    return running;
+}
+
+void FanoutGroup::work(const std::size_t index, MessageHandler handler)
+{
+    // Each worker parses with its own copy of the parser, so no state is shared between them.
+    const MessageParser parser = *MessageParser::getInstance();
+    const std::shared_ptr<RawSession>& session = sessions[index];
+    std::vector<std::vector<uint8_t>> frames(workerBatchSize, std::vector<uint8_t>(workerFrameSize, 0));
+
+    // The units and the message are reused for every frame to keep allocations out of the loop.
+    std::vector<std::shared_ptr<ProtocolDataUnit>> units;
+    Message message;
+
+    try
+    {
+        while (running)
+        {
+            if (!session->waitForFrames(workerPollInterval))
+            {
+                continue;
+            }
+
+            const std::size_t frameCount = session->receiveBatch(frames, frames.size());
+            for (std::size_t i = 0; i < frameCount; i++)
+            {
+                ParserContext context;
+                units.clear();
+                parser.parse(frames[i].data(), frames[i].size(), context, units);
+
+                message.clear();
+                for (const auto& unit : units)
+                {
+                    message.addDataUnit(unit);
+                }
+                handler(index, message);
+
+                frames[i].resize(workerFrameSize);
+            }
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        ERROR("FanoutGroup", "Worker {} stopped: {}", index, exception.what());
+    }
+}
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <libnts/ethernet/raw_session.hpp>
+#include <libnts/ethernet/ring_session.hpp>
+
+namespace nts {
+
+// Forward declaration.
+class Message;
+
+namespace ss {
+
+/// Group of raw socket sessions that share the traffic of an interface through PACKET_FANOUT.
+///
+/// @details Every session of the group is bound to the same interface and joins the same
+/// fanout group, so the kernel distributes the received frames among them according to the
+/// fanout mode. Each session is meant to be serviced by its own thread, which start() takes
+/// care of: it spins up one worker per session, pinned to its own CPU, that parses every
+/// received frame with a private copy of the MessageParser and hands the result to a
+/// user provided handler.
+///
+/// @example
+/// FanoutGroup group("eth0", 4, FanoutMode::Hash, 42);
+/// group.start([](std::size_t worker, Message& message) {
+///     // Called concurrently from the worker threads.
+/// });
+/// ...
+/// group.stop();
+class FanoutGroup
+{
+public:
+    /// Handles the messages received by a worker thread.
+    typedef std::function<void(std::size_t worker, Message& message)> MessageHandler;
+
+    /// Constructor. Creates sessions that receive through the socket.
+    /// @param interface Name of the network interface to bind to.
+    /// @param sessionCount Number of sessions in the group.
+    /// @param mode How the frames are distributed among the sessions.
+    /// @param groupId Identifier of the fanout group. Must be unique for the interface.
+    /// @throws boost::system::system_error If a session cannot join the group.
+    FanoutGroup(const std::string& interface, const std::size_t sessionCount, const FanoutMode mode, const uint16_t groupId);
+
+    /// Constructor. Creates sessions that receive through a memory mapped ring.
+    /// @param rxGeometry Layout of the receive ring of each session.
+    FanoutGroup(const std::string& interface, const std::size_t sessionCount, const FanoutMode mode, const uint16_t groupId, const RingGeometry& rxGeometry);
+
+    /// Destructor. Stops the workers.
+    ~FanoutGroup();
+
+    /// Number of sessions in the group.
+    std::size_t getSessionCount() const;
+
+    /// Session with the given index.
+    std::shared_ptr<RawSession> getSession(const std::size_t index) const;
+
+    /// Start one worker thread per session.
+    /// @param handler Called from the worker threads with every message they receive. The message is
+    /// reused for the next frame, so the handler must copy whatever it keeps.
+    /// @param firstCpu CPU of the first worker. Worker N is pinned to CPU (firstCpu + N),
+    /// wrapping around the available CPUs.
+    void start(MessageHandler handler, const std::size_t firstCpu = 0);
+
+    /// Stop the worker threads and wait for them to finish.
+    void stop();
+
+    /// Whether the worker threads are running.
+    bool isRunning() const;
+
+protected:
+    /// Receive and parse frames until the group is stopped.
+    void work(const std::size_t index, MessageHandler handler);
+
+private:
+    /// Sessions of the group, one per worker.
+    std::vector<std::shared_ptr<RawSession>> sessions;
+
+    /// Worker threads, one per session.
+    std::vector<std::thread> workers;
+
+    /// Signals the workers to keep running.
+    std::atomic<bool> running{ false };
+};
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <mutex>
+
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/ethernet/fanout_group.hpp>
+#include <libnts/messaging/message.hpp>
+#include <libnts/messaging/parser.hpp>
+
+namespace nts {
+namespace tests {
+
+/// Broadcast frame with an unassigned EtherType, so that it is ignored by the network stack.
+std::vector<uint8_t> fanoutFrame = { { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x15, 0x5d, 0x3a, 0xe2, 0x9b, 0x88, 0xb5, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29 } };
+
+TEST(DISABLED_FanoutGroupUnitTests, Sessions)
+{
+    ss::FanoutGroup group("lo", 4, ss::FanoutMode::RoundRobin, 0x4e54);
+    ASSERT_EQ(group.getSessionCount(), 4);
+    ASSERT_TRUE(group.getSession(3));
+    ASSERT_FALSE(group.getSession(4));
+    ASSERT_FALSE(group.isRunning());
+}
+
+TEST(DISABLED_FanoutGroupUnitTests, Workers)
+{
+    MessageParser::getInstance()->addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet");
+
+    ss::FanoutGroup group("lo", 2, ss::FanoutMode::RoundRobin, 0x4e55);
+
+    // Count the frames received by each worker.
+    std::mutex mutex;
+    std::vector<std::size_t> framesPerWorker(group.getSessionCount(), 0);
+    group.start([&](std::size_t worker, Message& message) {
+        if (message.hasProtocol("ethernet"))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            framesPerWorker[worker]++;
+        }
+    });
+    ASSERT_TRUE(group.isRunning());
+
+    // Send the frames through a session outside of the group.
+    ss::RawSession sender("lo");
+    for (int i = 0; i < 64; i++)
+    {
+        sender.send(fanoutFrame);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    group.stop();
+    ASSERT_FALSE(group.isRunning());
+
+    // The traffic must have been shared by both workers.
+    EXPECT_GT(framesPerWorker[0], 0);
+    EXPECT_GT(framesPerWorker[1], 0);
+    EXPECT_GE(framesPerWorker[0] + framesPerWorker[1], 64);
+
+    MessageParser::getInstance()->removeProtocol("ethernet");
+}
+
+} // namespace tests
+} // namespace nts
@@ -0,0 +1,105 @@
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <boost/system/system_error.hpp>
+#include <memory>
+#include <thread>
+
+#include <libnts/ethernet/io_uring_session.hpp>
+#include <libnts/ethernet/raw_session.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// Broadcast frames of the given size with an unassigned EtherType, ignored by the network stack.
+std::vector<std::vector<uint8_t>> makeFrames(const std::size_t count, const std::size_t size)
+{
+    std::vector<uint8_t> frame(size, 0xab);
+    const uint8_t header[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x88, 0xb5 };
+    std::copy(std::begin(header), std::end(header), frame.begin());
+    return std::vector<std::vector<uint8_t>>(count, frame);
+}
+
+/// Session of the given type on the loopback interface, or nullptr without CAP_NET_RAW.
+template <typename SessionType>
+std::unique_ptr<SessionType> createSession(benchmark::State& state)
+{
+    try
+    {
+        return std::unique_ptr<SessionType>(new SessionType("lo"));
+    }
+    catch (const boost::system::system_error& error)
+    {
+        state.SkipWithError("Raw sockets are not available");
+        return nullptr;
+    }
+}
+
+} // namespace
+
+/// Batches of 64 frames sent to the loopback interface.
+template <typename SessionType>
+void BM_SendBatch(benchmark::State& state)
+{
+    std::unique_ptr<SessionType> session = createSession<SessionType>(state);
+    if (!session)
+    {
+        return;
+    }
+    std::vector<std::vector<uint8_t>> frames = makeFrames(64, state.range(0));
+    for (auto _ : state)
+    {
+        session->sendBatch(frames);
+    }
+    state.SetItemsProcessed(state.iterations() * frames.size());
+    state.SetBytesProcessed(state.iterations() * frames.size() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_SendBatch, ss::RawSession)->Arg(64)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_SendBatch, ss::IoUringSession)->Arg(64)->Arg(1500);
+
+/// Frames sent to the loopback interface by a raw socket on a sender thread, received in
+/// batches of up to 64 frames. Frames the kernel drops are not counted.
+template <typename SessionType>
+void BM_ReceiveBatch(benchmark::State& state)
+{
+    std::unique_ptr<SessionType> session = createSession<SessionType>(state);
+    if (!session)
+    {
+        return;
+    }
+    ss::RawSession sender("lo");
+    std::atomic<bool> running{ true };
+    std::thread thread([&sender, &running, &state]() {
+        std::vector<std::vector<uint8_t>> frames = makeFrames(64, state.range(0));
+        while (running.load(std::memory_order_relaxed))
+        {
+            sender.sendBatch(frames);
+        }
+    });
+
+    std::vector<std::vector<uint8_t>> buffers(64, std::vector<uint8_t>(ss::MTU_SIZE));
+    std::size_t frames = 0;
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        const std::size_t count = session->receiveBatch(buffers, buffers.size());
+        for (std::size_t i = 0; i < count; i++)
+        {
+            bytes += buffers[i].size();
+            buffers[i].resize(ss::MTU_SIZE);
+        }
+        frames += count;
+    }
+    running = false;
+    thread.join();
+    state.SetItemsProcessed(frames);
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK_TEMPLATE(BM_ReceiveBatch, ss::RawSession)->Arg(64)->Arg(1500)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReceiveBatch, ss::IoUringSession)->Arg(64)->Arg(1500)->UseRealTime();
+
+} // namespace benchmarks
+} // namespace nts
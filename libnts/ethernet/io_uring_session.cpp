@@ -0,0 +1,566 @@
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include <libnts/capture/capture_writer.hpp>
+#include <libnts/config/configuration.hpp>
+#include <libnts/core/io_uring.hpp>
+#include <libnts/ethernet/io_uring_session.hpp>
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// User data of the multishot receive. Sends use the index of their buffer.
+constexpr uint64_t receiveTag{ ~uint64_t(0) };
+
+/// Group of the receive buffers.
+constexpr uint16_t bufferGroup{ 0 };
+
+/// Largest number of entries of a buffer ring.
+constexpr uint32_t maxReceiveBuffers{ 32768 };
+
+/// Anonymous, page aligned memory.
+/// @throws boost::system::system_error If the memory cannot be mapped.
+uint8_t* mapMemory(const std::size_t size)
+{
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "mmap");
+    }
+    return static_cast<uint8_t*>(memory);
+}
+
+/// Runs a send right away and posts its result to the handler, like an asynchronous send.
+template <typename Send>
+void postSendResult(boost::asio::io_context& context, Send&& send, const Session::CompletionHandler& handler)
+{
+    boost::system::error_code error;
+    std::size_t bytes = 0;
+    try
+    {
+        bytes = send();
+    }
+    catch (const boost::system::system_error& failure)
+    {
+        error = failure.code();
+    }
+    boost::asio::post(context, [handler, error, bytes]() { handler(error, bytes); });
+}
+
+} // namespace
+
+IoUringOptions& IoUringOptions::configure(std::shared_ptr<Configuration> config, const std::string& key)
+{
+    if (auto count = config->getInt(key + ".EntryCount"))
+    {
+        entryCount = count.value();
+    }
+    if (auto count = config->getInt(key + ".ReceiveBufferCount"))
+    {
+        receiveBufferCount = count.value();
+    }
+    if (auto count = config->getInt(key + ".SendBufferCount"))
+    {
+        sendBufferCount = count.value();
+    }
+    if (auto size = config->getInt(key + ".BufferSize"))
+    {
+        bufferSize = size.value();
+    }
+    if (auto enable = config->getBool(key + ".Enabled"))
+    {
+        enabled = enable.value();
+    }
+    return *this;
+}
+
+IoUringSession::IoUringSession(const std::string& interface, const IoUringOptions& options)
+    : RawSession(interface)
+    , options(options)
+{
+    if (options.entryCount == 0 || options.sendBufferCount == 0 || options.bufferSize == 0 || options.receiveBufferCount == 0 || options.receiveBufferCount > maxReceiveBuffers)
+    {
+        throw std::invalid_argument("Invalid io_uring session options");
+    }
+    this->options.receiveBufferCount = detail::roundUpToPowerOfTwo(options.receiveBufferCount);
+
+    if (options.enabled && IoUring::isSupported())
+    {
+        try
+        {
+            setUp();
+        }
+        catch (const boost::system::system_error&)
+        {
+            // Older kernels lack buffer rings or multishot receives.
+            tearDown();
+        }
+    }
+}
+
+IoUringSession::~IoUringSession()
+{
+    tearDown();
+}
+
+std::size_t IoUringSession::send(std::vector<uint8_t>& inData)
+{
+    if (!ring)
+    {
+        return RawSession::send(inData);
+    }
+    reap();
+    throwSendError();
+    if (inData.size() > options.bufferSize)
+    {
+        return RawSession::send(inData);
+    }
+    const uint32_t index = acquireSendBuffer();
+    memcpy(sendBuffers + std::size_t(index) * options.bufferSize, inData.data(), inData.size());
+    queueSend(index, inData.size());
+    ring->submit();
+    return inData.size();
+}
+
+std::size_t IoUringSession::send(Serializable& inData)
+{
+    if (!ring)
+    {
+        return RawSession::send(inData);
+    }
+    reap();
+    throwSendError();
+    const uint32_t index = acquireSendBuffer();
+    const std::size_t size = inData.serialize(sendBuffers + std::size_t(index) * options.bufferSize, options.bufferSize);
+    if (size == 0)
+    {
+        // Objects that don't fit in a buffer go through the socket directly.
+        freeSendBuffers.push_back(index);
+        return RawSession::send(inData);
+    }
+    queueSend(index, size);
+    ring->submit();
+    return size;
+}
+
+std::size_t IoUringSession::receive(std::vector<uint8_t>& outData)
+{
+    if (!ring)
+    {
+        return RawSession::receive(outData);
+    }
+    ReceivedFrame frame;
+    nextFrame(frame, true);
+    const uint8_t* data = receiveBuffers + std::size_t(frame.bufferId) * options.bufferSize;
+    const std::size_t bytes = std::min<std::size_t>(frame.length, outData.size());
+    memcpy(outData.data(), data, bytes);
+    if (captureWriter)
+    {
+        captureWriter->capture(data, frame.length);
+    }
+    recycle(frame.bufferId);
+    return bytes;
+}
+
+std::size_t IoUringSession::receive(Serializable& outData)
+{
+    if (!ring)
+    {
+        return RawSession::receive(outData);
+    }
+    ReceivedFrame frame;
+    nextFrame(frame, true);
+    const uint8_t* data = receiveBuffers + std::size_t(frame.bufferId) * options.bufferSize;
+    if (captureWriter)
+    {
+        captureWriter->capture(data, frame.length);
+    }
+    outData.deserialize(data, frame.length);
+    recycle(frame.bufferId);
+    return frame.length;
+}
+
+std::size_t IoUringSession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    if (!ring)
+    {
+        return RawSession::sendBatch(inFrames);
+    }
+    reap();
+    throwSendError();
+
+    std::size_t framesSent = 0;
+    for (auto& frame : inFrames)
+    {
+        if (frame.size() > options.bufferSize)
+        {
+            // Keep the order of the frames.
+            ring->submit();
+            try
+            {
+                if (RawSession::send(frame) < frame.size())
+                {
+                    break;
+                }
+            }
+            catch (const boost::system::system_error&)
+            {
+                // The frames before it are on their way, so they are reported instead.
+                if (framesSent == 0)
+                {
+                    throw;
+                }
+                break;
+            }
+            framesSent++;
+            continue;
+        }
+        const uint32_t index = acquireSendBuffer();
+        memcpy(sendBuffers + std::size_t(index) * options.bufferSize, frame.data(), frame.size());
+        queueSend(index, frame.size());
+        framesSent++;
+    }
+    ring->submit();
+    return framesSent;
+}
+
+std::size_t IoUringSession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    if (!ring)
+    {
+        return RawSession::receiveBatch(outFrames, maxFrames);
+    }
+
+    // Wait for the first frame, then take whatever else is already received.
+    const std::size_t frameCount = std::min(maxFrames, outFrames.size());
+    std::size_t received = 0;
+    ReceivedFrame frame;
+    while (received < frameCount && nextFrame(frame, received == 0))
+    {
+        const uint8_t* data = receiveBuffers + std::size_t(frame.bufferId) * options.bufferSize;
+        std::vector<uint8_t>& outFrame = outFrames[received];
+        outFrame.resize(std::min<std::size_t>(frame.length, outFrame.size()));
+        memcpy(outFrame.data(), data, outFrame.size());
+        if (captureWriter)
+        {
+            captureWriter->capture(data, frame.length);
+        }
+        recycle(frame.bufferId);
+        received++;
+    }
+    return received;
+}
+
+bool IoUringSession::waitForFrames(const std::chrono::milliseconds timeout)
+{
+    if (!ring)
+    {
+        return RawSession::waitForFrames(timeout);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;)
+    {
+        reap();
+        if (!receivedFrames->empty())
+        {
+            return true;
+        }
+        if (!receiving)
+        {
+            armReceive();
+        }
+        ring->submit();
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            reap();
+            return !receivedFrames->empty();
+        }
+        // The ring is readable once completions are posted.
+        pollfd descriptor{ ring->getDescriptor(), POLLIN, 0 };
+        poll(&descriptor, 1, remaining.count());
+    }
+}
+
+void IoUringSession::asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler)
+{
+    if (!ring)
+    {
+        RawSession::asyncSend(inData, handler);
+        return;
+    }
+    postSendResult(*ioContext, [this, &inData]() { return send(inData); }, handler);
+}
+
+void IoUringSession::asyncSend(Serializable& inData, CompletionHandler handler)
+{
+    if (!ring)
+    {
+        RawSession::asyncSend(inData, handler);
+        return;
+    }
+    postSendResult(*ioContext, [this, &inData]() { return send(inData); }, handler);
+}
+
+void IoUringSession::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler)
+{
+    checkDirectReceive();
+    RawSession::asyncReceive(outData, handler);
+}
+
+void IoUringSession::asyncReceive(Serializable& outData, CompletionHandler handler)
+{
+    checkDirectReceive();
+    RawSession::asyncReceive(outData, handler);
+}
+
+void IoUringSession::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    checkDirectReceive();
+    RawSession::asyncReceive(outData, handler, slot);
+}
+
+void IoUringSession::asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    checkDirectReceive();
+    RawSession::asyncReceive(outData, handler, slot);
+}
+
+void IoUringSession::joinFanout(const uint16_t groupId, const FanoutMode mode)
+{
+    checkDirectReceive();
+    RawSession::joinFanout(groupId, mode);
+}
+
+void IoUringSession::flush()
+{
+    if (!ring)
+    {
+        return;
+    }
+    ring->submit();
+    reap();
+    while (freeSendBuffers.size() < options.sendBufferCount)
+    {
+        ring->submit(1);
+        reap();
+    }
+    throwSendError();
+}
+
+bool IoUringSession::isUsingIoUring() const
+{
+    return ring != nullptr;
+}
+
+void IoUringSession::setUp()
+{
+    // Every buffer may hold a completion, and the multishot receive posts one more when it
+    // stops. Completions that don't fit are held by the kernel until it is entered again.
+    const uint32_t completionCount = std::max(2 * options.entryCount, options.receiveBufferCount + options.sendBufferCount + 1);
+    ring.reset(new IoUring(options.entryCount, 0, completionCount));
+
+    // Send buffers are registered, so the kernel doesn't map them for every send.
+    const std::size_t sendSize = std::size_t(options.sendBufferCount) * options.bufferSize;
+    sendBuffers = mapMemory(sendSize);
+    ring->registerBuffers({ iovec{ sendBuffers, sendSize } });
+    freeSendBuffers.reserve(options.sendBufferCount);
+    for (uint32_t i = 0; i < options.sendBufferCount; i++)
+    {
+        freeSendBuffers.push_back(options.sendBufferCount - 1 - i);
+    }
+
+    // Receive buffers are handed to the kernel through a buffer ring.
+    receiveBuffers = mapMemory(std::size_t(options.receiveBufferCount) * options.bufferSize);
+    bufferRing = reinterpret_cast<io_uring_buf_ring*>(mapMemory(options.receiveBufferCount * sizeof(io_uring_buf)));
+    ring->registerBufferRing(bufferRing, options.receiveBufferCount, bufferGroup);
+    for (uint32_t i = 0; i < options.receiveBufferCount; i++)
+    {
+        recycle(i);
+    }
+    receivedFrames.reset(new SpscRingBuffer<ReceivedFrame>(options.receiveBufferCount));
+
+    // Invalid flags are rejected while the entry is submitted, so a kernel without
+    // multishot receives fails here.
+    armReceive();
+    ring->submit();
+    reap();
+}
+
+void IoUringSession::tearDown()
+{
+    // The ring goes first, so the kernel is done with the buffers.
+    ring.reset();
+    if (bufferRing)
+    {
+        munmap(bufferRing, options.receiveBufferCount * sizeof(io_uring_buf));
+        bufferRing = nullptr;
+    }
+    if (receiveBuffers)
+    {
+        munmap(receiveBuffers, std::size_t(options.receiveBufferCount) * options.bufferSize);
+        receiveBuffers = nullptr;
+    }
+    if (sendBuffers)
+    {
+        munmap(sendBuffers, std::size_t(options.sendBufferCount) * options.bufferSize);
+        sendBuffers = nullptr;
+    }
+    receivedFrames.reset();
+    freeSendBuffers.clear();
+    receiving = false;
+    sendError = 0;
+}
+
+bool IoUringSession::nextFrame(ReceivedFrame& outFrame, const bool wait)
+{
+    for (;;)
+    {
+        reap();
+        if (receivedFrames->tryPop(outFrame))
+        {
+            return true;
+        }
+        // The receive stops when the kernel runs out of buffers.
+        if (!receiving)
+        {
+            armReceive();
+        }
+        if (!wait)
+        {
+            ring->submit();
+            reap();
+            return receivedFrames->tryPop(outFrame);
+        }
+        ring->submit(1);
+    }
+}
+
+void IoUringSession::recycle(const uint16_t bufferId)
+{
+    // The entries overlay the ring, tail included. The bufs member can't be used from C++,
+    // where the flexible array of the kernel header starts after an empty struct of one byte.
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(bufferRing)[bufferRingTail & (options.receiveBufferCount - 1)];
+    entry.addr = reinterpret_cast<uint64_t>(receiveBuffers + std::size_t(bufferId) * options.bufferSize);
+    entry.len = options.bufferSize;
+    entry.bid = bufferId;
+    bufferRingTail++;
+    __atomic_store_n(&bufferRing->tail, bufferRingTail, __ATOMIC_RELEASE);
+}
+
+void IoUringSession::armReceive()
+{
+    io_uring_sqe* entry = nextSubmission();
+    entry->opcode = IORING_OP_RECV;
+    entry->fd = socket.native_handle();
+    entry->ioprio = IORING_RECV_MULTISHOT;
+    entry->flags = IOSQE_BUFFER_SELECT;
+    entry->buf_group = bufferGroup;
+    entry->user_data = receiveTag;
+    receiving = true;
+}
+
+uint32_t IoUringSession::acquireSendBuffer()
+{
+    if (freeSendBuffers.empty())
+    {
+        reap();
+    }
+    while (freeSendBuffers.empty())
+    {
+        ring->submit(1);
+        reap();
+    }
+    const uint32_t index = freeSendBuffers.back();
+    freeSendBuffers.pop_back();
+    return index;
+}
+
+void IoUringSession::queueSend(const uint32_t bufferIndex, const std::size_t length)
+{
+    io_uring_sqe* entry = nextSubmission();
+    entry->opcode = IORING_OP_WRITE_FIXED;
+    entry->fd = socket.native_handle();
+    entry->addr = reinterpret_cast<uint64_t>(sendBuffers + std::size_t(bufferIndex) * options.bufferSize);
+    entry->len = length;
+    entry->buf_index = 0;
+    entry->user_data = bufferIndex;
+}
+
+io_uring_sqe* IoUringSession::nextSubmission()
+{
+    io_uring_sqe* entry;
+    while ((entry = ring->getSubmission()) == nullptr)
+    {
+        ring->submit();
+    }
+    return entry;
+}
+
+void IoUringSession::reap()
+{
+    IoCompletion completion;
+    while (ring->peekCompletion(completion))
+    {
+        process(completion);
+    }
+}
+
+void IoUringSession::process(const IoCompletion& completion)
+{
+    if (completion.userData == receiveTag)
+    {
+        if ((completion.flags & IORING_CQE_F_MORE) == 0)
+        {
+            receiving = false;
+        }
+        if (completion.result >= 0 && (completion.flags & IORING_CQE_F_BUFFER) != 0)
+        {
+            // There are as many slots as buffers, so there is always room.
+            receivedFrames->tryPush(ReceivedFrame{ uint16_t(completion.flags >> IORING_CQE_BUFFER_SHIFT), uint32_t(completion.result) });
+        }
+        else if (completion.result < 0 && completion.result != -ENOBUFS)
+        {
+            throw boost::system::system_error(-completion.result, boost::system::system_category(), "recv");
+        }
+        return;
+    }
+
+    // Send errors are kept for the next send, rather than thrown from whatever operation
+    // happens to reap the completion.
+    freeSendBuffers.push_back(static_cast<uint32_t>(completion.userData));
+    if (completion.result < 0 && sendError == 0)
+    {
+        sendError = -completion.result;
+    }
+}
+
+void IoUringSession::throwSendError()
+{
+    if (sendError != 0)
+    {
+        const int error = sendError;
+        sendError = 0;
+        throw boost::system::system_error(error, boost::system::system_category(), "send");
+    }
+}
+
+void IoUringSession::checkDirectReceive() const
+{
+    if (ring)
+    {
+        throw std::logic_error("io_uring sessions receive through the ring, not the socket");
+    }
+}
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <memory>
+
+#include <libnts/core/ring_buffer.hpp>
+#include <libnts/ethernet/raw_session.hpp>
+
+// Forward declarations.
+struct io_uring_sqe;
+struct io_uring_buf_ring;
+
+namespace nts {
+
+// Forward declarations.
+class Configuration;
+
+namespace ss {
+
+class IoUring;
+struct IoCompletion;
+
+/// Settings of an IoUringSession.
+struct IoUringOptions
+{
+    /// Size of the submission queue.
+    uint32_t entryCount{ 256 };
+
+    /// Number of buffers the kernel receives frames into. Rounded up to a power of two.
+    uint32_t receiveBufferCount{ 256 };
+
+    /// Number of registered buffers that frames are sent from.
+    uint32_t sendBufferCount{ 256 };
+
+    /// Size of each buffer. Longer received frames are truncated, and longer sent frames go
+    /// through the socket directly.
+    uint32_t bufferSize{ 2048 };
+
+    /// Use io_uring when the kernel supports it. The session behaves like a RawSession otherwise.
+    bool enabled{ true };
+
+    /// Configure the options with the parameters under the given key.
+    /// @example
+    /// options.configure(config, "Session.IoUring"); // Reads "Session.IoUring.EntryCount", etc.
+    IoUringOptions& configure(std::shared_ptr<Configuration> config, const std::string& key);
+};
+
+/// Communicate using a raw socket driven by io_uring.
+///
+/// @details Frames are received by a single multishot receive operation, which keeps
+/// filling buffers from a ring provided to the kernel until it is cancelled, so receiving
+/// needs no system call while frames keep arriving. Received frames are copied or
+/// deserialized straight from those buffers, which are then handed back to the kernel.
+/// Frames are sent from buffers registered with the kernel (IORING_OP_WRITE_FIXED), and a
+/// batch is submitted with a single system call. Sends complete asynchronously: their
+/// buffers are reused once the kernel is done with them, and a failed send is reported by
+/// the next send, or by flush().
+///
+/// When io_uring, buffer rings (Linux 5.19) or multishot receives (Linux 6.0) are not
+/// available, or when the options disable io_uring, every operation goes through the
+/// RawSession implementation.
+///
+/// Frames are taken from the socket by the multishot receive, so asynchronous receives and
+/// fanout groups, which read the socket directly, throw std::logic_error while io_uring is
+/// used. Asynchronous sends go through the ring like the other sends.
+///
+/// @example
+/// IoUringSession session("eth0");
+/// session.sendBatch(requests); // One system call for the whole batch.
+/// session.receiveBatch(replies, replies.size());
+class IoUringSession : public RawSession
+{
+public:
+    /// Constructor.
+    /// @param interface Name of the network interface to bind to.
+    /// @param options Settings of the queues and buffers.
+    explicit IoUringSession(const std::string& interface, const IoUringOptions& options = IoUringOptions());
+
+    /// Deconstructor.
+    ~IoUringSession();
+
+    /// Send data to the network.
+    /// @throws boost::system::system_error If a previous send failed.
+    virtual std::size_t send(std::vector<uint8_t>& inData);
+
+    /// Send object to the network. The object is serialized straight into a registered buffer.
+    /// @throws boost::system::system_error If a previous send failed.
+    virtual std::size_t send(Serializable& inData);
+
+    /// Receive data from the network.
+    /// @param outData Must be non-empty (size > 0).
+    virtual std::size_t receive(std::vector<uint8_t>& outData);
+
+    /// Receive object from the network. The object is deserialized straight from the
+    /// buffer the kernel received the frame into.
+    virtual std::size_t receive(Serializable& outData);
+
+    /// Send several frames to the network with a single submission.
+    /// @returns The number of frames handed to the kernel, which stops at the first frame
+    /// that is too large for a buffer and can't be sent through the socket either.
+    /// @throws boost::system::system_error If a previous send failed.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive the available frames from the network.
+    /// @details Blocks until at least one frame is received.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Start sending data to the network, through the ring.
+    virtual void asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler);
+
+    /// Start sending an object to the network, through the ring.
+    virtual void asyncSend(Serializable& inData, CompletionHandler handler);
+
+    /// Start receiving data from the network.
+    /// @throws std::logic_error If the session uses io_uring.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler);
+
+    /// Start receiving an object from the network.
+    /// @throws std::logic_error If the session uses io_uring.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler);
+
+    /// Start receiving data from the network, with a slot that cancels only this operation.
+    /// @throws std::logic_error If the session uses io_uring.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Start receiving an object from the network, with a slot that cancels only this operation.
+    /// @throws std::logic_error If the session uses io_uring.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Join a PACKET_FANOUT group.
+    /// @throws std::logic_error If the session uses io_uring.
+    virtual void joinFanout(const uint16_t groupId, const FanoutMode mode);
+
+    /// Wait until a frame can be received without blocking.
+    /// @returns Whether a frame is available before the timeout expires.
+    virtual bool waitForFrames(const std::chrono::milliseconds timeout);
+
+    /// Wait until the kernel is done with every send.
+    /// @throws boost::system::system_error If a send failed since the last report.
+    virtual void flush();
+
+    /// Whether operations go through io_uring, rather than the RawSession implementation.
+    bool isUsingIoUring() const;
+
+private:
+    /// Frame received into a buffer of the buffer ring.
+    struct ReceivedFrame
+    {
+        /// Buffer the frame was received into.
+        uint16_t bufferId{ 0 };
+
+        /// Length of the frame.
+        uint32_t length{ 0 };
+    };
+
+    /// Create the queues and buffers, and start receiving.
+    void setUp();
+
+    /// Release the queues and buffers.
+    void tearDown();
+
+    /// Take the oldest received frame.
+    /// @param wait Whether to wait for a frame when none was received yet.
+    /// @returns Whether a frame was taken.
+    bool nextFrame(ReceivedFrame& outFrame, const bool wait);
+
+    /// Hand a receive buffer back to the kernel.
+    void recycle(const uint16_t bufferId);
+
+    /// Start the multishot receive.
+    void armReceive();
+
+    /// Index of a free send buffer, waiting for a send to complete if there is none.
+    uint32_t acquireSendBuffer();
+
+    /// Prepare a send of the first length bytes of the send buffer.
+    void queueSend(const uint32_t bufferIndex, const std::size_t length);
+
+    /// Next free submission entry, submitting the prepared ones if the queue is full.
+    io_uring_sqe* nextSubmission();
+
+    /// Process every available completion.
+    void reap();
+
+    /// Process a completion, queueing received frames and freeing send buffers.
+    void process(const IoCompletion& completion);
+
+    /// Report the failure of a send since the last report, if there was one.
+    /// @throws boost::system::system_error With the error of the send.
+    void throwSendError();
+
+    /// Throws std::logic_error for operations that read the socket directly, if the session
+    /// uses io_uring.
+    void checkDirectReceive() const;
+
+    /// Settings of the queues and buffers.
+    IoUringOptions options;
+
+    /// Queues shared with the kernel. Null when io_uring is not used.
+    std::unique_ptr<IoUring> ring;
+
+    /// Buffers that frames are received into.
+    uint8_t* receiveBuffers{ nullptr };
+
+    /// Buffers that frames are sent from, registered with the kernel.
+    uint8_t* sendBuffers{ nullptr };
+
+    /// Ring that hands receive buffers to the kernel.
+    io_uring_buf_ring* bufferRing{ nullptr };
+
+    /// Next position of the buffer ring.
+    uint16_t bufferRingTail{ 0 };
+
+    /// Received frames that were not taken yet.
+    std::unique_ptr<SpscRingBuffer<ReceivedFrame>> receivedFrames;
+
+    /// Indices of the send buffers the kernel is done with.
+    std::vector<uint32_t> freeSendBuffers;
+
+    /// Whether the multishot receive is active.
+    bool receiving{ false };
+
+    /// Error of the first send that failed since the last report, or 0.
+    int sendError{ 0 };
+};
+
+} // namespace ss
+} // namespace nts
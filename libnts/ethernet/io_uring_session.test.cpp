@@ -0,0 +1,247 @@
+#include <boost/system/system_error.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <unistd.h>
+
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/core/data_unit.hpp>
+#include <libnts/core/io_uring.hpp>
+#include <libnts/ethernet/io_uring_session.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Broadcast frame with an unassigned EtherType, so that it is ignored by the network stack.
+/// The source address holds the process id, since ctest runs several test processes on the
+/// loopback interface at once, and the bytes after the header identify the frame.
+std::vector<uint8_t> makeFrame(const uint16_t index, const std::size_t size = 60)
+{
+    std::vector<uint8_t> frame(size, 0x5a);
+    const uint32_t pid = static_cast<uint32_t>(getpid());
+    const uint8_t header[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02, 0x00, uint8_t(pid >> 24), uint8_t(pid >> 16), uint8_t(pid >> 8), uint8_t(pid), 0x88, 0xb5 };
+    std::copy(std::begin(header), std::end(header), frame.begin());
+    frame[14] = index >> 8;
+    frame[15] = index & 0xff;
+    return frame;
+}
+
+/// Whether the frame is a test frame of this process.
+bool isTestFrame(const std::vector<uint8_t>& frame)
+{
+    const uint32_t pid = static_cast<uint32_t>(getpid());
+    return frame.size() > 16 && frame[12] == 0x88 && frame[13] == 0xb5 && frame[8] == uint8_t(pid >> 24) && frame[9] == uint8_t(pid >> 16) && frame[10] == uint8_t(pid >> 8) && frame[11] == uint8_t(pid);
+}
+
+/// Index of a test frame.
+uint16_t getIndex(const std::vector<uint8_t>& frame)
+{
+    return uint16_t(frame[14] << 8 | frame[15]);
+}
+
+/// Session on the loopback interface, or nullptr without CAP_NET_RAW.
+std::unique_ptr<ss::IoUringSession> createSession(const ss::IoUringOptions& options)
+{
+    try
+    {
+        return std::unique_ptr<ss::IoUringSession>(new ss::IoUringSession("lo", options));
+    }
+    catch (const boost::system::system_error& error)
+    {
+        return nullptr;
+    }
+}
+
+/// Sends and receives single frames and objects through the session.
+void checkSendReceive(ss::IoUringSession& session)
+{
+    std::vector<uint8_t> request = makeFrame(1);
+    ASSERT_EQ(session.send(request), request.size());
+    std::vector<uint8_t> buffer(ss::MTU_SIZE, 0);
+    do
+    {
+        buffer.resize(ss::MTU_SIZE);
+        buffer.resize(session.receive(buffer));
+    } while (!isTestFrame(buffer) || getIndex(buffer) != 1);
+    EXPECT_EQ(buffer, request);
+
+    GenericDataUnit object = GenericDataUnit().setData(makeFrame(2));
+    ASSERT_EQ(session.send(object), 60u);
+    GenericDataUnit received;
+    do
+    {
+        ASSERT_GT(session.receive(received), 0u);
+    } while (!isTestFrame(received.getData()) || getIndex(received.getData()) != 2);
+    EXPECT_EQ(received.getData(), object.getData());
+}
+
+/// Sends a batch through the session and receives every frame of it.
+void checkBatch(ss::IoUringSession& session)
+{
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        frames.push_back(makeFrame(i, 60 + i));
+    }
+    ASSERT_EQ(session.sendBatch(frames), frames.size());
+
+    std::set<uint16_t> indices;
+    std::vector<std::vector<uint8_t>> buffers(16, std::vector<uint8_t>(ss::MTU_SIZE));
+    while (indices.size() < frames.size())
+    {
+        ASSERT_TRUE(session.waitForFrames(std::chrono::milliseconds(1000)));
+        const std::size_t count = session.receiveBatch(buffers, buffers.size());
+        ASSERT_GT(count, 0u);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (isTestFrame(buffers[i]))
+            {
+                ASSERT_EQ(buffers[i], frames[getIndex(buffers[i])]);
+                indices.insert(getIndex(buffers[i]));
+            }
+            buffers[i].resize(ss::MTU_SIZE);
+        }
+    }
+}
+
+} // namespace
+
+TEST(IoUringSessionUnitTests, SendReceive)
+{
+    std::unique_ptr<ss::IoUringSession> session = createSession(ss::IoUringOptions());
+    if (!session)
+    {
+        GTEST_SKIP() << "Raw sockets are not available";
+    }
+    EXPECT_EQ(session->isUsingIoUring(), ss::IoUring::isSupported());
+    checkSendReceive(*session);
+}
+
+TEST(IoUringSessionUnitTests, Batch)
+{
+    // Fewer buffers than frames, so buffers are reused while the batch is in flight.
+    ss::IoUringOptions options;
+    options.entryCount = 16;
+    options.sendBufferCount = 8;
+    options.receiveBufferCount = 64;
+    std::unique_ptr<ss::IoUringSession> session = createSession(options);
+    if (!session)
+    {
+        GTEST_SKIP() << "Raw sockets are not available";
+    }
+    checkBatch(*session);
+}
+
+TEST(IoUringSessionUnitTests, Fallback)
+{
+    ss::IoUringOptions options;
+    options.enabled = false;
+    std::unique_ptr<ss::IoUringSession> session = createSession(options);
+    if (!session)
+    {
+        GTEST_SKIP() << "Raw sockets are not available";
+    }
+    EXPECT_FALSE(session->isUsingIoUring());
+    checkSendReceive(*session);
+    checkBatch(*session);
+}
+
+TEST(IoUringSessionUnitTests, LargeFrames)
+{
+    ss::IoUringOptions options;
+    options.bufferSize = 256;
+    std::unique_ptr<ss::IoUringSession> session = createSession(options);
+    if (!session)
+    {
+        GTEST_SKIP() << "Raw sockets are not available";
+    }
+
+    // Frames larger than the buffers are sent through the socket, and truncated when received.
+    std::vector<uint8_t> frame = makeFrame(3, 1000);
+    ASSERT_EQ(session->send(frame), frame.size());
+    std::vector<uint8_t> buffer(ss::MTU_SIZE, 0);
+    do
+    {
+        buffer.resize(ss::MTU_SIZE);
+        buffer.resize(session->receive(buffer));
+    } while (!isTestFrame(buffer) || getIndex(buffer) != 3);
+    const std::size_t expected = session->isUsingIoUring() ? 256 : 1000;
+    ASSERT_EQ(buffer.size(), expected);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), frame.begin()));
+}
+
+TEST(IoUringSessionUnitTests, AsyncOperations)
+{
+    std::unique_ptr<ss::IoUringSession> session = createSession(ss::IoUringOptions());
+    if (!session)
+    {
+        GTEST_SKIP() << "Raw sockets are not available";
+    }
+    if (!session->isUsingIoUring())
+    {
+        GTEST_SKIP() << "io_uring is not available";
+    }
+
+    // The multishot receive owns the socket.
+    std::vector<uint8_t> buffer(ss::MTU_SIZE, 0);
+    const auto ignore = [](const boost::system::error_code& error, std::size_t bytes) {};
+    EXPECT_THROW(session->asyncReceive(buffer, ignore), std::logic_error);
+    EXPECT_THROW(session->asyncReceive(buffer, ignore, std::make_shared<ss::CancellationSlot>()), std::logic_error);
+    EXPECT_THROW(session->joinFanout(1, ss::FanoutMode::Hash), std::logic_error);
+
+    // Asynchronous sends go through the ring.
+    std::vector<uint8_t> request = makeFrame(7);
+    std::size_t sent = 0;
+    session->asyncSend(request, [&sent](const boost::system::error_code& error, std::size_t bytes) {
+        EXPECT_FALSE(error);
+        sent = bytes;
+    });
+    session->run(1);
+    EXPECT_EQ(sent, request.size());
+    EXPECT_NO_THROW(session->flush());
+    do
+    {
+        buffer.resize(ss::MTU_SIZE);
+        buffer.resize(session->receive(buffer));
+    } while (!isTestFrame(buffer) || getIndex(buffer) != 7);
+    EXPECT_EQ(buffer, request);
+}
+
+TEST(IoUringSessionUnitTests, Options)
+{
+    ss::IoUringOptions options;
+    options.receiveBufferCount = 0;
+    EXPECT_THROW(ss::IoUringSession("lo", options), std::invalid_argument);
+
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->intParams["Session.IoUring.EntryCount"] = 64;
+    config->intParams["Session.IoUring.ReceiveBufferCount"] = 128;
+    config->intParams["Session.IoUring.SendBufferCount"] = 32;
+    config->intParams["Session.IoUring.BufferSize"] = 4096;
+    config->boolParams["Session.IoUring.Enabled"] = false;
+    options.configure(config, "Session.IoUring");
+    EXPECT_EQ(options.entryCount, 64u);
+    EXPECT_EQ(options.receiveBufferCount, 128u);
+    EXPECT_EQ(options.sendBufferCount, 32u);
+    EXPECT_EQ(options.bufferSize, 4096u);
+    EXPECT_FALSE(options.enabled);
+
+    config->stringParams["Session.Type"] = "uring";
+    config->stringParams["Session.Interface"] = "lo";
+    try
+    {
+        std::shared_ptr<ss::Session> session = ss::Session::create(config);
+        auto uringSession = std::dynamic_pointer_cast<ss::IoUringSession>(session);
+        ASSERT_TRUE(uringSession);
+        EXPECT_FALSE(uringSession->isUsingIoUring());
+    }
+    catch (const boost::system::system_error& error)
+    {
+        GTEST_SKIP() << "Raw sockets are not available";
+    }
+}
+
+} // namespace tests
+} // namespace nts
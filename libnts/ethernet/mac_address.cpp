@@ -0,0 +1,67 @@
+#include <libnts/ethernet/mac_address.hpp>
+
+#include <cstring>
+
+namespace eth {
+
+namespace {
+
+/// Digits of the hexadecimal octets.
+const char hexDigits[] = "0123456789abcdef";
+
+} // namespace
+
+constexpr std::size_t MacAddress::maxStringSize;
+
+MacAddress::MacAddress(const std::array<uint8_t, 6>& bytes)
+{
+    memcpy(octets, bytes.data(), sizeof(octets));
+}
+
+MacAddress MacAddress::parse(const std::string& text)
+{
+    return parse(text.data(), text.size());
+}
+
+std::size_t MacAddress::format(char* outBuffer, const std::size_t capacity) const noexcept
+{
+    // Format on the stack first, since the length is only known at the end.
+    char text[maxStringSize];
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < 6; i++)
+    {
+        if (i > 0)
+        {
+            text[length++] = ':';
+        }
+        // Like ether_ntoa, octets below 0x10 have a single digit.
+        if (octets[i] >= 0x10)
+        {
+            text[length++] = hexDigits[octets[i] >> 4];
+        }
+        text[length++] = hexDigits[octets[i] & 0x0f];
+    }
+
+    if (capacity < length + 1)
+    {
+        return 0;
+    }
+    memcpy(outBuffer, text, length);
+    outBuffer[length] = '\0';
+    return length;
+}
+
+std::string MacAddress::toString() const
+{
+    char text[maxStringSize];
+    return std::string(text, format(text, sizeof(text)));
+}
+
+std::array<uint8_t, 6> MacAddress::getBytes() const
+{
+    std::array<uint8_t, 6> bytes;
+    memcpy(bytes.data(), octets, sizeof(octets));
+    return bytes;
+}
+
+} // namespace eth
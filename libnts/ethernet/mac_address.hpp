@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace eth {
+
+/// 48-bit MAC address, stored in network byte order.
+///
+/// @details A plain value type that can be parsed at compile time and formatted into a caller
+/// provided buffer, so addresses can be compared and printed from any thread without locks or
+/// allocations. Text uses the format of ether_ntoa: six hexadecimal octets separated by colons,
+/// without leading zeros.
+///
+/// @example
+/// using namespace eth::literals;
+/// constexpr MacAddress gateway = "0:15:5d:f6:7c:15"_mac;
+/// char text[MacAddress::maxStringSize];
+/// frame.getDestinationMac().format(text, sizeof(text));
+class MacAddress
+{
+public:
+    /// Size of the longest formatted address, including the null terminator.
+    static constexpr std::size_t maxStringSize{ 18 };
+
+    /// Constructor. Creates the all zeros address.
+    constexpr MacAddress() = default;
+
+    /// Constructor.
+    /// @param a, b, c, d, e, f Octets of the address, in transmission order.
+    constexpr MacAddress(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d, const uint8_t e, const uint8_t f)
+        : octets{ a, b, c, d, e, f }
+    {
+    }
+
+    /// Constructor.
+    /// @param bytes Octets of the address, in transmission order.
+    explicit MacAddress(const std::array<uint8_t, 6>& bytes);
+
+    /// Address from its text representation. Octets may be separated by colons or dashes.
+    /// @throws std::invalid_argument If the text is not a valid address. Compilation fails instead
+    /// when parsing a literal at compile time.
+    static constexpr MacAddress parse(const char* text, const std::size_t length);
+
+    /// Address from its text representation.
+    /// @throws std::invalid_argument If the text is not a valid address.
+    static MacAddress parse(const std::string& text);
+
+    /// Parse the text representation of an address without throwing.
+    /// @returns Whether the text is a valid address. The output is only written on success.
+    static constexpr bool tryParse(const char* text, const std::size_t length, MacAddress& outAddress) noexcept;
+
+    /// Write the text representation of the address to the buffer, followed by a null terminator.
+    /// @returns The length of the text, or 0 if the buffer is too small.
+    std::size_t format(char* outBuffer, const std::size_t capacity) const noexcept;
+
+    /// Text representation of the address.
+    std::string toString() const;
+
+    /// Octets of the address, in transmission order.
+    std::array<uint8_t, 6> getBytes() const;
+
+    /// Octet at the given position, in transmission order.
+    constexpr uint8_t operator[](const std::size_t index) const
+    {
+        return octets[index];
+    }
+
+    /// Whether the address is ff:ff:ff:ff:ff:ff.
+    constexpr bool isBroadcast() const
+    {
+        return (octets[0] & octets[1] & octets[2] & octets[3] & octets[4] & octets[5]) == 0xff;
+    }
+
+    /// Whether the group bit of the address is set.
+    constexpr bool isMulticast() const
+    {
+        return (octets[0] & 0x01) != 0;
+    }
+
+    constexpr bool operator==(const MacAddress& other) const
+    {
+        return octets[0] == other.octets[0] && octets[1] == other.octets[1] && octets[2] == other.octets[2]
+            && octets[3] == other.octets[3] && octets[4] == other.octets[4] && octets[5] == other.octets[5];
+    }
+
+    constexpr bool operator!=(const MacAddress& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    /// Value of a hexadecimal digit, or -1.
+    static constexpr int hexValue(const char digit);
+
+    /// Octets of the address, in transmission order.
+    uint8_t octets[6]{};
+};
+
+constexpr int MacAddress::hexValue(const char digit)
+{
+    return (digit >= '0' && digit <= '9') ? digit - '0'
+        : (digit >= 'a' && digit <= 'f')  ? digit - 'a' + 10
+        : (digit >= 'A' && digit <= 'F')  ? digit - 'A' + 10
+                                          : -1;
+}
+
+constexpr bool MacAddress::tryParse(const char* text, const std::size_t length, MacAddress& outAddress) noexcept
+{
+    MacAddress address;
+    std::size_t position = 0;
+    for (std::size_t i = 0; i < 6; i++)
+    {
+        if (i > 0)
+        {
+            if (position >= length || (text[position] != ':' && text[position] != '-'))
+            {
+                return false;
+            }
+            position++;
+        }
+
+        // Each octet has one or two digits.
+        int value = 0;
+        std::size_t digits = 0;
+        while (position < length && digits < 2 && hexValue(text[position]) >= 0)
+        {
+            value = value * 16 + hexValue(text[position]);
+            position++;
+            digits++;
+        }
+        if (digits == 0)
+        {
+            return false;
+        }
+        address.octets[i] = static_cast<uint8_t>(value);
+    }
+    if (position != length)
+    {
+        return false;
+    }
+    outAddress = address;
+    return true;
+}
+
+constexpr MacAddress MacAddress::parse(const char* text, const std::size_t length)
+{
+    MacAddress address;
+    if (!tryParse(text, length, address))
+    {
+        throw std::invalid_argument("Invalid MAC address");
+    }
+    return address;
+}
+
+namespace literals {
+
+/// MAC address literal, parsed at compile time when used in a constant expression.
+constexpr MacAddress operator"" _mac(const char* text, const std::size_t length)
+{
+    return MacAddress::parse(text, length);
+}
+
+} // namespace literals
+
+} // namespace eth
@@ -0,0 +1,80 @@
+#include <cstring>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include <libnts/ethernet/mac_address.hpp>
+
+namespace eth {
+namespace tests {
+
+using namespace eth::literals;
+
+TEST(MacAddressUnitTests, Parsing)
+{
+    // Literals are parsed at compile time.
+    constexpr MacAddress address = "0:15:5d:F6:7c:15"_mac;
+    static_assert(address[0] == 0x00 && address[3] == 0xf6 && address[5] == 0x15, "Literal was not parsed");
+    EXPECT_EQ(address, MacAddress(0x00, 0x15, 0x5d, 0xf6, 0x7c, 0x15));
+    EXPECT_EQ(MacAddress::parse("00-15-5d-f6-7c-15"), address);
+
+    MacAddress parsed;
+    EXPECT_FALSE(MacAddress::tryParse("0:15:5d:f6:7c", 13, parsed));
+    EXPECT_FALSE(MacAddress::tryParse("0:15:5d:f6:7c:15:", 17, parsed));
+    EXPECT_FALSE(MacAddress::tryParse("0:15:5d:f6:7c:150", 17, parsed));
+    EXPECT_FALSE(MacAddress::tryParse("0:15:5d:g6:7c:15", 16, parsed));
+    EXPECT_EQ(parsed, MacAddress());
+    EXPECT_THROW(MacAddress::parse(std::string("0::5d:f6:7c:15")), std::invalid_argument);
+
+    EXPECT_TRUE("ff:ff:ff:ff:ff:ff"_mac.isBroadcast());
+    EXPECT_TRUE("1:0:5e:0:0:1"_mac.isMulticast());
+    EXPECT_FALSE(address.isMulticast());
+}
+
+TEST(MacAddressUnitTests, Formatting)
+{
+    // Same format as ether_ntoa.
+    EXPECT_EQ("0:15:5d:f6:7c:15"_mac.toString(), "0:15:5d:f6:7c:15");
+    EXPECT_EQ(MacAddress().toString(), "0:0:0:0:0:0");
+
+    char text[MacAddress::maxStringSize];
+    EXPECT_EQ("ff:ff:ff:ff:ff:ff"_mac.format(text, sizeof(text)), 17);
+    EXPECT_STREQ(text, "ff:ff:ff:ff:ff:ff");
+
+    // Doesn't fit with the null terminator.
+    EXPECT_EQ("ff:ff:ff:ff:ff:ff"_mac.format(text, 17), 0);
+}
+
+TEST(MacAddressUnitTests, Threads)
+{
+    // Formatting keeps no shared state, so threads don't see each other's addresses.
+    std::vector<std::thread> threads;
+    std::vector<bool> results(8, false);
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        threads.emplace_back([i, &results]() {
+            const MacAddress address(0, 0, 0, 0, 0, static_cast<uint8_t>(i));
+            char expected[MacAddress::maxStringSize];
+            address.format(expected, sizeof(expected));
+            bool matches = true;
+            for (int j = 0; j < 10000; j++)
+            {
+                char text[MacAddress::maxStringSize];
+                address.format(text, sizeof(text));
+                matches = matches && std::string(text) == expected && MacAddress::parse(text, strlen(text)) == address;
+            }
+            results[i] = matches;
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        EXPECT_TRUE(results[i]);
+    }
+}
+
+} // namespace tests
+} // namespace eth
@@ -1,22 +1,46 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <net/ethernet.h>
 #include <netpacket/packet.h>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
 
+#include <libnts/capture/capture_writer.hpp>
 #include <libnts/ethernet/raw_session.hpp>
 
 namespace nts {
 namespace ss {
 
+namespace {
+
+/// Size of the buffers that objects are serialized into. Fits any frame the socket can carry.
+constexpr std::size_t frameBufferSize{ 65536 };
+
+} // namespace
+
 RawSession::RawSession()
-    : socket(ioContext, raw_protocol_t(PF_PACKET, SOCK_RAW))
+    : RawSession("eth0")
+{
+}
+
+RawSession::RawSession(const std::string& interface)
+    : RawSession(interface, std::make_shared<boost::asio::io_context>())
 {
-    std::string ifname("eth0");
+}
 
+RawSession::RawSession(const std::string& interface, std::shared_ptr<boost::asio::io_context> context)
+    : ioContext(context)
+    , socket(*context, raw_protocol_t(PF_PACKET, SOCK_RAW))
+    , sendBuffer(frameBufferSize, 0)
+    , receiveBuffer(frameBufferSize, 0)
+{
     sockaddr_ll sockaddr;
     memset(&sockaddr, 0, sizeof(sockaddr));
     sockaddr.sll_family = PF_PACKET;
     sockaddr.sll_protocol = htons(ETH_P_ALL);
-    sockaddr.sll_ifindex = if_nametoindex(ifname.c_str());
+    sockaddr.sll_ifindex = if_nametoindex(interface.c_str());
     sockaddr.sll_hatype = 1;
 
     socket.bind(raw_endpoint_t(&sockaddr, sizeof(sockaddr)));
@@ -31,15 +55,15 @@ std::size_t RawSession::send(std::vector<uint8_t>& inData)
 
 std::size_t RawSession::send(Serializable& inData)
 {
-    // The buffer will hold the data to send.
-    boost::asio::streambuf buffer;
-    std::ostream os(&buffer);
-
-    // Add the contents of the message to the buffer.
-    inData.toStream(os);
+    // Write the object into the reusable buffer.
+    const std::size_t size = inData.serialize(sendBuffer.data(), sendBuffer.size());
+    if (size == 0)
+    {
+        return 0;
+    }
 
     // Send the data through the socket.
-    const std::size_t bytes = socket.send(buffer.data());
+    const std::size_t bytes = socket.send(boost::asio::buffer(sendBuffer.data(), size));
     return bytes;
 }
 
@@ -47,23 +71,340 @@ std::size_t RawSession::receive(std::vector<uint8_t>& outData)
 {
     // Read data from the socket.
     const std::size_t bytes = socket.receive(boost::asio::buffer(outData));
+    if (captureWriter)
+    {
+        captureWriter->capture(outData.data(), bytes);
+    }
     return bytes;
 }
 
 std::size_t RawSession::receive(Serializable& outData)
 {
-    // The buffer will hold the data.
-    boost::asio::streambuf buffer;
-
-    // Read data from the socket into the buffer.
-    const std::size_t bytes = socket.receive(buffer.prepare(MTU_SIZE));
+    // Read data from the socket into the reusable buffer.
+    const std::size_t bytes = socket.receive(boost::asio::buffer(receiveBuffer));
+    if (captureWriter)
+    {
+        captureWriter->capture(receiveBuffer.data(), bytes);
+    }
 
-    // Get the message from the buffer.
-    std::istream is(&buffer);
-    outData.fromStream(is);
+    // Get the object from the buffer.
+    outData.deserialize(receiveBuffer.data(), bytes);
 
     return bytes;
 }
 
+std::size_t RawSession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    messages.resize(inFrames.size());
+    vectors.resize(inFrames.size());
+    for (std::size_t i = 0; i < inFrames.size(); i++)
+    {
+        vectors[i].iov_base = inFrames[i].data();
+        vectors[i].iov_len = inFrames[i].size();
+        memset(&messages[i], 0, sizeof(mmsghdr));
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // The kernel may accept only part of the batch, so keep going until every frame is sent.
+    std::size_t framesSent = 0;
+    while (framesSent < inFrames.size())
+    {
+        const int result = sendmmsg(socket.native_handle(), &messages[framesSent], inFrames.size() - framesSent, 0);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // The frames before the failed one went out, so they are reported instead.
+            if (framesSent == 0)
+            {
+                throw boost::system::system_error(errno, boost::system::system_category(), "sendmmsg");
+            }
+            break;
+        }
+        framesSent += result;
+    }
+    return framesSent;
+}
+
+std::size_t RawSession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    const std::size_t frameCount = std::min(maxFrames, outFrames.size());
+    messages.resize(frameCount);
+    vectors.resize(frameCount);
+    for (std::size_t i = 0; i < frameCount; i++)
+    {
+        vectors[i].iov_base = outFrames[i].data();
+        vectors[i].iov_len = outFrames[i].size();
+        memset(&messages[i], 0, sizeof(mmsghdr));
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Wait for the first frame, then take whatever else is already queued.
+    const int result = recvmmsg(socket.native_handle(), messages.data(), frameCount, MSG_WAITFORONE, nullptr);
+    if (result < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "recvmmsg");
+    }
+
+    for (int i = 0; i < result; i++)
+    {
+        outFrames[i].resize(messages[i].msg_len);
+        if (captureWriter)
+        {
+            captureWriter->capture(outFrames[i].data(), messages[i].msg_len);
+        }
+    }
+    return result;
+}
+
+void RawSession::asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler)
+{
+    socket.async_send(boost::asio::buffer(inData), handler);
+}
+
+void RawSession::asyncSend(Serializable& inData, CompletionHandler handler)
+{
+    // The buffer must outlive the operation, so it is owned by the completion handler.
+    auto buffer = std::make_shared<std::vector<uint8_t>>(frameBufferSize, 0);
+    const std::size_t size = inData.serialize(buffer->data(), buffer->size());
+    if (size == 0)
+    {
+        // Objects that don't fit are not sent.
+        boost::asio::post(*ioContext, [handler]() { handler(boost::system::error_code(), 0); });
+        return;
+    }
+
+    socket.async_send(boost::asio::buffer(buffer->data(), size), [buffer, handler](const boost::system::error_code& error, std::size_t bytes) {
+        handler(error, bytes);
+    });
+}
+
+void RawSession::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler)
+{
+    if (!captureWriter)
+    {
+        socket.async_receive(boost::asio::buffer(outData), handler);
+        return;
+    }
+    std::shared_ptr<cap::CaptureWriter> writer = captureWriter;
+    socket.async_receive(boost::asio::buffer(outData), [writer, &outData, handler](const boost::system::error_code& error, std::size_t bytes) {
+        if (!error)
+        {
+            writer->capture(outData.data(), bytes);
+        }
+        handler(error, bytes);
+    });
+}
+
+void RawSession::asyncReceive(Serializable& outData, CompletionHandler handler)
+{
+    auto buffer = std::make_shared<std::vector<uint8_t>>(frameBufferSize, 0);
+    std::shared_ptr<cap::CaptureWriter> writer = captureWriter;
+    socket.async_receive(boost::asio::buffer(*buffer), [buffer, writer, &outData, handler](const boost::system::error_code& error, std::size_t bytes) {
+        if (!error)
+        {
+            if (writer)
+            {
+                writer->capture(buffer->data(), bytes);
+            }
+
+            // Get the object from the buffer.
+            outData.deserialize(buffer->data(), bytes);
+        }
+        handler(error, bytes);
+    });
+}
+
+void RawSession::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    std::shared_ptr<cap::CaptureWriter> writer = captureWriter;
+    const int fd = socket.native_handle();
+    ReceiveAttempt attempt = [fd, writer, &outData](std::size_t& bytes) {
+        const ssize_t result = recv(fd, outData.data(), outData.size(), MSG_DONTWAIT);
+        if (result < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return false;
+            }
+            throw boost::system::system_error(errno, boost::system::system_category(), "recv");
+        }
+        bytes = static_cast<std::size_t>(result);
+        if (writer)
+        {
+            writer->capture(outData.data(), bytes);
+        }
+        return true;
+    };
+    asyncReceiveWhenReadable(attempt, handler, slot);
+}
+
+void RawSession::asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    auto buffer = std::make_shared<std::vector<uint8_t>>(frameBufferSize, 0);
+    std::shared_ptr<cap::CaptureWriter> writer = captureWriter;
+    const int fd = socket.native_handle();
+    ReceiveAttempt attempt = [fd, buffer, writer, &outData](std::size_t& bytes) {
+        const ssize_t result = recv(fd, buffer->data(), buffer->size(), MSG_DONTWAIT);
+        if (result < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return false;
+            }
+            throw boost::system::system_error(errno, boost::system::system_category(), "recv");
+        }
+        bytes = static_cast<std::size_t>(result);
+        if (writer)
+        {
+            writer->capture(buffer->data(), bytes);
+        }
+        outData.deserialize(buffer->data(), bytes);
+        return true;
+    };
+    asyncReceiveWhenReadable(attempt, handler, slot);
+}
+
+void RawSession::asyncReceiveWhenReadable(ReceiveAttempt attempt, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    // The duplicate descriptor shares the socket, but its operations are cancelled on their own.
+    const int fd = dup(socket.native_handle());
+    if (fd < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "dup");
+    }
+    auto pending = std::make_shared<PendingReceive>(*ioContext, fd, attempt, handler);
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingReceives.erase(std::remove_if(pendingReceives.begin(), pendingReceives.end(),
+                                             [](const std::weak_ptr<PendingReceive>& entry) { return entry.expired(); }),
+                              pendingReceives.end());
+        pendingReceives.push_back(pending);
+    }
+    boost::asio::post(pending->waiter.get_executor(), [pending]() { receiveOrWait(pending); });
+    slot->assign([pending]() { cancelReceive(pending); });
+}
+
+void RawSession::receiveOrWait(std::shared_ptr<PendingReceive> pending)
+{
+    if (pending->cancelled)
+    {
+        pending->handler(boost::asio::error::operation_aborted, 0);
+        return;
+    }
+    std::size_t bytes = 0;
+    try
+    {
+        if (pending->attempt(bytes))
+        {
+            pending->handler(boost::system::error_code(), bytes);
+            return;
+        }
+    }
+    catch (const boost::system::system_error& error)
+    {
+        pending->handler(error.code(), 0);
+        return;
+    }
+
+    // Try again once the socket is readable, unless the operation is cancelled first.
+    pending->waiter.async_wait(boost::asio::posix::descriptor_base::wait_read, [pending](const boost::system::error_code& error) {
+        if (error && !pending->cancelled)
+        {
+            pending->handler(error, 0);
+            return;
+        }
+        receiveOrWait(pending);
+    });
+}
+
+void RawSession::cancelReceive(std::shared_ptr<PendingReceive> pending)
+{
+    // Attempts that already started on the strand may still complete the operation.
+    if (!pending->cancelled.exchange(true))
+    {
+        boost::asio::post(pending->waiter.get_executor(), [pending]() { pending->waiter.cancel(); });
+    }
+}
+
+void RawSession::cancel()
+{
+    socket.cancel();
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    for (const auto& entry : pendingReceives)
+    {
+        if (auto pending = entry.lock())
+        {
+            cancelReceive(pending);
+        }
+    }
+    pendingReceives.clear();
+}
+
+RawSession::PendingReceive::PendingReceive(boost::asio::io_context& context, const int fd, ReceiveAttempt attempt, CompletionHandler handler)
+    : waiter(boost::asio::make_strand(context), fd)
+    , attempt(attempt)
+    , handler(handler)
+{
+}
+
+std::shared_ptr<boost::asio::io_context> RawSession::getContext() const
+{
+    return ioContext;
+}
+
+std::size_t RawSession::run(const std::size_t threadCount)
+{
+    // The context may have run out of work before, in which case it must be restarted.
+    ioContext->restart();
+
+    std::vector<std::thread> pool;
+    std::atomic<std::size_t> handlers{ 0 };
+    for (std::size_t i = 1; i < threadCount; i++)
+    {
+        pool.emplace_back([this, &handlers]() { handlers += ioContext->run(); });
+    }
+    handlers += ioContext->run();
+
+    for (auto& thread : pool)
+    {
+        thread.join();
+    }
+    return handlers;
+}
+
+void RawSession::joinFanout(const uint16_t groupId, const FanoutMode mode)
+{
+    const int fanout = groupId | (static_cast<int>(mode) << 16);
+    if (setsockopt(socket.native_handle(), SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "PACKET_FANOUT");
+    }
+}
+
+bool RawSession::waitForFrames(const std::chrono::milliseconds timeout)
+{
+    pollfd descriptor;
+    descriptor.fd = socket.native_handle();
+    descriptor.events = POLLIN;
+    descriptor.revents = 0;
+    return poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0;
+}
+
+void RawSession::setCaptureWriter(std::shared_ptr<cap::CaptureWriter> writer)
+{
+    captureWriter = writer;
+}
+
+std::shared_ptr<cap::CaptureWriter> RawSession::getCaptureWriter() const
+{
+    return captureWriter;
+}
+
 } // namespace ss
 } // namespace nts
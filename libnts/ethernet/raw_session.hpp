@@ -1,22 +1,71 @@
 #pragma once
 
+#include <atomic>
 #include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <sys/socket.h>
 
 #include <libnts/core/session.hpp>
 
 namespace nts {
+
+// Forward declaration.
+namespace cap {
+class CaptureWriter;
+}
+
 namespace ss {
 
 typedef boost::asio::generic::raw_protocol raw_protocol_t;
 typedef boost::asio::generic::basic_endpoint<raw_protocol_t> raw_endpoint_t;
 
+/// Algorithms used by PACKET_FANOUT to distribute frames among the sessions of a group.
+enum class FanoutMode : uint16_t
+{
+    /// Frames of the same flow go to the same session (PACKET_FANOUT_HASH).
+    Hash = 0,
+    /// Frames are distributed in turns (PACKET_FANOUT_LB).
+    RoundRobin = 1,
+    /// Frames go to the session with the same index as the receiving CPU (PACKET_FANOUT_CPU).
+    Cpu = 2,
+    /// Frames go to the next session once the current one is full (PACKET_FANOUT_ROLLOVER).
+    Rollover = 3,
+    /// Frames go to a random session (PACKET_FANOUT_RND).
+    Random = 4,
+    /// Frames go to the session matching the receive queue of the NIC (PACKET_FANOUT_QM).
+    QueueMapping = 5,
+};
+
 /// Communicate using raw sockets.
+///
+/// @details Asynchronous operations are serviced by the session's io_context. Several
+/// sessions can share the same context, and the context can be run on a pool of threads
+/// with run(), so that many exchanges progress concurrently without a thread per session.
+///
+/// @example
+/// auto context = std::make_shared<boost::asio::io_context>();
+/// RawSession sessionA("eth0", context);
+/// RawSession sessionB("eth1", context);
+/// sessionA.asyncReceive(replyA, handlerA);
+/// sessionB.asyncReceive(replyB, handlerB);
+/// sessionA.run(4); // Services both sessions with four threads.
 class RawSession : public Session
 {
 public:
-    /// Constructor.
+    /// Constructor. Binds the session to the "eth0" interface.
     RawSession();
 
+    /// Constructor.
+    /// @param interface Name of the network interface to bind to.
+    explicit RawSession(const std::string& interface);
+
+    /// Constructor.
+    /// @param interface Name of the network interface to bind to.
+    /// @param context Services the asynchronous operations of the session.
+    RawSession(const std::string& interface, std::shared_ptr<boost::asio::io_context> context);
+
     /// Deconstructor.
     ~RawSession() = default;
 
@@ -24,6 +73,7 @@ public:
     virtual std::size_t send(std::vector<uint8_t>& inData);
 
     /// Send object to the network.
+    /// @returns The size of the object, or 0 if it could not be serialized.
     virtual std::size_t send(Serializable& inData);
 
     /// Receive data from the network.
@@ -33,12 +83,129 @@ public:
     /// Receive object from the network.
     virtual std::size_t receive(Serializable& outData);
 
-private:
+    /// Send several frames to the network with a single system call (sendmmsg).
+    /// @returns The number of frames sent, which stops at the first frame that fails.
+    /// @throws boost::system::system_error If the first frame can't be sent.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive the available frames from the network with a single system call (recvmmsg).
+    /// @details Blocks until at least one frame is received.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Start sending data to the network.
+    virtual void asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler);
+
+    /// Start sending an object to the network.
+    virtual void asyncSend(Serializable& inData, CompletionHandler handler);
+
+    /// Start receiving data from the network.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler);
+
+    /// Start receiving an object from the network.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler);
+
+    /// Start receiving data from the network, with a slot that cancels only this operation.
+    /// @details The operation waits on a duplicate of the socket's descriptor, so that it can
+    /// be cancelled without affecting the operations that wait on the socket.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Start receiving an object from the network, with a slot that cancels only this operation.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Cancel all outstanding asynchronous operations, including those started with a slot.
+    virtual void cancel();
+
+    /// Context that services the asynchronous operations of the session.
+    std::shared_ptr<boost::asio::io_context> getContext() const;
+
+    /// Run the context on a pool of threads until every asynchronous operation completes.
+    /// @details The calling thread is part of the pool. When the context is shared, it must not
+    /// be running on other threads already.
+    /// @param threadCount Number of threads in the pool.
+    /// @returns The number of handlers that were executed.
+    std::size_t run(const std::size_t threadCount);
+
+    /// Join a PACKET_FANOUT group, sharing the received frames with the other sessions of
+    /// the group.
+    /// @param groupId Identifier of the group. Sessions with the same id share the traffic.
+    /// @param mode How the frames are distributed. Must be the same for the whole group.
+    /// @throws boost::system::system_error If the session cannot join the group.
+    virtual void joinFanout(const uint16_t groupId, const FanoutMode mode);
+
+    /// Wait until a frame can be received without blocking.
+    /// @returns Whether a frame is available before the timeout expires.
+    virtual bool waitForFrames(const std::chrono::milliseconds timeout);
+
+    /// Record every frame received by the session.
+    /// @details Frames are copied into the writer on the receiving thread. The writer accepts
+    /// frames from a single thread, so asynchronous receives should then be serviced by a
+    /// single thread too.
+    /// @param writer Writer of the capture, or nullptr to stop recording.
+    void setCaptureWriter(std::shared_ptr<cap::CaptureWriter> writer);
+
+    /// Writer of the frames received by the session, if any.
+    std::shared_ptr<cap::CaptureWriter> getCaptureWriter() const;
+
+protected:
+    /// Receives a frame without blocking, and returns false if there is none.
+    typedef std::function<bool(std::size_t& bytes)> ReceiveAttempt;
+
+    /// Start receiving with the attempt each time the socket becomes readable, until it
+    /// receives a frame or the slot cancels the operation.
+    void asyncReceiveWhenReadable(ReceiveAttempt attempt, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
     /// Manages asynchronous send and receive operations.
-    boost::asio::io_context ioContext;
+    std::shared_ptr<boost::asio::io_context> ioContext;
 
     /// Handles communication with the physical network layer.
     raw_protocol_t::socket socket;
+
+    /// Records the received frames.
+    std::shared_ptr<cap::CaptureWriter> captureWriter;
+
+private:
+    /// Receive started with a slot, which waits for the socket on a descriptor of its own.
+    struct PendingReceive
+    {
+        PendingReceive(boost::asio::io_context& context, const int fd, ReceiveAttempt attempt, CompletionHandler handler);
+
+        /// Duplicate of the socket's descriptor. Its handlers run on a strand, so that the
+        /// operation can be cancelled from any thread.
+        boost::asio::posix::basic_stream_descriptor<boost::asio::strand<boost::asio::io_context::executor_type>> waiter;
+
+        /// Receives the frame once the socket is readable.
+        ReceiveAttempt attempt;
+
+        /// Called once the operation completes.
+        CompletionHandler handler;
+
+        /// Whether the operation was cancelled.
+        std::atomic<bool> cancelled{ false };
+    };
+
+    /// Receive with the attempt, or wait until the socket is readable and try again.
+    static void receiveOrWait(std::shared_ptr<PendingReceive> pending);
+
+    /// Abort the operation, unless it already completed.
+    static void cancelReceive(std::shared_ptr<PendingReceive> pending);
+
+    /// Protects the pending receives.
+    std::mutex pendingMutex;
+
+    /// Outstanding operations that were started with a slot.
+    std::vector<std::weak_ptr<PendingReceive>> pendingReceives;
+
+    /// Message headers reused by the batch operations.
+    std::vector<mmsghdr> messages;
+
+    /// Scatter/gather vectors reused by the batch operations.
+    std::vector<iovec> vectors;
+
+    /// Objects are serialized into this buffer before being sent.
+    std::vector<uint8_t> sendBuffer;
+
+    /// Frames are received into this buffer before objects are deserialized from them.
+    std::vector<uint8_t> receiveBuffer;
 };
 
 } // namespace ss
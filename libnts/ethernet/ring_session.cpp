@@ -0,0 +1,568 @@
+#include <libnts/ethernet/ring_session.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <linux/if_packet.h>
+#include <stdexcept>
+#include <sys/mman.h>
+
+#include <libnts/capture/capture_writer.hpp>
+#include <libnts/config/configuration.hpp>
+
+namespace nts {
+namespace ss {
+
+RingGeometry& RingGeometry::configure(std::shared_ptr<Configuration> config, const std::string& key)
+{
+    if (auto size = config->getInt(key + ".BlockSize"))
+    {
+        blockSize = size.value();
+    }
+    if (auto count = config->getInt(key + ".BlockCount"))
+    {
+        blockCount = count.value();
+    }
+    if (auto size = config->getInt(key + ".FrameSize"))
+    {
+        frameSize = size.value();
+    }
+    if (auto timeout = config->getInt(key + ".RetireTimeout"))
+    {
+        retireTimeout = timeout.value();
+    }
+    return *this;
+}
+
+namespace {
+
+/// Geometry of a ring that is not created.
+RingGeometry disabledRing()
+{
+    RingGeometry geometry;
+    geometry.blockCount = 0;
+    return geometry;
+}
+
+/// Ask the kernel to create a TPACKET_V3 ring with the given geometry.
+void requestRing(const int fd, const int option, const RingGeometry& geometry)
+{
+    tpacket_req3 request;
+    memset(&request, 0, sizeof(request));
+    request.tp_block_size = geometry.blockSize;
+    request.tp_block_nr = geometry.blockCount;
+    request.tp_frame_size = geometry.frameSize;
+    request.tp_frame_nr = (geometry.blockSize / geometry.frameSize) * geometry.blockCount;
+
+    // Transmit rings don't support block retirement.
+    if (option == PACKET_RX_RING)
+    {
+        request.tp_retire_blk_tov = geometry.retireTimeout;
+    }
+
+    if (setsockopt(fd, SOL_PACKET, option, &request, sizeof(request)) < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(),
+            option == PACKET_RX_RING ? "PACKET_RX_RING" : "PACKET_TX_RING");
+    }
+}
+
+/// Offset of the frame data from the start of a transmit slot.
+constexpr std::size_t slotDataOffset{ TPACKET_ALIGN(sizeof(tpacket3_hdr)) };
+
+} // namespace
+
+RingSession::RingSession(const std::string& interface, const RingGeometry& rxGeometry)
+    : RingSession(interface, rxGeometry, disabledRing())
+{
+}
+
+RingSession::RingSession(const std::string& interface, const RingGeometry& rxGeometry, const RingGeometry& txGeometry)
+    : RawSession(interface)
+    , rxGeometry(rxGeometry)
+    , txGeometry(txGeometry)
+{
+    const int fd = socket.native_handle();
+
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "PACKET_VERSION");
+    }
+
+    const std::size_t rxSize = static_cast<std::size_t>(rxGeometry.blockSize) * rxGeometry.blockCount;
+    const std::size_t txSize = static_cast<std::size_t>(txGeometry.blockSize) * txGeometry.blockCount;
+    if (rxSize > 0)
+    {
+        requestRing(fd, PACKET_RX_RING, rxGeometry);
+    }
+    if (txSize > 0)
+    {
+        requestRing(fd, PACKET_TX_RING, txGeometry);
+    }
+
+    // Both rings are mapped at once, with the transmit ring after the receive ring.
+    ringSize = rxSize + txSize;
+    if (ringSize == 0)
+    {
+        return;
+    }
+    void* mapping = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "mmap");
+    }
+    ring = static_cast<uint8_t*>(mapping);
+
+    if (txSize > 0)
+    {
+        txRing = ring + rxSize;
+        slotCount = (txGeometry.blockSize / txGeometry.frameSize) * txGeometry.blockCount;
+    }
+}
+
+RingSession::~RingSession()
+{
+    if (ring)
+    {
+        munmap(ring, ringSize);
+    }
+}
+
+std::size_t RingSession::send(std::vector<uint8_t>& inData)
+{
+    if (!txRing)
+    {
+        return RawSession::send(inData);
+    }
+
+    // Empty frames would queue a slot with nothing to send.
+    if (inData.empty())
+    {
+        return 0;
+    }
+
+    // Copy the data into the next slot of the ring.
+    const boost::asio::mutable_buffer slot = acquireSlot();
+    if (inData.size() > slot.size())
+    {
+        return 0;
+    }
+    memcpy(slot.data(), inData.data(), inData.size());
+    commitSlot(inData.size());
+    return inData.size();
+}
+
+std::size_t RingSession::send(Serializable& inData)
+{
+    if (!txRing)
+    {
+        return RawSession::send(inData);
+    }
+
+    // Serialize the object directly into the next slot of the ring.
+    const boost::asio::mutable_buffer slot = acquireSlot();
+    const std::size_t bytes = inData.serialize(static_cast<uint8_t*>(slot.data()), slot.size());
+    if (bytes == 0)
+    {
+        return 0;
+    }
+    commitSlot(bytes);
+    return bytes;
+}
+
+std::size_t RingSession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    if (!txRing)
+    {
+        return RawSession::sendBatch(inFrames);
+    }
+
+    // Queue every frame without flushing, then hand them to the kernel at once. The batch
+    // stops at the first frame that isn't sent, so the count is a prefix of the batch.
+    const std::size_t threshold = flushThreshold;
+    flushThreshold = 0;
+    std::size_t framesSent = 0;
+    try
+    {
+        for (auto& frame : inFrames)
+        {
+            if (frame.empty() || send(frame) < frame.size())
+            {
+                break;
+            }
+            framesSent++;
+        }
+        flushThreshold = threshold;
+        flush();
+    }
+    catch (...)
+    {
+        // Later sends would never be flushed without the threshold.
+        flushThreshold = threshold;
+        throw;
+    }
+    return framesSent;
+}
+
+std::size_t RingSession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::receiveBatch(outFrames, maxFrames);
+    }
+
+    // Wait for the first frame, then take the remaining frames of the same block.
+    const std::size_t frameCount = std::min(maxFrames, outFrames.size());
+    std::size_t framesReceived = 0;
+    while (framesReceived < frameCount && (framesReceived == 0 || framesLeft > 0))
+    {
+        auto& frame = outFrames[framesReceived++];
+        frame.resize(receive(frame));
+    }
+    return framesReceived;
+}
+
+std::size_t RingSession::receive(std::vector<uint8_t>& outData)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::receive(outData);
+    }
+
+    // Copy the next frame out of the ring.
+    const boost::asio::const_buffer frame = nextFrame();
+    const std::size_t bytes = std::min(frame.size(), outData.size());
+    memcpy(outData.data(), frame.data(), bytes);
+    return bytes;
+}
+
+std::size_t RingSession::receive(Serializable& outData)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::receive(outData);
+    }
+
+    // Read the object directly from the ring.
+    const boost::asio::const_buffer frame = nextFrame();
+    outData.deserialize(static_cast<const uint8_t*>(frame.data()), frame.size());
+    return frame.size();
+}
+
+std::size_t RingSession::receiveBlock(std::vector<boost::asio::const_buffer>& outFrames)
+{
+    if (!rxGeometry.blockCount)
+    {
+        throw std::logic_error("RingSession has no receive ring");
+    }
+
+    // Keep the held block if some of its frames were not read yet.
+    if (framesLeft == 0)
+    {
+        releaseBlock();
+    }
+    waitForBlock();
+
+    outFrames.clear();
+    outFrames.reserve(framesLeft);
+    while (framesLeft > 0)
+    {
+        outFrames.push_back(nextFrame());
+    }
+    return outFrames.size();
+}
+
+void RingSession::asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler)
+{
+    if (!txRing)
+    {
+        return RawSession::asyncSend(inData, handler);
+    }
+
+    const std::size_t bytes = send(inData);
+    boost::asio::post(*ioContext, [handler, bytes]() { handler(boost::system::error_code(), bytes); });
+}
+
+void RingSession::asyncSend(Serializable& inData, CompletionHandler handler)
+{
+    if (!txRing)
+    {
+        return RawSession::asyncSend(inData, handler);
+    }
+
+    const std::size_t bytes = send(inData);
+    boost::asio::post(*ioContext, [handler, bytes]() { handler(boost::system::error_code(), bytes); });
+}
+
+void RingSession::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::asyncReceive(outData, handler);
+    }
+
+    if (waitForFrames(std::chrono::milliseconds(0)))
+    {
+        const std::size_t bytes = receive(outData);
+        boost::asio::post(*ioContext, [handler, bytes]() { handler(boost::system::error_code(), bytes); });
+        return;
+    }
+
+    // Try again once the kernel retires a block.
+    socket.async_wait(raw_protocol_t::socket::wait_read, [this, &outData, handler](const boost::system::error_code& error) {
+        if (error)
+        {
+            handler(error, 0);
+            return;
+        }
+        asyncReceive(outData, handler);
+    });
+}
+
+void RingSession::asyncReceive(Serializable& outData, CompletionHandler handler)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::asyncReceive(outData, handler);
+    }
+
+    if (waitForFrames(std::chrono::milliseconds(0)))
+    {
+        const std::size_t bytes = receive(outData);
+        boost::asio::post(*ioContext, [handler, bytes]() { handler(boost::system::error_code(), bytes); });
+        return;
+    }
+
+    // Try again once the kernel retires a block.
+    socket.async_wait(raw_protocol_t::socket::wait_read, [this, &outData, handler](const boost::system::error_code& error) {
+        if (error)
+        {
+            handler(error, 0);
+            return;
+        }
+        asyncReceive(outData, handler);
+    });
+}
+
+void RingSession::asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::asyncReceive(outData, handler, slot);
+    }
+    asyncReceiveWhenReadable(
+        [this, &outData](std::size_t& bytes) {
+            if (!waitForFrames(std::chrono::milliseconds(0)))
+            {
+                return false;
+            }
+            bytes = receive(outData);
+            return true;
+        },
+        handler, slot);
+}
+
+void RingSession::asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::asyncReceive(outData, handler, slot);
+    }
+    asyncReceiveWhenReadable(
+        [this, &outData](std::size_t& bytes) {
+            if (!waitForFrames(std::chrono::milliseconds(0)))
+            {
+                return false;
+            }
+            bytes = receive(outData);
+            return true;
+        },
+        handler, slot);
+}
+
+bool RingSession::waitForFrames(const std::chrono::milliseconds timeout)
+{
+    if (!rxGeometry.blockCount)
+    {
+        return RawSession::waitForFrames(timeout);
+    }
+    if (framesLeft > 0)
+    {
+        return true;
+    }
+
+    // Frames are available once the kernel retires the next block.
+    releaseBlock();
+    auto* block = reinterpret_cast<tpacket_block_desc*>(ring + static_cast<std::size_t>(blockIndex) * rxGeometry.blockSize);
+    if (__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)
+    {
+        return true;
+    }
+    return RawSession::waitForFrames(timeout);
+}
+
+void RingSession::releaseBlock()
+{
+    if (heldBlock)
+    {
+        // Make sure every read of the block happens before the kernel can reuse it.
+        __atomic_store_n(&heldBlock->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        heldBlock = nullptr;
+        nextHeader = nullptr;
+        framesLeft = 0;
+        blockIndex = (blockIndex + 1) % rxGeometry.blockCount;
+    }
+}
+
+boost::asio::mutable_buffer RingSession::acquireSlot()
+{
+    if (!txRing)
+    {
+        throw std::logic_error("RingSession has no transmit ring");
+    }
+
+    tpacket3_hdr* slot = getSlot(slotIndex);
+    for (;;)
+    {
+        const uint32_t status = __atomic_load_n(&slot->tp_status, __ATOMIC_ACQUIRE);
+        if (status == TP_STATUS_AVAILABLE)
+        {
+            break;
+        }
+        if (status & TP_STATUS_WRONG_FORMAT)
+        {
+            // The kernel rejected the frame in this slot, so it can be reused.
+            __atomic_store_n(&slot->tp_status, TP_STATUS_AVAILABLE, __ATOMIC_RELAXED);
+            break;
+        }
+        if (pendingFrames > 0)
+        {
+            // Every slot is queued, so the ring must be flushed before writing another frame.
+            flush();
+        }
+        else
+        {
+            // The kernel is still sending the frame in this slot.
+            socket.wait(raw_protocol_t::socket::wait_write);
+        }
+    }
+    return boost::asio::mutable_buffer(reinterpret_cast<uint8_t*>(slot) + slotDataOffset, txGeometry.frameSize - slotDataOffset);
+}
+
+void RingSession::commitSlot(const std::size_t length)
+{
+    tpacket3_hdr* slot = getSlot(slotIndex);
+    slot->tp_len = static_cast<uint32_t>(length);
+    slot->tp_snaplen = static_cast<uint32_t>(length);
+    slot->tp_next_offset = 0;
+    __atomic_store_n(&slot->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+    slotIndex = (slotIndex + 1) % slotCount;
+    pendingFrames++;
+    if (flushThreshold > 0 && pendingFrames >= flushThreshold)
+    {
+        flush();
+    }
+}
+
+std::size_t RingSession::flush()
+{
+    if (pendingFrames == 0)
+    {
+        return 0;
+    }
+
+    // A single call hands every queued slot to the kernel, and blocks until they are sent.
+    if (::sendto(socket.native_handle(), nullptr, 0, 0, nullptr, 0) < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "sendto");
+    }
+
+    const std::size_t frames = pendingFrames;
+    pendingFrames = 0;
+    txStatistics.flushes++;
+    txStatistics.framesFlushed += frames;
+    txStatistics.lastFlushFrames = frames;
+    return frames;
+}
+
+std::size_t RingSession::getFlushThreshold() const
+{
+    return flushThreshold;
+}
+
+RingSession& RingSession::setFlushThreshold(const std::size_t threshold)
+{
+    flushThreshold = threshold;
+    return *this;
+}
+
+const RingStatistics& RingSession::getTxStatistics() const
+{
+    return txStatistics;
+}
+
+const RingGeometry& RingSession::getRxGeometry() const
+{
+    return rxGeometry;
+}
+
+const RingGeometry& RingSession::getTxGeometry() const
+{
+    return txGeometry;
+}
+
+tpacket_block_desc* RingSession::waitForBlock()
+{
+    if (heldBlock)
+    {
+        return heldBlock;
+    }
+
+    auto* block = reinterpret_cast<tpacket_block_desc*>(ring + static_cast<std::size_t>(blockIndex) * rxGeometry.blockSize);
+    while ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+    {
+        // The socket becomes readable once the kernel retires a block.
+        socket.wait(raw_protocol_t::socket::wait_read);
+    }
+
+    heldBlock = block;
+    framesLeft = block->hdr.bh1.num_pkts;
+    nextHeader = reinterpret_cast<tpacket3_hdr*>(reinterpret_cast<uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt);
+    return heldBlock;
+}
+
+boost::asio::const_buffer RingSession::nextFrame()
+{
+    // Move on to the next block once every frame of the current one was read.
+    while (framesLeft == 0)
+    {
+        releaseBlock();
+        waitForBlock();
+    }
+
+    tpacket3_hdr* header = nextHeader;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(header) + header->tp_mac;
+
+    framesLeft--;
+    nextHeader = reinterpret_cast<tpacket3_hdr*>(reinterpret_cast<uint8_t*>(header) + header->tp_next_offset);
+
+    // Every receive path reads through here, so this is where the frames are recorded.
+    if (captureWriter)
+    {
+        const int64_t timestamp = static_cast<int64_t>(header->tp_sec) * 1000000000 + header->tp_nsec;
+        captureWriter->capture(data, header->tp_snaplen, timestamp);
+    }
+
+    return boost::asio::const_buffer(data, header->tp_snaplen);
+}
+
+tpacket3_hdr* RingSession::getSlot(const std::size_t index) const
+{
+    const std::size_t slotsPerBlock = txGeometry.blockSize / txGeometry.frameSize;
+    const std::size_t offset = (index / slotsPerBlock) * txGeometry.blockSize + (index % slotsPerBlock) * txGeometry.frameSize;
+    return reinterpret_cast<tpacket3_hdr*>(txRing + offset);
+}
+
+} // namespace ss
+} // namespace nts
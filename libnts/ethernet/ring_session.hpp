@@ -0,0 +1,248 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libnts/ethernet/raw_session.hpp>
+
+// Forward declarations.
+struct tpacket_block_desc;
+struct tpacket3_hdr;
+
+namespace nts {
+
+// Forward declaration.
+class Configuration;
+
+namespace ss {
+
+/// Layout of a memory mapped packet ring.
+struct RingGeometry
+{
+    /// Size of each block in bytes. Must be a multiple of the page size.
+    uint32_t blockSize{ 1 << 20 };
+
+    /// Number of blocks in the ring. A ring without blocks is disabled.
+    uint32_t blockCount{ 64 };
+
+    /// Size of each frame slot in bytes. Must be a multiple of 16.
+    uint32_t frameSize{ 2048 };
+
+    /// Milliseconds after which the kernel retires a partially filled block.
+    /// @note Only used by receive rings.
+    uint32_t retireTimeout{ 10 };
+
+    /// Configure the geometry with the parameters under the given key.
+    /// @example
+    /// geometry.configure(config, "Session.RxRing"); // Reads "Session.RxRing.BlockSize", etc.
+    RingGeometry& configure(std::shared_ptr<Configuration> config, const std::string& key);
+};
+
+/// Counters of the frames handed to the kernel through the transmit ring.
+struct RingStatistics
+{
+    /// Number of times the ring was flushed.
+    uint64_t flushes{ 0 };
+
+    /// Total number of frames flushed.
+    uint64_t framesFlushed{ 0 };
+
+    /// Number of frames handed to the kernel by the most recent flush.
+    std::size_t lastFlushFrames{ 0 };
+};
+
+/// Raw socket session that exchanges frames through memory mapped rings (TPACKET_V3).
+///
+/// @details With a PACKET_RX_RING, the kernel writes frames into blocks of a ring that is
+/// shared with this process, and hands over entire blocks at a time. Consumers can walk every
+/// frame of a block with receiveBlock() without copying, or use the regular Session
+/// interface, which copies one frame per call out of the current block.
+///
+/// With a PACKET_TX_RING, frames are written directly into the slots of the ring and are
+/// handed to the kernel in bulk by flush(), with a single system call. Frames are flushed
+/// automatically once the number of queued frames reaches the flush threshold.
+///
+/// @example
+/// RingSession session("eth0", RingGeometry(), txGeometry);
+/// session.setFlushThreshold(64);
+/// for (auto& frame : frames)
+/// {
+///     session.send(frame); // Flushes every 64 frames.
+/// }
+/// session.flush();
+class RingSession : public RawSession
+{
+public:
+    /// Constructor. Only creates a receive ring.
+    /// @param interface Name of the network interface to bind to.
+    /// @param rxGeometry Layout of the receive ring.
+    /// @throws boost::system::system_error If the ring cannot be created.
+    RingSession(const std::string& interface, const RingGeometry& rxGeometry);
+
+    /// Constructor.
+    /// @param interface Name of the network interface to bind to.
+    /// @param rxGeometry Layout of the receive ring.
+    /// @param txGeometry Layout of the transmit ring.
+    /// @throws boost::system::system_error If the rings cannot be created.
+    RingSession(const std::string& interface, const RingGeometry& rxGeometry, const RingGeometry& txGeometry);
+
+    /// Deconstructor.
+    /// @note Queued frames that were not flushed are discarded.
+    ~RingSession();
+
+    /// Send data to the network.
+    /// @details With a transmit ring, the data is queued and only sent when the ring is flushed.
+    /// @returns The size of the data, or 0 if it is empty or doesn't fit into a slot, in which
+    /// case nothing is queued.
+    virtual std::size_t send(std::vector<uint8_t>& inData);
+
+    /// Send object to the network.
+    /// @details With a transmit ring, the object is serialized directly into the ring and only
+    /// sent when the ring is flushed.
+    /// @returns The size of the object in bytes, or 0 if it does not fit into a slot.
+    virtual std::size_t send(Serializable& inData);
+
+    /// Send several frames to the network.
+    /// @details With a transmit ring, every frame is queued and the ring is flushed once.
+    /// @returns The number of frames sent, which stops at the first frame that is empty or
+    /// doesn't fit into a slot.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive several frames from the network.
+    /// @details With a receive ring, frames are copied out of the current block. Blocks until
+    /// at least one frame is received.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Receive data from the network.
+    /// @param outData Must be non-empty (size > 0). Larger frames are truncated.
+    virtual std::size_t receive(std::vector<uint8_t>& outData);
+
+    /// Receive object from the network.
+    virtual std::size_t receive(Serializable& outData);
+
+    /// Start sending data to the network.
+    /// @details With a transmit ring, the data is queued immediately and the handler is
+    /// posted to the context.
+    virtual void asyncSend(std::vector<uint8_t>& inData, CompletionHandler handler);
+
+    /// Start sending an object to the network.
+    virtual void asyncSend(Serializable& inData, CompletionHandler handler);
+
+    /// Start receiving data from the network.
+    /// @details With a receive ring, waits for the socket to signal a retired block and reads
+    /// the next frame from the ring.
+    /// @note Operations on the rings are not thread safe. Run the context on a single thread,
+    /// or wrap the handlers in a strand.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler);
+
+    /// Start receiving an object from the network.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler);
+
+    /// Start receiving data from the network, with a slot that cancels only this operation.
+    virtual void asyncReceive(std::vector<uint8_t>& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Start receiving an object from the network, with a slot that cancels only this operation.
+    virtual void asyncReceive(Serializable& outData, CompletionHandler handler, std::shared_ptr<CancellationSlot> slot);
+
+    /// Wait until a frame can be received without blocking.
+    /// @returns Whether a frame is available before the timeout expires.
+    virtual bool waitForFrames(const std::chrono::milliseconds timeout);
+
+    /// Wait for the next block of frames and expose them as views into the ring.
+    /// @details The views remain valid until releaseBlock() is called. If the current block
+    /// still has unread frames, only those are returned.
+    /// @returns The number of frames in the block.
+    /// @throws std::logic_error If the session has no receive ring.
+    std::size_t receiveBlock(std::vector<boost::asio::const_buffer>& outFrames);
+
+    /// Hand the current block back to the kernel.
+    void releaseBlock();
+
+    /// Reserve the next free slot of the transmit ring for writing a frame.
+    /// @details Flushes the ring if every slot is in use.
+    /// @returns A view of the slot's data area.
+    /// @throws std::logic_error If the session has no transmit ring.
+    boost::asio::mutable_buffer acquireSlot();
+
+    /// Queue the frame that was written into the slot returned by acquireSlot().
+    /// @param length Size of the frame in bytes.
+    void commitSlot(std::size_t length);
+
+    /// Hand every queued frame to the kernel with a single system call.
+    /// @returns The number of frames flushed.
+    /// @throws boost::system::system_error If the kernel rejects the frames.
+    std::size_t flush();
+
+    /// Number of queued frames that triggers an automatic flush. Zero disables it.
+    std::size_t getFlushThreshold() const;
+
+    /// Number of queued frames that triggers an automatic flush. Zero disables it.
+    RingSession& setFlushThreshold(const std::size_t threshold);
+
+    /// Counters of the frames flushed through the transmit ring.
+    const RingStatistics& getTxStatistics() const;
+
+    /// Layout of the receive ring.
+    const RingGeometry& getRxGeometry() const;
+
+    /// Layout of the transmit ring.
+    const RingGeometry& getTxGeometry() const;
+
+protected:
+    /// Wait until the current block is owned by user space.
+    tpacket_block_desc* waitForBlock();
+
+    /// View of the next frame of the current block, waiting for a new block if necessary.
+    /// @details Records the frame with its kernel timestamp when a capture writer is set.
+    boost::asio::const_buffer nextFrame();
+
+    /// Header of the transmit ring slot with the given index.
+    tpacket3_hdr* getSlot(const std::size_t index) const;
+
+private:
+    /// Layout of the receive ring.
+    RingGeometry rxGeometry;
+
+    /// Layout of the transmit ring.
+    RingGeometry txGeometry;
+
+    /// Start of the memory mapped rings. The transmit ring follows the receive ring.
+    uint8_t* ring{ nullptr };
+
+    /// Size of the memory mapped rings in bytes.
+    std::size_t ringSize{ 0 };
+
+    /// Start of the transmit ring.
+    uint8_t* txRing{ nullptr };
+
+    /// Number of slots in the transmit ring.
+    std::size_t slotCount{ 0 };
+
+    /// Index of the next slot to be written.
+    std::size_t slotIndex{ 0 };
+
+    /// Frames queued since the last flush.
+    std::size_t pendingFrames{ 0 };
+
+    /// Number of queued frames that triggers an automatic flush.
+    std::size_t flushThreshold{ 1 };
+
+    /// Counters of the transmit ring.
+    RingStatistics txStatistics;
+
+    /// Index of the block being consumed.
+    uint32_t blockIndex{ 0 };
+
+    /// Block currently held by user space, if any.
+    tpacket_block_desc* heldBlock{ nullptr };
+
+    /// Next frame to be read from the held block.
+    tpacket3_hdr* nextHeader{ nullptr };
+
+    /// Frames of the held block that were not read yet.
+    uint32_t framesLeft{ 0 };
+};
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+
+#include <libnts/core/data_unit.hpp>
+#include <libnts/ethernet/ring_session.hpp>
+
+namespace nts {
+namespace tests {
+
+/// Broadcast frame with an unassigned EtherType, so that it is ignored by the network stack.
+std::vector<uint8_t> testFrame = { { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x15, 0x5d, 0x3a, 0xe2, 0x9b, 0x88, 0xb5, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29 } };
+
+/// Small ring so that the tests don't reserve too much memory.
+ss::RingGeometry testGeometry()
+{
+    ss::RingGeometry geometry;
+    geometry.blockSize = 1 << 16;
+    geometry.blockCount = 4;
+    geometry.retireTimeout = 1;
+    return geometry;
+}
+
+TEST(DISABLED_RingSessionUnitTests, ReceiveVector)
+{
+    // The loopback interface receives every frame sent through it.
+    ss::RingSession session("lo", testGeometry());
+
+    const std::size_t sendSize = session.send(testFrame);
+    ASSERT_EQ(sendSize, testFrame.size());
+
+    std::vector<uint8_t> frame(ss::MTU_SIZE, 0);
+    const std::size_t receiveSize = session.receive(frame);
+    ASSERT_EQ(receiveSize, testFrame.size());
+    frame.resize(receiveSize);
+    EXPECT_EQ(frame, testFrame);
+}
+
+TEST(DISABLED_RingSessionUnitTests, ReceiveBlock)
+{
+    ss::RingSession session("lo", testGeometry());
+
+    for (int i = 0; i < 8; i++)
+    {
+        ASSERT_EQ(session.send(testFrame), testFrame.size());
+    }
+
+    // Walk the blocks until every frame was seen.
+    std::size_t framesSeen = 0;
+    std::vector<boost::asio::const_buffer> frames;
+    while (framesSeen < 8)
+    {
+        session.receiveBlock(frames);
+        for (const auto& frame : frames)
+        {
+            ASSERT_EQ(frame.size(), testFrame.size());
+            EXPECT_EQ(memcmp(frame.data(), testFrame.data(), testFrame.size()), 0);
+        }
+        framesSeen += frames.size();
+        session.releaseBlock();
+    }
+    EXPECT_GE(framesSeen, 8);
+}
+
+TEST(DISABLED_RingSessionUnitTests, ReceiveSerializable)
+{
+    ss::RingSession session("lo", testGeometry());
+
+    GenericDataUnit request;
+    request.setData(testFrame);
+    ASSERT_EQ(session.send(request), testFrame.size());
+
+    GenericDataUnit reply;
+    const std::size_t receiveSize = session.receive(reply);
+    ASSERT_EQ(receiveSize, testFrame.size());
+    EXPECT_EQ(reply.getData(), testFrame);
+}
+
+TEST(DISABLED_RingSessionUnitTests, TransmitRing)
+{
+    ss::RingSession session("lo", testGeometry(), testGeometry());
+    session.setFlushThreshold(4);
+
+    // Frames are only handed to the kernel once the threshold is reached.
+    for (int i = 0; i < 6; i++)
+    {
+        ASSERT_EQ(session.send(testFrame), testFrame.size());
+    }
+    EXPECT_EQ(session.getTxStatistics().flushes, 1);
+    EXPECT_EQ(session.getTxStatistics().lastFlushFrames, 4);
+
+    // Flush the remaining frames explicitly.
+    EXPECT_EQ(session.flush(), 2);
+    EXPECT_EQ(session.flush(), 0);
+    EXPECT_EQ(session.getTxStatistics().framesFlushed, 6);
+
+    // Every frame must have reached the interface.
+    std::size_t framesSeen = 0;
+    std::vector<boost::asio::const_buffer> frames;
+    while (framesSeen < 6)
+    {
+        framesSeen += session.receiveBlock(frames);
+        session.releaseBlock();
+    }
+    EXPECT_GE(framesSeen, 6);
+}
+
+TEST(DISABLED_RingSessionUnitTests, TransmitSerializable)
+{
+    ss::RingSession session("lo", testGeometry(), testGeometry());
+
+    GenericDataUnit request;
+    request.setData(testFrame);
+    ASSERT_EQ(session.send(request), testFrame.size());
+    EXPECT_EQ(session.getTxStatistics().framesFlushed, 1);
+
+    GenericDataUnit reply;
+    ASSERT_EQ(session.receive(reply), testFrame.size());
+    EXPECT_EQ(reply.getData(), testFrame);
+}
+
+TEST(DISABLED_RingSessionUnitTests, Batch)
+{
+    ss::RingSession session("lo", testGeometry(), testGeometry());
+
+    // The whole batch is handed to the kernel with a single flush.
+    std::vector<std::vector<uint8_t>> batch(16, testFrame);
+    ASSERT_EQ(session.sendBatch(batch), batch.size());
+    EXPECT_EQ(session.getTxStatistics().flushes, 1);
+    EXPECT_EQ(session.getTxStatistics().lastFlushFrames, batch.size());
+
+    std::size_t framesSeen = 0;
+    std::vector<std::vector<uint8_t>> frames(64, std::vector<uint8_t>(ss::MTU_SIZE, 0));
+    while (framesSeen < batch.size())
+    {
+        const std::size_t framesReceived = session.receiveBatch(frames, frames.size());
+        ASSERT_GT(framesReceived, 0);
+        EXPECT_EQ(frames[0], testFrame);
+        framesSeen += framesReceived;
+        for (auto& frame : frames)
+        {
+            frame.resize(ss::MTU_SIZE);
+        }
+    }
+
+    // Batches stop at the first frame that isn't sent, and empty frames aren't queued.
+    batch[2].resize(65536);
+    EXPECT_EQ(session.sendBatch(batch), 2u);
+    std::vector<uint8_t> empty;
+    EXPECT_EQ(session.send(empty), 0u);
+    EXPECT_EQ(session.flush(), 0);
+}
+
+TEST(DISABLED_RawSessionUnitTests, Batch)
+{
+    ss::RawSession session("lo");
+
+    std::vector<std::vector<uint8_t>> batch(16, testFrame);
+    ASSERT_EQ(session.sendBatch(batch), batch.size());
+
+    std::vector<std::vector<uint8_t>> frames(64, std::vector<uint8_t>(ss::MTU_SIZE, 0));
+    const std::size_t framesReceived = session.receiveBatch(frames, frames.size());
+    ASSERT_GT(framesReceived, 0);
+    EXPECT_EQ(frames[0], testFrame);
+}
+
+TEST(DISABLED_RawSessionUnitTests, Async)
+{
+    // Two sessions serviced by the same context.
+    auto context = std::make_shared<boost::asio::io_context>();
+    ss::RawSession sender("lo", context);
+    ss::RawSession receiver("lo", context);
+
+    std::vector<uint8_t> frame(ss::MTU_SIZE, 0);
+    std::size_t bytesReceived = 0;
+    receiver.asyncReceive(frame, [&bytesReceived](const boost::system::error_code& error, std::size_t bytes) {
+        ASSERT_FALSE(error);
+        bytesReceived = bytes;
+    });
+
+    GenericDataUnit request;
+    request.setData(testFrame);
+    std::size_t bytesSent = 0;
+    sender.asyncSend(request, [&bytesSent](const boost::system::error_code& error, std::size_t bytes) {
+        ASSERT_FALSE(error);
+        bytesSent = bytes;
+    });
+
+    EXPECT_EQ(sender.run(2), 2);
+    EXPECT_EQ(bytesSent, testFrame.size());
+    EXPECT_EQ(bytesReceived, testFrame.size());
+}
+
+TEST(DISABLED_RawSessionUnitTests, Cancel)
+{
+    ss::RawSession session("lo");
+
+    GenericDataUnit reply;
+    boost::system::error_code result;
+    session.asyncReceive(reply, [&result](const boost::system::error_code& error, std::size_t bytes) {
+        result = error;
+    });
+    session.cancel();
+    session.run(1);
+    EXPECT_EQ(result, boost::asio::error::operation_aborted);
+}
+
+TEST(DISABLED_RawSessionUnitTests, CancelSlot)
+{
+    ss::RawSession session("lo");
+
+    // Only the receive of the slot is aborted.
+    std::vector<uint8_t> first(ss::MTU_SIZE, 0);
+    boost::system::error_code firstResult;
+    auto slot = std::make_shared<ss::CancellationSlot>();
+    session.asyncReceive(
+        first, [&firstResult](const boost::system::error_code& error, std::size_t bytes) { firstResult = error; }, slot);
+    std::vector<uint8_t> second(ss::MTU_SIZE, 0);
+    std::size_t bytesReceived = 0;
+    session.asyncReceive(
+        second, [&bytesReceived](const boost::system::error_code& error, std::size_t bytes) {
+            ASSERT_FALSE(error);
+            bytesReceived = bytes;
+        },
+        std::make_shared<ss::CancellationSlot>());
+    slot->emit();
+    ASSERT_EQ(session.send(testFrame), testFrame.size());
+
+    session.run(1);
+    EXPECT_EQ(firstResult, boost::asio::error::operation_aborted);
+    EXPECT_EQ(bytesReceived, testFrame.size());
+}
+
+TEST(DISABLED_RingSessionUnitTests, Async)
+{
+    ss::RingSession session("lo", testGeometry());
+
+    std::vector<uint8_t> frame(ss::MTU_SIZE, 0);
+    std::size_t bytesReceived = 0;
+    session.asyncReceive(frame, [&bytesReceived](const boost::system::error_code& error, std::size_t bytes) {
+        ASSERT_FALSE(error);
+        bytesReceived = bytes;
+    });
+    ASSERT_EQ(session.send(testFrame), testFrame.size());
+
+    session.run(1);
+    EXPECT_EQ(bytesReceived, testFrame.size());
+}
+
+} // namespace tests
+} // namespace nts
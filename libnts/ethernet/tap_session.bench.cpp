@@ -0,0 +1,121 @@
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <boost/system/system_error.hpp>
+#include <memory>
+#include <thread>
+
+#include <libnts/ethernet/raw_session.hpp>
+#include <libnts/ethernet/tap_session.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// Broadcast frames of the given size with an unassigned EtherType, ignored by the network stack.
+std::vector<std::vector<uint8_t>> makeFrames(const std::size_t count, const std::size_t size)
+{
+    std::vector<uint8_t> frame(size, 0xab);
+    const uint8_t header[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x88, 0xb5 };
+    std::copy(std::begin(header), std::end(header), frame.begin());
+    return std::vector<std::vector<uint8_t>>(count, frame);
+}
+
+/// TAP device for the benchmark, or nullptr without CAP_NET_ADMIN.
+std::unique_ptr<ss::TapSession> createTap(benchmark::State& state)
+{
+    try
+    {
+        return std::unique_ptr<ss::TapSession>(new ss::TapSession("ntsbench"));
+    }
+    catch (const boost::system::system_error& error)
+    {
+        state.SkipWithError("TAP devices are not available");
+        return nullptr;
+    }
+}
+
+} // namespace
+
+/// Frames written to a TAP device by a sender thread, through the kernel's receive path, to
+/// a raw socket bound to the device. Frames the kernel drops are not counted.
+void BM_TapToRaw(benchmark::State& state)
+{
+    std::unique_ptr<ss::TapSession> tap = createTap(state);
+    if (!tap)
+    {
+        return;
+    }
+    ss::RawSession raw(tap->getName());
+    std::atomic<bool> running{ true };
+    std::thread sender([&tap, &running, &state]() {
+        std::vector<std::vector<uint8_t>> frames = makeFrames(64, state.range(0));
+        while (running.load(std::memory_order_relaxed))
+        {
+            tap->sendBatch(frames);
+        }
+    });
+
+    std::vector<std::vector<uint8_t>> buffers(64, std::vector<uint8_t>(ss::MTU_SIZE));
+    std::size_t frames = 0;
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        const std::size_t count = raw.receiveBatch(buffers, buffers.size());
+        for (std::size_t i = 0; i < count; i++)
+        {
+            bytes += buffers[i].size();
+            buffers[i].resize(ss::MTU_SIZE);
+        }
+        frames += count;
+    }
+    running = false;
+    sender.join();
+    state.SetItemsProcessed(frames);
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_TapToRaw)->Arg(64)->Arg(1500)->UseRealTime();
+
+/// Frames sent by a raw socket on a sender thread, through the kernel's transmit path, to
+/// the TAP device. Frames the kernel drops are not counted.
+void BM_RawToTap(benchmark::State& state)
+{
+    std::unique_ptr<ss::TapSession> tap = createTap(state);
+    if (!tap)
+    {
+        return;
+    }
+    ss::RawSession raw(tap->getName());
+    std::atomic<bool> running{ true };
+    std::thread sender([&raw, &running, &state]() {
+        std::vector<std::vector<uint8_t>> frames = makeFrames(64, state.range(0));
+        while (running.load(std::memory_order_relaxed))
+        {
+            raw.sendBatch(frames);
+        }
+    });
+
+    std::vector<std::vector<uint8_t>> buffers(64, std::vector<uint8_t>(ss::MTU_SIZE + 14));
+    std::size_t frames = 0;
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        const std::size_t count = tap->receiveBatch(buffers, buffers.size());
+        for (std::size_t i = 0; i < count; i++)
+        {
+            bytes += buffers[i].size();
+            buffers[i].resize(ss::MTU_SIZE + 14);
+        }
+        frames += count;
+    }
+    running = false;
+    sender.join();
+    state.SetItemsProcessed(frames);
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_RawToTap)->Arg(64)->Arg(1500)->UseRealTime();
+
+} // namespace benchmarks
+} // namespace nts
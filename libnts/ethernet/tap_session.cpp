@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/if_tun.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <libnts/ethernet/tap_session.hpp>
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Size of the buffers that objects are serialized into. Fits any frame the device can carry.
+constexpr std::size_t frameBufferSize{ 65536 };
+
+/// Throws the error of the last system call, after closing the descriptors.
+[[noreturn]] void fail(const char* call, std::initializer_list<int> descriptors)
+{
+    const int error = errno;
+    for (const int descriptor : descriptors)
+    {
+        if (descriptor >= 0)
+        {
+            close(descriptor);
+        }
+    }
+    throw boost::system::system_error(error, boost::system::system_category(), call);
+}
+
+/// Set the IFF_UP flag of the interface.
+void bringUp(const char* name, const int tapDescriptor, const int epollDescriptor)
+{
+    const int control = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (control < 0)
+    {
+        fail("socket", { tapDescriptor, epollDescriptor });
+    }
+    ifreq request;
+    memset(&request, 0, sizeof(request));
+    strncpy(request.ifr_name, name, IFNAMSIZ - 1);
+    if (ioctl(control, SIOCGIFFLAGS, &request) < 0)
+    {
+        fail("SIOCGIFFLAGS", { control, tapDescriptor, epollDescriptor });
+    }
+    if ((request.ifr_flags & IFF_UP) == 0)
+    {
+        request.ifr_flags |= IFF_UP;
+        if (ioctl(control, SIOCSIFFLAGS, &request) < 0)
+        {
+            fail("SIOCSIFFLAGS", { control, tapDescriptor, epollDescriptor });
+        }
+    }
+    close(control);
+}
+
+} // namespace
+
+TapSession::TapSession(const std::string& name)
+    : sendBuffer(frameBufferSize, 0)
+    , receiveBuffer(frameBufferSize, 0)
+{
+    if (name.size() >= IFNAMSIZ)
+    {
+        throw std::invalid_argument("Interface name is too long: " + name);
+    }
+
+    descriptor = open("/dev/net/tun", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (descriptor < 0)
+    {
+        fail("open", {});
+    }
+
+    // Frames are read and written without the packet information header.
+    ifreq request;
+    memset(&request, 0, sizeof(request));
+    request.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(request.ifr_name, name.c_str(), IFNAMSIZ - 1);
+    if (ioctl(descriptor, TUNSETIFF, &request) < 0)
+    {
+        fail("TUNSETIFF", { descriptor });
+    }
+    this->name = request.ifr_name;
+
+    epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (epollDescriptor < 0)
+    {
+        fail("epoll_create1", { descriptor });
+    }
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = registeredEvents;
+    if (epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, descriptor, &event) < 0)
+    {
+        fail("epoll_ctl", { descriptor, epollDescriptor });
+    }
+
+    // Writes fail while the link is down.
+    bringUp(this->name.c_str(), descriptor, epollDescriptor);
+}
+
+TapSession::~TapSession()
+{
+    close(epollDescriptor);
+    close(descriptor);
+}
+
+std::size_t TapSession::send(std::vector<uint8_t>& inData)
+{
+    while (!tryWrite(inData.data(), inData.size()))
+    {
+        wait(EPOLLOUT, -1);
+    }
+    return inData.size();
+}
+
+std::size_t TapSession::send(Serializable& inData)
+{
+    // Write the object into the reusable buffer.
+    const std::size_t size = inData.serialize(sendBuffer.data(), sendBuffer.size());
+    if (size == 0)
+    {
+        return 0;
+    }
+    while (!tryWrite(sendBuffer.data(), size))
+    {
+        wait(EPOLLOUT, -1);
+    }
+    return size;
+}
+
+std::size_t TapSession::receive(std::vector<uint8_t>& outData)
+{
+    ssize_t bytes;
+    while ((bytes = tryRead(outData.data(), outData.size())) < 0)
+    {
+        wait(EPOLLIN, -1);
+    }
+    return bytes;
+}
+
+std::size_t TapSession::receive(Serializable& outData)
+{
+    ssize_t bytes;
+    while ((bytes = tryRead(receiveBuffer.data(), receiveBuffer.size())) < 0)
+    {
+        wait(EPOLLIN, -1);
+    }
+    outData.deserialize(receiveBuffer.data(), bytes);
+    return bytes;
+}
+
+std::size_t TapSession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    std::size_t framesSent = 0;
+    while (framesSent < inFrames.size())
+    {
+        // Write until the queue of the device is full, then wait for room.
+        while (framesSent < inFrames.size() && tryWrite(inFrames[framesSent].data(), inFrames[framesSent].size()))
+        {
+            framesSent++;
+        }
+        if (framesSent < inFrames.size())
+        {
+            wait(EPOLLOUT, -1);
+        }
+    }
+    return framesSent;
+}
+
+std::size_t TapSession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    const std::size_t frameCount = std::min(maxFrames, outFrames.size());
+    std::size_t received = 0;
+    while (received == 0 && frameCount > 0)
+    {
+        // Take every frame that is already queued, then wait if there was none.
+        ssize_t bytes;
+        while (received < frameCount && (bytes = tryRead(outFrames[received].data(), outFrames[received].size())) >= 0)
+        {
+            outFrames[received].resize(bytes);
+            received++;
+        }
+        if (received == 0)
+        {
+            wait(EPOLLIN, -1);
+        }
+    }
+    return received;
+}
+
+bool TapSession::waitForFrames(const std::chrono::milliseconds timeout)
+{
+    return wait(EPOLLIN, timeout.count());
+}
+
+std::string TapSession::getName() const
+{
+    return name;
+}
+
+int TapSession::getDescriptor() const
+{
+    return descriptor;
+}
+
+bool TapSession::wait(const uint32_t events, const int timeout)
+{
+    // The descriptor stays registered, and is only modified when the direction changes.
+    if (registeredEvents != events)
+    {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        if (epoll_ctl(epollDescriptor, EPOLL_CTL_MOD, descriptor, &event) < 0)
+        {
+            throw boost::system::system_error(errno, boost::system::system_category(), "epoll_ctl");
+        }
+        registeredEvents = events;
+    }
+
+    epoll_event event;
+    int result;
+    while ((result = epoll_wait(epollDescriptor, &event, 1, timeout)) < 0 && errno == EINTR)
+    {
+    }
+    if (result < 0)
+    {
+        throw boost::system::system_error(errno, boost::system::system_category(), "epoll_wait");
+    }
+    return result > 0;
+}
+
+ssize_t TapSession::tryRead(uint8_t* outData, const std::size_t length)
+{
+    const ssize_t bytes = read(descriptor, outData, length);
+    if (bytes < 0)
+    {
+        if (errno == EAGAIN || errno == EINTR)
+        {
+            return -1;
+        }
+        throw boost::system::system_error(errno, boost::system::system_category(), "read");
+    }
+    return bytes;
+}
+
+bool TapSession::tryWrite(const uint8_t* inData, const std::size_t length)
+{
+    if (write(descriptor, inData, length) < 0)
+    {
+        if (errno == EAGAIN || errno == EINTR)
+        {
+            return false;
+        }
+        throw boost::system::system_error(errno, boost::system::system_category(), "write");
+    }
+    return true;
+}
+
+} // namespace ss
+} // namespace nts
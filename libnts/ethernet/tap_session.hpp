@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <libnts/core/session.hpp>
+
+namespace nts {
+namespace ss {
+
+/// Communicate through a TAP device.
+///
+/// @details The session creates the TAP device, or attaches to an existing persistent one,
+/// and brings its link up. Frames sent by the session are received by the kernel on that
+/// interface, and frames the kernel transmits on it are received by the session. A
+/// RawSession or RingSession bound to the same interface, or a process in another network
+/// namespace behind it, then exchanges frames with the session through the real network
+/// stack, without touching a physical network. This needs CAP_NET_ADMIN, which a plain
+/// network namespace (unshare -rn) provides.
+///
+/// The descriptor of the device is non-blocking. Operations that would block wait for it
+/// with epoll, and batch operations move every frame that is ready after a single wait.
+/// A TAP device carries one frame per read or write, so batches still make one call per
+/// frame.
+///
+/// For the other end of a veth pair, bind a RawSession or RingSession to it by name.
+///
+/// @example
+/// TapSession tap("nts0");
+/// RawSession raw("nts0");
+/// tap.send(request);     // Received by the kernel on nts0, and seen by raw.
+/// raw.receive(reply);
+class TapSession : public Session
+{
+public:
+    /// Constructor.
+    /// @param name Name of the TAP device. The kernel picks one ("tapN") if empty.
+    /// @throws boost::system::system_error If the device cannot be created or brought up.
+    explicit TapSession(const std::string& name);
+
+    /// Deconstructor. The device is removed, unless it is persistent.
+    ~TapSession();
+
+    /// Send data to the kernel.
+    virtual std::size_t send(std::vector<uint8_t>& inData);
+
+    /// Send object to the kernel.
+    /// @returns The number of bytes sent, or 0 if the object doesn't fit into a frame.
+    virtual std::size_t send(Serializable& inData);
+
+    /// Receive data from the kernel.
+    /// @param outData Must be non-empty (size > 0). Longer frames are truncated.
+    virtual std::size_t receive(std::vector<uint8_t>& outData);
+
+    /// Receive object from the kernel.
+    virtual std::size_t receive(Serializable& outData);
+
+    /// Send several frames, waiting for room only when the device queue is full.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive the available frames.
+    /// @details Blocks until at least one frame is received.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Wait until a frame can be received without blocking.
+    /// @returns Whether a frame is available before the timeout expires.
+    virtual bool waitForFrames(const std::chrono::milliseconds timeout);
+
+    /// Name of the TAP device.
+    virtual std::string getName() const;
+
+    /// Descriptor of the TAP device.
+    virtual int getDescriptor() const;
+
+private:
+    /// Wait until the descriptor is ready for the events, or the timeout expires.
+    /// @param timeout Timeout in milliseconds, or -1 to wait forever.
+    /// @returns Whether the descriptor is ready.
+    bool wait(const uint32_t events, const int timeout);
+
+    /// Read a frame without blocking.
+    /// @returns The number of bytes read, or -1 if no frame is available.
+    ssize_t tryRead(uint8_t* outData, const std::size_t length);
+
+    /// Write a frame without blocking.
+    /// @returns Whether the frame was written.
+    bool tryWrite(const uint8_t* inData, const std::size_t length);
+
+    /// Descriptor of the TAP device.
+    int descriptor;
+
+    /// Waits for the descriptor to be ready.
+    int epollDescriptor;
+
+    /// Events the descriptor is currently registered for.
+    uint32_t registeredEvents{ 0 };
+
+    /// Name of the TAP device.
+    std::string name;
+
+    /// Objects are serialized into this buffer before being sent.
+    std::vector<uint8_t> sendBuffer;
+
+    /// Frames are received into this buffer before objects are deserialized from them.
+    std::vector<uint8_t> receiveBuffer;
+};
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,155 @@
+#include <boost/system/system_error.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <unistd.h>
+
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/core/data_unit.hpp>
+#include <libnts/ethernet/raw_session.hpp>
+#include <libnts/ethernet/tap_session.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Broadcast frame with an unassigned EtherType, so that it is ignored by the network stack.
+std::vector<uint8_t> makeFrame(const uint8_t index)
+{
+    std::vector<uint8_t> frame = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x88, 0xb5 };
+    for (uint8_t i = 0; i < 46; i++)
+    {
+        frame.push_back(index + i);
+    }
+    return frame;
+}
+
+/// Whether the frame is a test frame, rather than one the kernel sends on its own (IPv6
+/// neighbor discovery, for instance).
+bool isTestFrame(const std::vector<uint8_t>& frame)
+{
+    return frame.size() > 14 && frame[12] == 0x88 && frame[13] == 0xb5;
+}
+
+/// TAP device for the test, or nullptr without CAP_NET_ADMIN.
+std::unique_ptr<ss::TapSession> createTap(const std::string& name)
+{
+    try
+    {
+        return std::unique_ptr<ss::TapSession>(new ss::TapSession(name + std::to_string(getpid() % 10000)));
+    }
+    catch (const boost::system::system_error& error)
+    {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+TEST(TapSessionUnitTests, SendReceive)
+{
+    std::unique_ptr<ss::TapSession> tap = createTap("ntstap");
+    if (!tap)
+    {
+        GTEST_SKIP() << "TAP devices are not available";
+    }
+    ss::RawSession raw(tap->getName());
+
+    // Frames sent by the TAP session are received by the kernel on the interface.
+    std::vector<uint8_t> request = makeFrame(1);
+    ASSERT_EQ(tap->send(request), request.size());
+    std::vector<uint8_t> buffer(ss::MTU_SIZE, 0);
+    do
+    {
+        buffer.resize(raw.receive(buffer));
+    } while (!isTestFrame(buffer));
+    EXPECT_EQ(buffer, request);
+
+    // Frames the kernel transmits on the interface are received by the TAP session.
+    std::vector<uint8_t> reply = makeFrame(2);
+    ASSERT_EQ(raw.send(reply), reply.size());
+    ASSERT_TRUE(tap->waitForFrames(std::chrono::milliseconds(1000)));
+    do
+    {
+        buffer.resize(ss::MTU_SIZE);
+        buffer.resize(tap->receive(buffer));
+    } while (!isTestFrame(buffer));
+    EXPECT_EQ(buffer, reply);
+
+    GenericDataUnit object = GenericDataUnit().setData(makeFrame(3));
+    ASSERT_EQ(raw.send(object), 60u);
+    GenericDataUnit received;
+    do
+    {
+        ASSERT_GT(tap->receive(received), 0u);
+    } while (!isTestFrame(received.getData()));
+    EXPECT_EQ(received.getData(), object.getData());
+}
+
+TEST(TapSessionUnitTests, Batch)
+{
+    std::unique_ptr<ss::TapSession> tap = createTap("ntsbatch");
+    if (!tap)
+    {
+        GTEST_SKIP() << "TAP devices are not available";
+    }
+    ss::RawSession raw(tap->getName());
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        frames.push_back(makeFrame(i));
+    }
+    ASSERT_EQ(raw.sendBatch(frames), frames.size());
+
+    std::vector<std::vector<uint8_t>> received;
+    std::vector<std::vector<uint8_t>> buffers(8, std::vector<uint8_t>(ss::MTU_SIZE));
+    while (received.size() < frames.size())
+    {
+        ASSERT_TRUE(tap->waitForFrames(std::chrono::milliseconds(1000)));
+        const std::size_t count = tap->receiveBatch(buffers, buffers.size());
+        ASSERT_GT(count, 0u);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (isTestFrame(buffers[i]))
+            {
+                received.push_back(buffers[i]);
+            }
+            buffers[i].resize(ss::MTU_SIZE);
+        }
+    }
+    EXPECT_EQ(received, frames);
+
+    ASSERT_EQ(tap->sendBatch(frames), frames.size());
+    std::size_t count = 0;
+    while (count < frames.size())
+    {
+        ASSERT_TRUE(raw.waitForFrames(std::chrono::milliseconds(1000)));
+        const std::size_t batch = raw.receiveBatch(buffers, buffers.size());
+        for (std::size_t i = 0; i < batch; i++)
+        {
+            count += isTestFrame(buffers[i]) ? 1 : 0;
+            buffers[i].resize(ss::MTU_SIZE);
+        }
+    }
+}
+
+TEST(TapSessionUnitTests, Create)
+{
+    if (!createTap("ntsprobe"))
+    {
+        GTEST_SKIP() << "TAP devices are not available";
+    }
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Session.Type"] = "tap";
+    config->stringParams["Session.Interface"] = "ntscfg" + std::to_string(getpid() % 10000);
+    std::shared_ptr<ss::Session> session = ss::Session::create(config);
+    auto tap = std::dynamic_pointer_cast<ss::TapSession>(session);
+    ASSERT_TRUE(tap);
+    EXPECT_EQ(tap->getName(), config->stringParams["Session.Interface"]);
+
+    EXPECT_THROW(ss::TapSession("an_interface_name_that_is_too_long"), std::invalid_argument);
+}
+
+} // namespace tests
+} // namespace nts
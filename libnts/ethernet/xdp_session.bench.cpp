@@ -0,0 +1,154 @@
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <boost/system/system_error.hpp>
+#include <memory>
+#include <thread>
+
+#include <libnts/ethernet/raw_session.hpp>
+#include <libnts/ethernet/tap_session.hpp>
+#include <libnts/ethernet/xdp_session.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// Broadcast frames of the given size with an unassigned EtherType, ignored by the network stack.
+std::vector<std::vector<uint8_t>> makeFrames(const std::size_t count, const std::size_t size)
+{
+    std::vector<uint8_t> frame(size, 0xab);
+    const uint8_t header[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x88, 0xb5 };
+    std::copy(std::begin(header), std::end(header), frame.begin());
+    return std::vector<std::vector<uint8_t>>(count, frame);
+}
+
+/// TAP device for the benchmark, or nullptr without CAP_NET_ADMIN.
+std::unique_ptr<ss::TapSession> createTap(benchmark::State& state)
+{
+    try
+    {
+        return std::unique_ptr<ss::TapSession>(new ss::TapSession("ntsxdpbench"));
+    }
+    catch (const boost::system::system_error& error)
+    {
+        state.SkipWithError("TAP devices are not available");
+        return nullptr;
+    }
+}
+
+/// Receiving end of the benchmark on the TAP device, or nullptr if it cannot be created.
+template <typename SessionType>
+std::unique_ptr<SessionType> createSession(benchmark::State& state, const std::string& interface)
+{
+    try
+    {
+        return std::unique_ptr<SessionType>(new SessionType(interface));
+    }
+    catch (const boost::system::system_error& error)
+    {
+        state.SkipWithError(error.what());
+        return nullptr;
+    }
+}
+
+/// Receive a batch of frames, as views into the UMEM for AF_XDP sessions.
+/// @returns The number of bytes received.
+std::size_t receiveFrames(ss::RawSession& session, std::vector<std::vector<uint8_t>>& buffers, std::size_t& outFrames)
+{
+    std::size_t bytes = 0;
+    outFrames = session.receiveBatch(buffers, buffers.size());
+    for (std::size_t i = 0; i < outFrames; i++)
+    {
+        bytes += buffers[i].size();
+        buffers[i].resize(ss::MTU_SIZE);
+    }
+    return bytes;
+}
+
+std::size_t receiveFrames(ss::XdpSession& session, std::vector<std::vector<uint8_t>>& buffers, std::size_t& outFrames)
+{
+    static thread_local std::vector<boost::asio::const_buffer> views;
+    std::size_t bytes = 0;
+    outFrames = session.receiveViews(views, buffers.size());
+    for (const auto& view : views)
+    {
+        benchmark::DoNotOptimize(*static_cast<const uint8_t*>(view.data()));
+        bytes += view.size();
+    }
+    session.releaseViews();
+    return bytes;
+}
+
+} // namespace
+
+/// Frames written to a TAP device by a sender thread, through the kernel's receive path, to
+/// a session bound to the device. Frames the kernel drops are not counted.
+template <typename SessionType>
+void BM_TapReceive(benchmark::State& state)
+{
+    std::unique_ptr<ss::TapSession> tap = createTap(state);
+    if (!tap)
+    {
+        return;
+    }
+    std::unique_ptr<SessionType> session = createSession<SessionType>(state, tap->getName());
+    if (!session)
+    {
+        return;
+    }
+    std::atomic<bool> running{ true };
+    std::thread sender([&tap, &running, &state]() {
+        std::vector<std::vector<uint8_t>> frames = makeFrames(64, state.range(0));
+        while (running.load(std::memory_order_relaxed))
+        {
+            tap->sendBatch(frames);
+        }
+    });
+
+    std::vector<std::vector<uint8_t>> buffers(64, std::vector<uint8_t>(ss::MTU_SIZE));
+    std::size_t frames = 0;
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::size_t count = 0;
+        bytes += receiveFrames(*session, buffers, count);
+        frames += count;
+    }
+    running = false;
+    sender.join();
+    state.SetItemsProcessed(frames);
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK_TEMPLATE(BM_TapReceive, ss::RawSession)->Arg(64)->Arg(1500)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TapReceive, ss::XdpSession)->Arg(64)->Arg(1500)->UseRealTime();
+
+/// Batches of 64 frames sent by a session bound to a TAP device. The device drops the
+/// frames once its queue is full, since nobody reads them.
+template <typename SessionType>
+void BM_TapSend(benchmark::State& state)
+{
+    std::unique_ptr<ss::TapSession> tap = createTap(state);
+    if (!tap)
+    {
+        return;
+    }
+    std::unique_ptr<SessionType> session = createSession<SessionType>(state, tap->getName());
+    if (!session)
+    {
+        return;
+    }
+    std::vector<std::vector<uint8_t>> frames = makeFrames(64, state.range(0));
+    for (auto _ : state)
+    {
+        session->sendBatch(frames);
+    }
+    state.SetItemsProcessed(state.iterations() * frames.size());
+    state.SetBytesProcessed(state.iterations() * frames.size() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_TapSend, ss::RawSession)->Arg(64)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_TapSend, ss::XdpSession)->Arg(64)->Arg(1500);
+
+} // namespace benchmarks
+} // namespace nts
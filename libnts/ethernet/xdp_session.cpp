@@ -0,0 +1,598 @@
+#include <libnts/ethernet/xdp_session.hpp>
+
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <cstring>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+#include <libnts/config/configuration.hpp>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+namespace nts {
+namespace ss {
+
+namespace {
+
+/// Number of times a busy queue is bound before giving up, 10 ms apart.
+constexpr int bindAttempts{ 100 };
+
+/// Time the device has to take queued frames or release sent ones before a send fails, for
+/// example while the link is down.
+constexpr std::chrono::milliseconds sendTimeout{ 1000 };
+
+/// Calls the bpf system call, which glibc has no wrapper for.
+int bpf(const int command, bpf_attr& attributes)
+{
+    return static_cast<int>(syscall(__NR_bpf, command, &attributes, sizeof(attributes)));
+}
+
+/// Throws the error of the last system call.
+[[noreturn]] void fail(const char* call)
+{
+    throw boost::system::system_error(errno, boost::system::system_category(), call);
+}
+
+/// Instruction of an eBPF program.
+bpf_insn instruction(const uint8_t code, const uint8_t destination, const uint8_t source, const int16_t offset, const int32_t immediate)
+{
+    bpf_insn result;
+    result.code = code;
+    result.dst_reg = destination;
+    result.src_reg = source;
+    result.off = offset;
+    result.imm = immediate;
+    return result;
+}
+
+/// Attach the XDP program to the interface with a BPF link (Linux 5.9).
+/// @returns The descriptor of the link, or -1 on failure.
+int attachProgram(const int program, const unsigned int interfaceIndex, const uint32_t flags)
+{
+    bpf_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.link_create.prog_fd = program;
+    attributes.link_create.target_ifindex = interfaceIndex;
+    attributes.link_create.attach_type = BPF_XDP;
+    attributes.link_create.flags = flags;
+    return bpf(BPF_LINK_CREATE, attributes);
+}
+
+/// Whether the value is a power of two.
+bool isPowerOfTwo(const uint32_t value)
+{
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+} // namespace
+
+XdpOptions& XdpOptions::configure(std::shared_ptr<Configuration> config, const std::string& key)
+{
+    if (auto name = config->getString(key + ".Mode"))
+    {
+        if (name.value() == "native")
+        {
+            mode = XdpMode::Native;
+        }
+        else if (name.value() == "generic")
+        {
+            mode = XdpMode::Generic;
+        }
+        else if (name.value() == "auto")
+        {
+            mode = XdpMode::Auto;
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown XDP mode: " + name.value());
+        }
+    }
+    if (auto id = config->getInt(key + ".QueueId"))
+    {
+        queueId = id.value();
+    }
+    if (auto count = config->getInt(key + ".FrameCount"))
+    {
+        frameCount = count.value();
+    }
+    if (auto size = config->getInt(key + ".FrameSize"))
+    {
+        frameSize = size.value();
+    }
+    if (auto size = config->getInt(key + ".RingSize"))
+    {
+        ringSize = size.value();
+    }
+    return *this;
+}
+
+XdpSession::XdpSession(const std::string& interface, const XdpOptions& options)
+    : options(options)
+    , mode(options.mode == XdpMode::Auto ? XdpMode::Native : options.mode)
+{
+    const uint32_t pageSize = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+    if (!isPowerOfTwo(options.frameSize) || options.frameSize < 2048 || options.frameSize > pageSize)
+    {
+        throw std::invalid_argument("XDP frame size must be a power of two from 2048 to the page size");
+    }
+    // The send half takes the extra frame of an odd count, and each of its frames needs an
+    // entry of the transmit ring.
+    if (options.frameCount < 2 || !isPowerOfTwo(options.ringSize) || options.frameCount - options.frameCount / 2 > options.ringSize)
+    {
+        throw std::invalid_argument("XDP rings must be a power of two, and hold the send half of the frames");
+    }
+    const unsigned int interfaceIndex = if_nametoindex(interface.c_str());
+    if (interfaceIndex == 0)
+    {
+        fail("if_nametoindex");
+    }
+
+    try
+    {
+        setUpSocket(interfaceIndex);
+        setUpProgram(interfaceIndex);
+    }
+    catch (...)
+    {
+        tearDown();
+        throw;
+    }
+}
+
+XdpSession::~XdpSession()
+{
+    tearDown();
+}
+
+std::size_t XdpSession::send(std::vector<uint8_t>& inData)
+{
+    if (inData.size() > options.frameSize)
+    {
+        return 0;
+    }
+    const uint64_t address = acquireFrame();
+    memcpy(umem + address, inData.data(), inData.size());
+    queueFrame(address, inData.size());
+    flush();
+    return inData.size();
+}
+
+std::size_t XdpSession::send(Serializable& inData)
+{
+    const uint64_t address = acquireFrame();
+    const std::size_t size = inData.serialize(umem + address, options.frameSize);
+    if (size == 0)
+    {
+        freeFrames.push_back(address);
+        return 0;
+    }
+    queueFrame(address, size);
+    flush();
+    return size;
+}
+
+std::size_t XdpSession::receive(std::vector<uint8_t>& outData)
+{
+    releaseViews();
+    waitForReceived(-1);
+    const xdp_desc& frame = static_cast<const xdp_desc*>(rxRing.descriptors)[rxConsumer & rxRing.mask];
+    const std::size_t bytes = std::min<std::size_t>(frame.len, outData.size());
+    memcpy(outData.data(), umem + frame.addr, bytes);
+    recycle(1);
+    return bytes;
+}
+
+std::size_t XdpSession::receive(Serializable& outData)
+{
+    releaseViews();
+    waitForReceived(-1);
+    const xdp_desc& frame = static_cast<const xdp_desc*>(rxRing.descriptors)[rxConsumer & rxRing.mask];
+    outData.deserialize(umem + frame.addr, frame.len);
+    recycle(1);
+    return frame.len;
+}
+
+std::size_t XdpSession::sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+{
+    std::size_t framesSent = 0;
+    for (auto& frame : inFrames)
+    {
+        // Batches stop at the first frame that isn't sent, so the count is a prefix.
+        if (frame.size() > options.frameSize)
+        {
+            break;
+        }
+        uint64_t address;
+        try
+        {
+            address = acquireFrame();
+        }
+        catch (const boost::system::system_error&)
+        {
+            // The frames queued so far were handed to the device while waiting.
+            if (framesSent == 0)
+            {
+                throw;
+            }
+            return framesSent;
+        }
+        memcpy(umem + address, frame.data(), frame.size());
+        queueFrame(address, frame.size());
+        framesSent++;
+    }
+    flush();
+    return framesSent;
+}
+
+std::size_t XdpSession::receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames)
+{
+    releaseViews();
+    const uint32_t available = waitForReceived(-1);
+    const std::size_t frameCount = std::min({ std::size_t(available), maxFrames, outFrames.size() });
+    for (std::size_t i = 0; i < frameCount; i++)
+    {
+        const xdp_desc& frame = static_cast<const xdp_desc*>(rxRing.descriptors)[(rxConsumer + i) & rxRing.mask];
+        std::vector<uint8_t>& outFrame = outFrames[i];
+        outFrame.resize(std::min<std::size_t>(frame.len, outFrame.size()));
+        memcpy(outFrame.data(), umem + frame.addr, outFrame.size());
+    }
+    recycle(static_cast<uint32_t>(frameCount));
+    return frameCount;
+}
+
+bool XdpSession::waitForFrames(const std::chrono::milliseconds timeout)
+{
+    return waitForReceived(static_cast<int>(timeout.count())) > 0;
+}
+
+std::size_t XdpSession::receiveViews(std::vector<boost::asio::const_buffer>& outFrames, const std::size_t maxFrames)
+{
+    releaseViews();
+    const uint32_t available = waitForReceived(-1);
+    const std::size_t frameCount = std::min(std::size_t(available), maxFrames);
+    outFrames.clear();
+    outFrames.reserve(frameCount);
+    for (std::size_t i = 0; i < frameCount; i++)
+    {
+        const xdp_desc& frame = static_cast<const xdp_desc*>(rxRing.descriptors)[(rxConsumer + i) & rxRing.mask];
+        outFrames.emplace_back(umem + frame.addr, frame.len);
+    }
+    heldFrames = static_cast<uint32_t>(frameCount);
+    return frameCount;
+}
+
+void XdpSession::releaseViews()
+{
+    if (heldFrames > 0)
+    {
+        recycle(heldFrames);
+        heldFrames = 0;
+    }
+}
+
+XdpMode XdpSession::getMode() const
+{
+    return mode;
+}
+
+const XdpOptions& XdpSession::getOptions() const
+{
+    return options;
+}
+
+int XdpSession::getDescriptor() const
+{
+    return descriptor;
+}
+
+void XdpSession::setUpSocket(const unsigned int interfaceIndex)
+{
+    descriptor = socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (descriptor < 0)
+    {
+        fail("socket");
+    }
+
+    // The UMEM is registered with the socket, which then shares it with the kernel.
+    const std::size_t umemSize = std::size_t(options.frameCount) * options.frameSize;
+    void* memory = mmap(nullptr, umemSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        fail("mmap");
+    }
+    umem = static_cast<uint8_t*>(memory);
+    xdp_umem_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.addr = reinterpret_cast<uint64_t>(umem);
+    registration.len = umemSize;
+    registration.chunk_size = options.frameSize;
+    if (setsockopt(descriptor, SOL_XDP, XDP_UMEM_REG, &registration, sizeof(registration)) < 0)
+    {
+        fail("XDP_UMEM_REG");
+    }
+
+    const int ringOptions[] = { XDP_UMEM_FILL_RING, XDP_UMEM_COMPLETION_RING, XDP_RX_RING, XDP_TX_RING };
+    for (const int option : ringOptions)
+    {
+        if (setsockopt(descriptor, SOL_XDP, option, &options.ringSize, sizeof(options.ringSize)) < 0)
+        {
+            fail("setsockopt");
+        }
+    }
+    xdp_mmap_offsets offsets;
+    socklen_t offsetsSize = sizeof(offsets);
+    if (getsockopt(descriptor, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &offsetsSize) < 0)
+    {
+        fail("XDP_MMAP_OFFSETS");
+    }
+    mapRing(fillRing, XDP_UMEM_PGOFF_FILL_RING, offsets.fr, sizeof(uint64_t));
+    mapRing(completionRing, XDP_UMEM_PGOFF_COMPLETION_RING, offsets.cr, sizeof(uint64_t));
+    mapRing(rxRing, XDP_PGOFF_RX_RING, offsets.rx, sizeof(xdp_desc));
+    mapRing(txRing, XDP_PGOFF_TX_RING, offsets.tx, sizeof(xdp_desc));
+
+    // The first half of the frames receives, and the second half sends.
+    const uint32_t receiveFrames = options.frameCount / 2;
+    auto* fillAddresses = static_cast<uint64_t*>(fillRing.descriptors);
+    for (uint32_t i = 0; i < receiveFrames; i++)
+    {
+        fillAddresses[fillProducer++ & fillRing.mask] = uint64_t(i) * options.frameSize;
+    }
+    __atomic_store_n(fillRing.producer, fillProducer, __ATOMIC_RELEASE);
+    freeFrames.reserve(options.frameCount - receiveFrames);
+    for (uint32_t i = options.frameCount; i > receiveFrames; i--)
+    {
+        freeFrames.push_back(uint64_t(i - 1) * options.frameSize);
+    }
+
+    // Generic mode always copies frames, so the kernel need not try zero copy.
+    sockaddr_xdp address;
+    memset(&address, 0, sizeof(address));
+    address.sxdp_family = AF_XDP;
+    address.sxdp_ifindex = interfaceIndex;
+    address.sxdp_queue_id = options.queueId;
+    address.sxdp_flags = mode == XdpMode::Generic ? XDP_COPY : 0;
+    // The kernel releases the queue of a closed socket asynchronously, so a session that
+    // replaces another one may have to wait for it.
+    int attempts = bindAttempts;
+    while (bind(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        if (errno != EBUSY || --attempts == 0)
+        {
+            fail("bind");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void XdpSession::setUpProgram(const unsigned int interfaceIndex)
+{
+    // The program looks sockets up by receive queue.
+    bpf_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.map_type = BPF_MAP_TYPE_XSKMAP;
+    attributes.key_size = sizeof(uint32_t);
+    attributes.value_size = sizeof(uint32_t);
+    attributes.max_entries = options.queueId + 1;
+    mapDescriptor = bpf(BPF_MAP_CREATE, attributes);
+    if (mapDescriptor < 0)
+    {
+        fail("BPF_MAP_CREATE");
+    }
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.map_fd = mapDescriptor;
+    attributes.key = reinterpret_cast<uint64_t>(&options.queueId);
+    attributes.value = reinterpret_cast<uint64_t>(&descriptor);
+    attributes.flags = BPF_ANY;
+    if (bpf(BPF_MAP_UPDATE_ELEM, attributes) < 0)
+    {
+        fail("BPF_MAP_UPDATE_ELEM");
+    }
+
+    // return bpf_redirect_map(&sockets, ctx->rx_queue_index, XDP_PASS);
+    // The flags of bpf_redirect_map() hold the action for queues without a socket (Linux 5.3).
+    const bpf_insn program[] = {
+        instruction(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_1, offsetof(xdp_md, rx_queue_index), 0),
+        instruction(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, mapDescriptor),
+        instruction(0, 0, 0, 0, 0),
+        instruction(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS),
+        instruction(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+        instruction(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+    };
+    const char license[] = "Dual MIT/GPL";
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.prog_type = BPF_PROG_TYPE_XDP;
+    attributes.insn_cnt = sizeof(program) / sizeof(program[0]);
+    attributes.insns = reinterpret_cast<uint64_t>(program);
+    attributes.license = reinterpret_cast<uint64_t>(license);
+    programDescriptor = bpf(BPF_PROG_LOAD, attributes);
+    if (programDescriptor < 0)
+    {
+        fail("BPF_PROG_LOAD");
+    }
+
+    linkDescriptor = attachProgram(programDescriptor, interfaceIndex, mode == XdpMode::Native ? XDP_FLAGS_DRV_MODE : XDP_FLAGS_SKB_MODE);
+    if (linkDescriptor < 0 && options.mode == XdpMode::Auto)
+    {
+        // The driver has no native XDP support.
+        mode = XdpMode::Generic;
+        linkDescriptor = attachProgram(programDescriptor, interfaceIndex, XDP_FLAGS_SKB_MODE);
+    }
+    if (linkDescriptor < 0)
+    {
+        fail("BPF_LINK_CREATE");
+    }
+}
+
+void XdpSession::tearDown()
+{
+    // The program goes first, so that no frame is redirected to a closed socket.
+    const int descriptors[] = { linkDescriptor, programDescriptor, mapDescriptor };
+    for (const int fd : descriptors)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+    linkDescriptor = programDescriptor = mapDescriptor = -1;
+
+    Ring* rings[] = { &rxRing, &txRing, &fillRing, &completionRing };
+    for (Ring* ring : rings)
+    {
+        if (ring->mapping)
+        {
+            munmap(ring->mapping, ring->mappingSize);
+        }
+        *ring = Ring();
+    }
+    if (descriptor >= 0)
+    {
+        close(descriptor);
+        descriptor = -1;
+    }
+    if (umem)
+    {
+        munmap(umem, std::size_t(options.frameCount) * options.frameSize);
+        umem = nullptr;
+    }
+}
+
+void XdpSession::mapRing(Ring& ring, const uint64_t offset, const xdp_ring_offset& ringOffsets, const std::size_t descriptorSize)
+{
+    const std::size_t size = ringOffsets.desc + options.ringSize * descriptorSize;
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, descriptor, offset);
+    if (mapping == MAP_FAILED)
+    {
+        fail("mmap");
+    }
+    uint8_t* base = static_cast<uint8_t*>(mapping);
+    ring.producer = reinterpret_cast<uint32_t*>(base + ringOffsets.producer);
+    ring.consumer = reinterpret_cast<uint32_t*>(base + ringOffsets.consumer);
+    ring.descriptors = base + ringOffsets.desc;
+    ring.mask = options.ringSize - 1;
+    ring.mapping = mapping;
+    ring.mappingSize = size;
+}
+
+uint32_t XdpSession::waitForReceived(const int timeout)
+{
+    uint32_t available = __atomic_load_n(rxRing.producer, __ATOMIC_ACQUIRE) - rxConsumer - heldFrames;
+    while (available == 0 && timeout != 0)
+    {
+        pollfd descriptors{ descriptor, POLLIN, 0 };
+        const int ready = poll(&descriptors, 1, timeout);
+        if (ready < 0 && errno != EINTR)
+        {
+            fail("poll");
+        }
+        available = __atomic_load_n(rxRing.producer, __ATOMIC_ACQUIRE) - rxConsumer - heldFrames;
+        if (ready == 0)
+        {
+            break;
+        }
+    }
+    return available;
+}
+
+void XdpSession::recycle(const uint32_t count)
+{
+    // There are only as many receive frames as fill ring entries, so the ring has room.
+    const auto* frames = static_cast<const xdp_desc*>(rxRing.descriptors);
+    auto* fillAddresses = static_cast<uint64_t*>(fillRing.descriptors);
+    const uint64_t frameMask = ~uint64_t(options.frameSize - 1);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        fillAddresses[fillProducer++ & fillRing.mask] = frames[(rxConsumer + i) & rxRing.mask].addr & frameMask;
+    }
+    __atomic_store_n(fillRing.producer, fillProducer, __ATOMIC_RELEASE);
+    rxConsumer += count;
+    __atomic_store_n(rxRing.consumer, rxConsumer, __ATOMIC_RELEASE);
+}
+
+uint64_t XdpSession::acquireFrame()
+{
+    if (freeFrames.empty())
+    {
+        reclaim();
+    }
+    const auto deadline = std::chrono::steady_clock::now() + sendTimeout;
+    while (freeFrames.empty())
+    {
+        // Send the queued frames, and give the device some time to release them.
+        flush();
+        if (freeFrames.empty())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                throw boost::system::system_error(ETIMEDOUT, boost::system::system_category(), "XDP completion");
+            }
+            pollfd descriptors{ descriptor, POLLOUT, 0 };
+            poll(&descriptors, 1, 1);
+            reclaim();
+        }
+    }
+    const uint64_t address = freeFrames.back();
+    freeFrames.pop_back();
+    return address;
+}
+
+void XdpSession::queueFrame(const uint64_t address, const std::size_t length)
+{
+    // There are only as many send frames as transmit ring entries, so the ring has room.
+    xdp_desc& frame = static_cast<xdp_desc*>(txRing.descriptors)[txProducer++ & txRing.mask];
+    frame.addr = address;
+    frame.len = static_cast<uint32_t>(length);
+    frame.options = 0;
+}
+
+void XdpSession::flush()
+{
+    __atomic_store_n(txRing.producer, txProducer, __ATOMIC_RELEASE);
+
+    // Copy mode sends a limited number of frames per call, and asks for another one (EAGAIN).
+    const auto deadline = std::chrono::steady_clock::now() + sendTimeout;
+    while (__atomic_load_n(txRing.consumer, __ATOMIC_ACQUIRE) != txProducer)
+    {
+        if (sendto(descriptor, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0 && errno != EAGAIN && errno != EBUSY && errno != ENOBUFS && errno != EINTR)
+        {
+            fail("sendto");
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            // The frames stay queued, and the next flush tries again.
+            reclaim();
+            throw boost::system::system_error(ETIMEDOUT, boost::system::system_category(), "sendto");
+        }
+    }
+    reclaim();
+}
+
+void XdpSession::reclaim()
+{
+    const uint32_t producer = __atomic_load_n(completionRing.producer, __ATOMIC_ACQUIRE);
+    const auto* addresses = static_cast<const uint64_t*>(completionRing.descriptors);
+    for (; completionConsumer != producer; completionConsumer++)
+    {
+        freeFrames.push_back(addresses[completionConsumer & completionRing.mask]);
+    }
+    __atomic_store_n(completionRing.consumer, completionConsumer, __ATOMIC_RELEASE);
+}
+
+} // namespace ss
+} // namespace nts
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libnts/core/session.hpp>
+
+// Forward declaration.
+struct xdp_ring_offset;
+
+namespace nts {
+
+// Forward declaration.
+class Configuration;
+
+namespace ss {
+
+/// Where the XDP program that hands frames to an XdpSession runs.
+enum class XdpMode
+{
+    /// In the network driver, before socket buffers are allocated. Needs driver support.
+    Native,
+
+    /// After the driver, on socket buffers (skb mode). Works on any interface, including veth
+    /// pairs and TAP devices, but frames are copied into the UMEM.
+    Generic,
+
+    /// Native mode if the driver supports it, and generic mode otherwise.
+    Auto,
+};
+
+/// Settings of an XdpSession.
+struct XdpOptions
+{
+    /// Where the XDP program runs.
+    XdpMode mode{ XdpMode::Generic };
+
+    /// Receive queue of the interface to take frames from.
+    uint32_t queueId{ 0 };
+
+    /// Number of frames of the UMEM. Half of them receive frames, and the other half, which
+    /// gets the extra frame of an odd count, send them.
+    uint32_t frameCount{ 4096 };
+
+    /// Size of each frame of the UMEM. Must be a power of two from 2048 to the page size.
+    uint32_t frameSize{ 2048 };
+
+    /// Number of descriptors of each ring. Must be a power of two, and hold the send half of
+    /// the frames.
+    uint32_t ringSize{ 2048 };
+
+    /// Configure the options with the parameters under the given key.
+    /// @details "Mode" is one of "native", "generic" or "auto".
+    /// @throws std::invalid_argument If the mode is unknown.
+    /// @example
+    /// options.configure(config, "Session.Xdp"); // Reads "Session.Xdp.Mode", etc.
+    XdpOptions& configure(std::shared_ptr<Configuration> config, const std::string& key);
+};
+
+/// Communicate through an AF_XDP socket, bypassing most of the network stack.
+///
+/// @details Frames live in a region of memory shared with the kernel (the UMEM), which is
+/// split into fixed size frames. Free frames are handed to the kernel through the fill ring,
+/// and received frames come back through the receive ring. Frames to send are written into
+/// free frames and queued on the transmit ring, and the kernel returns them through the
+/// completion ring once they are sent. Batches move many descriptors with a single system
+/// call, or none at all for receives.
+///
+/// The session loads a small XDP program on the interface that redirects every frame of the
+/// queue to the socket, and frames of other queues to the network stack. The program is
+/// detached when the session is destroyed. This needs CAP_NET_ADMIN and CAP_BPF (or
+/// CAP_SYS_ADMIN).
+///
+/// receiveViews() exposes received frames as views into the UMEM, which can be handed to
+/// MessageParser::parseBuffer() or Serializable::deserialize() without copying them.
+///
+/// @note An interface runs a single XDP program, so only one session can be bound to it.
+///
+/// @example
+/// XdpSession session("veth0");
+/// std::vector<boost::asio::const_buffer> frames;
+/// session.receiveViews(frames, 64);
+/// for (const auto& frame : frames)
+/// {
+///     message.deserialize(static_cast<const uint8_t*>(frame.data()), frame.size());
+/// }
+/// session.releaseViews();
+class XdpSession : public Session
+{
+public:
+    /// Constructor.
+    /// @param interface Name of the network interface to bind to.
+    /// @param options Settings of the UMEM and the rings.
+    /// @throws std::invalid_argument If the options are invalid.
+    /// @throws boost::system::system_error If the socket or the XDP program cannot be set up.
+    explicit XdpSession(const std::string& interface, const XdpOptions& options = XdpOptions());
+
+    /// Deconstructor. Detaches the XDP program.
+    ~XdpSession();
+
+    /// Send data to the network.
+    /// @returns The size of the data, or 0 if it does not fit into a frame.
+    /// @throws boost::system::system_error If the device doesn't take the frames within a
+    /// second, for example while the link is down.
+    virtual std::size_t send(std::vector<uint8_t>& inData);
+
+    /// Send object to the network. The object is serialized straight into the UMEM.
+    /// @returns The size of the object, or 0 if it does not fit into a frame.
+    /// @throws boost::system::system_error If the device doesn't take the frames within a
+    /// second.
+    virtual std::size_t send(Serializable& inData);
+
+    /// Receive data from the network.
+    /// @param outData Must be non-empty (size > 0). Longer frames are truncated.
+    virtual std::size_t receive(std::vector<uint8_t>& outData);
+
+    /// Receive object from the network. The object is deserialized straight from the UMEM.
+    virtual std::size_t receive(Serializable& outData);
+
+    /// Send several frames to the network with a single system call.
+    /// @details Stops at the first frame that doesn't fit into a UMEM frame, or at the first
+    /// frame for which no UMEM frame is released in time.
+    /// @returns The number of leading frames sent.
+    /// @throws boost::system::system_error If not even the first frame gets a UMEM frame, or
+    /// the device doesn't take the queued frames within a second.
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames);
+
+    /// Receive the available frames from the network.
+    /// @details Blocks until at least one frame is received.
+    virtual std::size_t receiveBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t maxFrames);
+
+    /// Wait until a frame can be received without blocking.
+    /// @returns Whether a frame is available before the timeout expires.
+    virtual bool waitForFrames(const std::chrono::milliseconds timeout);
+
+    /// Receive the available frames from the network, and expose them as views into the UMEM.
+    /// @details Blocks until at least one frame is received. The views remain valid until
+    /// releaseViews() is called, and frames that are still held are released first.
+    /// @returns The number of frames received.
+    std::size_t receiveViews(std::vector<boost::asio::const_buffer>& outFrames, const std::size_t maxFrames);
+
+    /// Hand the frames of the last receiveViews() back to the kernel.
+    void releaseViews();
+
+    /// Where the XDP program runs. Never XdpMode::Auto.
+    XdpMode getMode() const;
+
+    /// Settings of the UMEM and the rings.
+    const XdpOptions& getOptions() const;
+
+    /// Descriptor of the AF_XDP socket.
+    int getDescriptor() const;
+
+private:
+    /// Ring of descriptors shared with the kernel.
+    struct Ring
+    {
+        /// Index of the next descriptor the producer writes.
+        uint32_t* producer{ nullptr };
+
+        /// Index of the next descriptor the consumer reads.
+        uint32_t* consumer{ nullptr };
+
+        /// Descriptors: frame addresses for the fill and completion rings, and xdp_desc for the
+        /// receive and transmit rings.
+        void* descriptors{ nullptr };
+
+        /// Number of descriptors minus one.
+        uint32_t mask{ 0 };
+
+        /// Memory mapping of the ring.
+        void* mapping{ nullptr };
+
+        /// Size of the memory mapping.
+        std::size_t mappingSize{ 0 };
+    };
+
+    /// Create the UMEM and the rings, and bind the socket.
+    void setUpSocket(const unsigned int interfaceIndex);
+
+    /// Load the XDP program and attach it to the interface.
+    void setUpProgram(const unsigned int interfaceIndex);
+
+    /// Release every resource.
+    void tearDown();
+
+    /// Map a ring of the socket into memory.
+    void mapRing(Ring& ring, const uint64_t offset, const xdp_ring_offset& ringOffsets, const std::size_t descriptorSize);
+
+    /// Wait for received frames.
+    /// @param timeout Timeout in milliseconds, or -1 to wait forever.
+    /// @returns The number of received frames that were not taken yet.
+    uint32_t waitForReceived(const int timeout);
+
+    /// Hand received frames back to the kernel through the fill ring.
+    void recycle(const uint32_t count);
+
+    /// Free frame for sending, waiting for a send to complete if there is none.
+    /// @throws boost::system::system_error If no send completes within the timeout.
+    uint64_t acquireFrame();
+
+    /// Queue the first length bytes of the frame on the transmit ring.
+    void queueFrame(const uint64_t address, const std::size_t length);
+
+    /// Publish the queued frames and have the kernel send them.
+    /// @throws boost::system::system_error If the device doesn't take them within the timeout.
+    void flush();
+
+    /// Take the frames the kernel is done sending from the completion ring.
+    void reclaim();
+
+    /// Settings of the UMEM and the rings.
+    XdpOptions options;
+
+    /// Where the XDP program runs.
+    XdpMode mode{ XdpMode::Generic };
+
+    /// AF_XDP socket.
+    int descriptor{ -1 };
+
+    /// Map from receive queues to sockets, read by the XDP program.
+    int mapDescriptor{ -1 };
+
+    /// XDP program.
+    int programDescriptor{ -1 };
+
+    /// Link that attaches the program to the interface. Closing it detaches the program.
+    int linkDescriptor{ -1 };
+
+    /// Frames shared with the kernel.
+    uint8_t* umem{ nullptr };
+
+    /// Frames given by the kernel.
+    Ring rxRing;
+
+    /// Frames handed to the kernel for sending.
+    Ring txRing;
+
+    /// Free frames handed to the kernel for receiving.
+    Ring fillRing;
+
+    /// Frames the kernel is done sending.
+    Ring completionRing;
+
+    /// Local copy of the producer index of the transmit ring.
+    uint32_t txProducer{ 0 };
+
+    /// Local copy of the producer index of the fill ring.
+    uint32_t fillProducer{ 0 };
+
+    /// Local copy of the consumer index of the receive ring.
+    uint32_t rxConsumer{ 0 };
+
+    /// Local copy of the consumer index of the completion ring.
+    uint32_t completionConsumer{ 0 };
+
+    /// Received frames exposed by receiveViews() that were not released yet.
+    uint32_t heldFrames{ 0 };
+
+    /// Frames that are free for sending.
+    std::vector<uint64_t> freeFrames;
+};
+
+} // namespace ss
+} // namespace nts
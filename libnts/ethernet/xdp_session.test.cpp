@@ -0,0 +1,234 @@
+#include <boost/system/system_error.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <unistd.h>
+
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/core/data_unit.hpp>
+#include <libnts/ethernet/tap_session.hpp>
+#include <libnts/ethernet/xdp_session.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Broadcast frame with an unassigned EtherType, so that it is ignored by the network stack.
+std::vector<uint8_t> makeFrame(const uint8_t index)
+{
+    std::vector<uint8_t> frame = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x88, 0xb5 };
+    for (uint8_t i = 0; i < 46; i++)
+    {
+        frame.push_back(index + i);
+    }
+    return frame;
+}
+
+/// Whether the frame is a test frame, rather than one the kernel sends on its own.
+bool isTestFrame(const std::vector<uint8_t>& frame)
+{
+    return frame.size() > 14 && frame[12] == 0x88 && frame[13] == 0xb5;
+}
+
+/// TAP device with an XDP session bound to it, for frames that go through the kernel.
+struct XdpPair
+{
+    std::unique_ptr<ss::TapSession> tap;
+    std::unique_ptr<ss::XdpSession> xdp;
+};
+
+/// Pair for the test, with empty sessions without CAP_NET_ADMIN or CAP_BPF.
+XdpPair createPair(const std::string& name, const ss::XdpOptions& options = ss::XdpOptions())
+{
+    XdpPair pair;
+    try
+    {
+        pair.tap.reset(new ss::TapSession(name + std::to_string(getpid() % 10000)));
+        pair.xdp.reset(new ss::XdpSession(pair.tap->getName(), options));
+    }
+    catch (const boost::system::system_error& error)
+    {
+        pair.xdp.reset();
+    }
+    return pair;
+}
+
+} // namespace
+
+TEST(XdpSessionUnitTests, SendReceive)
+{
+    XdpPair pair = createPair("ntsxdp");
+    if (!pair.xdp)
+    {
+        GTEST_SKIP() << "AF_XDP sockets are not available";
+    }
+    EXPECT_EQ(pair.xdp->getMode(), ss::XdpMode::Generic);
+
+    // Frames the kernel receives on the interface are redirected to the socket.
+    std::vector<uint8_t> request = makeFrame(1);
+    ASSERT_EQ(pair.tap->send(request), request.size());
+    ASSERT_TRUE(pair.xdp->waitForFrames(std::chrono::milliseconds(1000)));
+    std::vector<uint8_t> buffer(ss::MTU_SIZE, 0);
+    buffer.resize(pair.xdp->receive(buffer));
+    EXPECT_EQ(buffer, request);
+
+    GenericDataUnit object = GenericDataUnit().setData(makeFrame(2));
+    ASSERT_EQ(pair.tap->send(object), 60u);
+    GenericDataUnit received;
+    ASSERT_EQ(pair.xdp->receive(received), 60u);
+    EXPECT_EQ(received.getData(), object.getData());
+
+    // Frames sent by the socket are transmitted on the interface.
+    std::vector<uint8_t> reply = makeFrame(3);
+    ASSERT_EQ(pair.xdp->send(reply), reply.size());
+    ASSERT_EQ(pair.xdp->send(object), 60u);
+    std::vector<std::vector<uint8_t>> replies;
+    while (replies.size() < 2)
+    {
+        ASSERT_TRUE(pair.tap->waitForFrames(std::chrono::milliseconds(1000)));
+        buffer.resize(ss::MTU_SIZE);
+        buffer.resize(pair.tap->receive(buffer));
+        if (isTestFrame(buffer))
+        {
+            replies.push_back(buffer);
+        }
+    }
+    EXPECT_EQ(replies[0], reply);
+    EXPECT_EQ(replies[1], object.getData());
+
+    // Frames larger than the UMEM frames are not sent.
+    std::vector<uint8_t> large(4096, 0);
+    EXPECT_EQ(pair.xdp->send(large), 0u);
+}
+
+TEST(XdpSessionUnitTests, Batch)
+{
+    // Fewer frames than the batches, so frames are reused while batches are in flight.
+    ss::XdpOptions options;
+    options.frameCount = 16;
+    options.ringSize = 8;
+    XdpPair pair = createPair("ntsxdpb", options);
+    if (!pair.xdp)
+    {
+        GTEST_SKIP() << "AF_XDP sockets are not available";
+    }
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        frames.push_back(makeFrame(i));
+    }
+    ASSERT_EQ(pair.xdp->sendBatch(frames), frames.size());
+    std::vector<std::vector<uint8_t>> received;
+    std::vector<uint8_t> buffer(ss::MTU_SIZE, 0);
+    while (received.size() < frames.size())
+    {
+        ASSERT_TRUE(pair.tap->waitForFrames(std::chrono::milliseconds(1000)));
+        buffer.resize(ss::MTU_SIZE);
+        buffer.resize(pair.tap->receive(buffer));
+        if (isTestFrame(buffer))
+        {
+            received.push_back(buffer);
+        }
+    }
+    EXPECT_EQ(received, frames);
+
+    // Received frames are exposed as views until they are released.
+    received.clear();
+    for (std::size_t i = 0; i < frames.size(); i += 4)
+    {
+        std::vector<std::vector<uint8_t>> batch(frames.begin() + i, frames.begin() + i + 4);
+        ASSERT_EQ(pair.tap->sendBatch(batch), batch.size());
+        std::vector<boost::asio::const_buffer> views;
+        while (received.size() < i + batch.size())
+        {
+            ASSERT_TRUE(pair.xdp->waitForFrames(std::chrono::milliseconds(1000)));
+            ASSERT_GT(pair.xdp->receiveViews(views, 3), 0u);
+            ASSERT_LE(views.size(), 3u);
+            for (const auto& view : views)
+            {
+                const uint8_t* data = static_cast<const uint8_t*>(view.data());
+                received.emplace_back(data, data + view.size());
+            }
+        }
+        pair.xdp->releaseViews();
+    }
+    EXPECT_EQ(received, frames);
+
+    // Frames that arrive while every receive frame is in use are dropped, so the batches
+    // are not larger than the receive half of the UMEM.
+    std::vector<std::vector<uint8_t>> buffers(3, std::vector<uint8_t>(ss::MTU_SIZE));
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < frames.size(); i += 8)
+    {
+        std::vector<std::vector<uint8_t>> batch(frames.begin() + i, frames.begin() + i + 8);
+        ASSERT_EQ(pair.tap->sendBatch(batch), batch.size());
+        while (count < i + batch.size())
+        {
+            ASSERT_TRUE(pair.xdp->waitForFrames(std::chrono::milliseconds(1000)));
+            const std::size_t received = pair.xdp->receiveBatch(buffers, buffers.size());
+            for (std::size_t j = 0; j < received; j++)
+            {
+                EXPECT_EQ(buffers[j], frames[count + j]);
+                buffers[j].resize(ss::MTU_SIZE);
+            }
+            count += received;
+        }
+    }
+    EXPECT_EQ(count, frames.size());
+}
+
+TEST(XdpSessionUnitTests, Options)
+{
+    ss::XdpOptions options;
+    options.frameSize = 1000;
+    EXPECT_THROW(ss::XdpSession("lo", options), std::invalid_argument);
+    options.frameSize = 2048;
+    options.ringSize = 1000;
+    EXPECT_THROW(ss::XdpSession("lo", options), std::invalid_argument);
+
+    // The send half of an odd count has one frame more than the transmit ring.
+    options.ringSize = 4;
+    options.frameCount = 9;
+    EXPECT_THROW(ss::XdpSession("lo", options), std::invalid_argument);
+    options.frameCount = 4096;
+    options.ringSize = 2048;
+
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Session.Xdp.Mode"] = "auto";
+    config->intParams["Session.Xdp.QueueId"] = 1;
+    config->intParams["Session.Xdp.FrameCount"] = 64;
+    config->intParams["Session.Xdp.FrameSize"] = 4096;
+    config->intParams["Session.Xdp.RingSize"] = 32;
+    options.configure(config, "Session.Xdp");
+    EXPECT_EQ(options.mode, ss::XdpMode::Auto);
+    EXPECT_EQ(options.queueId, 1u);
+    EXPECT_EQ(options.frameCount, 64u);
+    EXPECT_EQ(options.frameSize, 4096u);
+    EXPECT_EQ(options.ringSize, 32u);
+    config->stringParams["Session.Xdp.Mode"] = "fast";
+    EXPECT_THROW(options.configure(config, "Session.Xdp"), std::invalid_argument);
+}
+
+TEST(XdpSessionUnitTests, Create)
+{
+    XdpPair pair = createPair("ntsxdpc");
+    if (!pair.xdp)
+    {
+        GTEST_SKIP() << "AF_XDP sockets are not available";
+    }
+    const std::string interface = pair.tap->getName();
+    pair.xdp.reset();
+
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Session.Type"] = "xdp";
+    config->stringParams["Session.Interface"] = interface;
+    config->stringParams["Session.Xdp.Mode"] = "auto";
+    std::shared_ptr<ss::Session> session = ss::Session::create(config);
+    auto xdp = std::dynamic_pointer_cast<ss::XdpSession>(session);
+    ASSERT_TRUE(xdp);
+    EXPECT_NE(xdp->getMode(), ss::XdpMode::Auto);
+}
+
+} // namespace tests
+} // namespace nts
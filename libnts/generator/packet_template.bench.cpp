@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/generator/packet_template.hpp>
+#include <libnts/icmp/icmp.hpp>
+#include <libnts/ipv4/ipv4.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// ICMP echo request with a payload.
+Message makeMessage(std::shared_ptr<ip::Ipv4DataUnit> ipv4, std::shared_ptr<icmp::IcmpDataUnit> icmp)
+{
+    ipv4->setTotalLength(20 + 8 + 56).setProtocol((uint8_t)ip::IpPayloadProtocols::ICMP);
+    return Message()
+        .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+        .addDataUnit(ipv4)
+        .addDataUnit(icmp)
+        .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData(std::vector<uint8_t>(56, 0xab))));
+}
+
+} // namespace
+
+/// Rewrite the fields of the data units and serialize the whole message for each packet.
+void BM_MessageRewrite(benchmark::State& state)
+{
+    auto ipv4 = std::make_shared<ip::Ipv4DataUnit>();
+    auto icmp = std::make_shared<icmp::IcmpDataUnit>();
+    Message message = makeMessage(ipv4, icmp);
+    std::vector<uint8_t> frame(message.getSize());
+    uint16_t sequence = 0;
+    for (auto _ : state)
+    {
+        sequence++;
+        ipv4->setIdentification(sequence).setSourceAddress(ip::Ipv4Address(0x0a000000 | (sequence & 0xFF)));
+        ipv4->computeChecksum();
+        icmp->setSequenceNumber(sequence);
+        icmp->computeChecksum(frame.data() + 42, 56);
+        message.serialize(frame.data(), frame.size());
+        benchmark::DoNotOptimize(frame.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Same changes, applied by the mutators of a template.
+void BM_TemplateNext(benchmark::State& state)
+{
+    Message message = makeMessage(std::make_shared<ip::Ipv4DataUnit>(), std::make_shared<icmp::IcmpDataUnit>());
+    gen::PacketTemplate packets(message);
+    packets.addMutator("ipv4.identification", gen::FieldMutator::increment())
+        .addMutator("ipv4.source", gen::FieldMutator::range(0x0a000000, 0x0a0000ff))
+        .addMutator("icmp.sequence", gen::FieldMutator::increment());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(packets.next().data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Template packets copied into a batch of frames, as handed to Session::sendBatch.
+void BM_TemplateFillBatch(benchmark::State& state)
+{
+    Message message = makeMessage(std::make_shared<ip::Ipv4DataUnit>(), std::make_shared<icmp::IcmpDataUnit>());
+    gen::PacketTemplate packets(message);
+    packets.addMutator("ipv4.identification", gen::FieldMutator::increment())
+        .addMutator("ipv4.source", gen::FieldMutator::range(0x0a000000, 0x0a0000ff))
+        .addMutator("icmp.sequence", gen::FieldMutator::increment());
+    std::vector<std::vector<uint8_t>> frames;
+    for (auto _ : state)
+    {
+        packets.fillBatch(frames, state.range(0));
+        benchmark::DoNotOptimize(frames.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_MessageRewrite);
+BENCHMARK(BM_TemplateNext);
+BENCHMARK(BM_TemplateFillBatch)->Arg(64);
+
+} // namespace benchmarks
+} // namespace nts
@@ -0,0 +1,453 @@
+#include <libnts/generator/packet_template.hpp>
+
+#include <algorithm>
+#include <boost/endian/conversion.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <libnts/config/configuration.hpp>
+#include <libnts/core/checksum.hpp>
+#include <libnts/core/session.hpp>
+#include <libnts/ethernet/mac_address.hpp>
+#include <libnts/ipv4/ipv4_address.hpp>
+
+namespace nts {
+namespace gen {
+
+namespace {
+
+/// Smallest IPv4 header.
+constexpr std::size_t ipv4HeaderSize{ 20 };
+
+/// ICMP header.
+constexpr std::size_t icmpHeaderSize{ 8 };
+
+/// Field that mutators can refer to by name.
+struct NamedField
+{
+    /// Name of the field.
+    const char* name;
+
+    /// Tag of the data unit that contains the field.
+    const char* protocol;
+
+    /// Offset of the field from the start of the data unit.
+    std::size_t offset;
+
+    /// Width of the field in bytes.
+    std::size_t width;
+};
+
+const NamedField namedFields[] = {
+    { "ethernet.destination", "ethernet", 0, 6 },
+    { "ethernet.source", "ethernet", 6, 6 },
+    { "ipv4.identification", "ipv4", 4, 2 },
+    { "ipv4.ttl", "ipv4", 8, 1 },
+    { "ipv4.source", "ipv4", 12, 4 },
+    { "ipv4.destination", "ipv4", 16, 4 },
+    { "icmp.identifier", "icmp", 4, 2 },
+    { "icmp.sequence", "icmp", 6, 2 },
+};
+
+/// Largest value that fits in a field of the given width.
+uint64_t widthMask(const std::size_t width)
+{
+    return width >= 8 ? ~uint64_t(0) : (uint64_t(1) << (8 * width)) - 1;
+}
+
+/// Writes the low bytes of the value to the buffer in network byte order.
+void storeBig(uint8_t* outBuffer, const std::size_t width, const uint64_t value)
+{
+    const uint64_t big = boost::endian::native_to_big(value);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&big);
+
+    // Constant sizes let the compiler turn the copies into plain stores. Branches are used
+    // instead of a switch, since an indirect jump through a table costs more than the store.
+    if (width == 2)
+    {
+        memcpy(outBuffer, bytes + 6, 2);
+    }
+    else if (width == 4)
+    {
+        memcpy(outBuffer, bytes + 4, 4);
+    }
+    else if (width == 1)
+    {
+        outBuffer[0] = static_cast<uint8_t>(value);
+    }
+    else if (width == 6)
+    {
+        memcpy(outBuffer, bytes + 2, 6);
+    }
+    else
+    {
+        memcpy(outBuffer, bytes + 8 - width, width);
+    }
+}
+
+/// One's complement sum of the value as 16-bit words, aligned to its last byte.
+uint16_t sumWords(const uint64_t value, const bool swap)
+{
+    uint64_t sum = (value & 0xFFFF) + ((value >> 16) & 0xFFFF) + ((value >> 32) & 0xFFFF) + (value >> 48);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+
+    // When the last byte is a high byte, every byte of the value sits on the other half of
+    // its word. The one's complement sum is byte order independent, so swapping the result
+    // is enough (RFC 1071).
+    const uint16_t folded = static_cast<uint16_t>(sum);
+    return swap ? boost::endian::endian_reverse(folded) : folded;
+}
+
+/// Next value of a xorshift64* generator, which is much cheaper than the standard engines.
+uint64_t nextRandom(uint64_t& state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1d;
+}
+
+/// Number, IPv4 address or MAC address in text form.
+uint64_t parseValue(const std::string& text)
+{
+    ip::Ipv4Address ipAddress;
+    if (ip::Ipv4Address::tryParse(text.data(), text.size(), ipAddress))
+    {
+        return ipAddress.toUint32();
+    }
+    eth::MacAddress macAddress;
+    if (eth::MacAddress::tryParse(text.data(), text.size(), macAddress))
+    {
+        uint64_t value = 0;
+        for (std::size_t i = 0; i < 6; i++)
+        {
+            value = (value << 8) | macAddress[i];
+        }
+        return value;
+    }
+    char* end = nullptr;
+    const uint64_t value = std::strtoull(text.c_str(), &end, 0);
+    if (text.empty() || text[0] == '-' || *end != '\0')
+    {
+        throw std::invalid_argument("Invalid mutator value: " + text);
+    }
+    return value;
+}
+
+} // namespace
+
+FieldMutator FieldMutator::increment(const uint64_t step)
+{
+    FieldMutator mutator;
+    mutator.mode = MutatorMode::Increment;
+    mutator.step = step;
+    return mutator;
+}
+
+FieldMutator FieldMutator::range(const uint64_t minimum, const uint64_t maximum, const uint64_t step)
+{
+    FieldMutator mutator;
+    mutator.mode = MutatorMode::Range;
+    mutator.minimum = minimum;
+    mutator.maximum = maximum;
+    mutator.step = step;
+    return mutator;
+}
+
+FieldMutator FieldMutator::random(const uint64_t minimum, const uint64_t maximum)
+{
+    FieldMutator mutator;
+    mutator.mode = MutatorMode::Random;
+    mutator.minimum = minimum;
+    mutator.maximum = maximum;
+    return mutator;
+}
+
+PacketTemplate::PacketTemplate(Message& message)
+{
+    setMessage(message);
+}
+
+PacketTemplate& PacketTemplate::setMessage(Message& message)
+{
+    image.assign(message.getSize(), 0);
+    message.serialize(image.data(), image.size());
+
+    // Locate the first data unit of each protocol.
+    std::vector<std::shared_ptr<ProtocolDataUnit>> units;
+    message.getDataUnits(units);
+    layers.clear();
+    std::size_t offset = 0;
+    for (const auto& unit : units)
+    {
+        const std::string protocol = unit->getProtocolTag();
+        if (getLayerOffset(protocol) == image.size())
+        {
+            layers.emplace_back(protocol, offset);
+        }
+        offset += unit->getUnitSize();
+    }
+
+    // Compute the checksums once. Mutators only adjust them from here on.
+    checksums.clear();
+    const std::size_t ipOffset = getLayerOffset("ipv4");
+    if (ipOffset + ipv4HeaderSize <= image.size())
+    {
+        const std::size_t headerLength = std::min<std::size_t>(std::max<std::size_t>((image[ipOffset] & 0x0F) * 4, ipv4HeaderSize), image.size() - ipOffset);
+        checksums.push_back({ ipOffset, ipOffset + headerLength, ipOffset + 10 });
+    }
+    const std::size_t icmpOffset = getLayerOffset("icmp");
+    if (icmpOffset + icmpHeaderSize <= image.size())
+    {
+        checksums.push_back({ icmpOffset, image.size(), icmpOffset + 2 });
+    }
+    for (const auto& region : checksums)
+    {
+        image[region.checksum] = 0;
+        image[region.checksum + 1] = 0;
+        const uint16_t checksum = internetChecksum(image.data() + region.begin, region.end - region.begin);
+        image[region.checksum] = checksum >> 8;
+        image[region.checksum + 1] = checksum & 0xFF;
+    }
+
+    mutators.clear();
+    packetCount = 0;
+    return *this;
+}
+
+PacketTemplate& PacketTemplate::addMutator(const std::string& field, const FieldMutator& mutator)
+{
+    for (const auto& namedField : namedFields)
+    {
+        if (field == namedField.name)
+        {
+            const std::size_t layerOffset = getLayerOffset(namedField.protocol);
+            if (layerOffset == image.size())
+            {
+                throw std::logic_error("Message has no " + std::string(namedField.protocol) + " layer");
+            }
+            return addMutator(layerOffset + namedField.offset, namedField.width, mutator);
+        }
+    }
+    throw std::invalid_argument("Unknown field: " + field);
+}
+
+PacketTemplate& PacketTemplate::addMutator(const std::size_t offset, const std::size_t width, const FieldMutator& mutator)
+{
+    if (width == 0 || width > 8 || offset + width > image.size())
+    {
+        throw std::logic_error("Field doesn't fit in the packet image");
+    }
+    if (mutator.mode != MutatorMode::Increment && mutator.minimum > mutator.maximum)
+    {
+        throw std::invalid_argument("Mutator minimum is larger than its maximum");
+    }
+
+    CompiledMutator compiled{};
+    compiled.offset = offset;
+    compiled.width = width;
+    compiled.mutator = mutator;
+    const uint64_t mask = widthMask(width);
+    compiled.mutator.minimum &= mask;
+    compiled.mutator.maximum &= mask;
+    for (std::size_t i = 0; i < width; i++)
+    {
+        compiled.written = (compiled.written << 8) | image[offset + i];
+    }
+    // Increments start from the value of the message.
+    compiled.value = mutator.mode == MutatorMode::Range ? compiled.mutator.minimum : compiled.written;
+
+    // Work out once how the field contributes to each checksum that covers it.
+    const std::size_t end = offset + width;
+    for (const auto& region : checksums)
+    {
+        if (end <= region.begin || offset >= region.end)
+        {
+            continue;
+        }
+        if (compiled.patchCount == 2)
+        {
+            throw std::logic_error("Field spans more than two checksum regions");
+        }
+        ChecksumPatch& patch = compiled.patches[compiled.patchCount++];
+        patch.checksum = region.checksum;
+        patch.swap = (end - region.begin) % 2 == 1;
+        patch.mask = 0;
+        for (std::size_t i = 0; i < width; i++)
+        {
+            // Byte i of the value, counted from the last one.
+            const std::size_t position = end - 1 - i;
+            if (position >= region.begin && position < region.end)
+            {
+                patch.mask |= uint64_t(0xFF) << (8 * i);
+            }
+        }
+    }
+    mutators.push_back(compiled);
+    return *this;
+}
+
+PacketTemplate& PacketTemplate::clearMutators()
+{
+    mutators.clear();
+    return *this;
+}
+
+PacketTemplate& PacketTemplate::configure(std::shared_ptr<Configuration> config, const std::string& key)
+{
+    if (auto seed = config->getString(key + ".Seed"))
+    {
+        setSeed(parseValue(seed.value()));
+    }
+
+    for (std::size_t index = 0;; index++)
+    {
+        const std::string mutatorKey = key + ".Mutators." + std::to_string(index);
+        const auto field = config->getString(mutatorKey + ".Field");
+        const auto offset = config->getString(mutatorKey + ".Offset");
+        if (!field && !offset)
+        {
+            break;
+        }
+
+        FieldMutator mutator;
+        const std::string mode = config->getString(mutatorKey + ".Mode").value_or("increment");
+        if (mode == "increment")
+        {
+            mutator.mode = MutatorMode::Increment;
+        }
+        else if (mode == "range")
+        {
+            mutator.mode = MutatorMode::Range;
+        }
+        else if (mode == "random")
+        {
+            mutator.mode = MutatorMode::Random;
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown mutator mode: " + mode);
+        }
+        if (auto minimum = config->getString(mutatorKey + ".Minimum"))
+        {
+            mutator.minimum = parseValue(minimum.value());
+        }
+        if (auto maximum = config->getString(mutatorKey + ".Maximum"))
+        {
+            mutator.maximum = parseValue(maximum.value());
+        }
+        if (auto step = config->getString(mutatorKey + ".Step"))
+        {
+            mutator.step = parseValue(step.value());
+        }
+
+        if (field)
+        {
+            addMutator(field.value(), mutator);
+        }
+        else
+        {
+            const std::string width = config->getString(mutatorKey + ".Width").value_or("1");
+            addMutator(parseValue(offset.value()), parseValue(width), mutator);
+        }
+    }
+    return *this;
+}
+
+PacketTemplate& PacketTemplate::setSeed(const uint64_t seed)
+{
+    // The generator never leaves the zero state, so that seed is replaced.
+    randomState = seed != 0 ? seed : 0x9e3779b97f4a7c15;
+    return *this;
+}
+
+const std::vector<uint8_t>& PacketTemplate::next()
+{
+    // Everything stays in this loop: calls between functions of a shared library go through
+    // the PLT and cost more than the mutation itself.
+    for (auto& compiled : mutators)
+    {
+        const FieldMutator& mutator = compiled.mutator;
+        uint64_t value = compiled.value;
+        switch (mutator.mode)
+        {
+        case MutatorMode::Increment:
+            compiled.value = (value + mutator.step) & widthMask(compiled.width);
+            break;
+        case MutatorMode::Range:
+        {
+            const uint64_t following = value + mutator.step;
+            compiled.value = (following > mutator.maximum || following < value) ? mutator.minimum : following;
+            break;
+        }
+        case MutatorMode::Random:
+        {
+            // The modulo slightly favors small values when the span isn't a power of two,
+            // which is fine for traffic generation.
+            const uint64_t span = mutator.maximum - mutator.minimum + 1;
+            const uint64_t random = nextRandom(randomState);
+            value = mutator.minimum + (span != 0 ? random % span : random);
+            break;
+        }
+        }
+
+        storeBig(image.data() + compiled.offset, compiled.width, value);
+        for (std::size_t i = 0; i < compiled.patchCount; i++)
+        {
+            const ChecksumPatch& patch = compiled.patches[i];
+            uint8_t* field = image.data() + patch.checksum;
+            const uint16_t checksum = updateChecksum(uint16_t((field[0] << 8) | field[1]),
+                                                     sumWords(compiled.written & patch.mask, patch.swap),
+                                                     sumWords(value & patch.mask, patch.swap));
+            field[0] = checksum >> 8;
+            field[1] = checksum & 0xFF;
+        }
+        compiled.written = value;
+    }
+    packetCount++;
+    return image;
+}
+
+std::size_t PacketTemplate::fillBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t count)
+{
+    outFrames.resize(count);
+    for (auto& frame : outFrames)
+    {
+        const std::vector<uint8_t>& packet = next();
+        frame.assign(packet.begin(), packet.end());
+    }
+    return count;
+}
+
+std::size_t PacketTemplate::sendBatch(ss::Session& session, const std::size_t count)
+{
+    fillBatch(batch, count);
+    return session.sendBatch(batch);
+}
+
+const std::vector<uint8_t>& PacketTemplate::getImage() const
+{
+    return image;
+}
+
+std::size_t PacketTemplate::getLayerOffset(const std::string& protocol) const
+{
+    for (const auto& layer : layers)
+    {
+        if (layer.first == protocol)
+        {
+            return layer.second;
+        }
+    }
+    return image.size();
+}
+
+uint64_t PacketTemplate::getPacketCount() const
+{
+    return packetCount;
+}
+
+} // namespace gen
+} // namespace nts
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libnts/messaging/message.hpp>
+
+namespace nts {
+
+// Forward declaration.
+class Configuration;
+
+namespace ss {
+class Session;
+} // namespace ss
+
+namespace gen {
+
+/// How a mutator changes its field from one packet to the next.
+enum class MutatorMode
+{
+    /// Adds the step to the value of the previous packet, wrapping at the width of the field.
+    /// The first packet keeps the value of the message. Suits counters and sequence numbers.
+    Increment,
+    /// Walks from the minimum to the maximum by the step, then starts over. Suits address sweeps.
+    Range,
+    /// Draws a value between the minimum and the maximum, both inclusive.
+    Random,
+};
+
+/// Change applied to a field of the packet image before each packet is sent.
+struct FieldMutator
+{
+    /// Adds the step to the field for each packet.
+    static FieldMutator increment(const uint64_t step = 1);
+
+    /// Walks the field from the minimum to the maximum, both inclusive.
+    static FieldMutator range(const uint64_t minimum, const uint64_t maximum, const uint64_t step = 1);
+
+    /// Sets the field to a random value between the minimum and the maximum, both inclusive.
+    static FieldMutator random(const uint64_t minimum, const uint64_t maximum);
+
+    /// How the field changes.
+    MutatorMode mode{ MutatorMode::Increment };
+
+    /// Smallest value of the field. Unused in increment mode.
+    uint64_t minimum{ 0 };
+
+    /// Largest value of the field. Unused in increment mode.
+    uint64_t maximum{ 0 };
+
+    /// Difference between two consecutive values. Unused in random mode.
+    uint64_t step{ 1 };
+};
+
+/// Byte image of a message that is serialized once and then modified in place for each packet.
+///
+/// @details Rewriting the fields of data units and serializing every layer again for each
+/// packet costs far more than the few bytes that actually change. A template serializes the
+/// message once, locates its Ethernet, IPv4 and ICMP headers, and computes the IPv4 and ICMP
+/// checksums of the image. Each packet then only applies the mutators to their fields and
+/// adjusts the checksums that cover them (RFC 1624), so the cost of a packet depends on the
+/// number of mutators instead of the size of the message.
+///
+/// Mutators either target a named field ("ethernet.destination", "ethernet.source",
+/// "ipv4.identification", "ipv4.ttl", "ipv4.source", "ipv4.destination", "icmp.identifier",
+/// "icmp.sequence") or a raw offset and width in the image. Values are written in network
+/// byte order. Mutators must not overlap the checksum fields.
+///
+/// @note A template is not thread safe. Use one template per sending thread.
+///
+/// @example
+/// PacketTemplate packets(message);
+/// packets.addMutator("ipv4.source", FieldMutator::range(0x0a000001, 0x0a0000fe))
+///        .addMutator("icmp.sequence", FieldMutator::increment());
+/// while (running)
+/// {
+///     packets.sendBatch(*session, 64);
+/// }
+class PacketTemplate
+{
+public:
+    /// Constructor. Creates an empty template.
+    PacketTemplate() = default;
+
+    /// Constructor.
+    /// @param message Message to serialize into the image.
+    explicit PacketTemplate(Message& message);
+
+    /// Deconstructor.
+    virtual ~PacketTemplate() = default;
+
+    /// Serializes the message into the image and computes its checksums.
+    /// @details Removes the mutators, since the layout of the image may have changed.
+    virtual PacketTemplate& setMessage(Message& message);
+
+    /// Adds a mutator for a named field.
+    /// @throws std::invalid_argument If the field name is unknown.
+    /// @throws std::logic_error If the message doesn't contain the layer of the field.
+    virtual PacketTemplate& addMutator(const std::string& field, const FieldMutator& mutator);
+
+    /// Adds a mutator for the bytes at the offset.
+    /// @param offset Offset of the field from the start of the image.
+    /// @param width Width of the field in bytes, from 1 to 8.
+    /// @throws std::logic_error If the field doesn't fit in the image.
+    virtual PacketTemplate& addMutator(const std::size_t offset, const std::size_t width, const FieldMutator& mutator);
+
+    /// Removes every mutator. The image keeps the values of the last packet.
+    virtual PacketTemplate& clearMutators();
+
+    /// Adds the mutators listed in the Configuration object.
+    /// @details Mutators are read from "<key>.Mutators.0", "<key>.Mutators.1" and so on,
+    /// until an index is missing. Each one has a "Field" name, or an "Offset" and a "Width",
+    /// and a "Mode" ("increment", "range" or "random"). "Minimum", "Maximum" and "Step" accept
+    /// numbers as well as IPv4 and MAC addresses. "<key>.Seed" seeds the random mutators.
+    /// @throws std::invalid_argument If a parameter is invalid.
+    virtual PacketTemplate& configure(std::shared_ptr<Configuration> config, const std::string& key);
+
+    /// Seed of the generator used by random mutators.
+    virtual PacketTemplate& setSeed(const uint64_t seed);
+
+    /// Applies the mutators to the image.
+    /// @returns The image of the next packet.
+    virtual const std::vector<uint8_t>& next();
+
+    /// Writes the next packets to the frames.
+    /// @details Frames are resized to hold count packets. Their storage is reused, so a loop
+    /// that fills the same frames doesn't allocate once it is warmed up.
+    /// @returns The number of packets written.
+    virtual std::size_t fillBatch(std::vector<std::vector<uint8_t>>& outFrames, const std::size_t count);
+
+    /// Sends the next packets with the batch operation of the session.
+    /// @returns The number of packets sent.
+    virtual std::size_t sendBatch(ss::Session& session, const std::size_t count);
+
+    /// Image of the last packet.
+    virtual const std::vector<uint8_t>& getImage() const;
+
+    /// Offset of the first data unit with the protocol tag, or the size of the image if there
+    /// is none.
+    virtual std::size_t getLayerOffset(const std::string& protocol) const;
+
+    /// Number of packets produced since the message was set.
+    virtual uint64_t getPacketCount() const;
+
+private:
+    /// Bytes covered by a checksum.
+    struct ChecksumRegion
+    {
+        /// Offset of the first covered byte.
+        std::size_t begin;
+
+        /// Offset after the last covered byte.
+        std::size_t end;
+
+        /// Offset of the checksum field.
+        std::size_t checksum;
+    };
+
+    /// Adjustment of a checksum that covers a mutated field.
+    struct ChecksumPatch
+    {
+        /// Offset of the checksum field.
+        std::size_t checksum;
+
+        /// Bytes of the field value that the checksum covers.
+        uint64_t mask;
+
+        /// Whether the last byte of the field is the high byte of a checksum word.
+        bool swap;
+    };
+
+    /// Mutator bound to a field of the image.
+    struct CompiledMutator
+    {
+        /// Offset of the field.
+        std::size_t offset;
+
+        /// Width of the field in bytes.
+        std::size_t width;
+
+        /// Change to apply.
+        FieldMutator mutator;
+
+        /// Value of the field in the next packet.
+        uint64_t value;
+
+        /// Value of the field in the image.
+        uint64_t written;
+
+        /// Checksums that cover the field. A field spans two adjacent regions at most.
+        ChecksumPatch patches[2];
+
+        /// Number of patches in use.
+        std::size_t patchCount;
+    };
+
+    /// Serialized message.
+    std::vector<uint8_t> image;
+
+    /// Offsets of the first data unit of each protocol.
+    std::vector<std::pair<std::string, std::size_t>> layers;
+
+    /// Checksums that must follow the changes of the image.
+    std::vector<ChecksumRegion> checksums;
+
+    /// Mutators, in the order they are applied.
+    std::vector<CompiledMutator> mutators;
+
+    /// Frames reused by sendBatch.
+    std::vector<std::vector<uint8_t>> batch;
+
+    /// State of the random generator.
+    uint64_t randomState{ 0x9e3779b97f4a7c15 };
+
+    /// Packets produced since the message was set.
+    uint64_t packetCount{ 0 };
+};
+
+} // namespace gen
+} // namespace nts
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/core/session.hpp>
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/ethernet/ethernet_view.hpp>
+#include <libnts/generator/packet_template.hpp>
+#include <libnts/icmp/icmp.hpp>
+#include <libnts/icmp/icmp_view.hpp>
+#include <libnts/ipv4/ipv4.hpp>
+#include <libnts/ipv4/ipv4_view.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+using eth::literals::operator"" _mac;
+using ip::literals::operator"" _ipv4;
+
+/// ICMP echo request with an odd sized payload.
+Message makeMessage()
+{
+    constexpr std::size_t payloadSize{ 57 };
+    return Message()
+        .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setSourceAddress("02:00:00:00:00:01"_mac).setEtherType((uint16_t)eth::EtherType::IPv4)))
+        .addDataUnit(std::make_shared<ip::Ipv4DataUnit>(ip::Ipv4DataUnit().setTotalLength(20 + 8 + payloadSize).setProtocol((uint8_t)ip::IpPayloadProtocols::ICMP).setSourceAddress("10.0.0.1"_ipv4).setDestinationAddress("10.0.1.1"_ipv4)))
+        .addDataUnit(std::make_shared<icmp::IcmpDataUnit>(icmp::IcmpDataUnit().setIdentifier(0x1234).setSequenceNumber(0xfffe)))
+        .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData(std::vector<uint8_t>(payloadSize, 0xab))));
+}
+
+/// Whether the IPv4 and ICMP checksums of the frame are valid.
+::testing::AssertionResult checksumsValid(const std::vector<uint8_t>& frame)
+{
+    const ip::Ipv4View ipv4(frame.data() + 14, frame.size() - 14);
+    if (!ipv4.isChecksumValid())
+    {
+        return ::testing::AssertionFailure() << "Invalid IPv4 checksum";
+    }
+    const icmp::IcmpView icmp(frame.data() + 34, frame.size() - 34);
+    if (!icmp.isChecksumValid())
+    {
+        return ::testing::AssertionFailure() << "Invalid ICMP checksum";
+    }
+    return ::testing::AssertionSuccess();
+}
+
+/// Session that only keeps the sent frames.
+class BatchSession : public ss::Session
+{
+public:
+    virtual std::size_t send(std::vector<uint8_t>& inData)
+    {
+        frames.push_back(inData);
+        return inData.size();
+    }
+
+    virtual std::size_t send(Serializable& inData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t receive(std::vector<uint8_t>& outData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t receive(Serializable& outData)
+    {
+        return 0;
+    }
+
+    std::vector<std::vector<uint8_t>> frames;
+};
+
+} // namespace
+
+TEST(PacketTemplateUnitTests, Image)
+{
+    Message message = makeMessage();
+    gen::PacketTemplate packets(message);
+
+    // The image is the serialized message, with both checksums computed.
+    std::vector<uint8_t> frame(message.getSize());
+    message.serialize(frame.data(), frame.size());
+    const std::vector<uint8_t>& image = packets.getImage();
+    ASSERT_EQ(image.size(), frame.size());
+    EXPECT_TRUE(checksumsValid(image));
+    for (std::size_t i = 0; i < image.size(); i++)
+    {
+        if (i != 24 && i != 25 && i != 36 && i != 37)
+        {
+            EXPECT_EQ(image[i], frame[i]) << "Offset " << i;
+        }
+    }
+
+    EXPECT_EQ(packets.getLayerOffset("ethernet"), 0);
+    EXPECT_EQ(packets.getLayerOffset("ipv4"), 14);
+    EXPECT_EQ(packets.getLayerOffset("icmp"), 34);
+    EXPECT_EQ(packets.getLayerOffset("generic"), 42);
+    EXPECT_EQ(packets.getLayerOffset("udp"), image.size());
+
+    // Without mutators, every packet is the same.
+    const std::vector<uint8_t> first = image;
+    EXPECT_EQ(packets.next(), first);
+    EXPECT_EQ(packets.getPacketCount(), 1);
+}
+
+TEST(PacketTemplateUnitTests, Mutators)
+{
+    Message message = makeMessage();
+    gen::PacketTemplate packets(message);
+    packets.addMutator("icmp.sequence", gen::FieldMutator::increment())
+        .addMutator("ipv4.source", gen::FieldMutator::range(0x0a000001, 0x0a000003))
+        .addMutator("ethernet.destination", gen::FieldMutator::range(0x020000000010, 0x020000000020, 0x10))
+        .addMutator("ipv4.ttl", gen::FieldMutator::random(10, 20));
+
+    const uint16_t sequences[] = { 0xfffe, 0xffff, 0x0000, 0x0001, 0x0002 };
+    const ip::Ipv4Address sources[] = { "10.0.0.1"_ipv4, "10.0.0.2"_ipv4, "10.0.0.3"_ipv4, "10.0.0.1"_ipv4, "10.0.0.2"_ipv4 };
+    const eth::MacAddress destinations[] = { "02:00:00:00:00:10"_mac, "02:00:00:00:00:20"_mac, "02:00:00:00:00:10"_mac, "02:00:00:00:00:20"_mac, "02:00:00:00:00:10"_mac };
+    for (std::size_t i = 0; i < 5; i++)
+    {
+        const std::vector<uint8_t>& frame = packets.next();
+        const eth::EthernetView ethernet(frame.data(), frame.size());
+        const ip::Ipv4View ipv4(frame.data() + 14, frame.size() - 14);
+        const icmp::IcmpView icmp(frame.data() + 34, frame.size() - 34);
+        EXPECT_EQ(icmp.getSequenceNumber(), sequences[i]);
+        EXPECT_EQ(icmp.getIdentifier(), 0x1234);
+        EXPECT_EQ(ipv4.getSourceIp(), sources[i]);
+        EXPECT_EQ(ethernet.getDestinationMac(), destinations[i]);
+        EXPECT_EQ(ethernet.getSourceMac(), "02:00:00:00:00:01"_mac);
+        EXPECT_GE(ipv4.getTTL(), 10);
+        EXPECT_LE(ipv4.getTTL(), 20);
+    }
+
+    // The same seed gives the same random values.
+    gen::PacketTemplate first(message);
+    gen::PacketTemplate second(message);
+    first.setSeed(42).addMutator(60, 4, gen::FieldMutator::random(0, 0xffffffff));
+    second.setSeed(42).addMutator(60, 4, gen::FieldMutator::random(0, 0xffffffff));
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(first.next(), second.next());
+    }
+}
+
+TEST(PacketTemplateUnitTests, Checksums)
+{
+    Message message = makeMessage();
+    gen::PacketTemplate packets(message);
+    packets.addMutator("ipv4.identification", gen::FieldMutator::increment(7))
+        .addMutator("ipv4.destination", gen::FieldMutator::random(0, 0xffffffff))
+        .addMutator("ipv4.ttl", gen::FieldMutator::increment())
+        .addMutator("icmp.identifier", gen::FieldMutator::random(0, 0xffff))
+        // Odd offsets and the odd trailing byte of the payload.
+        .addMutator(47, 3, gen::FieldMutator::increment(0x010101))
+        .addMutator(98, 1, gen::FieldMutator::range(0, 255, 3));
+
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        ASSERT_TRUE(checksumsValid(packets.next())) << "Packet " << i;
+    }
+}
+
+TEST(PacketTemplateUnitTests, Batch)
+{
+    Message message = makeMessage();
+    gen::PacketTemplate packets(message);
+    packets.addMutator("icmp.sequence", gen::FieldMutator::range(1, 100));
+
+    std::vector<std::vector<uint8_t>> frames;
+    EXPECT_EQ(packets.fillBatch(frames, 4), 4);
+    ASSERT_EQ(frames.size(), 4);
+    for (std::size_t i = 0; i < frames.size(); i++)
+    {
+        EXPECT_EQ(icmp::IcmpView(frames[i].data() + 34, frames[i].size() - 34).getSequenceNumber(), i + 1);
+    }
+
+    BatchSession session;
+    EXPECT_EQ(packets.sendBatch(session, 3), 3);
+    ASSERT_EQ(session.frames.size(), 3);
+    for (std::size_t i = 0; i < session.frames.size(); i++)
+    {
+        EXPECT_EQ(icmp::IcmpView(session.frames[i].data() + 34, session.frames[i].size() - 34).getSequenceNumber(), i + 5);
+        EXPECT_TRUE(checksumsValid(session.frames[i]));
+    }
+    EXPECT_EQ(packets.getPacketCount(), 7);
+}
+
+TEST(PacketTemplateUnitTests, Configure)
+{
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Template.Seed"] = "7";
+    config->stringParams["Template.Mutators.0.Field"] = "ipv4.source";
+    config->stringParams["Template.Mutators.0.Mode"] = "range";
+    config->stringParams["Template.Mutators.0.Minimum"] = "192.168.0.10";
+    config->stringParams["Template.Mutators.0.Maximum"] = "192.168.0.11";
+    config->stringParams["Template.Mutators.1.Field"] = "ethernet.source";
+    config->stringParams["Template.Mutators.1.Mode"] = "range";
+    config->stringParams["Template.Mutators.1.Minimum"] = "02:00:00:00:00:aa";
+    config->stringParams["Template.Mutators.1.Maximum"] = "02:00:00:00:00:ff";
+    config->stringParams["Template.Mutators.2.Offset"] = "42";
+    config->stringParams["Template.Mutators.2.Width"] = "2";
+    config->stringParams["Template.Mutators.2.Step"] = "0x100";
+
+    Message message = makeMessage();
+    gen::PacketTemplate packets(message);
+    packets.configure(config, "Template");
+
+    packets.next();
+    const std::vector<uint8_t>& frame = packets.next();
+    EXPECT_EQ(ip::Ipv4View(frame.data() + 14, frame.size() - 14).getSourceIp(), "192.168.0.11"_ipv4);
+    EXPECT_EQ(eth::EthernetView(frame.data(), frame.size()).getSourceMac(), "02:00:00:00:00:ab"_mac);
+    EXPECT_EQ(frame[42], 0xac);
+    EXPECT_EQ(frame[43], 0xab);
+    EXPECT_TRUE(checksumsValid(frame));
+
+    config->stringParams["Template.Mutators.3.Field"] = "ipv4.ttl";
+    config->stringParams["Template.Mutators.3.Mode"] = "sweep";
+    EXPECT_THROW(packets.configure(config, "Template"), std::invalid_argument);
+    config->stringParams["Template.Mutators.3.Mode"] = "random";
+    config->stringParams["Template.Mutators.3.Maximum"] = "lots";
+    EXPECT_THROW(packets.configure(config, "Template"), std::invalid_argument);
+}
+
+TEST(PacketTemplateUnitTests, Errors)
+{
+    Message message = makeMessage();
+    gen::PacketTemplate packets(message);
+    EXPECT_THROW(packets.addMutator("ipv4.flavor", gen::FieldMutator::increment()), std::invalid_argument);
+    EXPECT_THROW(packets.addMutator("ipv4.ttl", gen::FieldMutator::range(20, 10)), std::invalid_argument);
+    EXPECT_THROW(packets.addMutator(98, 2, gen::FieldMutator::increment()), std::logic_error);
+    EXPECT_THROW(packets.addMutator(0, 9, gen::FieldMutator::increment()), std::logic_error);
+
+    Message ethernetOnly = Message().addDataUnit(std::make_shared<eth::EthernetDataUnit>());
+    packets.setMessage(ethernetOnly);
+    EXPECT_THROW(packets.addMutator("icmp.sequence", gen::FieldMutator::increment()), std::logic_error);
+    EXPECT_NO_THROW(packets.addMutator("ethernet.source", gen::FieldMutator::increment()));
+}
+
+} // namespace tests
+} // namespace nts
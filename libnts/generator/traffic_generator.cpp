@@ -0,0 +1,348 @@
+#include <libnts/generator/traffic_generator.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <stdexcept>
+#include <sys/prctl.h>
+
+#include <libnts/config/configuration.hpp>
+#include <libnts/core/session.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace nts {
+namespace gen {
+
+namespace {
+
+constexpr int64_t nanosecondsPerSecond{ 1000000000 };
+
+/// Largest oversleep sample taken into account, in nanoseconds.
+constexpr int64_t maxOversleep{ 200000 };
+
+/// Current time of the monotonic clock in nanoseconds.
+/// @details The vDSO serves the clock from the TSC without entering the kernel.
+int64_t now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return int64_t(time.tv_sec) * nanosecondsPerSecond + time.tv_nsec;
+}
+
+/// Hint to the CPU that this is a spin loop.
+inline void relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+/// Waits until the deadline, sleeping while it is further away than the spin threshold.
+/// @param oversleep Running estimate of how late the sleeps wake up. Added to the spin
+/// threshold and updated after each sleep.
+/// @returns Whether the deadline had already passed.
+bool waitUntil(const int64_t deadline, const int64_t spinThreshold, int64_t& oversleep)
+{
+    const int64_t current = now();
+    if (current >= deadline)
+    {
+        return true;
+    }
+    if (deadline - current > spinThreshold + oversleep)
+    {
+        const int64_t wakeUp = deadline - spinThreshold - oversleep;
+        timespec time;
+        time.tv_sec = wakeUp / nanosecondsPerSecond;
+        time.tv_nsec = wakeUp % nanosecondsPerSecond;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) == EINTR)
+        {
+        }
+        // Exponential moving average, with a weight of 1/8 for the last sleep. Samples are
+        // capped, so a rare preemption doesn't turn the following waits into long spins.
+        const int64_t late = std::min(std::max<int64_t>(now() - wakeUp, 0), maxOversleep);
+        oversleep += (late - oversleep) / 8;
+    }
+    while (now() < deadline)
+    {
+        relax();
+    }
+    return false;
+}
+
+/// Lowers the timer slack of the calling thread while it exists.
+/// @details The default slack of 50 microseconds lets the kernel delay the wake-up of a
+/// sleep to coalesce timers, which ruins the pacing of high rates.
+class TimerSlackGuard
+{
+public:
+    TimerSlackGuard()
+        : previous(prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0))
+    {
+        prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+    }
+
+    ~TimerSlackGuard()
+    {
+        if (previous > 0)
+        {
+            prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(previous), 0, 0, 0);
+        }
+    }
+
+private:
+    /// Slack before the guard was created.
+    const int previous;
+};
+
+/// Rate in text form, such as "10000000000".
+double parseRate(const std::string& text)
+{
+    char* end = nullptr;
+    const double rate = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !(rate > 0))
+    {
+        throw std::invalid_argument("Invalid rate: " + text);
+    }
+    return rate;
+}
+
+} // namespace
+
+std::string GeneratorReport::toString() const
+{
+    std::stringstream stream;
+    stream << "[Generator]"
+           << "\n\tPackets: " << packets << " Bytes: " << bytes
+           << "\n\tElapsed: " << elapsed.count() / 1e9 << " s"
+           << "\n\tPacket Rate: " << achievedPacketRate << " / " << requestedPacketRate << " pps"
+           << "\n\tBit Rate: " << achievedBitRate << " / " << requestedBitRate << " bps"
+           << "\n\tMean Interval: " << meanInterval << " / " << meanScheduledInterval << " ns"
+           << "\n\tJitter: " << meanJitter << " ns mean, " << maxJitter << " ns max"
+           << "\n\tLate Departures: " << lateDepartures;
+    return stream.str();
+}
+
+TrafficGenerator::TrafficGenerator(std::shared_ptr<ss::Session> session, std::shared_ptr<PacketTemplate> packets)
+    : session(session)
+    , packets(packets)
+{
+}
+
+PacingMode TrafficGenerator::getMode() const
+{
+    return mode;
+}
+
+TrafficGenerator& TrafficGenerator::setMode(const PacingMode mode)
+{
+    this->mode = mode;
+    return *this;
+}
+
+TrafficGenerator& TrafficGenerator::setPacketRate(const double packetsPerSecond)
+{
+    if (!(packetsPerSecond > 0))
+    {
+        throw std::invalid_argument("Packet rate must be positive");
+    }
+    packetRate = packetsPerSecond;
+    bitRate = 0;
+    return *this;
+}
+
+TrafficGenerator& TrafficGenerator::setBitRate(const double bitsPerSecond)
+{
+    if (!(bitsPerSecond > 0))
+    {
+        throw std::invalid_argument("Bit rate must be positive");
+    }
+    bitRate = bitsPerSecond;
+    return *this;
+}
+
+double TrafficGenerator::getPacketRate() const
+{
+    if (bitRate > 0)
+    {
+        return bitRate / (8.0 * std::max<std::size_t>(packets->getImage().size(), 1));
+    }
+    return packetRate;
+}
+
+TrafficGenerator& TrafficGenerator::setBurstSize(const std::size_t size)
+{
+    if (size == 0)
+    {
+        throw std::invalid_argument("Burst size must be positive");
+    }
+    burstSize = size;
+    return *this;
+}
+
+TrafficGenerator& TrafficGenerator::setSpinThreshold(const std::chrono::nanoseconds threshold)
+{
+    spinThreshold = threshold;
+    return *this;
+}
+
+TrafficGenerator& TrafficGenerator::setSeed(const uint64_t seed)
+{
+    random.seed(seed);
+    return *this;
+}
+
+TrafficGenerator& TrafficGenerator::configure(std::shared_ptr<Configuration> config, const std::string& key)
+{
+    if (auto mode = config->getString(key + ".Mode"))
+    {
+        if (mode.value() == "constant")
+        {
+            setMode(PacingMode::Constant);
+        }
+        else if (mode.value() == "burst")
+        {
+            setMode(PacingMode::Burst);
+        }
+        else if (mode.value() == "poisson")
+        {
+            setMode(PacingMode::Poisson);
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown pacing mode: " + mode.value());
+        }
+    }
+    if (auto rate = config->getString(key + ".PacketRate"))
+    {
+        setPacketRate(parseRate(rate.value()));
+    }
+    if (auto rate = config->getString(key + ".BitRate"))
+    {
+        setBitRate(parseRate(rate.value()));
+    }
+    if (auto size = config->getInt(key + ".BurstSize"))
+    {
+        if (size.value() <= 0)
+        {
+            throw std::invalid_argument("Burst size must be positive");
+        }
+        setBurstSize(size.value());
+    }
+    if (auto threshold = config->getInt(key + ".SpinThreshold"))
+    {
+        setSpinThreshold(std::chrono::nanoseconds(threshold.value()));
+    }
+    if (auto seed = config->getInt(key + ".Seed"))
+    {
+        setSeed(seed.value());
+    }
+    return *this;
+}
+
+GeneratorReport TrafficGenerator::run(const std::chrono::nanoseconds duration, const uint64_t maxPackets)
+{
+    GeneratorReport report;
+    const double rate = getPacketRate();
+    report.requestedPacketRate = rate;
+    report.requestedBitRate = rate * 8.0 * packets->getImage().size();
+
+    const TimerSlackGuard timerSlack;
+    const int64_t threshold = spinThreshold.count();
+    int64_t oversleep = 0;
+    const int64_t start = now();
+    const int64_t end = start + duration.count();
+
+    // The schedule is kept in floating point, so rounding errors don't add up over a run.
+    double scheduled = double(start);
+    int64_t lastDeparture = 0;
+    int64_t firstDeadline = 0;
+    int64_t lastDeadline = 0;
+    double intervalSum = 0;
+    double jitterSum = 0;
+    uint64_t departures = 0;
+
+    while (!stopped && (maxPackets == 0 || report.packets < maxPackets))
+    {
+        const int64_t deadline = static_cast<int64_t>(scheduled);
+        if (deadline >= end)
+        {
+            break;
+        }
+        if (waitUntil(deadline, threshold, oversleep))
+        {
+            report.lateDepartures++;
+        }
+
+        // Interval statistics compare each departure with the previous one.
+        const int64_t departure = now();
+        if (departures > 0)
+        {
+            const double interval = double(departure - lastDeparture);
+            const double jitter = std::abs(interval - double(deadline - lastDeadline));
+            intervalSum += interval;
+            jitterSum += jitter;
+            report.maxJitter = std::max(report.maxJitter, jitter);
+        }
+        else
+        {
+            firstDeadline = deadline;
+        }
+        lastDeparture = departure;
+        lastDeadline = deadline;
+        departures++;
+
+        std::size_t count = mode == PacingMode::Burst ? burstSize : 1;
+        if (maxPackets != 0)
+        {
+            count = std::min<uint64_t>(count, maxPackets - report.packets);
+        }
+        packets->fillBatch(batch, count);
+        const std::size_t sent = count == 1 ? (session->send(batch[0]) > 0 ? 1 : 0) : session->sendBatch(batch);
+        report.packets += sent;
+        report.bytes += sent * packets->getImage().size();
+
+        scheduled += nextInterval(rate, count);
+    }
+
+    report.elapsed = std::chrono::nanoseconds(std::max<int64_t>(now() - start, 1));
+    const double seconds = report.elapsed.count() / 1e9;
+    report.achievedPacketRate = report.packets / seconds;
+    report.achievedBitRate = report.bytes * 8.0 / seconds;
+    if (departures > 1)
+    {
+        report.meanInterval = intervalSum / (departures - 1);
+        report.meanJitter = jitterSum / (departures - 1);
+        report.meanScheduledInterval = double(lastDeadline - firstDeadline) / (departures - 1);
+    }
+    return report;
+}
+
+void TrafficGenerator::stop()
+{
+    stopped = true;
+}
+
+TrafficGenerator& TrafficGenerator::reset()
+{
+    stopped = false;
+    return *this;
+}
+
+double TrafficGenerator::nextInterval(const double packetRate, const std::size_t packets)
+{
+    const double meanInterval = nanosecondsPerSecond / packetRate;
+    if (mode == PacingMode::Poisson)
+    {
+        return std::exponential_distribution<double>(1.0 / meanInterval)(random);
+    }
+    return meanInterval * packets;
+}
+
+} // namespace gen
+} // namespace nts
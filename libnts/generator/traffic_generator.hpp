@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libnts/generator/packet_template.hpp>
+
+namespace nts {
+
+// Forward declaration.
+class Configuration;
+
+namespace ss {
+class Session;
+} // namespace ss
+
+namespace gen {
+
+/// How departures are spread over time.
+enum class PacingMode
+{
+    /// One packet at a fixed interval.
+    Constant,
+    /// A batch of packets sent back to back, with a fixed interval between batches.
+    Burst,
+    /// One packet at exponentially distributed intervals, like independent arrivals.
+    Poisson,
+};
+
+/// Outcome of a run of a TrafficGenerator.
+struct GeneratorReport
+{
+    /// Representation of the report in a console friendly format.
+    std::string toString() const;
+
+    /// Packets handed to the session.
+    uint64_t packets{ 0 };
+
+    /// Bytes handed to the session.
+    uint64_t bytes{ 0 };
+
+    /// Time from the start of the run to its end.
+    std::chrono::nanoseconds elapsed{ 0 };
+
+    /// Rate that was asked for, in packets per second.
+    double requestedPacketRate{ 0 };
+
+    /// Rate that was reached, in packets per second.
+    double achievedPacketRate{ 0 };
+
+    /// Rate that was asked for, in bits per second.
+    double requestedBitRate{ 0 };
+
+    /// Rate that was reached, in bits per second.
+    double achievedBitRate{ 0 };
+
+    /// Mean time between two departures, in nanoseconds.
+    double meanInterval{ 0 };
+
+    /// Mean time between two scheduled departures, in nanoseconds. Unlike meanInterval, it
+    /// doesn't depend on how the thread was scheduled.
+    double meanScheduledInterval{ 0 };
+
+    /// Mean absolute difference between the actual and the scheduled time between two
+    /// departures, in nanoseconds.
+    double meanJitter{ 0 };
+
+    /// Largest difference between the actual and the scheduled time between two departures,
+    /// in nanoseconds.
+    double maxJitter{ 0 };
+
+    /// Departures that were already late when their deadline came up.
+    uint64_t lateDepartures{ 0 };
+};
+
+/// Sends the packets of a template through a session at a target rate.
+///
+/// @details Departures are scheduled on the monotonic clock. The generator sleeps with an
+/// absolute clock_nanosleep until shortly before each deadline, then spins on the clock for
+/// the rest of the way. Sleeping keeps the CPU free at low rates, and spinning hides the
+/// wake-up latency of the scheduler, which is usually tens of microseconds. The spin
+/// threshold sets the balance between the two: larger values are more accurate and burn
+/// more CPU. The generator also measures how late its sleeps wake up and starts spinning
+/// that much earlier, and lowers the timer slack of the calling thread during a run.
+///
+/// Deadlines follow the schedule rather than the previous departure, so a late departure
+/// doesn't slow the run down: the following packets are sent as soon as possible until the
+/// generator catches up. Burst mode sends each burst with a single Session::sendBatch call.
+///
+/// @example
+/// auto packets = std::make_shared<PacketTemplate>(message);
+/// TrafficGenerator generator(session, packets);
+/// generator.setMode(PacingMode::Poisson).setPacketRate(100000);
+/// GeneratorReport report = generator.run(std::chrono::seconds(10));
+/// INFO("generator", "{}", report.toString());
+class TrafficGenerator
+{
+public:
+    /// Constructor.
+    /// @param session Session that sends the packets.
+    /// @param packets Template that produces the packets.
+    TrafficGenerator(std::shared_ptr<ss::Session> session, std::shared_ptr<PacketTemplate> packets);
+
+    /// Deconstructor.
+    virtual ~TrafficGenerator() = default;
+
+    /// How departures are spread over time.
+    virtual PacingMode getMode() const;
+
+    /// How departures are spread over time.
+    virtual TrafficGenerator& setMode(const PacingMode mode);
+
+    /// Target rate in packets per second.
+    /// @throws std::invalid_argument If the rate isn't positive.
+    virtual TrafficGenerator& setPacketRate(const double packetsPerSecond);
+
+    /// Target rate in bits per second, counting the bytes of each frame.
+    /// @details The packet rate is derived from the size of the template image when the
+    /// generator runs.
+    /// @throws std::invalid_argument If the rate isn't positive.
+    virtual TrafficGenerator& setBitRate(const double bitsPerSecond);
+
+    /// Target rate in packets per second.
+    virtual double getPacketRate() const;
+
+    /// Number of packets of each burst in burst mode.
+    /// @throws std::invalid_argument If the size is zero.
+    virtual TrafficGenerator& setBurstSize(const std::size_t size);
+
+    /// Time before a deadline when the generator stops sleeping and starts spinning.
+    virtual TrafficGenerator& setSpinThreshold(const std::chrono::nanoseconds threshold);
+
+    /// Seed of the intervals of Poisson mode.
+    virtual TrafficGenerator& setSeed(const uint64_t seed);
+
+    /// Reads "<key>.Mode" ("constant", "burst" or "poisson"), "<key>.PacketRate",
+    /// "<key>.BitRate", "<key>.BurstSize", "<key>.SpinThreshold" (in nanoseconds) and
+    /// "<key>.Seed" from the Configuration object. Rates are read as text, so they can exceed
+    /// the range of an integer parameter.
+    /// @throws std::invalid_argument If a parameter is invalid.
+    virtual TrafficGenerator& configure(std::shared_ptr<Configuration> config, const std::string& key);
+
+    /// Sends packets until the duration elapses, the packet limit is reached or stop() is
+    /// called, whichever comes first. Returns right away after a stop() without reset().
+    /// @param duration Length of the schedule.
+    /// @param maxPackets Number of packets to send, or 0 for no limit.
+    /// @returns Statistics of the run.
+    virtual GeneratorReport run(const std::chrono::nanoseconds duration, const uint64_t maxPackets = 0);
+
+    /// Ends the current run after its next departure. Can be called from any thread.
+    /// @details The request stays in effect until reset(), so a stop() that comes just before
+    /// run() ends that run too.
+    virtual void stop();
+
+    /// Clears a previous stop(), so that the generator can run again.
+    virtual TrafficGenerator& reset();
+
+private:
+    /// Interval until the next departure, in nanoseconds.
+    double nextInterval(const double packetRate, const std::size_t packets);
+
+    /// Session that sends the packets.
+    std::shared_ptr<ss::Session> session;
+
+    /// Template that produces the packets.
+    std::shared_ptr<PacketTemplate> packets;
+
+    /// How departures are spread over time.
+    PacingMode mode{ PacingMode::Constant };
+
+    /// Target rate in packets per second, if it was given in packets.
+    double packetRate{ 1000 };
+
+    /// Target rate in bits per second, if it was given in bits.
+    double bitRate{ 0 };
+
+    /// Number of packets of each burst.
+    std::size_t burstSize{ 32 };
+
+    /// Time before a deadline when the generator starts spinning.
+    std::chrono::nanoseconds spinThreshold{ std::chrono::microseconds(50) };
+
+    /// Generator of the Poisson intervals.
+    std::mt19937_64 random;
+
+    /// Frames reused between departures.
+    std::vector<std::vector<uint8_t>> batch;
+
+    /// Whether stop() was called.
+    std::atomic<bool> stopped{ false };
+};
+
+} // namespace gen
+} // namespace nts
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <thread>
+
+#include <libnts/config/configuration.test.hpp>
+#include <libnts/core/session.hpp>
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/generator/traffic_generator.hpp>
+
+namespace nts {
+namespace tests {
+
+namespace {
+
+/// Session that counts what it is asked to send.
+class CountingSession : public ss::Session
+{
+public:
+    virtual std::size_t send(std::vector<uint8_t>& inData)
+    {
+        sends++;
+        packets++;
+        return inData.size();
+    }
+
+    virtual std::size_t send(Serializable& inData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t receive(std::vector<uint8_t>& outData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t receive(Serializable& outData)
+    {
+        return 0;
+    }
+
+    virtual std::size_t sendBatch(std::vector<std::vector<uint8_t>>& inFrames)
+    {
+        batches++;
+        largestBatch = std::max(largestBatch, inFrames.size());
+        packets += inFrames.size();
+        return inFrames.size();
+    }
+
+    std::size_t sends{ 0 };
+    std::size_t batches{ 0 };
+    std::size_t largestBatch{ 0 };
+    std::size_t packets{ 0 };
+};
+
+/// Template of a 100 byte frame.
+std::shared_ptr<gen::PacketTemplate> makeTemplate()
+{
+    Message message = Message()
+                          .addDataUnit(std::make_shared<eth::EthernetDataUnit>())
+                          .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData(std::vector<uint8_t>(86, 0))));
+    return std::make_shared<gen::PacketTemplate>(message);
+}
+
+} // namespace
+
+TEST(TrafficGeneratorUnitTests, ConstantRate)
+{
+    auto session = std::make_shared<CountingSession>();
+    gen::TrafficGenerator generator(session, makeTemplate());
+    generator.setPacketRate(10000);
+
+    const gen::GeneratorReport report = generator.run(std::chrono::milliseconds(100));
+    EXPECT_EQ(report.packets, session->packets);
+    EXPECT_EQ(session->sends, session->packets);
+    EXPECT_EQ(report.bytes, report.packets * 100);
+    EXPECT_EQ(report.requestedPacketRate, 10000);
+    EXPECT_EQ(report.requestedBitRate, 8000000);
+    EXPECT_GE(report.maxJitter, report.meanJitter);
+
+    // Late departures are sent anyway, so the schedule alone sets the number of packets. The
+    // measured times depend on the load of the machine and are only checked for gross errors.
+    EXPECT_EQ(report.packets, 1000);
+    EXPECT_DOUBLE_EQ(report.meanScheduledInterval, 100000);
+    EXPECT_GT(report.achievedPacketRate, 1000);
+    EXPECT_LT(report.achievedPacketRate, 10100);
+    EXPECT_GT(report.meanInterval, 10000);
+    EXPECT_LT(report.meanInterval, 1000000);
+
+    // The packet limit ends the run early.
+    const gen::GeneratorReport limited = generator.run(std::chrono::seconds(10), 50);
+    EXPECT_EQ(limited.packets, 50);
+    EXPECT_LT(limited.elapsed, std::chrono::seconds(1));
+}
+
+TEST(TrafficGeneratorUnitTests, Burst)
+{
+    auto session = std::make_shared<CountingSession>();
+    gen::TrafficGenerator generator(session, makeTemplate());
+    generator.setMode(gen::PacingMode::Burst).setBurstSize(10).setPacketRate(20000);
+
+    const gen::GeneratorReport report = generator.run(std::chrono::milliseconds(100), 1995);
+    EXPECT_EQ(report.packets, 1995);
+    EXPECT_EQ(session->sends, 0);
+    EXPECT_EQ(session->batches, 200);
+    EXPECT_EQ(session->largestBatch, 10);
+    EXPECT_DOUBLE_EQ(report.meanScheduledInterval, 500000);
+    EXPECT_GT(report.meanInterval, 50000);
+    EXPECT_LT(report.meanInterval, 5000000);
+}
+
+TEST(TrafficGeneratorUnitTests, Poisson)
+{
+    auto session = std::make_shared<CountingSession>();
+    gen::TrafficGenerator generator(session, makeTemplate());
+    generator.setMode(gen::PacingMode::Poisson).setPacketRate(10000).setSeed(1);
+
+    // The intervals are exponential, so their mean is the interval of the rate and the
+    // jitter is of the same order.
+    const gen::GeneratorReport report = generator.run(std::chrono::milliseconds(200));
+    EXPECT_NEAR(report.packets, 2000, 300);
+    EXPECT_NEAR(report.meanScheduledInterval, 100000, 15000);
+    EXPECT_GT(report.meanInterval, 10000);
+    EXPECT_LT(report.meanInterval, 1000000);
+}
+
+TEST(TrafficGeneratorUnitTests, BitRate)
+{
+    auto session = std::make_shared<CountingSession>();
+    gen::TrafficGenerator generator(session, makeTemplate());
+    generator.setBitRate(8000000);
+    EXPECT_EQ(generator.getPacketRate(), 10000);
+    generator.setPacketRate(500);
+    EXPECT_EQ(generator.getPacketRate(), 500);
+
+    EXPECT_THROW(generator.setPacketRate(0), std::invalid_argument);
+    EXPECT_THROW(generator.setBitRate(-1), std::invalid_argument);
+    EXPECT_THROW(generator.setBurstSize(0), std::invalid_argument);
+}
+
+TEST(TrafficGeneratorUnitTests, Stop)
+{
+    auto session = std::make_shared<CountingSession>();
+    gen::TrafficGenerator generator(session, makeTemplate());
+    generator.setPacketRate(1000);
+
+    std::thread stopper([&generator]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        generator.stop();
+    });
+    const gen::GeneratorReport report = generator.run(std::chrono::seconds(10));
+    stopper.join();
+    EXPECT_LT(report.elapsed, std::chrono::seconds(5));
+    EXPECT_GT(report.packets, 0);
+
+    // A stop before the run isn't lost, and lasts until the reset.
+    generator.stop();
+    EXPECT_EQ(generator.run(std::chrono::seconds(10)).packets, 0);
+    EXPECT_EQ(generator.run(std::chrono::seconds(10)).packets, 0);
+    EXPECT_EQ(generator.reset().run(std::chrono::seconds(10), 5).packets, 5);
+}
+
+TEST(TrafficGeneratorUnitTests, Configure)
+{
+    auto config = std::make_shared<ConfigurationTests::TestConfiguration>();
+    config->stringParams["Generator.Mode"] = "burst";
+    config->stringParams["Generator.BitRate"] = "40000000000";
+    config->intParams["Generator.BurstSize"] = 4;
+
+    auto session = std::make_shared<CountingSession>();
+    gen::TrafficGenerator generator(session, makeTemplate());
+    generator.configure(config, "Generator");
+    EXPECT_EQ(generator.getMode(), gen::PacingMode::Burst);
+    EXPECT_EQ(generator.getPacketRate(), 50000000);
+    generator.run(std::chrono::seconds(1), 8);
+    EXPECT_EQ(session->largestBatch, 4);
+
+    config->stringParams["Generator.Mode"] = "poisson";
+    config->stringParams["Generator.PacketRate"] = "2500";
+    config->stringParams.erase("Generator.BitRate");
+    generator.configure(config, "Generator");
+    EXPECT_EQ(generator.getMode(), gen::PacingMode::Poisson);
+    EXPECT_EQ(generator.getPacketRate(), 2500);
+
+    config->stringParams["Generator.Mode"] = "wave";
+    EXPECT_THROW(generator.configure(config, "Generator"), std::invalid_argument);
+    config->stringParams["Generator.Mode"] = "constant";
+    config->stringParams["Generator.PacketRate"] = "fast";
+    EXPECT_THROW(generator.configure(config, "Generator"), std::invalid_argument);
+}
+
+} // namespace tests
+} // namespace nts
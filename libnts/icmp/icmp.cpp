@@ -1,12 +1,20 @@
 #include <libnts/icmp/icmp.hpp>
 
-#include <arpa/inet.h>
+#include <cstring>
 #include <sstream>
 
 #include <libnts/config/configuration.hpp>
+#include <libnts/core/checksum.hpp>
 
 namespace icmp {
 
+namespace {
+
+/// Size of the header.
+constexpr std::size_t headerSize{ 8 };
+
+} // namespace
+
 IcmpDataUnit& IcmpDataUnit::configure(std::shared_ptr<nts::Configuration> config)
 {
     return *this;
@@ -14,18 +22,43 @@ IcmpDataUnit& IcmpDataUnit::configure(std::shared_ptr<nts::Configuration> config
 
 void IcmpDataUnit::toStream(std::ostream& outStream) const
 {
-    outStream.write(reinterpret_cast<const char*>(&type), 1);
-    outStream.write(reinterpret_cast<const char*>(&code), 1);
-    outStream.write(reinterpret_cast<const char*>(&checksum), 2);
-    outStream.write(reinterpret_cast<const char*>(&restOfHeader), 4);
+    uint8_t buffer[headerSize];
+    serialize(buffer, headerSize);
+    outStream.write(reinterpret_cast<const char*>(buffer), headerSize);
 }
 
 void IcmpDataUnit::fromStream(std::istream& inStream)
 {
-    inStream.read(reinterpret_cast<char*>(&type), 1);
-    inStream.read(reinterpret_cast<char*>(&code), 1);
-    inStream.read(reinterpret_cast<char*>(&checksum), 2);
-    inStream.read(reinterpret_cast<char*>(&restOfHeader), 4);
+    uint8_t buffer[headerSize];
+    inStream.read(reinterpret_cast<char*>(buffer), headerSize);
+    deserialize(buffer, inStream.gcount());
+}
+
+std::size_t IcmpDataUnit::serialize(uint8_t* outBuffer, const std::size_t capacity) const
+{
+    if (capacity < headerSize)
+    {
+        return 0;
+    }
+    // The fields are stored in network byte order, so they are copied as they are.
+    memcpy(outBuffer + 0, &type, 1);
+    memcpy(outBuffer + 1, &code, 1);
+    memcpy(outBuffer + 2, &checksum, 2);
+    memcpy(outBuffer + 4, &restOfHeader, 4);
+    return headerSize;
+}
+
+std::size_t IcmpDataUnit::deserialize(const uint8_t* inBuffer, const std::size_t length)
+{
+    if (length < headerSize)
+    {
+        return 0;
+    }
+    memcpy(&type, inBuffer + 0, 1);
+    memcpy(&code, inBuffer + 1, 1);
+    memcpy(&checksum, inBuffer + 2, 2);
+    memcpy(&restOfHeader, inBuffer + 4, 4);
+    return headerSize;
 }
 
 std::string IcmpDataUnit::toString() const
@@ -51,13 +84,34 @@ std::size_t IcmpDataUnit::getUnitSize() const
 
 void IcmpDataUnit::computeChecksum()
 {
-    // @todo: The checksum requires access to the payload.
+    computeChecksum(nullptr, 0);
+}
+
+void IcmpDataUnit::computeChecksum(const uint8_t* payload, const std::size_t length)
+{
+    // The checksum field counts as zero while the checksum is computed.
+    uint8_t header[headerSize];
+    serialize(header, headerSize);
+    header[2] = 0;
+    header[3] = 0;
+
+    // The header has an even size, so the payload sum carries on from the header sum.
+    const uint16_t sum = nts::onesComplementSum(header, headerSize);
+    setChecksum(nts::internetChecksum(payload, length, sum));
 }
 
 bool IcmpDataUnit::isChecksumValid() const
 {
-    // @todo: The checksum requires access to the payload.
-    return true;
+    return isChecksumValid(nullptr, 0);
+}
+
+bool IcmpDataUnit::isChecksumValid(const uint8_t* payload, const std::size_t length) const
+{
+    // The one's complement sum of a valid message, checksum included, is 0xFFFF.
+    uint8_t header[headerSize];
+    serialize(header, headerSize);
+    const uint16_t sum = nts::onesComplementSum(header, headerSize);
+    return nts::onesComplementSum(payload, length, sum) == 0xFFFF;
 }
 
 uint8_t IcmpDataUnit::getType() const
@@ -77,9 +131,12 @@ uint16_t IcmpDataUnit::getChecksum() const
 
 std::string IcmpDataUnit::getIpAddress() const
 {
-    char string[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, reinterpret_cast<const in_addr*>(&restOfHeader), string, INET_ADDRSTRLEN);
-    return string;
+    return getIp().toString();
+}
+
+ip::Ipv4Address IcmpDataUnit::getIp() const
+{
+    return ip::Ipv4Address(restOfHeader);
 }
 
 uint16_t IcmpDataUnit::getIdentifier() const
@@ -117,7 +174,12 @@ IcmpDataUnit& IcmpDataUnit::setChecksum(const uint16_t checksum)
 
 IcmpDataUnit& IcmpDataUnit::setIpAddress(const std::string address)
 {
-    inet_pton(AF_INET, address.c_str(), reinterpret_cast<in_addr*>(&restOfHeader));
+    return setIpAddress(ip::Ipv4Address::parse(address));
+}
+
+IcmpDataUnit& IcmpDataUnit::setIpAddress(const ip::Ipv4Address& address)
+{
+    restOfHeader = address.toUint32();
     return *this;
 }
 
@@ -158,7 +220,42 @@ std::shared_ptr<nts::ProtocolDataUnit> IcmpParser::parse(std::istream& inStream,
     outContext["code"] = static_cast<int>(payload->getCode());
     outContext["type"] = static_cast<int>(payload->getType());
 
-    return std::move(payload);
+    return payload;
+}
+
+void IcmpParser::getDispatchKeys(std::vector<nts::ParserContext>& outKeys) const
+{
+    outKeys.assign({ nts::ParserContext{ nts::ProtocolId::Ipv4, 0x01 } });
+}
+
+std::shared_ptr<nts::ProtocolDataUnit> IcmpParser::parseLayer(std::istream& inStream, nts::ParserContext& context) const
+{
+    std::shared_ptr<IcmpDataUnit> payload = nts::makeDataUnit<IcmpDataUnit>(context.pool);
+    payload->fromStream(inStream);
+
+    context.protocol = nts::ProtocolId::Icmp;
+    context.nextProtocol = 0;
+
+    return payload;
+}
+
+std::shared_ptr<nts::ProtocolDataUnit> IcmpParser::parseBuffer(const uint8_t* inBuffer, const std::size_t length, nts::ParserContext& context, std::size_t& outBytes) const
+{
+    std::shared_ptr<IcmpDataUnit> payload = nts::makeDataUnit<IcmpDataUnit>(context.pool);
+    outBytes = payload->deserialize(inBuffer, length);
+    if (outBytes == 0)
+    {
+        // Truncated, so the data can't be parsed any further.
+        outBytes = length;
+        context.protocol = nts::ProtocolId::Unknown;
+        context.nextProtocol = 0;
+        return payload;
+    }
+
+    context.protocol = nts::ProtocolId::Icmp;
+    context.nextProtocol = 0;
+
+    return payload;
 }
 
 } // namespace icmp
@@ -3,6 +3,7 @@
 #include <boost/endian/arithmetic.hpp>
 
 #include <libnts/core/data_unit.hpp>
+#include <libnts/ipv4/ipv4_address.hpp>
 #include <libnts/messaging/parser.hpp>
 
 namespace nts {
@@ -107,6 +108,14 @@ public:
     /// Reads the packet from the stream.
     virtual void fromStream(std::istream& inStream);
 
+    /// Writes the packet to the buffer.
+    /// @returns The number of bytes written, or 0 if the packet does not fit.
+    virtual std::size_t serialize(uint8_t* outBuffer, const std::size_t capacity) const;
+
+    /// Reads the packet from the buffer.
+    /// @returns The number of bytes read, or 0 if the buffer is too short.
+    virtual std::size_t deserialize(const uint8_t* inBuffer, const std::size_t length);
+
     /// Representation of the message in a console friendly format.
     virtual std::string toString() const;
 
@@ -116,12 +125,22 @@ public:
     /// Size of the data unit in bytes.
     virtual std::size_t getUnitSize() const;
 
-    /// Update the checksum field with the correct checksum.
+    /// Update the checksum field with the correct checksum of a message without payload.
     void computeChecksum();
 
-    /// Verify the integrity of the header with the checksum.
+    /// Update the checksum field with the correct checksum of the header and payload.
+    /// @param payload Data that follows the header.
+    /// @param length Number of bytes of payload.
+    void computeChecksum(const uint8_t* payload, const std::size_t length);
+
+    /// Verify the integrity of a message without payload with the checksum.
     bool isChecksumValid() const;
 
+    /// Verify the integrity of the header and payload with the checksum.
+    /// @param payload Data that follows the header.
+    /// @param length Number of bytes of payload.
+    bool isChecksumValid(const uint8_t* payload, const std::size_t length) const;
+
     /// Identifies the type of control message.
     uint8_t getType() const;
 
@@ -134,6 +153,9 @@ public:
     /// Address of an alternative route. Used in redirect messages.
     std::string getIpAddress() const;
 
+    /// Address of an alternative route. Used in redirect messages.
+    ip::Ipv4Address getIp() const;
+
     /// Used to match requests with replies.
     uint16_t getIdentifier() const;
 
@@ -153,8 +175,12 @@ public:
     IcmpDataUnit& setChecksum(const uint16_t checksum);
 
     /// Address of an alternative route. Used in redirect messages.
+    /// @throws std::invalid_argument If the text is not a valid address.
     IcmpDataUnit& setIpAddress(const std::string address);
 
+    /// Address of an alternative route. Used in redirect messages.
+    IcmpDataUnit& setIpAddress(const ip::Ipv4Address& address);
+
     /// Used to match requests with replies.
     IcmpDataUnit& setIdentifier(const uint16_t identifier);
 
@@ -189,6 +215,15 @@ public:
 
     /// Parse an ICMP payload from the stream.
     virtual std::shared_ptr<nts::ProtocolDataUnit> parse(std::istream& inStream, std::map<std::string, int>& outContext) const;
+
+    /// After an IPv4 packet with the ICMP protocol number.
+    virtual void getDispatchKeys(std::vector<nts::ParserContext>& outKeys) const;
+
+    /// Parse an ICMP payload from the stream.
+    virtual std::shared_ptr<nts::ProtocolDataUnit> parseLayer(std::istream& inStream, nts::ParserContext& context) const;
+
+    /// Parse an ICMP payload from the buffer.
+    virtual std::shared_ptr<nts::ProtocolDataUnit> parseBuffer(const uint8_t* inBuffer, const std::size_t length, nts::ParserContext& context, std::size_t& outBytes) const;
 };
 
 } // namespace icmp
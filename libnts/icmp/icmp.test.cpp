@@ -1,8 +1,10 @@
 #include <boost/asio.hpp>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <sstream>
 
 #include <libnts/icmp/icmp.hpp>
+#include <libnts/icmp/icmp_view.hpp>
 
 namespace icmp {
 namespace tests {
@@ -57,7 +59,51 @@ TEST(IcmpUnitTests, Serialization)
     EXPECT_EQ(packetB.getIpAddress(), "1.2.3.4");
 }
 
-/// @todo: Add unit tests for the checksum.
+TEST(IcmpUnitTests, BufferSerialization)
+{
+    IcmpDataUnit packetA = IcmpDataUnit().setType((uint8_t)IcmpMessageCode::EchoReply).setChecksum(0x1234).setIdentifier(0xbeef).setSequenceNumber(7);
+
+    uint8_t buffer[8];
+    EXPECT_EQ(packetA.serialize(buffer, 7), 0);
+    ASSERT_EQ(packetA.serialize(buffer, sizeof(buffer)), 8);
+
+    // Both APIs produce the same bytes.
+    std::stringstream stream;
+    packetA.toStream(stream);
+    EXPECT_EQ(stream.str(), std::string(reinterpret_cast<char*>(buffer), 8));
+
+    IcmpDataUnit packetB;
+    EXPECT_EQ(packetB.deserialize(buffer, sizeof(buffer)), 8);
+    EXPECT_EQ(packetB.getType(), (uint8_t)IcmpMessageType::EchoReply);
+    EXPECT_EQ(packetB.getChecksum(), 0x1234);
+    EXPECT_EQ(packetB.getIdentifier(), 0xbeef);
+    EXPECT_EQ(packetB.getSequenceNumber(), 7);
+}
+
+TEST(IcmpUnitTests, Checksum)
+{
+    // Echo request with a 4-byte payload.
+    const std::vector<uint8_t> message{ 0x08, 0x00, 0x33, 0x31, 0x00, 0x01, 0x00, 0x07, 'a', 'b', 'c', 'd' };
+    const uint8_t* payload = message.data() + 8;
+
+    IcmpDataUnit packet;
+    ASSERT_EQ(packet.deserialize(message.data(), message.size()), 8);
+    EXPECT_TRUE(packet.isChecksumValid(payload, 4));
+    EXPECT_FALSE(packet.isChecksumValid());
+    EXPECT_TRUE(IcmpView(message.data(), message.size()).isChecksumValid());
+
+    // Any change to the payload is detected.
+    const uint8_t corrupted[] = { 'a', 'b', 'c', 'e' };
+    EXPECT_FALSE(packet.isChecksumValid(corrupted, sizeof(corrupted)));
+
+    // The checksum covers the header and the payload.
+    packet.setChecksum(0).computeChecksum(payload, 4);
+    EXPECT_EQ(packet.getChecksum(), 0x3331);
+    packet.setSequenceNumber(8).computeChecksum(payload, 4);
+    EXPECT_TRUE(packet.isChecksumValid(payload, 4));
+    packet.computeChecksum();
+    EXPECT_TRUE(packet.isChecksumValid());
+}
 
 TEST(IcmpParserUnitTests, CanParse)
 {
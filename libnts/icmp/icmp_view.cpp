@@ -0,0 +1,95 @@
+#include <libnts/icmp/icmp_view.hpp>
+
+#include <boost/endian/conversion.hpp>
+
+#include <libnts/core/checksum.hpp>
+
+namespace icmp {
+
+namespace {
+
+/// Size of the header.
+constexpr std::size_t headerSize{ 8 };
+
+} // namespace
+
+IcmpView::IcmpView(const uint8_t* data, const std::size_t length)
+    : data(data)
+    , length(length)
+{
+}
+
+bool IcmpView::isValid() const
+{
+    return length >= headerSize;
+}
+
+std::size_t IcmpView::getUnitSize() const
+{
+    return headerSize;
+}
+
+bool IcmpView::isChecksumValid() const
+{
+    // The one's complement sum of a valid message, checksum included, is 0xFFFF.
+    return nts::onesComplementSum(data, length) == 0xFFFF;
+}
+
+uint8_t IcmpView::getType() const
+{
+    return data[0];
+}
+
+uint8_t IcmpView::getCode() const
+{
+    return data[1];
+}
+
+uint16_t IcmpView::getChecksum() const
+{
+    return boost::endian::load_big_u16(data + 2);
+}
+
+std::string IcmpView::getIpAddress() const
+{
+    return getIp().toString();
+}
+
+ip::Ipv4Address IcmpView::getIp() const
+{
+    return ip::Ipv4Address(boost::endian::load_big_u32(data + 4));
+}
+
+uint16_t IcmpView::getIdentifier() const
+{
+    return boost::endian::load_big_u16(data + 4);
+}
+
+uint16_t IcmpView::getSequenceNumber() const
+{
+    return boost::endian::load_big_u16(data + 6);
+}
+
+uint16_t IcmpView::getNextHopMtu() const
+{
+    return boost::endian::load_big_u16(data + 6);
+}
+
+const uint8_t* IcmpView::getPayload() const
+{
+    return data + headerSize;
+}
+
+std::size_t IcmpView::getPayloadSize() const
+{
+    return length - headerSize;
+}
+
+IcmpDataUnit IcmpView::toDataUnit() const
+{
+    IcmpDataUnit message;
+    message.deserialize(data, length);
+    return message;
+}
+
+} // namespace icmp
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <libnts/icmp/icmp.hpp>
+
+namespace icmp {
+
+/// Read-only view of an ICMP header inside a received buffer.
+///
+/// @details Interprets the header fields in place instead of copying them, so a view is
+/// trivially copyable and never allocates. The getters mirror those of IcmpDataUnit. The
+/// buffer must outlive the view. When a test needs to modify the message, toDataUnit() returns
+/// an owning copy.
+class IcmpView
+{
+public:
+    /// Constructor. Creates an invalid view.
+    IcmpView() = default;
+
+    /// Constructor.
+    /// @param data Start of the message.
+    /// @param length Number of bytes available from the start of the message.
+    IcmpView(const uint8_t* data, const std::size_t length);
+
+    /// Whether the buffer holds the whole header.
+    /// @note The other getters assume that the view is valid.
+    bool isValid() const;
+
+    /// Size of the header in bytes.
+    std::size_t getUnitSize() const;
+
+    /// Verify the integrity of the header and payload with the checksum.
+    /// @note The payload is assumed to extend to the end of the buffer.
+    bool isChecksumValid() const;
+
+    /// Identifies the type of control message.
+    uint8_t getType() const;
+
+    /// Identifies the sub-type of control message.
+    uint8_t getCode() const;
+
+    /// 16-bit one's complement sum of all 16 bit words in the header and data.
+    uint16_t getChecksum() const;
+
+    /// Address of an alternative route. Used in redirect messages.
+    std::string getIpAddress() const;
+
+    /// Address of an alternative route. Used in redirect messages.
+    ip::Ipv4Address getIp() const;
+
+    /// Used to match requests with replies.
+    uint16_t getIdentifier() const;
+
+    /// Used to match requests with replies.
+    uint16_t getSequenceNumber() const;
+
+    /// MTU of the next hop network in case of a 'datagram is too big' error.
+    uint16_t getNextHopMtu() const;
+
+    /// Start of the data, right after the header.
+    const uint8_t* getPayload() const;
+
+    /// Number of bytes available after the header.
+    std::size_t getPayloadSize() const;
+
+    /// Owning copy of the header.
+    IcmpDataUnit toDataUnit() const;
+
+private:
+    /// Start of the message.
+    const uint8_t* data{ nullptr };
+
+    /// Number of bytes available from the start of the message.
+    std::size_t length{ 0 };
+};
+
+} // namespace icmp
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <type_traits>
+
+#include <libnts/icmp/icmp_view.hpp>
+
+namespace icmp {
+namespace tests {
+
+static_assert(std::is_trivially_copyable<IcmpView>::value, "Views must be trivially copyable");
+
+TEST(IcmpViewUnitTests, Accessors)
+{
+    IcmpDataUnit message = IcmpDataUnit().setType((uint8_t)IcmpMessageType::EchoReply).setCode((uint8_t)IcmpMessageCode::EchoReply).setChecksum(0x1234).setIdentifier(0xbeef).setSequenceNumber(7);
+
+    std::vector<uint8_t> buffer(12, 0);
+    ASSERT_EQ(message.serialize(buffer.data(), buffer.size()), 8);
+
+    IcmpView view(buffer.data(), buffer.size());
+    ASSERT_TRUE(view.isValid());
+    EXPECT_EQ(view.getType(), (uint8_t)IcmpMessageType::EchoReply);
+    EXPECT_EQ(view.getCode(), (uint8_t)IcmpMessageCode::EchoReply);
+    EXPECT_EQ(view.getChecksum(), 0x1234);
+    EXPECT_EQ(view.getIdentifier(), 0xbeef);
+    EXPECT_EQ(view.getSequenceNumber(), 7);
+    EXPECT_EQ(view.getIpAddress(), "190.239.0.7");
+    EXPECT_EQ(view.getPayloadSize(), 4);
+
+    EXPECT_FALSE(IcmpView(buffer.data(), 7).isValid());
+}
+
+TEST(IcmpViewUnitTests, ToDataUnit)
+{
+    std::vector<uint8_t> buffer(8, 0);
+    IcmpDataUnit().setIdentifier(3).setSequenceNumber(4).serialize(buffer.data(), buffer.size());
+
+    IcmpDataUnit message = IcmpView(buffer.data(), buffer.size()).toDataUnit();
+    EXPECT_EQ(message.getIdentifier(), 3);
+    EXPECT_EQ(message.getSequenceNumber(), 4);
+}
+
+} // namespace tests
+} // namespace icmp
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include <libnts/ipv4/ipv4.hpp>
+
+namespace ip {
+namespace benchmarks {
+
+/// Rewrite the per packet fields of a template and compute the checksum from scratch.
+void BM_Ipv4RewriteFullChecksum(benchmark::State& state)
+{
+    Ipv4DataUnit packet;
+    uint32_t sequence = 0;
+    for (auto _ : state)
+    {
+        sequence++;
+        packet.setTTL(sequence).setIdentification(sequence).setSourceAddress(Ipv4Address(0x0a000000 | (sequence & 0xFFFF)));
+        packet.computeChecksum();
+        benchmark::DoNotOptimize(packet.getHeaderChecksum());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Rewrite the per packet fields of a template and let the setters adjust the checksum.
+void BM_Ipv4RewriteAutoChecksum(benchmark::State& state)
+{
+    Ipv4DataUnit packet = Ipv4DataUnit().setAutoChecksum(true);
+    uint32_t sequence = 0;
+    for (auto _ : state)
+    {
+        sequence++;
+        packet.setTTL(sequence).setIdentification(sequence).setSourceAddress(Ipv4Address(0x0a000000 | (sequence & 0xFFFF)));
+        benchmark::DoNotOptimize(packet.getHeaderChecksum());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Ipv4RewriteFullChecksum);
+BENCHMARK(BM_Ipv4RewriteAutoChecksum);
+
+} // namespace benchmarks
+} // namespace ip
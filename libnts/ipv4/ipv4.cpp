@@ -1,16 +1,29 @@
 #include <libnts/ipv4/ipv4.hpp>
 
-#include <arpa/inet.h>
+#include <cstring>
 #include <sstream>
 
 #include <libnts/config/configuration.hpp>
+#include <libnts/core/checksum.hpp>
 
 namespace ip {
 
+namespace {
+
+/// Size of a header without options.
+constexpr std::size_t headerSize{ 20 };
+
+/// 16-bit word made of two 8-bit fields.
+uint16_t joinBytes(const uint8_t high, const uint8_t low)
+{
+    return static_cast<uint16_t>((high << 8) | low);
+}
+
+} // namespace
+
 Ipv4DataUnit::Ipv4DataUnit()
 {
-    setSourceAddress("0.0.0.0");
-    setDestinationAddress("0.0.0.0");
+    // The addresses are already zeroed by their initializers.
     computeChecksum();
 }
 
@@ -34,30 +47,55 @@ Ipv4DataUnit& Ipv4DataUnit::configure(std::shared_ptr<nts::Configuration> config
 
 void Ipv4DataUnit::toStream(std::ostream& outStream) const
 {
-    outStream.write(reinterpret_cast<const char*>(&versionAndIhl), 1);
-    outStream.write(reinterpret_cast<const char*>(&dscpAndEcn), 1);
-    outStream.write(reinterpret_cast<const char*>(&totalLength), 2);
-    outStream.write(reinterpret_cast<const char*>(&identification), 2);
-    outStream.write(reinterpret_cast<const char*>(&flagsAndOffset), 2);
-    outStream.write(reinterpret_cast<const char*>(&timeToLive), 1);
-    outStream.write(reinterpret_cast<const char*>(&protocol), 1);
-    outStream.write(reinterpret_cast<const char*>(&checksum), 2);
-    outStream.write(reinterpret_cast<const char*>(&sourceAddress), 4);
-    outStream.write(reinterpret_cast<const char*>(&destinationAddress), 4);
+    uint8_t buffer[headerSize];
+    serialize(buffer, headerSize);
+    outStream.write(reinterpret_cast<const char*>(buffer), headerSize);
 }
 
 void Ipv4DataUnit::fromStream(std::istream& inStream)
 {
-    inStream.read(reinterpret_cast<char*>(&versionAndIhl), 1);
-    inStream.read(reinterpret_cast<char*>(&dscpAndEcn), 1);
-    inStream.read(reinterpret_cast<char*>(&totalLength), 2);
-    inStream.read(reinterpret_cast<char*>(&identification), 2);
-    inStream.read(reinterpret_cast<char*>(&flagsAndOffset), 2);
-    inStream.read(reinterpret_cast<char*>(&timeToLive), 1);
-    inStream.read(reinterpret_cast<char*>(&protocol), 1);
-    inStream.read(reinterpret_cast<char*>(&checksum), 2);
-    inStream.read(reinterpret_cast<char*>(&sourceAddress), 4);
-    inStream.read(reinterpret_cast<char*>(&destinationAddress), 4);
+    uint8_t buffer[headerSize];
+    inStream.read(reinterpret_cast<char*>(buffer), headerSize);
+    deserialize(buffer, inStream.gcount());
+}
+
+std::size_t Ipv4DataUnit::serialize(uint8_t* outBuffer, const std::size_t capacity) const
+{
+    if (capacity < headerSize)
+    {
+        return 0;
+    }
+    // The fields are stored in network byte order, so they are copied as they are.
+    memcpy(outBuffer + 0, &versionAndIhl, 1);
+    memcpy(outBuffer + 1, &dscpAndEcn, 1);
+    memcpy(outBuffer + 2, &totalLength, 2);
+    memcpy(outBuffer + 4, &identification, 2);
+    memcpy(outBuffer + 6, &flagsAndOffset, 2);
+    memcpy(outBuffer + 8, &timeToLive, 1);
+    memcpy(outBuffer + 9, &protocol, 1);
+    memcpy(outBuffer + 10, &checksum, 2);
+    memcpy(outBuffer + 12, &sourceAddress, 4);
+    memcpy(outBuffer + 16, &destinationAddress, 4);
+    return headerSize;
+}
+
+std::size_t Ipv4DataUnit::deserialize(const uint8_t* inBuffer, const std::size_t length)
+{
+    if (length < headerSize)
+    {
+        return 0;
+    }
+    memcpy(&versionAndIhl, inBuffer + 0, 1);
+    memcpy(&dscpAndEcn, inBuffer + 1, 1);
+    memcpy(&totalLength, inBuffer + 2, 2);
+    memcpy(&identification, inBuffer + 4, 2);
+    memcpy(&flagsAndOffset, inBuffer + 6, 2);
+    memcpy(&timeToLive, inBuffer + 8, 1);
+    memcpy(&protocol, inBuffer + 9, 1);
+    memcpy(&checksum, inBuffer + 10, 2);
+    memcpy(&sourceAddress, inBuffer + 12, 4);
+    memcpy(&destinationAddress, inBuffer + 16, 4);
+    return headerSize;
 }
 
 std::string Ipv4DataUnit::toString() const
@@ -90,14 +128,30 @@ std::size_t Ipv4DataUnit::getUnitSize() const
 
 void Ipv4DataUnit::computeChecksum()
 {
-    uint16_t sum = getHeaderSum();
-    setHeaderChecksum(static_cast<uint16_t>(~sum));
+    setHeaderChecksum(static_cast<uint16_t>(~getHeaderSum()));
+}
+
+bool Ipv4DataUnit::isAutoChecksum() const
+{
+    return autoChecksum;
+}
+
+Ipv4DataUnit& Ipv4DataUnit::setAutoChecksum(const bool enabled)
+{
+    autoChecksum = enabled;
+    if (enabled)
+    {
+        computeChecksum();
+    }
+    return *this;
 }
 
 bool Ipv4DataUnit::isChecksumValid() const
 {
-    uint16_t sum = getHeaderSum();
-    return (sum + getHeaderChecksum()) == 0xFFFF;
+    // The one's complement sum of a valid header, checksum included, is 0xFFFF.
+    uint8_t header[headerSize];
+    serialize(header, headerSize);
+    return nts::onesComplementSum(header, headerSize) == 0xFFFF;
 }
 
 uint8_t Ipv4DataUnit::getVersion() const
@@ -157,74 +211,96 @@ uint16_t Ipv4DataUnit::getHeaderChecksum() const
 
 std::string Ipv4DataUnit::getSourceAddress() const
 {
-    char string[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, reinterpret_cast<const in_addr*>(&sourceAddress), string, INET_ADDRSTRLEN);
-    return string;
+    return getSourceIp().toString();
 }
 
 std::string Ipv4DataUnit::getDestinationAddress() const
 {
-    char string[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, reinterpret_cast<const in_addr*>(&destinationAddress), string, INET_ADDRSTRLEN);
-    return string;
+    return getDestinationIp().toString();
+}
+
+Ipv4Address Ipv4DataUnit::getSourceIp() const
+{
+    return Ipv4Address(sourceAddress);
+}
+
+Ipv4Address Ipv4DataUnit::getDestinationIp() const
+{
+    return Ipv4Address(destinationAddress);
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setVersion(const uint8_t version)
 {
+    const uint16_t oldWord = joinBytes(versionAndIhl, dscpAndEcn);
     versionAndIhl = (versionAndIhl & 0x0F) | (version << 4);
+    updateChecksum(oldWord, joinBytes(versionAndIhl, dscpAndEcn));
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setIHL(const uint8_t ihl)
 {
+    const uint16_t oldWord = joinBytes(versionAndIhl, dscpAndEcn);
     versionAndIhl = (versionAndIhl & 0xF0) | (ihl & 0x0F);
+    updateChecksum(oldWord, joinBytes(versionAndIhl, dscpAndEcn));
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setDSCP(const uint8_t dscp)
 {
+    const uint16_t oldWord = joinBytes(versionAndIhl, dscpAndEcn);
     dscpAndEcn = (dscpAndEcn & 0x03) | (dscp << 2);
+    updateChecksum(oldWord, joinBytes(versionAndIhl, dscpAndEcn));
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setECN(const uint8_t ecn)
 {
+    const uint16_t oldWord = joinBytes(versionAndIhl, dscpAndEcn);
     dscpAndEcn = (dscpAndEcn & 0xFC) | (ecn & 0x03);
+    updateChecksum(oldWord, joinBytes(versionAndIhl, dscpAndEcn));
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setTotalLength(const uint16_t length)
 {
+    updateChecksum(totalLength, length);
     totalLength = length;
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setIdentification(const uint16_t id)
 {
+    updateChecksum(identification, id);
     identification = id;
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setFlags(const uint8_t flags)
 {
+    const uint16_t oldWord = flagsAndOffset;
     flagsAndOffset = (flagsAndOffset & 0x1FFF) | (flags << 13);
+    updateChecksum(oldWord, flagsAndOffset);
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setFragmentOffset(const uint16_t offset)
 {
+    const uint16_t oldWord = flagsAndOffset;
     flagsAndOffset = (flagsAndOffset & 0xE000) | (offset & 0x1FFF);
+    updateChecksum(oldWord, flagsAndOffset);
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setTTL(const uint8_t ttl)
 {
+    updateChecksum(joinBytes(timeToLive, protocol), joinBytes(ttl, protocol));
     timeToLive = ttl;
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setProtocol(const uint8_t protocol)
 {
+    updateChecksum(joinBytes(timeToLive, this->protocol), joinBytes(timeToLive, protocol));
     this->protocol = protocol;
     return *this;
 }
@@ -237,32 +313,52 @@ Ipv4DataUnit& Ipv4DataUnit::setHeaderChecksum(const uint16_t checksum)
 
 Ipv4DataUnit& Ipv4DataUnit::setSourceAddress(const std::string source)
 {
-    inet_pton(AF_INET, source.c_str(), reinterpret_cast<in_addr*>(&sourceAddress));
+    return setSourceAddress(Ipv4Address::parse(source));
+}
+
+Ipv4DataUnit& Ipv4DataUnit::setSourceAddress(const Ipv4Address& source)
+{
+    updateChecksum32(sourceAddress, source.toUint32());
+    sourceAddress = source.toUint32();
     return *this;
 }
 
 Ipv4DataUnit& Ipv4DataUnit::setDestinationAddress(const std::string destination)
 {
-    inet_pton(AF_INET, destination.c_str(), reinterpret_cast<in_addr*>(&destinationAddress));
+    return setDestinationAddress(Ipv4Address::parse(destination));
+}
+
+Ipv4DataUnit& Ipv4DataUnit::setDestinationAddress(const Ipv4Address& destination)
+{
+    updateChecksum32(destinationAddress, destination.toUint32());
+    destinationAddress = destination.toUint32();
     return *this;
 }
 
 uint16_t Ipv4DataUnit::getHeaderSum() const
 {
     // Add up every 16-bit word in the header, excluding the checksum field.
-    uint32_t sum = (versionAndIhl << 4) + dscpAndEcn
-        + totalLength + identification + flagsAndOffset
-        + (timeToLive << 4) + protocol
-        + (sourceAddress >> 12) + (sourceAddress & 0xFFFF)
-        + (destinationAddress >> 12) + (destinationAddress & 0xFFFF);
-
-    // Carry over.
-    while (sum > 0xFFFF)
+    uint8_t header[headerSize];
+    serialize(header, headerSize);
+    header[10] = 0;
+    header[11] = 0;
+    return nts::onesComplementSum(header, headerSize);
+}
+
+void Ipv4DataUnit::updateChecksum(const uint16_t oldWord, const uint16_t newWord)
+{
+    if (autoChecksum)
     {
-        sum = (sum >> 4) + (sum & 0xFF);
+        checksum = nts::updateChecksum(getHeaderChecksum(), oldWord, newWord);
     }
+}
 
-    return static_cast<uint16_t>(sum);
+void Ipv4DataUnit::updateChecksum32(const uint32_t oldWord, const uint32_t newWord)
+{
+    if (autoChecksum)
+    {
+        checksum = nts::updateChecksum32(getHeaderChecksum(), oldWord, newWord);
+    }
 }
 
 bool Ipv4Parser::canParse(const std::map<std::string, int>& inContext) const
@@ -283,7 +379,42 @@ std::shared_ptr<nts::ProtocolDataUnit> Ipv4Parser::parse(std::istream& inStream,
     outContext["ipv4"] = 1;
     outContext["protocol"] = static_cast<int>(packet->getProtocol());
 
-    return std::move(packet);
+    return packet;
+}
+
+void Ipv4Parser::getDispatchKeys(std::vector<nts::ParserContext>& outKeys) const
+{
+    outKeys.assign({ nts::ParserContext{ nts::ProtocolId::Ethernet, 0x0800 } });
+}
+
+std::shared_ptr<nts::ProtocolDataUnit> Ipv4Parser::parseLayer(std::istream& inStream, nts::ParserContext& context) const
+{
+    std::shared_ptr<Ipv4DataUnit> packet = nts::makeDataUnit<Ipv4DataUnit>(context.pool);
+    packet->fromStream(inStream);
+
+    context.protocol = nts::ProtocolId::Ipv4;
+    context.nextProtocol = packet->getProtocol();
+
+    return packet;
+}
+
+std::shared_ptr<nts::ProtocolDataUnit> Ipv4Parser::parseBuffer(const uint8_t* inBuffer, const std::size_t length, nts::ParserContext& context, std::size_t& outBytes) const
+{
+    std::shared_ptr<Ipv4DataUnit> packet = nts::makeDataUnit<Ipv4DataUnit>(context.pool);
+    outBytes = packet->deserialize(inBuffer, length);
+    if (outBytes == 0)
+    {
+        // Truncated, so the data can't be parsed any further.
+        outBytes = length;
+        context.protocol = nts::ProtocolId::Unknown;
+        context.nextProtocol = 0;
+        return packet;
+    }
+
+    context.protocol = nts::ProtocolId::Ipv4;
+    context.nextProtocol = packet->getProtocol();
+
+    return packet;
 }
 
 } // namespace ip
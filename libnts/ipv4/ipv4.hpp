@@ -1,6 +1,9 @@
+#pragma once
+
 #include <boost/endian/arithmetic.hpp>
 
 #include <libnts/core/data_unit.hpp>
+#include <libnts/ipv4/ipv4_address.hpp>
 #include <libnts/messaging/parser.hpp>
 
 namespace nts {
@@ -40,6 +43,14 @@ public:
     /// Reads the packet from the stream.
     virtual void fromStream(std::istream& inStream);
 
+    /// Writes the packet to the buffer.
+    /// @returns The number of bytes written, or 0 if the packet does not fit.
+    virtual std::size_t serialize(uint8_t* outBuffer, const std::size_t capacity) const;
+
+    /// Reads the packet from the buffer.
+    /// @returns The number of bytes read, or 0 if the buffer is too short.
+    virtual std::size_t deserialize(const uint8_t* inBuffer, const std::size_t length);
+
     /// Representation of the packet in a console friendly format.
     virtual std::string toString() const;
 
@@ -55,6 +66,16 @@ public:
     /// Verify the integrity of the header with the checksum.
     bool isChecksumValid() const;
 
+    /// Whether the setters keep the checksum up to date.
+    bool isAutoChecksum() const;
+
+    /// Whether the setters keep the checksum up to date.
+    /// @details Enabling the mode computes the checksum once. From then on, each setter adjusts
+    /// the checksum for the field it changes (RFC 1624), which takes a few arithmetic operations
+    /// instead of a sum over the header. Checksums set explicitly or read with the header are
+    /// kept as they are, so an invalid checksum stays invalid.
+    Ipv4DataUnit& setAutoChecksum(const bool enabled);
+
     /// Header protocol version.
     uint8_t getVersion() const;
 
@@ -96,6 +117,12 @@ public:
     /// IPv4 address of the recipient.
     std::string getDestinationAddress() const;
 
+    /// IPv4 address of the sender.
+    Ipv4Address getSourceIp() const;
+
+    /// IPv4 address of the recipient.
+    Ipv4Address getDestinationIp() const;
+
     /// Header protocol version.
     Ipv4DataUnit& setVersion(const uint8_t version);
 
@@ -132,15 +159,29 @@ public:
     Ipv4DataUnit& setHeaderChecksum(const uint16_t checksum);
 
     /// IPv4 address of the sender.
+    /// @throws std::invalid_argument If the text is not a valid address.
     Ipv4DataUnit& setSourceAddress(const std::string source);
 
+    /// IPv4 address of the sender.
+    Ipv4DataUnit& setSourceAddress(const Ipv4Address& source);
+
     /// IPv4 address of the recipient.
+    /// @throws std::invalid_argument If the text is not a valid address.
     Ipv4DataUnit& setDestinationAddress(const std::string destination);
 
+    /// IPv4 address of the recipient.
+    Ipv4DataUnit& setDestinationAddress(const Ipv4Address& destination);
+
 protected:
-    // Sum of all 16-bit words in the header, excluding the checksum.
+    /// One's complement sum of all 16-bit words in the header, excluding the checksum.
     uint16_t getHeaderSum() const;
 
+    /// Adjust the checksum for a 16-bit word of the header that changed, in auto-checksum mode.
+    void updateChecksum(const uint16_t oldWord, const uint16_t newWord);
+
+    /// Adjust the checksum for a 32-bit word of the header that changed, in auto-checksum mode.
+    void updateChecksum32(const uint32_t oldWord, const uint32_t newWord);
+
 private:
     boost::endian::big_uint8_t versionAndIhl{ 0x45 };
 
@@ -161,6 +202,9 @@ private:
     boost::endian::big_uint32_t sourceAddress{ 0 };
 
     boost::endian::big_uint32_t destinationAddress{ 0 };
+
+    /// Whether the setters keep the checksum up to date.
+    bool autoChecksum{ false };
 };
 
 /// Parser for the IPv4 protocol.
@@ -178,6 +222,15 @@ public:
 
     /// Parse an IPv4 packet from the stream.
     virtual std::shared_ptr<nts::ProtocolDataUnit> parse(std::istream& inStream, std::map<std::string, int>& outContext) const;
+
+    /// After an Ethernet frame with the IPv4 EtherType.
+    virtual void getDispatchKeys(std::vector<nts::ParserContext>& outKeys) const;
+
+    /// Parse an IPv4 packet from the stream.
+    virtual std::shared_ptr<nts::ProtocolDataUnit> parseLayer(std::istream& inStream, nts::ParserContext& context) const;
+
+    /// Parse an IPv4 packet from the buffer.
+    virtual std::shared_ptr<nts::ProtocolDataUnit> parseBuffer(const uint8_t* inBuffer, const std::size_t length, nts::ParserContext& context, std::size_t& outBytes) const;
 };
 
 } // namespace ip
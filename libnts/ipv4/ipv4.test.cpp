@@ -1,5 +1,6 @@
 #include <boost/asio.hpp>
 #include <iostream>
+#include <sstream>
 #include <gtest/gtest.h>
 
 #include <libnts/ipv4/ipv4.hpp>
@@ -38,6 +39,8 @@ TEST(Ipv4UnitTests, Accessors)
     EXPECT_EQ(packet.getHeaderChecksum(), 12345);
     EXPECT_EQ(packet.getSourceAddress(), "1.2.3.4");
     EXPECT_EQ(packet.getDestinationAddress(), "4.3.2.1");
+    EXPECT_EQ(packet.getSourceIp(), Ipv4Address(1, 2, 3, 4));
+    EXPECT_EQ(packet.setDestinationAddress(Ipv4Address(5, 6, 7, 8)).getDestinationAddress(), "5.6.7.8");
 }
 
 TEST(Ipv4UnitTests, Serialization)
@@ -71,12 +74,68 @@ TEST(Ipv4UnitTests, Serialization)
     EXPECT_EQ(packetB.getDestinationAddress(), "4.3.2.1");
 }
 
+TEST(Ipv4UnitTests, BufferSerialization)
+{
+    Ipv4DataUnit packetA = Ipv4DataUnit().setTotalLength(110).setIdentification(0xdead).setTTL(1).setSourceAddress("1.2.3.4").setDestinationAddress("4.3.2.1");
+
+    uint8_t buffer[32];
+    EXPECT_EQ(packetA.serialize(buffer, 19), 0);
+    ASSERT_EQ(packetA.serialize(buffer, sizeof(buffer)), 20);
+
+    // Both APIs produce the same bytes.
+    std::stringstream stream;
+    packetA.toStream(stream);
+    EXPECT_EQ(stream.str(), std::string(reinterpret_cast<char*>(buffer), 20));
+
+    Ipv4DataUnit packetB;
+    EXPECT_EQ(packetB.deserialize(buffer, 19), 0);
+    EXPECT_EQ(packetB.deserialize(buffer, sizeof(buffer)), 20);
+    EXPECT_EQ(packetB.getTotalLength(), 110);
+    EXPECT_EQ(packetB.getIdentification(), 0xdead);
+    EXPECT_EQ(packetB.getTTL(), 1);
+    EXPECT_EQ(packetB.getSourceAddress(), "1.2.3.4");
+    EXPECT_EQ(packetB.getDestinationAddress(), "4.3.2.1");
+}
+
 TEST(Ipv4UnitTests, Checksum)
 {
     Ipv4DataUnit packet = Ipv4DataUnit().setHeaderChecksum(0x1234);
     EXPECT_FALSE(packet.isChecksumValid());
     packet.computeChecksum();
     EXPECT_TRUE(packet.isChecksumValid());
+
+    // Sample header with a known good checksum.
+    const std::vector<uint8_t> header{ 0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11, 0xb8, 0x61, 0xc0, 0xa8, 0x00, 0x01, 0xc0, 0xa8, 0x00, 0xc7 };
+    ASSERT_EQ(packet.deserialize(header.data(), header.size()), 20);
+    EXPECT_TRUE(packet.isChecksumValid());
+    packet.setHeaderChecksum(0).computeChecksum();
+    EXPECT_EQ(packet.getHeaderChecksum(), 0xb861);
+}
+
+TEST(Ipv4UnitTests, AutoChecksum)
+{
+    Ipv4DataUnit packet = Ipv4DataUnit().setHeaderChecksum(0x1234);
+    EXPECT_FALSE(packet.isAutoChecksum());
+
+    // Enabling the mode fixes the checksum.
+    packet.setAutoChecksum(true);
+    EXPECT_TRUE(packet.isAutoChecksum());
+    EXPECT_TRUE(packet.isChecksumValid());
+
+    // Every setter keeps it valid, and equal to a full computation.
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        packet.setTTL(i).setIdentification(i * 977).setSourceAddress(Ipv4Address(i * 2654435761u)).setDestinationAddress(Ipv4Address(~i));
+        packet.setVersion(i).setIHL(i).setDSCP(i).setECN(i).setTotalLength(i * 3).setFlags(i).setFragmentOffset(i * 5).setProtocol(i * 11);
+        ASSERT_TRUE(packet.isChecksumValid());
+        Ipv4DataUnit copy = packet;
+        copy.computeChecksum();
+        ASSERT_EQ(packet.getHeaderChecksum(), copy.getHeaderChecksum());
+    }
+
+    // Without the mode, setters leave the checksum alone.
+    packet.setAutoChecksum(false).setTTL(1).setTTL(2);
+    EXPECT_FALSE(packet.isChecksumValid());
 }
 
 TEST(Ipv4ParserUnitTests, CanParse)
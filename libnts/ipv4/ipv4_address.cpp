@@ -0,0 +1,84 @@
+#include <libnts/ipv4/ipv4_address.hpp>
+
+#include <cstring>
+
+namespace ip {
+
+namespace {
+
+/// Decimal text of every octet value, built at compile time.
+struct OctetTable
+{
+    constexpr OctetTable()
+        : digits{}
+        , lengths{}
+    {
+        for (int value = 0; value < 256; value++)
+        {
+            const int hundreds = value / 100;
+            const int tens = (value / 10) % 10;
+            const int units = value % 10;
+            int length = 0;
+            if (hundreds > 0)
+            {
+                digits[value][length++] = static_cast<char>('0' + hundreds);
+            }
+            if (hundreds > 0 || tens > 0)
+            {
+                digits[value][length++] = static_cast<char>('0' + tens);
+            }
+            digits[value][length++] = static_cast<char>('0' + units);
+            lengths[value] = static_cast<uint8_t>(length);
+        }
+    }
+
+    /// Digits of each value, without leading zeros.
+    char digits[256][3];
+
+    /// Number of digits of each value.
+    uint8_t lengths[256];
+};
+
+constexpr OctetTable octetTable;
+
+} // namespace
+
+constexpr std::size_t Ipv4Address::maxStringSize;
+
+Ipv4Address Ipv4Address::parse(const std::string& text)
+{
+    return parse(text.data(), text.size());
+}
+
+std::size_t Ipv4Address::format(char* outBuffer, const std::size_t capacity) const noexcept
+{
+    // Format on the stack first, since the length is only known at the end.
+    char text[maxStringSize];
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < 4; i++)
+    {
+        if (i > 0)
+        {
+            text[length++] = '.';
+        }
+        const uint8_t octet = (*this)[i];
+        memcpy(text + length, octetTable.digits[octet], 3);
+        length += octetTable.lengths[octet];
+    }
+
+    if (capacity < length + 1)
+    {
+        return 0;
+    }
+    memcpy(outBuffer, text, length);
+    outBuffer[length] = '\0';
+    return length;
+}
+
+std::string Ipv4Address::toString() const
+{
+    char text[maxStringSize];
+    return std::string(text, format(text, sizeof(text)));
+}
+
+} // namespace ip
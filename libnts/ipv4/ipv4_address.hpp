@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace ip {
+
+/// 32-bit IPv4 address.
+///
+/// @details A plain value type that can be parsed at compile time and formatted into a caller
+/// provided buffer, so addresses can be compared and printed from any thread without locks or
+/// allocations. The value is kept in host byte order; data units convert it when they store it
+/// in a header. Text uses the dotted decimal format of inet_ntop.
+///
+/// @example
+/// using namespace ip::literals;
+/// constexpr Ipv4Address gateway = "192.168.1.1"_ipv4;
+/// char text[Ipv4Address::maxStringSize];
+/// packet.getSourceIp().format(text, sizeof(text));
+class Ipv4Address
+{
+public:
+    /// Size of the longest formatted address, including the null terminator.
+    static constexpr std::size_t maxStringSize{ 16 };
+
+    /// Constructor. Creates the 0.0.0.0 address.
+    constexpr Ipv4Address() = default;
+
+    /// Constructor.
+    /// @param value Address in host byte order.
+    constexpr explicit Ipv4Address(const uint32_t value)
+        : value(value)
+    {
+    }
+
+    /// Constructor.
+    /// @param a, b, c, d Octets of the address, from the most significant one.
+    constexpr Ipv4Address(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d)
+        : value((uint32_t(a) << 24) | (uint32_t(b) << 16) | (uint32_t(c) << 8) | d)
+    {
+    }
+
+    /// Address from its dotted decimal representation.
+    /// @throws std::invalid_argument If the text is not a valid address. Compilation fails instead
+    /// when parsing a literal at compile time.
+    static constexpr Ipv4Address parse(const char* text, const std::size_t length);
+
+    /// Address from its dotted decimal representation.
+    /// @throws std::invalid_argument If the text is not a valid address.
+    static Ipv4Address parse(const std::string& text);
+
+    /// Parse the dotted decimal representation of an address without throwing.
+    /// @returns Whether the text is a valid address. The output is only written on success.
+    static constexpr bool tryParse(const char* text, const std::size_t length, Ipv4Address& outAddress) noexcept;
+
+    /// Write the dotted decimal representation of the address to the buffer, followed by a null
+    /// terminator.
+    /// @returns The length of the text, or 0 if the buffer is too small.
+    std::size_t format(char* outBuffer, const std::size_t capacity) const noexcept;
+
+    /// Dotted decimal representation of the address.
+    std::string toString() const;
+
+    /// Address in host byte order.
+    constexpr uint32_t toUint32() const
+    {
+        return value;
+    }
+
+    /// Octet at the given position, from the most significant one.
+    constexpr uint8_t operator[](const std::size_t index) const
+    {
+        return static_cast<uint8_t>(value >> (24 - 8 * index));
+    }
+
+    constexpr bool operator==(const Ipv4Address& other) const
+    {
+        return value == other.value;
+    }
+
+    constexpr bool operator!=(const Ipv4Address& other) const
+    {
+        return value != other.value;
+    }
+
+    constexpr bool operator<(const Ipv4Address& other) const
+    {
+        return value < other.value;
+    }
+
+private:
+    /// Address in host byte order.
+    uint32_t value{ 0 };
+};
+
+constexpr bool Ipv4Address::tryParse(const char* text, const std::size_t length, Ipv4Address& outAddress) noexcept
+{
+    uint32_t address = 0;
+    std::size_t position = 0;
+    for (std::size_t i = 0; i < 4; i++)
+    {
+        if (i > 0)
+        {
+            if (position >= length || text[position] != '.')
+            {
+                return false;
+            }
+            position++;
+        }
+
+        // Each octet has up to three digits, and no leading zeros, like inet_pton.
+        uint32_t octet = 0;
+        std::size_t digits = 0;
+        while (position < length && text[position] >= '0' && text[position] <= '9')
+        {
+            if (digits == 3 || (digits == 1 && octet == 0))
+            {
+                return false;
+            }
+            octet = octet * 10 + (text[position] - '0');
+            position++;
+            digits++;
+        }
+        if (digits == 0 || octet > 255)
+        {
+            return false;
+        }
+        address = (address << 8) | octet;
+    }
+    if (position != length)
+    {
+        return false;
+    }
+    outAddress = Ipv4Address(address);
+    return true;
+}
+
+constexpr Ipv4Address Ipv4Address::parse(const char* text, const std::size_t length)
+{
+    Ipv4Address address;
+    if (!tryParse(text, length, address))
+    {
+        throw std::invalid_argument("Invalid IPv4 address");
+    }
+    return address;
+}
+
+namespace literals {
+
+/// IPv4 address literal, parsed at compile time when used in a constant expression.
+constexpr Ipv4Address operator"" _ipv4(const char* text, const std::size_t length)
+{
+    return Ipv4Address::parse(text, length);
+}
+
+} // namespace literals
+
+} // namespace ip
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <libnts/ipv4/ipv4_address.hpp>
+
+namespace ip {
+namespace tests {
+
+using namespace ip::literals;
+
+TEST(Ipv4AddressUnitTests, Parsing)
+{
+    // Literals are parsed at compile time.
+    constexpr Ipv4Address address = "192.168.1.254"_ipv4;
+    static_assert(address.toUint32() == 0xc0a801fe, "Literal was not parsed");
+    EXPECT_EQ(address, Ipv4Address(192, 168, 1, 254));
+    EXPECT_EQ(address[0], 192);
+    EXPECT_EQ(address[3], 254);
+    EXPECT_EQ(Ipv4Address::parse(std::string("0.0.0.0")), Ipv4Address());
+
+    // Same rules as inet_pton.
+    Ipv4Address parsed;
+    EXPECT_FALSE(Ipv4Address::tryParse("192.168.1", 9, parsed));
+    EXPECT_FALSE(Ipv4Address::tryParse("192.168.1.256", 13, parsed));
+    EXPECT_FALSE(Ipv4Address::tryParse("192.168.01.1", 12, parsed));
+    EXPECT_FALSE(Ipv4Address::tryParse("192.168.1.1.", 12, parsed));
+    EXPECT_FALSE(Ipv4Address::tryParse("192.168..1", 10, parsed));
+    EXPECT_EQ(parsed, Ipv4Address());
+    EXPECT_THROW(Ipv4Address::parse(std::string("localhost")), std::invalid_argument);
+}
+
+TEST(Ipv4AddressUnitTests, Formatting)
+{
+    EXPECT_EQ("10.0.100.7"_ipv4.toString(), "10.0.100.7");
+    EXPECT_EQ(Ipv4Address().toString(), "0.0.0.0");
+
+    char text[Ipv4Address::maxStringSize];
+    EXPECT_EQ("255.255.255.255"_ipv4.format(text, sizeof(text)), 15);
+    EXPECT_STREQ(text, "255.255.255.255");
+
+    // Doesn't fit with the null terminator.
+    EXPECT_EQ("255.255.255.255"_ipv4.format(text, 15), 0);
+}
+
+} // namespace tests
+} // namespace ip
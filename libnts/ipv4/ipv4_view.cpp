@@ -0,0 +1,133 @@
+#include <libnts/ipv4/ipv4_view.hpp>
+
+#include <algorithm>
+#include <boost/endian/conversion.hpp>
+
+#include <libnts/core/checksum.hpp>
+
+namespace ip {
+
+namespace {
+
+/// Size of a header without options.
+constexpr std::size_t minimumHeaderSize{ 20 };
+
+} // namespace
+
+Ipv4View::Ipv4View(const uint8_t* data, const std::size_t length)
+    : data(data)
+    , length(length)
+{
+}
+
+bool Ipv4View::isValid() const
+{
+    return length >= minimumHeaderSize && getUnitSize() >= minimumHeaderSize && getUnitSize() <= length;
+}
+
+std::size_t Ipv4View::getUnitSize() const
+{
+    return getIHL() * 4;
+}
+
+bool Ipv4View::isChecksumValid() const
+{
+    // The one's complement sum of a valid header, checksum included, is 0xFFFF.
+    return nts::onesComplementSum(data, getUnitSize()) == 0xFFFF;
+}
+
+uint8_t Ipv4View::getVersion() const
+{
+    return (data[0] >> 4);
+}
+
+uint8_t Ipv4View::getIHL() const
+{
+    return (data[0] & 0x0F);
+}
+
+uint8_t Ipv4View::getDSCP() const
+{
+    return (data[1] >> 2);
+}
+
+uint8_t Ipv4View::getECN() const
+{
+    return (data[1] & 0x03);
+}
+
+uint16_t Ipv4View::getTotalLength() const
+{
+    return boost::endian::load_big_u16(data + 2);
+}
+
+uint16_t Ipv4View::getIdentification() const
+{
+    return boost::endian::load_big_u16(data + 4);
+}
+
+uint8_t Ipv4View::getFlags() const
+{
+    return (boost::endian::load_big_u16(data + 6) >> 13);
+}
+
+uint16_t Ipv4View::getFragmentOffset() const
+{
+    return (boost::endian::load_big_u16(data + 6) & 0x1FFF);
+}
+
+uint8_t Ipv4View::getTTL() const
+{
+    return data[8];
+}
+
+uint8_t Ipv4View::getProtocol() const
+{
+    return data[9];
+}
+
+uint16_t Ipv4View::getHeaderChecksum() const
+{
+    return boost::endian::load_big_u16(data + 10);
+}
+
+std::string Ipv4View::getSourceAddress() const
+{
+    return getSourceIp().toString();
+}
+
+std::string Ipv4View::getDestinationAddress() const
+{
+    return getDestinationIp().toString();
+}
+
+Ipv4Address Ipv4View::getSourceIp() const
+{
+    return Ipv4Address(boost::endian::load_big_u32(data + 12));
+}
+
+Ipv4Address Ipv4View::getDestinationIp() const
+{
+    return Ipv4Address(boost::endian::load_big_u32(data + 16));
+}
+
+const uint8_t* Ipv4View::getPayload() const
+{
+    return data + getUnitSize();
+}
+
+std::size_t Ipv4View::getPayloadSize() const
+{
+    // Frames may be padded past the end of the packet.
+    const std::size_t end = std::min<std::size_t>(std::max<std::size_t>(getTotalLength(), getUnitSize()), length);
+    return end - getUnitSize();
+}
+
+Ipv4DataUnit Ipv4View::toDataUnit() const
+{
+    Ipv4DataUnit packet;
+    packet.deserialize(data, length);
+    return packet;
+}
+
+} // namespace ip
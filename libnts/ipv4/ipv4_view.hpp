@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <libnts/ipv4/ipv4.hpp>
+
+namespace ip {
+
+/// Read-only view of an IPv4 header inside a received buffer.
+///
+/// @details Interprets the header fields in place instead of copying them, so a view is
+/// trivially copyable and never allocates. The getters mirror those of Ipv4DataUnit. The
+/// buffer must outlive the view. When a test needs to modify the packet, toDataUnit() returns
+/// an owning copy.
+class Ipv4View
+{
+public:
+    /// Constructor. Creates an invalid view.
+    Ipv4View() = default;
+
+    /// Constructor.
+    /// @param data Start of the packet.
+    /// @param length Number of bytes available from the start of the packet.
+    Ipv4View(const uint8_t* data, const std::size_t length);
+
+    /// Whether the buffer holds the whole header, including the options.
+    /// @note The other getters assume that the view is valid.
+    bool isValid() const;
+
+    /// Size of the header in bytes, including the options.
+    std::size_t getUnitSize() const;
+
+    /// Verify the integrity of the header with the checksum.
+    bool isChecksumValid() const;
+
+    /// Header protocol version.
+    uint8_t getVersion() const;
+
+    /// Internet Header Length (IHL) specifies the number of 32-bit words in the header.
+    uint8_t getIHL() const;
+
+    /// Differentiated Services Code Point (DSCP) is used to classify network traffic.
+    uint8_t getDSCP() const;
+
+    /// Explicit Congestion Notification (ECN) allows notification of congestion without
+    /// dropping packets.
+    uint8_t getECN() const;
+
+    /// Size of the entire packet in bytes, including header and data.
+    uint16_t getTotalLength() const;
+
+    /// Identifier for grouping fragments of a single IP packet.
+    uint16_t getIdentification() const;
+
+    /// A 3-bit field of Reserved, Don't Fragment (DF) and More Fragments (MF) flags.
+    uint8_t getFlags() const;
+
+    /// Specifies the offset of the current fragment relative to the beginning of the original
+    /// packet in units of eight-byte blocks.
+    uint16_t getFragmentOffset() const;
+
+    /// Limits the lifetime of the packet.
+    uint8_t getTTL() const;
+
+    /// Protocol of the payload.
+    uint8_t getProtocol() const;
+
+    /// 16-bit one's complement sum of all 16 bit words in the header.
+    uint16_t getHeaderChecksum() const;
+
+    /// IPv4 address of the sender.
+    std::string getSourceAddress() const;
+
+    /// IPv4 address of the recipient.
+    std::string getDestinationAddress() const;
+
+    /// IPv4 address of the sender.
+    Ipv4Address getSourceIp() const;
+
+    /// IPv4 address of the recipient.
+    Ipv4Address getDestinationIp() const;
+
+    /// Start of the payload, right after the header.
+    const uint8_t* getPayload() const;
+
+    /// Number of payload bytes, bounded by the total length and the size of the buffer.
+    std::size_t getPayloadSize() const;
+
+    /// Owning copy of the header, without the options.
+    Ipv4DataUnit toDataUnit() const;
+
+private:
+    /// Start of the packet.
+    const uint8_t* data{ nullptr };
+
+    /// Number of bytes available from the start of the packet.
+    std::size_t length{ 0 };
+};
+
+} // namespace ip
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <type_traits>
+
+#include <libnts/ipv4/ipv4_view.hpp>
+
+namespace ip {
+namespace tests {
+
+static_assert(std::is_trivially_copyable<Ipv4View>::value, "Views must be trivially copyable");
+
+TEST(Ipv4ViewUnitTests, Accessors)
+{
+    Ipv4DataUnit packet = Ipv4DataUnit().setDSCP(14).setECN(3).setTotalLength(28).setIdentification(0xdead).setFlags(2).setFragmentOffset(18).setTTL(1).setProtocol((uint8_t)IpPayloadProtocols::ICMP).setHeaderChecksum(12345).setSourceAddress("1.2.3.4").setDestinationAddress("4.3.2.1");
+
+    // Header, payload and padding.
+    std::vector<uint8_t> buffer(46, 0);
+    ASSERT_EQ(packet.serialize(buffer.data(), buffer.size()), 20);
+
+    Ipv4View view(buffer.data(), buffer.size());
+    ASSERT_TRUE(view.isValid());
+    EXPECT_EQ(view.getUnitSize(), 20);
+    EXPECT_EQ(view.getVersion(), 4);
+    EXPECT_EQ(view.getIHL(), 5);
+    EXPECT_EQ(view.getDSCP(), 14);
+    EXPECT_EQ(view.getECN(), 3);
+    EXPECT_EQ(view.getTotalLength(), 28);
+    EXPECT_EQ(view.getIdentification(), 0xdead);
+    EXPECT_EQ(view.getFlags(), 2);
+    EXPECT_EQ(view.getFragmentOffset(), 18);
+    EXPECT_EQ(view.getTTL(), 1);
+    EXPECT_EQ(view.getProtocol(), (uint8_t)IpPayloadProtocols::ICMP);
+    EXPECT_EQ(view.getHeaderChecksum(), 12345);
+    EXPECT_EQ(view.getSourceAddress(), "1.2.3.4");
+    EXPECT_EQ(view.getDestinationAddress(), "4.3.2.1");
+
+    // The padding is not part of the payload.
+    EXPECT_EQ(view.getPayload(), buffer.data() + 20);
+    EXPECT_EQ(view.getPayloadSize(), 8);
+}
+
+TEST(Ipv4ViewUnitTests, Validity)
+{
+    std::vector<uint8_t> buffer(24, 0);
+    Ipv4DataUnit().serialize(buffer.data(), buffer.size());
+    EXPECT_TRUE(Ipv4View(buffer.data(), 20).isValid());
+    EXPECT_FALSE(Ipv4View(buffer.data(), 19).isValid());
+
+    // Options must fit in the buffer.
+    buffer[0] = 0x46;
+    EXPECT_EQ(Ipv4View(buffer.data(), 24).getUnitSize(), 24);
+    EXPECT_TRUE(Ipv4View(buffer.data(), 24).isValid());
+    EXPECT_FALSE(Ipv4View(buffer.data(), 20).isValid());
+
+    // Headers can't be shorter than 20 bytes.
+    buffer[0] = 0x44;
+    EXPECT_FALSE(Ipv4View(buffer.data(), 24).isValid());
+}
+
+TEST(Ipv4ViewUnitTests, Checksum)
+{
+    // Sample header with a known good checksum.
+    const std::vector<uint8_t> header{ 0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11, 0xb8, 0x61, 0xc0, 0xa8, 0x00, 0x01, 0xc0, 0xa8, 0x00, 0xc7 };
+    EXPECT_TRUE(Ipv4View(header.data(), header.size()).isChecksumValid());
+
+    std::vector<uint8_t> corrupted = header;
+    corrupted[8] = 0x3f;
+    EXPECT_FALSE(Ipv4View(corrupted.data(), corrupted.size()).isChecksumValid());
+}
+
+TEST(Ipv4ViewUnitTests, ToDataUnit)
+{
+    std::vector<uint8_t> buffer(20, 0);
+    Ipv4DataUnit().setTTL(9).setSourceAddress("10.0.0.1").serialize(buffer.data(), buffer.size());
+
+    Ipv4DataUnit packet = Ipv4View(buffer.data(), buffer.size()).toDataUnit();
+    EXPECT_EQ(packet.getTTL(), 9);
+    EXPECT_EQ(packet.getSourceAddress(), "10.0.0.1");
+}
+
+} // namespace tests
+} // namespace ip
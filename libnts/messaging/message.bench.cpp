@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/icmp/icmp.hpp>
+#include <libnts/ipv4/ipv4.hpp>
+#include <libnts/messaging/message.hpp>
+#include <libnts/messaging/parser.hpp>
+
+namespace nts {
+namespace benchmarks {
+
+namespace {
+
+/// ICMP echo request with a payload, as received from the network.
+std::vector<uint8_t> makeFrame()
+{
+    std::shared_ptr<MessageParser> parser = MessageParser::getInstance();
+    parser->addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet");
+    parser->addProtocol(std::make_shared<ip::Ipv4Parser>(), "ipv4");
+    parser->addProtocol(std::make_shared<icmp::IcmpParser>(), "icmp");
+
+    Message message = Message()
+                          .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+                          .addDataUnit(std::make_shared<ip::Ipv4DataUnit>(ip::Ipv4DataUnit().setProtocol((uint8_t)ip::IpPayloadProtocols::ICMP)))
+                          .addDataUnit(std::make_shared<icmp::IcmpDataUnit>())
+                          .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData(std::vector<uint8_t>(56, 0xab))));
+    std::vector<uint8_t> frame(message.getSize(), 0);
+    message.serialize(frame.data(), frame.size());
+    return frame;
+}
+
+} // namespace
+
+/// Filter that only looks at the first header, with every layer decoded up front.
+void BM_MessageFilterEager(benchmark::State& state)
+{
+    const std::vector<uint8_t> frame = makeFrame();
+    for (auto _ : state)
+    {
+        Message message;
+        message.deserialize(frame.data(), frame.size());
+        benchmark::DoNotOptimize(message.getDataUnit("ethernet"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Filter that only looks at the first header, decoding only that header.
+void BM_MessageFilterLazy(benchmark::State& state)
+{
+    const std::vector<uint8_t> frame = makeFrame();
+    for (auto _ : state)
+    {
+        Message message = Message().setLazy(true);
+        message.deserialize(frame.data(), frame.size());
+        benchmark::DoNotOptimize(message.getDataUnit("ethernet"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Every layer is needed, so lazy decoding can only add overhead.
+void BM_MessageAllLayersLazy(benchmark::State& state)
+{
+    const std::vector<uint8_t> frame = makeFrame();
+    for (auto _ : state)
+    {
+        Message message = Message().setLazy(true);
+        message.deserialize(frame.data(), frame.size());
+        benchmark::DoNotOptimize(message.hasProtocol("generic"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Every layer is needed, with the units and the message recycled between frames.
+void BM_MessageAllLayersPooled(benchmark::State& state)
+{
+    const std::vector<uint8_t> frame = makeFrame();
+    Message message = Message().setLazy(true).setPool(DataUnitPool::create());
+    for (auto _ : state)
+    {
+        message.clear().deserialize(frame.data(), frame.size());
+        benchmark::DoNotOptimize(message.hasProtocol("generic"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MessageFilterEager);
+BENCHMARK(BM_MessageFilterLazy);
+BENCHMARK(BM_MessageAllLayersLazy);
+BENCHMARK(BM_MessageAllLayersPooled);
+
+} // namespace benchmarks
+} // namespace nts
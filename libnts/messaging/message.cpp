@@ -1,6 +1,7 @@
 #include <libnts/messaging/message.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include <libnts/messaging/parser.hpp>
@@ -13,17 +14,73 @@ void Message::toStream(std::ostream& outStream) const
     {
         unit->toStream(outStream);
     }
+
+    // Pending layers are written as they were received.
+    outStream.write(reinterpret_cast<const char*>(rawData.data() + rawOffset), rawData.size() - rawOffset);
 }
 
 void Message::fromStream(std::istream& inStream)
 {
+    if (lazy)
+    {
+        // Keep everything that is left in the stream for later.
+        GenericDataUnit raw;
+        raw.fromStream(inStream);
+        setRawData(raw.getData().data(), raw.getUnitSize());
+        return;
+    }
+
     if (std::shared_ptr<MessageParser> parser = MessageParser::getInstance())
     {
-        std::map<std::string, int> context;
+        ParserContext context;
+        context.pool = pool.get();
         parser->parse(inStream, context, dataUnits);
     }
 }
 
+std::size_t Message::serialize(uint8_t* outBuffer, const std::size_t capacity) const
+{
+    std::size_t offset = 0;
+    for (const auto& unit : dataUnits)
+    {
+        if (unit->getUnitSize() > capacity - offset)
+        {
+            return 0;
+        }
+        offset += unit->serialize(outBuffer + offset, capacity - offset);
+    }
+
+    // Pending layers are written as they were received.
+    const std::size_t rawSize = rawData.size() - rawOffset;
+    if (rawSize > capacity - offset)
+    {
+        return 0;
+    }
+    if (rawSize > 0)
+    {
+        memcpy(outBuffer + offset, rawData.data() + rawOffset, rawSize);
+    }
+    return offset + rawSize;
+}
+
+std::size_t Message::deserialize(const uint8_t* inBuffer, const std::size_t length)
+{
+    if (lazy)
+    {
+        setRawData(inBuffer, length);
+        return length;
+    }
+
+    std::size_t bytes = 0;
+    if (std::shared_ptr<MessageParser> parser = MessageParser::getInstance())
+    {
+        ParserContext context;
+        context.pool = pool.get();
+        bytes = parser->parse(inBuffer, length, context, dataUnits);
+    }
+    return bytes;
+}
+
 std::string Message::toString() const
 {
     std::stringstream stream;
@@ -40,9 +97,11 @@ std::string Message::toString() const
 
 std::string Message::toVerboseString() const
 {
+    decodeAll();
+
     std::stringstream stream;
     stream << "[Message]\n";
-    for (const auto unit : dataUnits)
+    for (const auto& unit : dataUnits)
     {
         stream << unit->toString();
     }
@@ -51,7 +110,8 @@ std::string Message::toVerboseString() const
 
 std::size_t Message::getSize() const
 {
-    std::size_t totalSize = 0;
+    // Pending layers count with their raw size.
+    std::size_t totalSize = rawData.size() - rawOffset;
     for (const auto& unit : dataUnits)
     {
         totalSize += unit->getUnitSize();
@@ -61,12 +121,14 @@ std::size_t Message::getSize() const
 
 Message& Message::addDataUnit(std::shared_ptr<ProtocolDataUnit> data)
 {
+    decodeAll();
     dataUnits.push_back(data);
     return *this;
 }
 
 Message& Message::removeDataUnit(const std::string protocol)
 {
+    decodeAll();
     if (auto unit = getDataUnit(protocol))
     {
         auto removeItr = std::remove(dataUnits.begin(), dataUnits.end(), unit);
@@ -77,6 +139,7 @@ Message& Message::removeDataUnit(const std::string protocol)
 
 void Message::getDataUnits(std::vector<std::shared_ptr<ProtocolDataUnit>>& outUnits)
 {
+    decodeAll();
     outUnits = dataUnits;
 }
 
@@ -89,11 +152,21 @@ std::shared_ptr<ProtocolDataUnit> Message::getDataUnit(const std::string protoco
             return unit;
         }
     }
+
+    // Decode the pending layers until the protocol shows up.
+    while (decodeNext())
+    {
+        if (dataUnits.back()->getProtocolTag() == protocol)
+        {
+            return dataUnits.back();
+        }
+    }
     return nullptr;
 }
 
 void Message::getProtocolTags(std::vector<std::string>& outTags) const
 {
+    decodeAll();
     for (auto unit : dataUnits)
     {
         outTags.push_back(unit->getProtocolTag());
@@ -109,7 +182,94 @@ bool Message::hasProtocol(const std::string protocolTag) const
             return true;
         }
     }
+
+    // Decode the pending layers until the protocol shows up.
+    while (decodeNext())
+    {
+        if (dataUnits.back()->getProtocolTag() == protocolTag)
+        {
+            return true;
+        }
+    }
     return false;
 }
 
+bool Message::isLazy() const
+{
+    return lazy;
+}
+
+Message& Message::setLazy(const bool lazy)
+{
+    if (!lazy)
+    {
+        decodeAll();
+    }
+    this->lazy = lazy;
+    return *this;
+}
+
+Message& Message::clear()
+{
+    dataUnits.clear();
+    rawData.clear();
+    rawOffset = 0;
+    rawContext = ParserContext();
+    rawContext.pool = pool.get();
+    return *this;
+}
+
+std::shared_ptr<DataUnitPool> Message::getPool() const
+{
+    return pool;
+}
+
+Message& Message::setPool(std::shared_ptr<DataUnitPool> pool)
+{
+    this->pool = pool;
+    rawContext.pool = pool.get();
+    return *this;
+}
+
+bool Message::decodeNext() const
+{
+    const std::size_t rawSize = rawData.size() - rawOffset;
+    if (rawSize == 0)
+    {
+        return false;
+    }
+
+    std::size_t bytes = 0;
+    if (std::shared_ptr<MessageParser> parser = MessageParser::getInstance())
+    {
+        dataUnits.push_back(parser->parseBuffer(rawData.data() + rawOffset, rawSize, rawContext, bytes));
+    }
+    else
+    {
+        GenericParser generic = GenericParser();
+        dataUnits.push_back(generic.parseBuffer(rawData.data() + rawOffset, rawSize, rawContext, bytes));
+    }
+
+    // Layers that take nothing would never let the decoding finish.
+    rawOffset += (bytes == 0) ? rawSize : std::min(bytes, rawSize);
+    return true;
+}
+
+void Message::decodeAll() const
+{
+    while (decodeNext())
+    {
+    }
+}
+
+void Message::setRawData(const uint8_t* inData, const std::size_t length)
+{
+    // Layers of a previous read are decoded before they are replaced.
+    decodeAll();
+    rawData.assign(inData, inData + length);
+    rawOffset = 0;
+    rawContext = ParserContext();
+    rawContext.pool = pool.get();
+}
+
 } // namespace nts
@@ -3,11 +3,41 @@
 #include <memory>
 
 #include <libnts/core/data_unit.hpp>
+#include <libnts/core/data_unit_pool.hpp>
 #include <libnts/core/serializable.hpp>
+#include <libnts/messaging/parser.hpp>
 
 namespace nts {
 
 /// Collection of protocol data units that together represent a message.
+///
+/// @details In lazy mode, reading a message only stores its raw bytes. Layers are decoded
+/// one at a time with the MessageParser, and only once a getter needs them, so a filter that
+/// only looks at the first header doesn't pay for the rest. Decoded layers are kept, so
+/// repeated access is free. Lazy decoding relies on the dispatch table of the parser, so
+/// parsers without dispatch keys are not consulted.
+///
+/// Data units can be taken from a DataUnitPool instead of the heap. Clearing a message and
+/// reading the next one into it then recycles the units, the unit list and the raw bytes, so
+/// a receive loop stops allocating once it is warmed up.
+///
+/// @note Const getters may decode layers, so a lazy message must not be shared between
+/// threads without synchronization.
+///
+/// @example
+/// Message message = Message().setLazy(true);
+/// session->receive(message);
+/// if (message.hasProtocol("ipv4")) // Decodes the Ethernet and IPv4 headers only.
+/// {
+///     ...
+/// }
+///
+/// message.setPool(DataUnitPool::create());
+/// while (running)
+/// {
+///     session->receive(message.clear());
+///     ...
+/// }
 class Message : public Serializable
 {
 public:
@@ -23,6 +53,15 @@ public:
     /// Reads the message from the stream.
     virtual void fromStream(std::istream& inStream);
 
+    /// Writes every data unit of the message to the buffer, in order.
+    /// @returns The number of bytes written, or 0 if the message does not fit.
+    virtual std::size_t serialize(uint8_t* outBuffer, const std::size_t capacity) const;
+
+    /// Reads the message from the buffer.
+    /// @details Layers are parsed straight from the buffer, or only copied in lazy mode.
+    /// @returns The number of bytes read.
+    virtual std::size_t deserialize(const uint8_t* inBuffer, const std::size_t length);
+
     /// Representation of the message in a console friendly format.
     virtual std::string toString() const;
 
@@ -50,8 +89,52 @@ public:
     /// Wether the message contains a protocol with the given tag.
     bool hasProtocol(const std::string protocolTag) const;
 
+    /// Whether layers are only decoded when they are needed.
+    bool isLazy() const;
+
+    /// Whether layers are only decoded when they are needed.
+    /// @details Turning lazy mode off decodes the pending layers.
+    Message& setLazy(const bool lazy);
+
+    /// Removes every data unit and pending layer, keeping the allocated storage.
+    Message& clear();
+
+    /// Pool that parsed data units are taken from, or nullptr.
+    std::shared_ptr<DataUnitPool> getPool() const;
+
+    /// Pool that parsed data units are taken from.
+    /// @details Units are taken from the heap when the pool is null.
+    Message& setPool(std::shared_ptr<DataUnitPool> pool);
+
+protected:
+    /// Decode the next pending layer.
+    /// @returns Whether a layer was decoded.
+    bool decodeNext() const;
+
+    /// Decode all pending layers.
+    void decodeAll() const;
+
+    /// Keep the data as the pending layers of the message.
+    void setRawData(const uint8_t* inData, const std::size_t length);
+
 private:
-    std::vector<std::shared_ptr<ProtocolDataUnit>> dataUnits;
+    /// Data units of the message. In lazy mode, only the ones decoded so far.
+    mutable std::vector<std::shared_ptr<ProtocolDataUnit>> dataUnits;
+
+    /// Whether layers are only decoded when they are needed.
+    bool lazy{ false };
+
+    /// Raw bytes of the message, kept in lazy mode.
+    std::vector<uint8_t> rawData;
+
+    /// Offset of the first byte that was not decoded yet.
+    mutable std::size_t rawOffset{ 0 };
+
+    /// Context of the next layer to decode.
+    mutable ParserContext rawContext;
+
+    /// Pool that parsed data units are taken from.
+    std::shared_ptr<DataUnitPool> pool;
 };
 
 } // namespace nts
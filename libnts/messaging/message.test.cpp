@@ -1,5 +1,9 @@
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <gtest/gtest.h>
+#include <new>
+#include <sstream>
 
 #include <libnts/messaging/message.hpp>
 
@@ -8,6 +12,33 @@
 #include <libnts/icmp/icmp.hpp>
 #include <libnts/ipv4/ipv4.hpp>
 
+namespace {
+
+/// Number of heap allocations made by the test binary.
+std::atomic<std::size_t> allocationCount{ 0 };
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    allocationCount++;
+    if (void* block = std::malloc(size == 0 ? 1 : size))
+    {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
 namespace nts {
 namespace tests {
 
@@ -55,5 +86,155 @@ TEST(MessageUnitTests, DataUnits)
     ASSERT_TRUE(doesMessageContainGenericPayload);
 }
 
+TEST(MessageUnitTests, BufferSerialization)
+{
+    auto frame = std::make_shared<eth::EthernetDataUnit>();
+    frame->setEtherType((uint16_t)eth::EtherType::IPv4);
+    auto packet = std::make_shared<ip::Ipv4DataUnit>();
+    auto payload = std::make_shared<GenericDataUnit>(GenericDataUnit().setData({ 0, 1, 2, 3 }));
+    Message messageA = Message().addDataUnit(frame).addDataUnit(packet).addDataUnit(payload);
+    ASSERT_EQ(messageA.getSize(), 38);
+
+    // Doesn't fit.
+    std::vector<uint8_t> buffer(37, 0);
+    EXPECT_EQ(messageA.serialize(buffer.data(), buffer.size()), 0);
+
+    // Both APIs produce the same bytes.
+    buffer.resize(64);
+    ASSERT_EQ(messageA.serialize(buffer.data(), buffer.size()), 38);
+    std::stringstream stream;
+    messageA.toStream(stream);
+    EXPECT_EQ(stream.str(), std::string(buffer.begin(), buffer.begin() + 38));
+
+    // Reading from a buffer consumes all of it.
+    Message messageB;
+    EXPECT_EQ(messageB.deserialize(buffer.data(), 38), 38);
+    EXPECT_EQ(messageB.getSize(), 38);
+
+    // Layers parsed from the buffer are the same as those parsed from a stream.
+    Message messageC;
+    messageC.fromStream(stream);
+    std::vector<std::string> tagsB;
+    std::vector<std::string> tagsC;
+    messageB.getProtocolTags(tagsB);
+    messageC.getProtocolTags(tagsC);
+    EXPECT_EQ(tagsB, tagsC);
+    EXPECT_EQ(messageB.toVerboseString(), messageC.toVerboseString());
+}
+
+TEST(MessageUnitTests, LazyParsing)
+{
+    std::shared_ptr<MessageParser> parser = MessageParser::getInstance();
+    parser->addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet");
+    parser->addProtocol(std::make_shared<ip::Ipv4Parser>(), "ipv4");
+    parser->addProtocol(std::make_shared<icmp::IcmpParser>(), "icmp");
+
+    Message request = Message()
+                          .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+                          .addDataUnit(std::make_shared<ip::Ipv4DataUnit>(ip::Ipv4DataUnit().setProtocol((uint8_t)ip::IpPayloadProtocols::ICMP).setTTL(7)))
+                          .addDataUnit(std::make_shared<icmp::IcmpDataUnit>())
+                          .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData({ 1, 2, 3 })));
+    std::vector<uint8_t> buffer(request.getSize(), 0);
+    ASSERT_EQ(request.serialize(buffer.data(), buffer.size()), 45);
+
+    Message reply = Message().setLazy(true);
+    ASSERT_TRUE(reply.isLazy());
+    EXPECT_EQ(reply.deserialize(buffer.data(), buffer.size()), 45);
+    EXPECT_EQ(reply.getSize(), 45);
+
+    // Only the requested layers are decoded, and they are kept.
+    auto packet = std::dynamic_pointer_cast<ip::Ipv4DataUnit>(reply.getDataUnit("ipv4"));
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(packet->getTTL(), 7);
+    EXPECT_EQ(reply.getDataUnit("ipv4"), packet);
+    EXPECT_TRUE(reply.hasProtocol("ethernet"));
+    EXPECT_EQ(reply.getSize(), 45);
+
+    // Pending layers are written as they were received.
+    std::vector<uint8_t> copy(64, 0);
+    ASSERT_EQ(reply.serialize(copy.data(), copy.size()), 45);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), copy.begin()));
+
+    // Missing protocols decode everything.
+    EXPECT_FALSE(reply.hasProtocol("tcp"));
+    std::vector<std::string> protocols;
+    reply.getProtocolTags(protocols);
+    EXPECT_EQ(protocols, std::vector<std::string>({ "ethernet", "ipv4", "icmp", "generic" }));
+
+    // The stream API works the same way.
+    std::stringstream stream;
+    request.toStream(stream);
+    Message streamed = Message().setLazy(true);
+    streamed.fromStream(stream);
+    EXPECT_EQ(streamed.getSize(), 45);
+    EXPECT_TRUE(streamed.hasProtocol("icmp"));
+    streamed.setLazy(false);
+    std::vector<std::shared_ptr<ProtocolDataUnit>> units;
+    streamed.getDataUnits(units);
+    EXPECT_EQ(units.size(), 4);
+
+    parser->removeProtocol("ethernet");
+    parser->removeProtocol("ipv4");
+    parser->removeProtocol("icmp");
+}
+
+TEST(MessageUnitTests, PooledParsing)
+{
+    std::shared_ptr<MessageParser> parser = MessageParser::getInstance();
+    parser->addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet");
+    parser->addProtocol(std::make_shared<ip::Ipv4Parser>(), "ipv4");
+    parser->addProtocol(std::make_shared<icmp::IcmpParser>(), "icmp");
+
+    Message request = Message()
+                          .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+                          .addDataUnit(std::make_shared<ip::Ipv4DataUnit>(ip::Ipv4DataUnit().setProtocol((uint8_t)ip::IpPayloadProtocols::ICMP).setTTL(7)))
+                          .addDataUnit(std::make_shared<icmp::IcmpDataUnit>())
+                          .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData({ 1, 2, 3 })));
+    std::vector<uint8_t> buffer(request.getSize(), 0);
+    ASSERT_EQ(request.serialize(buffer.data(), buffer.size()), 45);
+
+    auto pool = DataUnitPool::create();
+    Message reply = Message().setLazy(true).setPool(pool);
+    EXPECT_EQ(reply.getPool(), pool);
+
+    // The first rounds warm up the pool and the storage of the message.
+    for (int i = 0; i < 2; i++)
+    {
+        reply.clear().deserialize(buffer.data(), buffer.size());
+        ASSERT_TRUE(reply.getDataUnit("generic"));
+    }
+    EXPECT_EQ(pool->getFreeObjectCount(), 0);
+
+    // Once warmed up, a receive loop doesn't touch the heap.
+    const std::size_t allocations = allocationCount;
+    for (int i = 0; i < 100; i++)
+    {
+        reply.clear().deserialize(buffer.data(), buffer.size());
+        auto packet = std::dynamic_pointer_cast<ip::Ipv4DataUnit>(reply.getDataUnit("ipv4"));
+        ASSERT_TRUE(packet);
+        EXPECT_EQ(packet->getTTL(), 7);
+        EXPECT_TRUE(reply.getDataUnit("generic"));
+    }
+    EXPECT_EQ(allocationCount, allocations);
+
+    // Recycled units don't carry the fields of the previous message.
+    reply.clear();
+    EXPECT_EQ(pool->getFreeObjectCount(), 4);
+    auto packet = pool->make<ip::Ipv4DataUnit>();
+    EXPECT_EQ(packet->getTTL(), ip::Ipv4DataUnit().getTTL());
+
+    // Eager parsing takes its units from the pool too.
+    Message eager = Message().setPool(pool);
+    std::stringstream stream;
+    request.toStream(stream);
+    eager.fromStream(stream);
+    EXPECT_EQ(eager.getSize(), 45);
+    EXPECT_EQ(pool->getFreeObjectCount(), 0);
+
+    parser->removeProtocol("ethernet");
+    parser->removeProtocol("ipv4");
+    parser->removeProtocol("icmp");
+}
+
 } // namespace tests
 } // namespace nts
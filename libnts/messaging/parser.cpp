@@ -1,9 +1,37 @@
 #include <libnts/messaging/parser.hpp>
 
 #include <algorithm>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
 
 namespace nts {
 
+void ProtocolParser::getDispatchKeys(std::vector<ParserContext>& outKeys) const
+{
+    outKeys.clear();
+}
+
+std::shared_ptr<ProtocolDataUnit> ProtocolParser::parseLayer(std::istream& inStream, ParserContext& context) const
+{
+    std::map<std::string, int> legacyContext;
+    std::shared_ptr<ProtocolDataUnit> unit = parse(inStream, legacyContext);
+    context.protocol = ProtocolId::Unknown;
+    context.nextProtocol = 0;
+    return unit;
+}
+
+std::shared_ptr<ProtocolDataUnit> ProtocolParser::parseBuffer(const uint8_t* inBuffer, const std::size_t length, ParserContext& context, std::size_t& outBytes) const
+{
+    boost::iostreams::stream<boost::iostreams::array_source> is(reinterpret_cast<const char*>(inBuffer), length);
+    std::shared_ptr<ProtocolDataUnit> unit = parseLayer(is, context);
+
+    // Units that read past the end, or not at all, take the whole buffer.
+    is.clear();
+    const std::streamoff bytes = is.tellg();
+    outBytes = (bytes <= 0) ? length : std::min<std::size_t>(bytes, length);
+    return unit;
+}
+
 std::shared_ptr<MessageParser> MessageParser::getInstance()
 {
     static std::shared_ptr<MessageParser> messageParser = std::make_shared<MessageParser>();
@@ -11,6 +39,71 @@ std::shared_ptr<MessageParser> MessageParser::getInstance()
 }
 
 void MessageParser::parse(std::istream& inStream, std::map<std::string, int>& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const
+{
+    // A string context can only be translated when it is empty, at the start of a message.
+    if (!legacyParsers.empty() || !inContext.empty())
+    {
+        parseLegacy(inStream, inContext, outMessage);
+        return;
+    }
+    ParserContext context;
+    parse(inStream, context, outMessage);
+}
+
+void MessageParser::parse(std::istream& inStream, ParserContext& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const
+{
+    if (!legacyParsers.empty() && inContext.protocol == ProtocolId::None)
+    {
+        std::map<std::string, int> context;
+        parseLegacy(inStream, context, outMessage);
+        return;
+    }
+
+    while (inStream.good() && inStream.peek() >= 0)
+    {
+        outMessage.push_back(parseLayer(inStream, inContext));
+    }
+}
+
+std::size_t MessageParser::parse(const uint8_t* inBuffer, const std::size_t length, ParserContext& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const
+{
+    if (!legacyParsers.empty() && inContext.protocol == ProtocolId::None)
+    {
+        boost::iostreams::stream<boost::iostreams::array_source> is(reinterpret_cast<const char*>(inBuffer), length);
+        std::map<std::string, int> context;
+        parseLegacy(is, context, outMessage);
+        is.clear();
+        const std::streamoff bytes = is.tellg();
+        return (bytes < 0) ? length : std::min<std::size_t>(bytes, length);
+    }
+
+    std::size_t offset = 0;
+    while (offset < length)
+    {
+        std::size_t bytes = 0;
+        outMessage.push_back(parseBuffer(inBuffer + offset, length - offset, inContext, bytes));
+
+        // Layers that take nothing would never let the parsing finish.
+        offset += (bytes == 0) ? length - offset : std::min(bytes, length - offset);
+    }
+    return offset;
+}
+
+std::shared_ptr<ProtocolDataUnit> MessageParser::parseLayer(std::istream& inStream, ParserContext& inContext) const
+{
+    // Look for the parser registered for the given context.
+    const auto it = dispatchTable.find(getDispatchKey(inContext));
+    if (it != dispatchTable.end())
+    {
+        return it->second->parseLayer(inStream, inContext);
+    }
+
+    // Use the generic parser to retrieve the remaining data.
+    GenericParser generic = GenericParser();
+    return generic.parseLayer(inStream, inContext);
+}
+
+void MessageParser::parseLegacy(std::istream& inStream, std::map<std::string, int>& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const
 {
     while (inStream.good() && inStream.peek() >= 0)
     {
@@ -34,14 +127,71 @@ void MessageParser::parse(std::istream& inStream, std::map<std::string, int>& in
     }
 }
 
+std::shared_ptr<ProtocolDataUnit> MessageParser::parseBuffer(const uint8_t* inBuffer, const std::size_t length, ParserContext& inContext, std::size_t& outBytes) const
+{
+    // Look for the parser registered for the given context.
+    const auto it = dispatchTable.find(getDispatchKey(inContext));
+    if (it != dispatchTable.end())
+    {
+        return it->second->parseBuffer(inBuffer, length, inContext, outBytes);
+    }
+
+    // Use the generic parser to retrieve the remaining data.
+    GenericParser generic = GenericParser();
+    return generic.parseBuffer(inBuffer, length, inContext, outBytes);
+}
+
+uint64_t MessageParser::getDispatchKey(const ParserContext& context)
+{
+    return (static_cast<uint64_t>(context.protocol) << 32) | context.nextProtocol;
+}
+
 void MessageParser::addProtocol(std::shared_ptr<ProtocolParser> parser, std::string identifier)
 {
+    removeProtocol(identifier);
+    parsers[identifier] = parser;
+
+    std::vector<ParserContext> keys;
+    parser->getDispatchKeys(keys);
+    for (const auto& key : keys)
+    {
+        dispatchTable[getDispatchKey(key)] = parser;
+    }
+    if (keys.empty())
+    {
+        legacyParsers.insert(identifier);
+    }
+}
+
+void MessageParser::addProtocol(std::shared_ptr<ProtocolParser> parser, std::string identifier, const ParserContext& key)
+{
+    removeProtocol(identifier);
     parsers[identifier] = parser;
+    dispatchTable[getDispatchKey(key)] = parser;
 }
 
 void MessageParser::removeProtocol(std::string identifier)
 {
-    parsers.erase(identifier);
+    const auto it = parsers.find(identifier);
+    if (it == parsers.end())
+    {
+        return;
+    }
+
+    // Keys that a later registration took over belong to the other parser.
+    for (auto entry = dispatchTable.begin(); entry != dispatchTable.end();)
+    {
+        if (entry->second == it->second)
+        {
+            entry = dispatchTable.erase(entry);
+        }
+        else
+        {
+            entry++;
+        }
+    }
+    legacyParsers.erase(identifier);
+    parsers.erase(it);
 }
 
 std::shared_ptr<ProtocolParser> MessageParser::getProtocol(std::string identifier) const
@@ -53,7 +203,7 @@ std::shared_ptr<ProtocolParser> MessageParser::getProtocol(std::string identifie
     return nullptr;
 }
 
-bool GenericParser::canParse(const std::map<std::string, int>& inContext) const
+bool GenericParser::canParse(const std::map<std::string, int>&) const
 {
     return true;
 }
@@ -69,7 +219,29 @@ std::shared_ptr<ProtocolDataUnit> GenericParser::parse(std::istream& inStream, s
     outContext["generic"] = 1;
     outContext["size"] = generic->getData().size();
 
-    return std::move(generic);
+    return generic;
+}
+
+std::shared_ptr<ProtocolDataUnit> GenericParser::parseLayer(std::istream& inStream, ParserContext& context) const
+{
+    std::shared_ptr<GenericDataUnit> generic = makeDataUnit<GenericDataUnit>(context.pool);
+    generic->fromStream(inStream);
+
+    context.protocol = ProtocolId::Unknown;
+    context.nextProtocol = 0;
+
+    return generic;
+}
+
+std::shared_ptr<ProtocolDataUnit> GenericParser::parseBuffer(const uint8_t* inBuffer, const std::size_t length, ParserContext& context, std::size_t& outBytes) const
+{
+    std::shared_ptr<GenericDataUnit> generic = makeDataUnit<GenericDataUnit>(context.pool);
+    outBytes = generic->deserialize(inBuffer, length);
+
+    context.protocol = ProtocolId::Unknown;
+    context.nextProtocol = 0;
+
+    return generic;
 }
 
 } // namespace nts
@@ -1,13 +1,45 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 #include <libnts/core/data_unit.hpp>
+#include <libnts/core/data_unit_pool.hpp>
 
 namespace nts {
 
+/// Identifies a protocol in the dispatch table of the MessageParser.
+/// @details Protocols defined outside the library should use values from Custom onwards.
+enum class ProtocolId : uint16_t
+{
+    None = 0,
+    Ethernet = 1,
+    Ipv4 = 2,
+    Icmp = 3,
+    Custom = 0x8000,
+    Unknown = 0xFFFF,
+};
+
+/// Context passed between protocol parsers.
+/// @details Identifies the last parsed protocol and the value of its next-protocol field,
+/// such as the EtherType or the IP protocol number. Together they select the parser of the
+/// next layer.
+struct ParserContext
+{
+    /// Protocol of the last parsed data unit. None at the start of a message.
+    ProtocolId protocol{ ProtocolId::None };
+
+    /// Next-protocol field of the last parsed data unit.
+    uint32_t nextProtocol{ 0 };
+
+    /// Pool that parsers take data units from. Units come from the heap when it is null.
+    DataUnitPool* pool{ nullptr };
+};
+
 /// Base class for protocol data unit parsers.
 class ProtocolParser
 {
@@ -23,9 +55,31 @@ public:
 
     /// Parse a single protocol data unit from the stream.
     virtual std::shared_ptr<ProtocolDataUnit> parse(std::istream& inStream, std::map<std::string, int>& outContext) const = 0;
+
+    /// Contexts in which this parser can be used, for the dispatch table of the MessageParser.
+    /// @details Parsers without dispatch keys are only reachable through canParse().
+    virtual void getDispatchKeys(std::vector<ParserContext>& outKeys) const;
+
+    /// Parse a single protocol data unit from the stream, and update the context with the
+    /// protocol of the unit and its next-protocol field.
+    /// @details The default implementation is an adapter over the string context parse. It
+    /// reports ProtocolId::Unknown, so the remaining data ends up in a GenericDataUnit unless
+    /// another parser was bound to that context.
+    virtual std::shared_ptr<ProtocolDataUnit> parseLayer(std::istream& inStream, ParserContext& context) const;
+
+    /// Parse a single protocol data unit from the buffer, and update the context with the
+    /// protocol of the unit and its next-protocol field.
+    /// @details The default implementation is an adapter over parseLayer().
+    /// @param outBytes Number of bytes taken by the unit.
+    virtual std::shared_ptr<ProtocolDataUnit> parseBuffer(const uint8_t* inBuffer, const std::size_t length, ParserContext& context, std::size_t& outBytes) const;
 };
 
 /// Singleton class for parsing several protocol data units.
+///
+/// @details Parsers are found with a single table lookup keyed by the protocol of the previous
+/// layer and its next-protocol field. Parsers that don't report dispatch keys still work, but
+/// while any of them is registered, messages are parsed by asking every parser whether it
+/// canParse() the current string context, as before.
 class MessageParser
 {
 public:
@@ -40,19 +94,60 @@ public:
 
     /// Deserialize all known protocols in the stream.
     /// Unrecognized protocols will be converted to a GenericDataUnit.
+    /// @note The context is only updated when parsers without dispatch keys are registered.
     void parse(std::istream& inStream, std::map<std::string, int>& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const;
 
+    /// Deserialize all known protocols in the stream, starting from the given context.
+    /// Unrecognized protocols will be converted to a GenericDataUnit.
+    void parse(std::istream& inStream, ParserContext& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const;
+
+    /// Deserialize all known protocols in the buffer, starting from the given context.
+    /// Unrecognized protocols will be converted to a GenericDataUnit.
+    /// @details Layers are parsed with parseBuffer(), unless parsers without dispatch keys are
+    /// registered, in which case the buffer is parsed as a stream.
+    /// @returns The number of bytes taken by the units.
+    std::size_t parse(const uint8_t* inBuffer, const std::size_t length, ParserContext& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const;
+
+    /// Deserialize a single protocol data unit, with the parser registered for the context.
+    /// Unrecognized protocols will be converted to a GenericDataUnit.
+    /// @note Parsers without dispatch keys are not consulted.
+    std::shared_ptr<ProtocolDataUnit> parseLayer(std::istream& inStream, ParserContext& inContext) const;
+
+    /// Deserialize a single protocol data unit from the buffer, with the parser registered for
+    /// the context. Unrecognized protocols will be converted to a GenericDataUnit.
+    /// @param outBytes Number of bytes taken by the unit.
+    /// @note Parsers without dispatch keys are not consulted.
+    std::shared_ptr<ProtocolDataUnit> parseBuffer(const uint8_t* inBuffer, const std::size_t length, ParserContext& inContext, std::size_t& outBytes) const;
+
     /// Add a parser for a specific protocol.
+    /// @details The parser is added to the dispatch table under each of its dispatch keys.
     void addProtocol(std::shared_ptr<ProtocolParser> parser, std::string identifier);
 
+    /// Add a parser for a specific protocol, to be used in the given context.
+    /// @details Lets parsers without dispatch keys take part in table dispatch.
+    void addProtocol(std::shared_ptr<ProtocolParser> parser, std::string identifier, const ParserContext& key);
+
     /// Remove a specific protocol parser.
     void removeProtocol(std::string identifier);
 
     /// Protocol parser with the given identifier.
     std::shared_ptr<ProtocolParser> getProtocol(std::string identifier) const;
 
+protected:
+    /// Deserialize the stream by asking every parser whether it can parse the current context.
+    void parseLegacy(std::istream& inStream, std::map<std::string, int>& inContext, std::vector<std::shared_ptr<ProtocolDataUnit>>& outMessage) const;
+
+    /// Key of the dispatch table for the given context.
+    static uint64_t getDispatchKey(const ParserContext& context);
+
 private:
     std::map<std::string, std::shared_ptr<ProtocolParser>> parsers;
+
+    /// Parsers by the context they are used in.
+    std::unordered_map<uint64_t, std::shared_ptr<ProtocolParser>> dispatchTable;
+
+    /// Identifiers of the parsers that were registered without dispatch keys.
+    std::set<std::string> legacyParsers;
 };
 
 /// Generic data unit parser for unspecified protocols.
@@ -70,6 +165,12 @@ public:
 
     /// Extract all available data as a single generic data unit.
     virtual std::shared_ptr<ProtocolDataUnit> parse(std::istream& inStream, std::map<std::string, int>& outContext) const final;
+
+    /// Extract all available data as a single generic data unit.
+    virtual std::shared_ptr<ProtocolDataUnit> parseLayer(std::istream& inStream, ParserContext& context) const final;
+
+    /// Extract all available data as a single generic data unit.
+    virtual std::shared_ptr<ProtocolDataUnit> parseBuffer(const uint8_t* inBuffer, const std::size_t length, ParserContext& context, std::size_t& outBytes) const final;
 };
 
 } // namespace nts
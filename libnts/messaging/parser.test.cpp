@@ -3,8 +3,12 @@
 #include <boost/asio.hpp>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <sstream>
 
 #include <libnts/core/data_unit.hpp>
+#include <libnts/ethernet/ethernet.hpp>
+#include <libnts/icmp/icmp.hpp>
+#include <libnts/ipv4/ipv4.hpp>
 #include <libnts/messaging/message.hpp>
 
 namespace nts {
@@ -59,5 +63,103 @@ TEST(ParserUnitTests, Parse)
     ASSERT_EQ(genericData->getUnitSize(), 10);
 }
 
+TEST(ParserUnitTests, Dispatch)
+{
+    MessageParser messageParser;
+    messageParser.addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet");
+    messageParser.addProtocol(std::make_shared<ip::Ipv4Parser>(), "ipv4");
+    messageParser.addProtocol(std::make_shared<icmp::IcmpParser>(), "icmp");
+
+    // Ethernet, IPv4, ICMP and a payload.
+    Message request = Message()
+                          .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+                          .addDataUnit(std::make_shared<ip::Ipv4DataUnit>(ip::Ipv4DataUnit().setProtocol((uint8_t)ip::IpPayloadProtocols::ICMP)))
+                          .addDataUnit(std::make_shared<icmp::IcmpDataUnit>())
+                          .addDataUnit(std::make_shared<GenericDataUnit>(GenericDataUnit().setData({ 1, 2, 3 })));
+    std::stringstream stream;
+    request.toStream(stream);
+
+    ParserContext context;
+    std::vector<std::shared_ptr<ProtocolDataUnit>> units;
+    messageParser.parse(stream, context, units);
+    ASSERT_EQ(units.size(), 4);
+    EXPECT_EQ(units[0]->getProtocolTag(), "ethernet");
+    EXPECT_EQ(units[1]->getProtocolTag(), "ipv4");
+    EXPECT_EQ(units[2]->getProtocolTag(), "icmp");
+    EXPECT_EQ(units[3]->getProtocolTag(), "generic");
+    EXPECT_EQ(units[3]->getUnitSize(), 3);
+    EXPECT_EQ(context.protocol, ProtocolId::Unknown);
+
+    // Without the IPv4 parser, everything after the frame is generic.
+    messageParser.removeProtocol("ipv4");
+    stream.clear();
+    stream.seekg(0);
+    context = ParserContext();
+    units.clear();
+    messageParser.parse(stream, context, units);
+    ASSERT_EQ(units.size(), 2);
+    EXPECT_EQ(units[1]->getProtocolTag(), "generic");
+    EXPECT_EQ(units[1]->getUnitSize(), 31);
+
+    // Removing a parser whose keys were taken over by another one keeps table dispatch.
+    messageParser.addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet2");
+    messageParser.removeProtocol("ethernet");
+    stream.clear();
+    stream.seekg(0);
+    context = ParserContext();
+    units.clear();
+    messageParser.parse(stream, context, units);
+    ASSERT_EQ(units.size(), 2);
+    EXPECT_EQ(units[0]->getProtocolTag(), "ethernet");
+    EXPECT_EQ(context.protocol, ProtocolId::Unknown);
+}
+
+TEST(ParserUnitTests, LegacyParsers)
+{
+    // Written against the string context only.
+    class LegacyIpv4Parser : public ProtocolParser
+    {
+    public:
+        virtual bool canParse(const std::map<std::string, int>& inContext) const
+        {
+            return ip::Ipv4Parser().canParse(inContext);
+        }
+
+        virtual std::shared_ptr<ProtocolDataUnit> parse(std::istream& inStream, std::map<std::string, int>& outContext) const
+        {
+            return ip::Ipv4Parser().parse(inStream, outContext);
+        }
+    };
+
+    MessageParser messageParser;
+    messageParser.addProtocol(std::make_shared<eth::EthernetParser>(), "ethernet");
+    messageParser.addProtocol(std::make_shared<LegacyIpv4Parser>(), "ipv4");
+
+    Message request = Message()
+                          .addDataUnit(std::make_shared<eth::EthernetDataUnit>(eth::EthernetDataUnit().setEtherType((uint16_t)eth::EtherType::IPv4)))
+                          .addDataUnit(std::make_shared<ip::Ipv4DataUnit>());
+    std::stringstream stream;
+    request.toStream(stream);
+
+    // The string context is still honoured.
+    std::map<std::string, int> context;
+    std::vector<std::shared_ptr<ProtocolDataUnit>> units;
+    messageParser.parse(stream, context, units);
+    ASSERT_EQ(units.size(), 2);
+    EXPECT_EQ(units[1]->getProtocolTag(), "ipv4");
+    EXPECT_EQ(context.at("ipv4"), 1);
+
+    // Bound to a context, the same parser takes part in table dispatch.
+    messageParser.addProtocol(std::make_shared<LegacyIpv4Parser>(), "ipv4", ParserContext{ ProtocolId::Ethernet, 0x0800 });
+    stream.clear();
+    stream.seekg(0);
+    ParserContext layerContext;
+    units.clear();
+    messageParser.parse(stream, layerContext, units);
+    ASSERT_EQ(units.size(), 2);
+    EXPECT_EQ(units[1]->getProtocolTag(), "ipv4");
+    EXPECT_EQ(layerContext.protocol, ProtocolId::Unknown);
+}
+
 } // namespace tests
 } // namespace nts